@@ -0,0 +1,216 @@
+/*
+ * SPDX-FileCopyrightText: 2025 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "expression_emote.h"
+
+static const char *TAG = "emote_bench";
+
+#define BENCH_H_RES                 320
+#define BENCH_V_RES                 240
+#define BENCH_FPS                   30
+#define BENCH_FLUSH_DELAY_US        2000    // A 320x16 RGB565 band over 40 MHz SPI
+#define BENCH_ROUNDS                3
+#define BENCH_ASSETS_DEFAULT        "../../test_apps/spiffs/esp32_s3_assets.bin"
+
+typedef enum {
+    BENCH_OP_EVENT,
+    BENCH_OP_EMOJI,
+    BENCH_OP_DIALOG,
+    BENCH_OP_QRCODE,
+} bench_op_t;
+
+typedef struct {
+    bench_op_t op;
+    const char *arg;                // Event, emoji or dialog name, or QR code text
+    const char *message;            // Event message
+    uint32_t hold_ms;               // Time rendered before the next step
+} bench_step_t;
+
+// The sequence of test_emote_basic() in test_apps, shortened
+static const bench_step_t bench_script[] = {
+    { BENCH_OP_DIALOG, "angry",                 NULL,                                   1000 },
+    { BENCH_OP_EVENT,  EMOTE_MGR_EVT_LISTEN,    NULL,                                   1000 },
+    { BENCH_OP_EVENT,  EMOTE_MGR_EVT_SPEAK,     "你好，我是 esp_emote_expression，我是 Brookesia！", 2000 },
+    { BENCH_OP_EMOJI,  "happy",                 NULL,                                   500 },
+    { BENCH_OP_DIALOG, "angry",                 NULL,                                   500 },
+    { BENCH_OP_EVENT,  EMOTE_MGR_EVT_SPEAK,     "Hello, I'm esp_emote_expression, I'm Brookesia!", 2000 },
+    { BENCH_OP_QRCODE, "https://www.esp32.com", NULL,                                   1000 },
+    { BENCH_OP_EVENT,  EMOTE_MGR_EVT_IDLE,      NULL,                                   0 },
+    { BENCH_OP_EVENT,  EMOTE_MGR_EVT_BAT,       "0,50",                                 1000 },
+    { BENCH_OP_EVENT,  EMOTE_MGR_EVT_BAT,       "1,100",                                1000 },
+    { BENCH_OP_EVENT,  EMOTE_MGR_EVT_OFF,       NULL,                                   1000 },
+};
+
+static int64_t bench_cpu_time_us(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &ts);
+    return (int64_t)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
+static esp_err_t bench_run_step(emote_handle_t handle, const bench_step_t *step)
+{
+    switch (step->op) {
+    case BENCH_OP_EVENT:
+        return emote_set_event_msg(handle, step->arg, step->message);
+    case BENCH_OP_EMOJI:
+        return emote_set_anim_emoji(handle, step->arg);
+    case BENCH_OP_DIALOG:
+        return emote_insert_anim_dialog(handle, step->arg, step->hold_ms);
+    case BENCH_OP_QRCODE:
+        return emote_set_qrcode_data(handle, step->arg);
+    default:
+        return ESP_ERR_INVALID_ARG;
+    }
+}
+
+#if CONFIG_EMOTE_PERF_STATS
+static void bench_print_metric(const char *name, const emote_perf_metric_t *metric)
+{
+    printf("  %-8s n=%-5u min %6u  avg %6u  p99 %6u  max %6u us\n", name, (unsigned)metric->count,
+           (unsigned)metric->min_us, (unsigned)metric->avg_us, (unsigned)metric->p99_us, (unsigned)metric->max_us);
+}
+#endif
+
+// Replays a log from emote_record_start() in place of the script, as fast as it was recorded
+static esp_err_t bench_run_log(emote_handle_t handle, const char *log_path)
+{
+    FILE *log = fopen(log_path, "rb");
+    if (!log) {
+        ESP_LOGE(TAG, "Failed to open %s", log_path);
+        return ESP_ERR_NOT_FOUND;
+    }
+
+    esp_err_t ret = emote_replay(handle, log, 100);
+    fclose(log);
+    return ret;
+}
+
+static int bench_run(const char *assets_path, const char *log_path)
+{
+    int result = EXIT_FAILURE;
+    emote_handle_t handle = NULL;
+
+    emote_config_t config = {
+        .flags = {
+            .double_buffer = true,
+        },
+        .gfx_emote = {
+            .h_res = BENCH_H_RES,
+            .v_res = BENCH_V_RES,
+            .fps = BENCH_FPS,
+        },
+        .buffers = {
+            .buf_pixels = BENCH_H_RES * 16,
+        },
+        .task = {
+            .task_priority = 5,
+            .task_stack = 8 * 1024,
+            .task_affinity = -1,
+        },
+    };
+    emote_headless_config_t headless_config = {
+        .flush_delay_us = BENCH_FLUSH_DELAY_US,
+    };
+
+    emote_headless_handle_t headless = emote_headless_create(&headless_config, &config);
+    if (!headless) {
+        ESP_LOGE(TAG, "Failed to create headless display");
+        return EXIT_FAILURE;
+    }
+
+    handle = emote_init(&config);
+    if (!handle) {
+        ESP_LOGE(TAG, "Failed to initialize emote");
+        goto done;
+    }
+
+    emote_data_t data = {
+        .type = EMOTE_SOURCE_PATH,
+        .source = {
+            .path = assets_path,
+        },
+    };
+    if (emote_mount_and_load_assets(handle, &data) != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to load assets from %s", assets_path);
+        goto done;
+    }
+
+    // Let the load settle, then measure the script only
+    vTaskDelay(pdMS_TO_TICKS(500));
+    emote_headless_reset_stats(headless);
+    emote_reset_perf_stats(handle);
+
+    int64_t wall_start = esp_timer_get_time();
+    int64_t cpu_start = bench_cpu_time_us();
+    for (int round = 0; round < BENCH_ROUNDS; round++) {
+        if (log_path) {
+            if (bench_run_log(handle, log_path) != ESP_OK) {
+                goto done;
+            }
+            continue;
+        }
+        for (size_t i = 0; i < sizeof(bench_script) / sizeof(bench_script[0]); i++) {
+            esp_err_t ret = bench_run_step(handle, &bench_script[i]);
+            if (ret != ESP_OK) {
+                ESP_LOGW(TAG, "Step %d failed: %s", (int)i, esp_err_to_name(ret));
+            }
+            vTaskDelay(pdMS_TO_TICKS(bench_script[i].hold_ms));
+        }
+    }
+    int64_t cpu_us = bench_cpu_time_us() - cpu_start;
+    int64_t wall_us = esp_timer_get_time() - wall_start;
+
+    emote_headless_stats_t stats;
+    emote_headless_get_stats(headless, &stats);
+    uint32_t frames = stats.frames ? stats.frames : 1;
+
+    printf("Headless benchmark, %dx%d at %d fps, %d us flush delay, %d rounds of %s\n",
+           BENCH_H_RES, BENCH_V_RES, BENCH_FPS, BENCH_FLUSH_DELAY_US, BENCH_ROUNDS, log_path ? log_path : "the script");
+    printf("  frames       %u in %.2f s, %.1f frames/s\n", (unsigned)stats.frames, wall_us / 1e6,
+           stats.frames * 1e6 / wall_us);
+    printf("  flushes      %u, %.1f per frame\n", (unsigned)stats.flushes, (double)stats.flushes / frames);
+    printf("  flush bytes  %llu, %llu per frame\n", (unsigned long long)stats.flush_bytes,
+           (unsigned long long)(stats.flush_bytes / frames));
+    printf("  cpu time     %.3f ms per frame, %.1f%% of wall time\n", cpu_us / 1e3 / frames,
+           cpu_us * 100.0 / wall_us);
+
+#if CONFIG_EMOTE_PERF_STATS
+    emote_perf_stats_t perf;
+    if (emote_get_perf_stats(handle, &perf) == ESP_OK) {
+        bench_print_metric("frame", &perf.frame);
+        bench_print_metric("flush", &perf.flush);
+        bench_print_metric("acquire", &perf.acquire);
+        printf("  copied       %llu bytes from storage\n", (unsigned long long)perf.bytes_copied);
+    }
+#endif
+    result = stats.frames > 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+
+done:
+    if (handle) {
+        emote_deinit(handle);
+    }
+    emote_headless_delete(headless);
+    return result;
+}
+
+void app_main(void)
+{
+    const char *assets_path = getenv("EMOTE_BENCH_ASSETS");
+    if (!assets_path) {
+        assets_path = BENCH_ASSETS_DEFAULT;
+    }
+
+    exit(bench_run(assets_path, getenv("EMOTE_BENCH_REPLAY")));
+}
@@ -0,0 +1,39 @@
+/*
+ * SPDX-FileCopyrightText: 2025 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include "expression_emote.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief  Create a manager on a headless display and load the test assets
+ *
+ * Assets are read from test_apps/spiffs/esp32_s3_assets.bin, or from the file
+ * named by EMOTE_TEST_ASSETS.
+ *
+ * @param[out]  headless  Headless display of the manager
+ *
+ * @return
+ *       - Handle  On success
+ *       - NULL    The display, the manager or the assets failed
+ */
+emote_handle_t test_emote_init(emote_headless_handle_t *headless);
+
+/**
+ * @brief  Delete a manager of test_emote_init() and its display
+ *
+ * @param[in]  handle    Handle to emote manager
+ * @param[in]  headless  Headless display of the manager
+ */
+void test_emote_cleanup(emote_handle_t handle, emote_headless_handle_t headless);
+
+#ifdef __cplusplus
+}
+#endif
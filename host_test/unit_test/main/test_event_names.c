@@ -0,0 +1,43 @@
+/*
+ * SPDX-FileCopyrightText: 2025 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <string.h>
+#include "unity.h"
+
+#include "expression_emote.h"
+
+static const struct {
+    const char *name;
+    emote_event_t id;
+} test_events[] = {
+    { EMOTE_MGR_EVT_IDLE,   EMOTE_EVENT_IDLE },
+    { EMOTE_MGR_EVT_SPEAK,  EMOTE_EVENT_SPEAK },
+    { EMOTE_MGR_EVT_LISTEN, EMOTE_EVENT_LISTEN },
+    { EMOTE_MGR_EVT_SYS,    EMOTE_EVENT_SYS },
+    { EMOTE_MGR_EVT_SET,    EMOTE_EVENT_SET },
+    { EMOTE_MGR_EVT_BAT,    EMOTE_EVENT_BAT },
+    { EMOTE_MGR_EVT_OFF,    EMOTE_EVENT_OFF },
+};
+
+_Static_assert(sizeof(test_events) / sizeof(test_events[0]) == EMOTE_EVENT_MAX, "Test does not cover emote_event_t");
+
+// The hash keys of the event table are typed by hand; a key that is not the sixth
+// character of its name makes the name unresolvable
+TEST_CASE("Test event names resolve", "[event]")
+{
+    static const char *const unknown[] = { "", "evt_", "evt_x", "evt_idlex", "evt_spea", "EVT_IDLE" };
+    emote_event_t id;
+
+    for (size_t i = 0; i < sizeof(test_events) / sizeof(test_events[0]); i++) {
+        id = EMOTE_EVENT_MAX;
+        TEST_ASSERT_EQUAL_MESSAGE(ESP_OK, emote_get_event_by_name(test_events[i].name, &id), test_events[i].name);
+        TEST_ASSERT_EQUAL_MESSAGE(test_events[i].id, id, test_events[i].name);
+    }
+    for (size_t i = 0; i < sizeof(unknown) / sizeof(unknown[0]); i++) {
+        TEST_ASSERT_EQUAL_MESSAGE(ESP_ERR_NOT_FOUND, emote_get_event_by_name(unknown[i], &id), unknown[i]);
+    }
+    TEST_ASSERT_EQUAL(ESP_ERR_INVALID_ARG, emote_get_event_by_name(NULL, &id));
+}
@@ -0,0 +1,119 @@
+/*
+ * SPDX-FileCopyrightText: 2025 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/semphr.h"
+#include <stdio.h>
+#include <string.h>
+#include "esp_timer.h"
+#include "unity.h"
+
+#include "test_emote.h"
+
+#define TEST_PRODUCERS              4
+#define TEST_PRODUCER_POSTS         200
+
+typedef struct {
+    emote_handle_t handle;
+    int index;
+    int posts;
+    uint32_t accepted;
+    uint32_t rejected;
+    SemaphoreHandle_t done;
+} test_producer_ctx_t;
+
+static esp_err_t test_wait_events_drained(emote_handle_t handle, emote_event_queue_stats_t *stats)
+{
+    for (int wait = 0; wait < 100; wait++) {
+        esp_err_t ret = emote_get_event_queue_stats(handle, stats);
+        if (ret != ESP_OK) {
+            return ret;
+        }
+        if (stats->applied + stats->coalesced == stats->posted) {
+            return ESP_OK;
+        }
+        vTaskDelay(pdMS_TO_TICKS(20));
+    }
+    return ESP_ERR_TIMEOUT;
+}
+
+static void test_event_producer_task(void *arg)
+{
+    test_producer_ctx_t *ctx = (test_producer_ctx_t *)arg;
+    char message[16];
+
+    for (int i = 0; i < ctx->posts; i++) {
+        snprintf(message, sizeof(message), "%d,%d", i & 1, (ctx->index * 10 + i) % 101);
+        if (emote_post_event(ctx->handle, EMOTE_EVENT_BAT, message) == ESP_OK) {
+            ctx->accepted++;
+        } else {
+            ctx->rejected++;
+        }
+        if ((i & 7) == 0) {
+            vTaskDelay(1);
+        }
+    }
+    xSemaphoreGive(ctx->done);
+    vTaskDelete(NULL);
+}
+
+TEST_CASE("Test posted event queue", "[event]")
+{
+    test_producer_ctx_t producers[TEST_PRODUCERS] = { 0 };
+    emote_event_queue_stats_t stats;
+    emote_headless_handle_t headless;
+    char long_message[CONFIG_EMOTE_EVENT_MSG_LEN + 1];
+
+    emote_handle_t handle = test_emote_init(&headless);
+    TEST_ASSERT_NOT_NULL(handle);
+
+    memset(long_message, 'x', sizeof(long_message) - 1);
+    long_message[sizeof(long_message) - 1] = '\0';
+    TEST_ASSERT_EQUAL(ESP_ERR_INVALID_SIZE, emote_post_event(handle, EMOTE_EVENT_SPEAK, long_message));
+    TEST_ASSERT_EQUAL(ESP_ERR_INVALID_ARG, emote_post_event(handle, EMOTE_EVENT_MAX, NULL));
+
+    // Posting returns at once, even while the render lock is held
+    TEST_ASSERT_EQUAL(ESP_OK, emote_lock(handle));
+    int64_t start = esp_timer_get_time();
+    TEST_ASSERT_EQUAL(ESP_OK, emote_post_event(handle, EMOTE_EVENT_SPEAK, "Posted while locked"));
+    int64_t post_us = esp_timer_get_time() - start;
+    TEST_ASSERT_EQUAL(ESP_OK, emote_unlock(handle));
+    printf("Post while locked: %lld us\n", (long long)post_us);
+
+    // Producers above the render task race for cells and preempt each other
+    SemaphoreHandle_t done = xSemaphoreCreateCounting(TEST_PRODUCERS, 0);
+    TEST_ASSERT_NOT_NULL(done);
+    for (int i = 0; i < TEST_PRODUCERS; i++) {
+        producers[i].handle = handle;
+        producers[i].index = i;
+        producers[i].posts = TEST_PRODUCER_POSTS;
+        producers[i].done = done;
+        TEST_ASSERT_EQUAL(pdPASS, xTaskCreate(test_event_producer_task, "evt_producer", 4096,
+                                              &producers[i], 6 + (i & 1), NULL));
+    }
+    for (int i = 0; i < TEST_PRODUCERS; i++) {
+        TEST_ASSERT_EQUAL(pdTRUE, xSemaphoreTake(done, pdMS_TO_TICKS(10000)));
+    }
+    vSemaphoreDelete(done);
+
+    uint32_t accepted = 1;
+    uint32_t rejected = 0;
+    for (int i = 0; i < TEST_PRODUCERS; i++) {
+        accepted += producers[i].accepted;
+        rejected += producers[i].rejected;
+    }
+
+    // Every accepted event is applied exactly once, or superseded
+    TEST_ASSERT_EQUAL(ESP_OK, test_wait_events_drained(handle, &stats));
+    printf("Event queue: posted %lu, dropped %lu, applied %lu, coalesced %lu, capacity %lu\n",
+           (unsigned long)stats.posted, (unsigned long)stats.dropped, (unsigned long)stats.applied,
+           (unsigned long)stats.coalesced, (unsigned long)stats.capacity);
+    TEST_ASSERT_EQUAL(accepted, stats.posted);
+    TEST_ASSERT_EQUAL(rejected, stats.dropped);
+
+    test_emote_cleanup(handle, headless);
+}
@@ -0,0 +1,84 @@
+/*
+ * SPDX-FileCopyrightText: 2025 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include <stdlib.h>
+#include "esp_log.h"
+#include "unity.h"
+
+#include "test_emote.h"
+
+static const char *TAG = "emote_host_test";
+
+#define TEST_H_RES                  320
+#define TEST_V_RES                  240
+#define TEST_ASSETS_DEFAULT         "../../test_apps/spiffs/esp32_s3_assets.bin"
+
+emote_handle_t test_emote_init(emote_headless_handle_t *headless)
+{
+    emote_config_t config = {
+        .flags = {
+            .double_buffer = true,
+        },
+        .gfx_emote = {
+            .h_res = TEST_H_RES,
+            .v_res = TEST_V_RES,
+            .fps = 30,
+        },
+        .buffers = {
+            .buf_pixels = TEST_H_RES * 16,
+        },
+        .task = {
+            .task_priority = 5,
+            .task_stack = 8 * 1024,
+            .task_affinity = -1,
+        },
+    };
+    emote_headless_config_t headless_config = {
+        .flush_delay_us = 0,
+    };
+
+    *headless = emote_headless_create(&headless_config, &config);
+    if (!*headless) {
+        ESP_LOGE(TAG, "Failed to create headless display");
+        return NULL;
+    }
+
+    emote_handle_t handle = emote_init(&config);
+    if (!handle) {
+        ESP_LOGE(TAG, "Failed to initialize emote");
+        emote_headless_delete(*headless);
+        return NULL;
+    }
+
+    const char *assets_path = getenv("EMOTE_TEST_ASSETS");
+    emote_data_t data = {
+        .type = EMOTE_SOURCE_PATH,
+        .source = {
+            .path = assets_path ? assets_path : TEST_ASSETS_DEFAULT,
+        },
+    };
+    if (emote_mount_and_load_assets(handle, &data) != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to load assets from %s", data.source.path);
+        test_emote_cleanup(handle, *headless);
+        return NULL;
+    }
+    return handle;
+}
+
+void test_emote_cleanup(emote_handle_t handle, emote_headless_handle_t headless)
+{
+    emote_deinit(handle);
+    emote_headless_delete(headless);
+}
+
+void app_main(void)
+{
+    UNITY_BEGIN();
+    unity_run_all_tests();
+    exit(UNITY_END());
+}
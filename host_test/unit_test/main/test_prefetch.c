@@ -0,0 +1,109 @@
+/*
+ * SPDX-FileCopyrightText: 2025 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/semphr.h"
+#include <stdio.h>
+#include <stdatomic.h>
+#include "esp_timer.h"
+#include "esp_mmap_assets.h"
+#include "unity.h"
+
+#include "test_emote.h"
+
+// A slow flash: each read waits out a fixed latency plus a 4 MB/s transfer
+#define TEST_FLASH_LATENCY_MS       2
+#define TEST_FLASH_BYTES_PER_MS     4096
+
+typedef struct {
+    SemaphoreHandle_t done;
+    esp_err_t result;
+    size_t loaded;
+} test_prefetch_ctx_t;
+
+static atomic_bool test_flash_slow;
+static atomic_uint test_flash_reads;
+
+size_t __real_mmap_assets_copy_mem(mmap_assets_handle_t handle, size_t offset, void *dest_buffer, size_t size);
+
+// Linked in place of mmap_assets_copy_mem() with -Wl,--wrap, see CMakeLists.txt
+size_t __wrap_mmap_assets_copy_mem(mmap_assets_handle_t handle, size_t offset, void *dest_buffer, size_t size)
+{
+    if (atomic_load(&test_flash_slow)) {
+        uint32_t delay_ms = TEST_FLASH_LATENCY_MS + size / TEST_FLASH_BYTES_PER_MS;
+        atomic_fetch_add(&test_flash_reads, 1);
+        vTaskDelay(pdMS_TO_TICKS(delay_ms) ? pdMS_TO_TICKS(delay_ms) : 1);
+    }
+    return __real_mmap_assets_copy_mem(handle, offset, dest_buffer, size);
+}
+
+static void test_prefetch_done(emote_handle_t handle, esp_err_t result, size_t loaded, void *user_data)
+{
+    test_prefetch_ctx_t *ctx = (test_prefetch_ctx_t *)user_data;
+    ctx->result = result;
+    ctx->loaded = loaded;
+    xSemaphoreGive(ctx->done);
+}
+
+TEST_CASE("Test background prefetch", "[cache]")
+{
+    static const char *const names[] = { "happy", "angry", "battery_bg" };
+    static const char *const missing[] = { "missing" };
+    const size_t count = sizeof(names) / sizeof(names[0]);
+    test_prefetch_ctx_t ctx = { 0 };
+    emote_headless_handle_t headless;
+    emote_cache_stats_t before;
+    emote_cache_stats_t after;
+
+    ctx.done = xSemaphoreCreateBinary();
+    TEST_ASSERT_NOT_NULL(ctx.done);
+
+    emote_handle_t handle = test_emote_init(&headless);
+    TEST_ASSERT_NOT_NULL(handle);
+    atomic_store(&test_flash_slow, true);
+
+    // Cold switch: the copy runs in the caller
+    int64_t start = esp_timer_get_time();
+    TEST_ASSERT_EQUAL(ESP_OK, emote_set_anim_emoji(handle, "sad"));
+    int64_t cold_us = esp_timer_get_time() - start;
+    TEST_ASSERT_GREATER_OR_EQUAL(TEST_FLASH_LATENCY_MS * 1000, cold_us);
+
+    // Requests return before the slow reads; the loader task copies in the background
+    TEST_ASSERT_EQUAL(ESP_ERR_NOT_FOUND, emote_prefetch(handle, missing, 1, test_prefetch_done, &ctx));
+    atomic_store(&test_flash_reads, 0);
+    start = esp_timer_get_time();
+    TEST_ASSERT_EQUAL(ESP_OK, emote_prefetch(handle, names, count, test_prefetch_done, &ctx));
+    int64_t request_us = esp_timer_get_time() - start;
+    TEST_ASSERT_LESS_THAN(cold_us, request_us);
+    TEST_ASSERT_EQUAL(pdTRUE, xSemaphoreTake(ctx.done, pdMS_TO_TICKS(5000)));
+    TEST_ASSERT_EQUAL(ESP_OK, ctx.result);
+    TEST_ASSERT_EQUAL(count, ctx.loaded);
+    TEST_ASSERT_GREATER_OR_EQUAL(count, atomic_load(&test_flash_reads));
+
+    // Warm switch: served from the cache, without touching the flash
+    atomic_store(&test_flash_reads, 0);
+    TEST_ASSERT_EQUAL(ESP_OK, emote_get_cache_stats(handle, &before));
+    start = esp_timer_get_time();
+    TEST_ASSERT_EQUAL(ESP_OK, emote_set_anim_emoji(handle, "happy"));
+    int64_t warm_us = esp_timer_get_time() - start;
+    TEST_ASSERT_EQUAL(ESP_OK, emote_get_cache_stats(handle, &after));
+    TEST_ASSERT_EQUAL(before.misses, after.misses);
+    TEST_ASSERT_EQUAL(0, atomic_load(&test_flash_reads));
+    TEST_ASSERT_LESS_THAN(cold_us, warm_us);
+
+    printf("Set emoji: cold %lld us, prefetched %lld us, prefetch request %lld us\n",
+           (long long)cold_us, (long long)warm_us, (long long)request_us);
+
+    // Unloading cancels pending requests instead of reading unmapped assets
+    TEST_ASSERT_EQUAL(ESP_OK, emote_prefetch(handle, names, count, test_prefetch_done, &ctx));
+    TEST_ASSERT_EQUAL(ESP_OK, emote_unload_assets(handle));
+    TEST_ASSERT_EQUAL(pdTRUE, xSemaphoreTake(ctx.done, pdMS_TO_TICKS(5000)));
+
+    atomic_store(&test_flash_slow, false);
+    test_emote_cleanup(handle, headless);
+    vSemaphoreDelete(ctx.done);
+}
@@ -8,3 +8,4 @@
 #include "expression_emote/emote_init.h"
 #include "expression_emote/emote_assets.h"
 #include "expression_emote/emote_api.h"
+#include "expression_emote/emote_headless.h"
@@ -5,7 +5,9 @@
  */
 #pragma once
 
+#include <stdio.h>
 #include "emote_init.h"
+#include "emote_assets.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -24,6 +26,22 @@ extern "C" {
 #define EMOTE_MGR_EVT_BAT               "evt_bat"
 #define EMOTE_MGR_EVT_OFF               "evt_off"
 
+/**
+ * @brief Event identifiers
+ *
+ * Enum counterparts of the EMOTE_MGR_EVT_* strings, dispatched without a name lookup.
+ */
+typedef enum {
+    EMOTE_EVENT_IDLE = 0,           /*!< EMOTE_MGR_EVT_IDLE */
+    EMOTE_EVENT_SPEAK,              /*!< EMOTE_MGR_EVT_SPEAK */
+    EMOTE_EVENT_LISTEN,             /*!< EMOTE_MGR_EVT_LISTEN */
+    EMOTE_EVENT_SYS,                /*!< EMOTE_MGR_EVT_SYS */
+    EMOTE_EVENT_SET,                /*!< EMOTE_MGR_EVT_SET */
+    EMOTE_EVENT_BAT,                /*!< EMOTE_MGR_EVT_BAT */
+    EMOTE_EVENT_OFF,                /*!< EMOTE_MGR_EVT_OFF */
+    EMOTE_EVENT_MAX,
+} emote_event_t;
+
 /**
  * @brief UI element name constants
  *
@@ -54,6 +72,74 @@ extern "C" {
 #define EMOTE_OBJ_TYPE_QRCODE           "qrcode"
 #define EMOTE_OBJ_TYPE_TIMER            "timer"
 
+/**
+ * @brief Counters of built-in object updates
+ *
+ * Label text, image/animation source and visibility of the built-in objects are
+ * compared with the last applied value; unchanged requests are skipped, so they
+ * neither copy asset data nor invalidate the display.
+ */
+typedef struct {
+    uint32_t text_updates;          // Label text changes applied
+    uint32_t text_skipped;          // Label text requests skipped as unchanged
+    uint32_t src_updates;           // Image/animation source changes applied
+    uint32_t src_skipped;           // Image/animation source requests skipped as unchanged
+    uint32_t visible_updates;       // Visibility changes applied
+    uint32_t visible_skipped;       // Visibility requests skipped as unchanged
+    uint32_t status_wakeups;        // Status (clock) timer wakeups
+} emote_update_stats_t;
+
+/**
+ * @brief Counters of the posted event queue
+ *
+ * Once the queue is drained, posted == applied + coalesced.
+ */
+typedef struct {
+    uint32_t posted;                /*!< Events received by emote_post_event() */
+    uint32_t dropped;               /*!< Events rejected because the queue was full */
+    uint32_t applied;               /*!< Events applied by the render task */
+    uint32_t coalesced;             /*!< Events superseded by a later one in the same frame, never applied */
+    uint32_t drains;                /*!< Render task wakeups of the drain timer, only while events are pending */
+    uint32_t capacity;              /*!< Queue capacity */
+} emote_event_queue_stats_t;
+
+/**
+ * @brief Rolling statistics of one timing, over the last CONFIG_EMOTE_PERF_WINDOW samples
+ */
+typedef struct {
+    uint32_t count;                 // Samples in the window
+    uint32_t min_us;
+    uint32_t avg_us;
+    uint32_t p99_us;
+    uint32_t max_us;
+} emote_perf_metric_t;
+
+/**
+ * @brief gfx lock timings of one function
+ *
+ * Nested locks are attributed to the outermost function that took the lock, which is
+ * the public API for calls made by the application.
+ */
+typedef struct {
+    const char *api;                // Function that took the lock
+    emote_perf_metric_t wait;       // Time blocked before the lock was taken
+    emote_perf_metric_t hold;       // Time the lock was held
+} emote_perf_lock_stats_t;
+
+#define EMOTE_PERF_MAX_APIS         16
+
+/**
+ * @brief Frame timing and lock contention statistics (CONFIG_EMOTE_PERF_STATS)
+ */
+typedef struct {
+    emote_perf_metric_t frame;      // Time between the first flushes of consecutive frames
+    emote_perf_metric_t flush;      // Flush callback to emote_notify_flush_finished(), per flushed area
+    emote_perf_metric_t acquire;    // Asset staging in partition-read and file modes, cache hits included
+    emote_perf_lock_stats_t locks[EMOTE_PERF_MAX_APIS];
+    size_t lock_count;              // Entries used in locks
+    uint64_t bytes_copied;          // Bytes read from storage by asset copies and text font glyphs
+} emote_perf_stats_t;
+
 /**
  * @brief Set emoji animation on eye object
  * @param handle Handle to emote manager
@@ -62,6 +148,14 @@ extern "C" {
  */
 esp_err_t emote_set_anim_emoji(emote_handle_t handle, const char *name);
 
+/**
+ * @brief Set emoji animation on eye object by pre-resolved id
+ * @param handle Handle to emote manager
+ * @param id Emoji id from emote_get_emoji_id()
+ * @return ESP_OK on success, error code on failure
+ */
+esp_err_t emote_set_anim_emoji_id(emote_handle_t handle, emote_asset_id_t id);
+
 /**
  * @brief Set QR code data
  * @param handle Handle to emote manager
@@ -78,6 +172,14 @@ esp_err_t emote_set_qrcode_data(emote_handle_t handle, const char *qrcode_text);
  */
 esp_err_t emote_set_dialog_anim(emote_handle_t handle, const char *name);
 
+/**
+ * @brief Set emergency dialog animation by pre-resolved id
+ * @param handle Handle to emote manager
+ * @param id Emoji id from emote_get_emoji_id()
+ * @return ESP_OK on success, error code on failure
+ */
+esp_err_t emote_set_dialog_anim_id(emote_handle_t handle, emote_asset_id_t id);
+
 /**
  * @brief Insert emergency dialog animation with auto-stop timer
  * @param handle Handle to emote manager
@@ -111,8 +213,57 @@ esp_err_t emote_wait_emerg_dlg_done(emote_handle_t handle, uint32_t timeout_ms);
  */
 esp_err_t emote_set_event_msg(emote_handle_t handle, const char *event, const char *message);
 
+/**
+ * @brief Set system event with message by identifier
+ * @param handle Handle to emote manager
+ * @param event Event identifier
+ * @param message Message string
+ * @return ESP_OK on success, ESP_ERR_INVALID_ARG for an unknown event, error code on failure
+ */
+esp_err_t emote_set_event(emote_handle_t handle, emote_event_t event, const char *message);
+
+/**
+ * @brief Resolve an EMOTE_MGR_EVT_* string to its identifier
+ * @param name Event type string
+ * @param[out] event Event identifier
+ * @return ESP_OK on success, ESP_ERR_NOT_FOUND if the name is not an event
+ */
+esp_err_t emote_get_event_by_name(const char *name, emote_event_t *event);
+
+/**
+ * @brief Queue an event to be applied by the render task at its next frame
+ *
+ * Lock-free and non-blocking, so it can be called from ISRs and high-priority tasks
+ * without waiting for the render lock. The message is copied into the queue. Events
+ * are applied in posting order, as emote_set_event() would. With
+ * CONFIG_EMOTE_EVENT_COALESCE, events posted within one frame are collapsed first:
+ * only the last UI event and the last battery event are applied.
+ *
+ * @param handle Handle to emote manager
+ * @param event Event identifier
+ * @param message Message string, shorter than CONFIG_EMOTE_EVENT_MSG_LEN, or NULL
+ * @return
+ *      - ESP_OK on success
+ *      - ESP_ERR_INVALID_SIZE if the message is too long
+ *      - ESP_ERR_NO_MEM if the queue is full
+ *      - ESP_ERR_NOT_SUPPORTED if the queue is disabled (CONFIG_EMOTE_EVENT_QUEUE_LEN is 0)
+ */
+esp_err_t emote_post_event(emote_handle_t handle, emote_event_t event, const char *message);
+
+/**
+ * @brief Get counters of the posted event queue
+ * @param handle Handle to emote manager
+ * @param stats Counters (output parameter)
+ * @return ESP_OK on success, ESP_ERR_NOT_SUPPORTED if the queue is disabled
+ */
+esp_err_t emote_get_event_queue_stats(emote_handle_t handle, emote_event_queue_stats_t *stats);
+
 /**
  * @brief Get graphics object by name
+ *
+ * For built-in objects, the state remembered for skipping unchanged updates is
+ * discarded, since the caller may modify the object directly.
+ *
  * @param handle Handle to emote manager
  * @param name Object name (predefined or custom)
  * @return Pointer to gfx_obj_t on success, NULL if object not found
@@ -159,6 +310,33 @@ esp_err_t emote_lock(emote_handle_t handle);
  */
 esp_err_t emote_unlock(emote_handle_t handle);
 
+/**
+ * @brief Start collecting updates to apply them together
+ *
+ * Until emote_batch_commit(), these calls made by the same task are recorded instead
+ * of applied: emote_set_anim_emoji(), emote_set_anim_emoji_id(), emote_set_event(),
+ * emote_set_event_msg(), emote_set_obj_visible(), emote_set_anim_visible() and
+ * emote_set_qrcode_data(). Names are validated when recorded. Other calls, and calls
+ * from other tasks, apply immediately.
+ *
+ * @param handle Handle to emote manager
+ * @return ESP_OK on success, ESP_ERR_INVALID_STATE if a batch is already open
+ */
+esp_err_t emote_batch_begin(emote_handle_t handle);
+
+/**
+ * @brief Apply the recorded updates atomically
+ *
+ * Emoji data is read from storage first; then all updates are applied in order
+ * under a single lock, so the next frame redraws their combined area once and never
+ * shows a partly updated face.
+ *
+ * @param handle Handle to emote manager
+ * @return ESP_OK on success, ESP_ERR_INVALID_STATE if this task has no open batch,
+ *         otherwise the first error returned by a recorded update
+ */
+esp_err_t emote_batch_commit(emote_handle_t handle);
+
 /**
  * @brief Notify that flush operation is finished
  * @param handle Handle to emote manager
@@ -173,6 +351,94 @@ esp_err_t emote_notify_flush_finished(emote_handle_t handle);
  */
 esp_err_t emote_notify_all_refresh(emote_handle_t handle);
 
+/**
+ * @brief Get counters of applied and skipped built-in object updates
+ * @param handle Handle to emote manager
+ * @param stats Counters (output parameter)
+ * @return ESP_OK on success, error code on failure
+ */
+esp_err_t emote_get_update_stats(emote_handle_t handle, emote_update_stats_t *stats);
+
+/**
+ * @brief Get frame timing and lock contention statistics
+ * @param handle Handle to emote manager
+ * @param stats Statistics (output parameter)
+ * @return ESP_OK on success, ESP_ERR_NOT_SUPPORTED if CONFIG_EMOTE_PERF_STATS is disabled
+ */
+esp_err_t emote_get_perf_stats(emote_handle_t handle, emote_perf_stats_t *stats);
+
+/**
+ * @brief Clear the samples behind emote_get_perf_stats()
+ * @param handle Handle to emote manager
+ * @return ESP_OK on success, ESP_ERR_NOT_SUPPORTED if CONFIG_EMOTE_PERF_STATS is disabled
+ */
+esp_err_t emote_reset_perf_stats(emote_handle_t handle);
+
+/**
+ * @brief Write the recorded spans as Chrome trace event JSON
+ *
+ * Spans cover event dispatch, asset staging, layout application, emoji and dialog
+ * switches, flush callbacks and update_cb notifications. The output opens in
+ * chrome://tracing or ui.perfetto.dev. On the linux target, pass a file opened for
+ * writing; on a device, pass stdout to dump over the console.
+ *
+ * @param handle Handle to emote manager
+ * @param stream Stream to write to
+ * @return ESP_OK on success, ESP_FAIL on a write error, ESP_ERR_NOT_SUPPORTED if CONFIG_EMOTE_TRACE is disabled
+ */
+esp_err_t emote_trace_dump(emote_handle_t handle, FILE *stream);
+
+/**
+ * @brief Drop the spans recorded so far
+ * @param handle Handle to emote manager
+ * @return ESP_OK on success, ESP_ERR_NOT_SUPPORTED if CONFIG_EMOTE_TRACE is disabled
+ */
+esp_err_t emote_trace_clear(emote_handle_t handle);
+
+/**
+ * @brief Start logging the API calls made on a handle
+ *
+ * Each call to the event, emoji, dialog, QR code, visibility and batch setters is
+ * written to the stream with its arguments and the time since the previous call, in a
+ * compact binary log that emote_replay() plays back. Calls made by the component
+ * itself, and calls from an ISR, are not logged. Writes happen in the calling task, so
+ * pass a stream that is cheap to write, such as one backed by RAM.
+ *
+ * @param handle Handle to emote manager
+ * @param stream Stream to write to, opened in binary mode
+ * @return ESP_OK on success, ESP_ERR_INVALID_STATE if already recording, ESP_FAIL on a write error,
+ *         ESP_ERR_NOT_SUPPORTED if CONFIG_EMOTE_RECORDER is disabled
+ */
+esp_err_t emote_record_start(emote_handle_t handle, FILE *stream);
+
+/**
+ * @brief Stop logging API calls and flush the stream
+ *
+ * The stream stays open, the caller closes it.
+ *
+ * @param handle Handle to emote manager
+ * @return ESP_OK on success, ESP_ERR_INVALID_STATE if not recording, ESP_FAIL on a write error,
+ *         ESP_ERR_NOT_SUPPORTED if CONFIG_EMOTE_RECORDER is disabled
+ */
+esp_err_t emote_record_stop(emote_handle_t handle);
+
+/**
+ * @brief Replay a log written by emote_record_start()
+ *
+ * Calls the logged APIs on the handle in order, from the calling task, spacing them
+ * as recorded and scaled by speed_percent. Failed calls are counted and skipped, as
+ * the application would have seen them fail too. Blocks until the end of the log.
+ * Replay does not need CONFIG_EMOTE_RECORDER; the handle should have the same assets
+ * loaded as the one that was recorded.
+ *
+ * @param handle Handle to emote manager
+ * @param stream Stream to read from, opened in binary mode
+ * @param speed_percent Playback speed: 100 for real time, 200 for twice as fast, 0 for no delays
+ * @return ESP_OK at the end of the log, ESP_ERR_INVALID_VERSION if the stream is not a log of this
+ *         version, ESP_ERR_INVALID_SIZE on a truncated or malformed call, ESP_ERR_NO_MEM if out of memory
+ */
+esp_err_t emote_replay(emote_handle_t handle, FILE *stream, uint32_t speed_percent);
+
 /**
  * @brief Get user data
  * @param handle Handle to emote manager
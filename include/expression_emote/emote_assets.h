@@ -23,6 +23,61 @@ typedef struct {
     bool loop;
 } emoji_data_t;
 
+/**
+ * @brief Pre-resolved emoji or icon identifier
+ *
+ * Resolved once from a name, then used without any string hashing or comparison.
+ * An id is valid until the assets are unloaded or loaded again.
+ */
+typedef int32_t emote_asset_id_t;
+
+#define EMOTE_ASSET_ID_INVALID          (-1)
+
+/**
+ * @brief Statistics of the shared asset cache
+ *
+ * The cache only holds copies made in partition-read and file modes; memory-mapped
+ * assets are used in place and never counted.
+ */
+typedef struct {
+    uint32_t hits;                  // Acquisitions served from a resident copy
+    uint32_t misses;                // Acquisitions that read the asset from storage
+    uint32_t evictions;             // Unreferenced copies dropped to stay within budget
+    uint32_t entry_count;           // Resident copies, referenced or not
+    size_t used_bytes;              // Bytes held by resident copies
+    size_t budget;                  // Bytes kept for unreferenced copies
+    uint64_t copied_bytes;          // Bytes read from storage by misses
+} emote_cache_stats_t;
+
+/**
+ * @brief Statistics of the glyph cache of a text font loaded in place
+ *
+ * Only fonts read from storage on demand (CONFIG_EMOTE_FONT_LOAD_IN_PLACE in
+ * partition-read and file modes) have a glyph cache.
+ */
+typedef struct {
+    uint32_t hits;                  // Glyph bitmaps served from the cache
+    uint32_t misses;                // Glyph bitmaps read from storage
+    uint32_t evictions;             // Bitmaps dropped to stay within budget
+    uint32_t entry_count;           // Cached bitmaps
+    size_t used_bytes;              // Bytes held by cached bitmaps, entry headers included
+    size_t budget;                  // CONFIG_EMOTE_FONT_GLYPH_CACHE_KB in bytes
+    uint64_t read_bytes;            // Bytes of glyph bitmaps read from storage
+} emote_glyph_cache_stats_t;
+
+/**
+ * @brief Completion callback of emote_prefetch()
+ *
+ * Called from the loader task, or from the caller when there is nothing to load.
+ *
+ * @param handle Handle to emote manager
+ * @param result ESP_OK if all assets were loaded, ESP_ERR_NO_MEM if some did not fit,
+ *               ESP_ERR_INVALID_STATE if cancelled by unloading or unmounting the assets
+ * @param loaded Number of assets copied into the cache
+ * @param user_data User data passed to emote_prefetch()
+ */
+typedef void (*emote_prefetch_done_cb_t)(emote_handle_t handle, esp_err_t result, size_t loaded, void *user_data);
+
 /**
  * @brief Mount assets from source
  * @param handle Handle to emote manager
@@ -78,6 +133,42 @@ esp_err_t emote_get_icon_data_by_name(emote_handle_t handle, const char *name, i
  */
 esp_err_t emote_get_emoji_data_by_name(emote_handle_t handle, const char *name, emoji_data_t **emoji);
 
+/**
+ * @brief Resolve an emoji name to an id
+ * @param handle Handle to emote manager
+ * @param name Emoji name
+ * @param id Emoji id (output parameter)
+ * @return ESP_OK on success, ESP_ERR_NOT_FOUND if the emoji is not loaded
+ */
+esp_err_t emote_get_emoji_id(emote_handle_t handle, const char *name, emote_asset_id_t *id);
+
+/**
+ * @brief Resolve an icon name to an id
+ * @param handle Handle to emote manager
+ * @param name Icon name
+ * @param id Icon id (output parameter)
+ * @return ESP_OK on success, ESP_ERR_NOT_FOUND if the icon is not loaded
+ */
+esp_err_t emote_get_icon_id(emote_handle_t handle, const char *name, emote_asset_id_t *id);
+
+/**
+ * @brief Get parsed emoji data by id
+ * @param handle Handle to emote manager
+ * @param id Emoji id from emote_get_emoji_id()
+ * @param emoji Emoji data pointer (output parameter)
+ * @return ESP_OK on success, ESP_ERR_INVALID_STATE if the id is stale, ESP_ERR_NOT_FOUND if out of range
+ */
+esp_err_t emote_get_emoji_data_by_id(emote_handle_t handle, emote_asset_id_t id, emoji_data_t **emoji);
+
+/**
+ * @brief Get parsed icon data by id
+ * @param handle Handle to emote manager
+ * @param id Icon id from emote_get_icon_id()
+ * @param icon Icon data pointer (output parameter)
+ * @return ESP_OK on success, ESP_ERR_INVALID_STATE if the id is stale, ESP_ERR_NOT_FOUND if out of range
+ */
+esp_err_t emote_get_icon_data_by_id(emote_handle_t handle, emote_asset_id_t id, icon_data_t **icon);
+
 /**
  * @brief Get asset file data by name (raw file data from asset bin)
  * @param handle Handle to emote manager
@@ -88,6 +179,64 @@ esp_err_t emote_get_emoji_data_by_name(emote_handle_t handle, const char *name,
  */
 esp_err_t emote_get_asset_data_by_name(emote_handle_t handle, const char *name, const uint8_t **data, size_t *size);
 
+/**
+ * @brief Get addressable asset file data by name, sharing the asset cache
+ *
+ * Memory-mapped assets are returned in place. Otherwise the file is read into the
+ * shared cache used by the built-in objects, or reused if already resident. Each
+ * successful call must be paired with emote_release_asset().
+ *
+ * @param handle Handle to emote manager
+ * @param name Asset file name
+ * @param data Pointer to store asset data pointer (output parameter)
+ * @param size Pointer to store asset data size (output parameter)
+ * @return ESP_OK on success, ESP_ERR_NOT_FOUND if missing, ESP_ERR_NO_MEM if it cannot be cached
+ */
+esp_err_t emote_acquire_asset(emote_handle_t handle, const char *name, const uint8_t **data, size_t *size);
+
+/**
+ * @brief Release asset data returned by emote_acquire_asset()
+ * @param handle Handle to emote manager
+ * @param data Asset data pointer
+ * @return ESP_OK on success, error code on failure
+ */
+esp_err_t emote_release_asset(emote_handle_t handle, const uint8_t *data);
+
+/**
+ * @brief Load emoji or icon data into the asset cache in the background
+ *
+ * Names are resolved immediately; the data is copied by a low-priority loader task
+ * without holding the render lock, so a later emote_set_anim_emoji() or event only
+ * has to swap pointers. Prefetched copies are kept as unused cache entries, so they
+ * must fit in CONFIG_EMOTE_ASSET_CACHE_SIZE_KB. Nothing is copied for memory-mapped
+ * assets.
+ *
+ * @param handle Handle to emote manager
+ * @param names Emoji or icon names
+ * @param count Number of names
+ * @param done_cb Completion callback, may be NULL
+ * @param user_data User data for done_cb
+ * @return ESP_OK if queued, ESP_ERR_NOT_FOUND if a name is unknown, ESP_ERR_NO_MEM if the queue is full
+ */
+esp_err_t emote_prefetch(emote_handle_t handle, const char *const names[], size_t count,
+                         emote_prefetch_done_cb_t done_cb, void *user_data);
+
+/**
+ * @brief Get statistics of the shared asset cache
+ * @param handle Handle to emote manager
+ * @param stats Statistics (output parameter)
+ * @return ESP_OK on success, error code on failure
+ */
+esp_err_t emote_get_cache_stats(emote_handle_t handle, emote_cache_stats_t *stats);
+
+/**
+ * @brief Get statistics of the text font glyph cache
+ * @param handle Handle to emote manager
+ * @param stats Statistics (output parameter)
+ * @return ESP_OK on success, ESP_ERR_INVALID_STATE if the text font is not loaded in place
+ */
+esp_err_t emote_get_glyph_cache_stats(emote_handle_t handle, emote_glyph_cache_stats_t *stats);
+
 #ifdef __cplusplus
 }
 #endif
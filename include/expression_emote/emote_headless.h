@@ -0,0 +1,85 @@
+/*
+ * SPDX-FileCopyrightText: 2025 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+#pragma once
+
+#include "emote_init.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// ===== OPAQUE HANDLE =====
+typedef struct emote_headless_s *emote_headless_handle_t;
+
+/**
+ * @brief Headless display configuration
+ */
+typedef struct {
+    uint32_t flush_delay_us;        /*!< Simulated transfer time of a flush before emote_notify_flush_finished(), 0 for none */
+} emote_headless_config_t;
+
+/**
+ * @brief Headless display counters
+ */
+typedef struct {
+    uint32_t frames;                /*!< Render passes that flushed at least one area */
+    uint32_t flushes;               /*!< Flush callbacks */
+    uint64_t flush_bytes;           /*!< Pixel bytes written to the framebuffer */
+} emote_headless_stats_t;
+
+/**
+ * @brief Create a headless display for emote_init()
+ *
+ * Sets the flush callback and user data of the emote configuration, so the manager
+ * renders into an in-memory RGB565 framebuffer of h_res x v_res pixels instead of a
+ * panel. Each flush copies the area, waits out the simulated transfer time and calls
+ * emote_notify_flush_finished() before returning, which keeps frame timing
+ * deterministic. Used to benchmark rendering without a board, including on the linux
+ * target.
+ *
+ * @param config Headless display configuration
+ * @param emote_config Emote configuration to set up (in/out), resolution already set
+ * @return Handle to headless display on success, NULL on failure
+ */
+emote_headless_handle_t emote_headless_create(const emote_headless_config_t *config, emote_config_t *emote_config);
+
+/**
+ * @brief Delete a headless display, after emote_deinit() of the manager drawing to it
+ * @param headless Handle to headless display
+ */
+void emote_headless_delete(emote_headless_handle_t headless);
+
+/**
+ * @brief Get the framebuffer
+ *
+ * Pixels are stored as flushed, byte-swapped if the swap flag of the emote
+ * configuration is set. Read it while the manager is idle, it is not locked.
+ *
+ * @param headless Handle to headless display
+ * @param width Framebuffer width in pixels (output parameter, can be NULL)
+ * @param height Framebuffer height in pixels (output parameter, can be NULL)
+ * @return Framebuffer on success, NULL on failure
+ */
+const uint16_t *emote_headless_get_framebuffer(emote_headless_handle_t headless, int *width, int *height);
+
+/**
+ * @brief Get the flush counters
+ * @param headless Handle to headless display
+ * @param stats Counters (output parameter)
+ * @return ESP_OK on success, error code on failure
+ */
+esp_err_t emote_headless_get_stats(emote_headless_handle_t headless, emote_headless_stats_t *stats);
+
+/**
+ * @brief Clear the flush counters
+ * @param headless Handle to headless display
+ * @return ESP_OK on success, error code on failure
+ */
+esp_err_t emote_headless_reset_stats(emote_headless_handle_t headless);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,95 @@
+/*
+ * SPDX-FileCopyrightText: 2025 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include "esp_err.h"
+#include "expression_emote.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Updates recorded between emote_batch_begin() and emote_batch_commit().
+ *
+ * While the task that opened the batch calls a batchable setter, the setter records
+ * the change here instead of applying it. Other tasks are not affected.
+ */
+typedef struct emote_batch_s emote_batch_t;
+
+/**
+ * @brief  Check whether setters called by the current task must be recorded
+ *
+ * @param[in]  handle  Emote handle
+ *
+ * @return
+ *       - true   A batch is open and owned by the calling task
+ *       - false  Setters apply immediately
+ */
+bool emote_batch_is_recording(emote_handle_t handle);
+
+/**
+ * @brief  Record an eye emoji change
+ *
+ * @param[in]  handle  Emote handle
+ * @param[in]  id      Emoji id
+ *
+ * @return
+ *       - ESP_OK          On success
+ *       - ESP_ERR_NO_MEM  Fail to grow the batch
+ */
+esp_err_t emote_batch_record_emoji(emote_handle_t handle, emote_asset_id_t id);
+
+/**
+ * @brief  Record an event
+ *
+ * @param[in]  handle   Emote handle
+ * @param[in]  event    Event identifier
+ * @param[in]  message  Message, copied; may be NULL
+ *
+ * @return
+ *       - ESP_OK          On success
+ *       - ESP_ERR_NO_MEM  Fail to grow the batch
+ */
+esp_err_t emote_batch_record_event(emote_handle_t handle, emote_event_t event, const char *message);
+
+/**
+ * @brief  Record a visibility change of a named object, or of the eye when name is NULL
+ *
+ * @param[in]  handle   Emote handle
+ * @param[in]  name     Object name, copied; NULL for the eye animation
+ * @param[in]  visible  Visibility
+ *
+ * @return
+ *       - ESP_OK                 On success
+ *       - ESP_ERR_INVALID_STATE  No object of that name exists
+ *       - ESP_ERR_NO_MEM         Fail to grow the batch
+ */
+esp_err_t emote_batch_record_visible(emote_handle_t handle, const char *name, bool visible);
+
+/**
+ * @brief  Record a QR code change
+ *
+ * @param[in]  handle  Emote handle
+ * @param[in]  text    QR code text, copied
+ *
+ * @return
+ *       - ESP_OK          On success
+ *       - ESP_ERR_NO_MEM  Fail to grow the batch
+ */
+esp_err_t emote_batch_record_qrcode(emote_handle_t handle, const char *text);
+
+/**
+ * @brief  Drop an open batch without applying it
+ *
+ * @param[in]  handle  Emote handle
+ */
+void emote_batch_deinit(emote_handle_t handle);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,91 @@
+/*
+ * SPDX-FileCopyrightText: 2025 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <stddef.h>
+#include "esp_err.h"
+#include "esp_mmap_assets.h"
+#include "expression_emote.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Reference-counted LRU cache of asset copies for partition-read and file modes.
+ *
+ * Entries are keyed by the asset offset returned by mmap_assets_get_mem(). An entry
+ * stays resident while referenced; once released it is kept in LRU order and only
+ * evicted when unreferenced entries exceed the byte budget.
+ */
+typedef struct emote_cache_s emote_cache_t;
+
+/**
+ * @brief  Create a cache
+ *
+ * @param[in]  budget  Maximum bytes kept resident by unreferenced entries
+ *
+ * @return
+ *       - Pointer to cache  On success
+ *       - NULL              Fail to create cache
+ */
+emote_cache_t *emote_cache_create(size_t budget);
+
+/**
+ * @brief  Destroy a cache and free all entries, including referenced ones
+ *
+ * @param[in]  cache  Cache to destroy
+ */
+void emote_cache_destroy(emote_cache_t *cache);
+
+/**
+ * @brief  Get a resident copy of an asset, loading it on a miss
+ *
+ * @param[in]  cache     Cache
+ * @param[in]  assets    Assets handle used to copy on a miss
+ * @param[in]  offset    Asset offset from mmap_assets_get_mem()
+ * @param[in]  size      Asset size
+ *
+ * @return
+ *       - Pointer to the cached copy, with one reference taken  On success
+ *       - NULL                                                 Out of memory, or the read failed
+ */
+const void *emote_cache_acquire(emote_cache_t *cache, mmap_assets_handle_t assets, size_t offset, size_t size);
+
+/**
+ * @brief  Drop a reference taken by emote_cache_acquire()
+ *
+ * @param[in]  cache  Cache
+ * @param[in]  data   Pointer returned by emote_cache_acquire()
+ *
+ * @return
+ *       - true   data belonged to the cache
+ *       - false  data is not a cache entry (e.g. a memory-mapped pointer)
+ */
+bool emote_cache_release(emote_cache_t *cache, const void *data);
+
+/**
+ * @brief  Drop all entries of the current mount
+ *
+ * Unreferenced entries are freed. Referenced entries are detached so they can no
+ * longer be hit, and are freed on their last release.
+ *
+ * @param[in]  cache  Cache
+ */
+void emote_cache_clear(emote_cache_t *cache);
+
+/**
+ * @brief  Get cache statistics
+ *
+ * @param[in]   cache  Cache
+ * @param[out]  stats  Statistics
+ */
+void emote_cache_get_stats(emote_cache_t *cache, emote_cache_stats_t *stats);
+
+#ifdef __cplusplus
+}
+#endif
@@ -11,6 +11,8 @@
 #include "gfx.h"
 #include "freertos/FreeRTOS.h"
 #include "freertos/semphr.h"
+#include "freertos/task.h"
+#include "emote_cache.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -27,6 +29,9 @@ typedef struct assets_hash_table_s assets_hash_table_t;
 #define EMOTE_DEF_ANIMATION_FPS         CONFIG_EMOTE_DEF_ANIMATION_FPS
 #define EMOTE_DEF_FONT_COLOR            CONFIG_EMOTE_DEF_FONT_COLOR
 #define EMOTE_DEF_BG_COLOR              CONFIG_EMOTE_DEF_BG_COLOR
+#define EMOTE_ASSET_CACHE_BUDGET        (CONFIG_EMOTE_ASSET_CACHE_SIZE_KB * 1024)
+#define EMOTE_DEF_TIMER_PERIOD_MS       1000
+#define EMOTE_DEF_STATUS_PERIOD_MS      60000    // Clock shows minutes
 
 // ===== ICON NAME CONSTANTS =====
 #define EMOTE_INDEX_JSON_FILENAME       "index.json"
@@ -37,6 +42,22 @@ typedef struct assets_hash_table_s assets_hash_table_t;
 #define EMOTE_ICON_BATTERY_BG           "battery_bg"
 #define EMOTE_ICON_BATTERY_CHARGE       "battery_charge"
 
+// ===== BUILT-IN ICON ENUM =====
+typedef enum {
+    EMOTE_BUILTIN_ICON_MIC = 0,
+    EMOTE_BUILTIN_ICON_TIPS,
+    EMOTE_BUILTIN_ICON_LISTEN,
+    EMOTE_BUILTIN_ICON_SPEAKER,
+    EMOTE_BUILTIN_ICON_BATTERY_BG,
+    EMOTE_BUILTIN_ICON_BATTERY_CHARGE,
+    EMOTE_BUILTIN_ICON_MAX
+} emote_builtin_icon_t;
+
+// ===== ASSET ID ENCODING =====
+#define EMOTE_ASSET_ID_INDEX_BITS       16
+#define EMOTE_ASSET_ID_INDEX_MASK       ((1 << EMOTE_ASSET_ID_INDEX_BITS) - 1)
+#define EMOTE_ASSET_ID_GEN_MASK         0x7FFF
+
 // ===== OBJECT TYPE ENUM =====
 typedef enum {
     EMOTE_DEF_OBJ_LEBAL_DEFAULT = 0,  // For default label
@@ -75,14 +96,33 @@ typedef union {
     // gfx_timer_handle_t timer;          // For timer objects (EMOTE_DEF_OBJ_TIMER_STATUS)
 } emote_obj_data_t;
 
+/** Last state applied to a default object, used to skip unchanged updates
+ *  Cleared whenever the object is (re)created or handed out to the application
+ */
+typedef struct {
+    bool visible_known;                // visible holds the applied visibility
+    bool visible;
+    const void *src;                   // Asset data_ref set as source, NULL if unknown
+    char *text;                        // Label text (heap copy), NULL if unknown
+} emote_obj_state_t;
+
 /** Default object entry with integrated user data
  *  Automatically associates user data based on object type using union
  */
 typedef struct {
     gfx_obj_t *obj;                    // Object pointer
     emote_obj_data_t data;    // User data union, automatically matches by type
+    emote_obj_state_t state;           // Last applied state
+    struct emote_digits_s *digits;     // Digit atlas drawing the label text, NULL for a plain label
+    struct emote_strip_s *strip;       // Scroll strip drawing the label text, NULL for a plain label
 } emote_def_obj_entry_t;
 
+/** Asset file name index entry, sorted by name at mount time */
+typedef struct {
+    const char *name;              // File name (owned by the mounted assets)
+    int index;                     // File index in the mounted assets
+} emote_asset_name_entry_t;
+
 typedef struct emote_custom_obj_entry_s {
     char *name;                    // Object name (dynamically allocated)
     gfx_obj_t *obj;                // Object pointer
@@ -95,16 +135,55 @@ struct emote_s {
     gfx_handle_t gfx_handle;
     gfx_disp_t *gfx_disp;
     mmap_assets_handle_t assets_handle;
+    bool assets_mmap;                           // Mounted from a memory-mapped partition
+
+    //asset name index [sorted by name, built by emote_mount_assets]
+    emote_asset_name_entry_t *asset_names;
+    int asset_name_count;
 
     /** Default objects with integrated cache
      *  Cache is automatically associated based on object type
      */
     emote_def_obj_entry_t def_objects[EMOTE_DEF_OBJ_MAX];
+    emote_update_stats_t update_stats;         // Applied/skipped updates of def_objects
+    uint32_t vis_staged;                       // def_objects with a staged visibility, bit per type
+    uint32_t vis_target;                       // Staged visibility, applied as a diff by emote_set_event
+    bool vis_staging;
     emote_custom_obj_entry_t *custom_objects;  // Linked list for custom objects
 
     //font cache
     lv_font_t *gfx_font;
     void *font_cache;
+    struct emote_font_s *font;                  // gfx_font read in place, NULL if loaded by gfx
+
+    //shared copies of assets [partition-read and file modes only]
+    emote_cache_t *asset_cache;
+    struct emote_prefetch_s *prefetch;          // Background loader, started on first use
+
+    //events posted from other tasks and ISRs, drained by the render task
+    struct emote_event_queue_s *event_queue;
+
+    //open batch [emote_batch_begin .. emote_batch_commit], owned by one task
+    struct emote_batch_s *batch;
+    TaskHandle_t batch_owner;
+
+#if CONFIG_EMOTE_PERF_STATS
+    //frame timing and lock contention [emote_get_perf_stats]
+    struct emote_perf_s *perf;
+#endif
+
+#if CONFIG_EMOTE_TRACE
+    //span ring [emote_trace_dump]
+    struct emote_trace_s *trace;
+#endif
+
+#if CONFIG_EMOTE_RECORDER
+    //API call log [emote_record_start .. emote_record_stop]
+    struct emote_recorder_s *recorder;
+#endif
+
+    //status timer [EMOTE_DEF_OBJ_TIMER_STATUS], wakes on wall-clock multiples of the period
+    uint32_t status_period_ms;
 
     //battery cache
     bool bat_is_charging;
@@ -113,6 +192,11 @@ struct emote_s {
     assets_hash_table_t *emoji_table;
     assets_hash_table_t *icon_table;
 
+    //asset id generation [bumped by every emote_load_assets, stale ids are rejected]
+    uint16_t asset_generation;
+    bool index_bin_loaded;                      // Tables of the last load came from index.bin
+    int builtin_icons[EMOTE_BUILTIN_ICON_MAX];  // icon_table index, -1 if missing
+
     //dialog timer [EMOTE_DEF_OBJ_ANIM_EMERG_DLG]
     gfx_timer_handle_t dialog_timer;
 
@@ -0,0 +1,74 @@
+/*
+ * SPDX-FileCopyrightText: 2025 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include "esp_err.h"
+#include "gfx.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Digit atlas drawing a numeric label as an image.
+ *
+ * The glyphs "0123456789:%" are rendered once from the label font into an A8 strip.
+ * A text update copies glyph rows from the strip into the alpha plane of an RGB565A8
+ * image covering the label, instead of having the label decode font bitmaps on every
+ * redraw. Text with other characters, or wider than the label, is handed back to the
+ * label.
+ */
+typedef struct emote_digits_s emote_digits_t;
+
+/**
+ * @brief  Create a digit atlas for a label
+ *
+ * Must be called with the gfx lock held, after the label is positioned and sized.
+ * The image takes the label's place; the label only draws fallback text.
+ *
+ * @param[in]  disp   Display
+ * @param[in]  label  Label object drawn over
+ * @param[in]  font   Font of the label
+ * @param[in]  color  Text color (0xRRGGBB)
+ * @param[in]  align  Horizontal text alignment
+ * @param[in]  pos    Alignment of the label (GFX_ALIGN_*)
+ * @param[in]  x      X offset of the label alignment
+ * @param[in]  y      Y offset of the label alignment
+ *
+ * @return
+ *       - Pointer to atlas  On success
+ *       - NULL              Out of memory, or the font lacks a glyph
+ */
+emote_digits_t *emote_digits_create(gfx_disp_t *disp, gfx_obj_t *label, const lv_font_t *font, uint32_t color,
+                                    gfx_text_align_t align, int pos, int x, int y);
+
+/**
+ * @brief  Delete a digit atlas and its image, with the gfx lock held
+ *
+ * @param[in]  digits  Atlas to delete
+ */
+void emote_digits_delete(emote_digits_t *digits);
+
+/**
+ * @brief  Draw text, with the gfx lock held
+ *
+ * @param[in]  digits  Atlas
+ * @param[in]  text    Text to draw
+ */
+void emote_digits_set_text(emote_digits_t *digits, const char *text);
+
+/**
+ * @brief  Follow the visibility of the label, with the gfx lock held
+ *
+ * @param[in]  digits   Atlas
+ * @param[in]  visible  Label visibility
+ */
+void emote_digits_set_visible(emote_digits_t *digits, bool visible);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,50 @@
+/*
+ * SPDX-FileCopyrightText: 2025 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include "esp_err.h"
+#include "expression_emote.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Bounded lock-free multi-producer, single-consumer queue behind emote_post_event().
+ *
+ * Producers claim a cell with one compare-and-swap and never block, so events can be
+ * posted from ISRs and high-priority tasks. A gfx timer drains the queue once per
+ * frame in the render task while events are pending, and is paused while it is empty.
+ */
+typedef struct emote_event_queue_s emote_event_queue_t;
+
+/**
+ * @brief  Create the queue and its drain timer
+ *
+ * Does nothing when CONFIG_EMOTE_EVENT_QUEUE_LEN is 0.
+ *
+ * @param[in]  handle     Emote handle, with the gfx engine initialized
+ * @param[in]  period_ms  Drain period, normally one frame
+ *
+ * @return
+ *       - ESP_OK         On success
+ *       - ESP_ERR_NO_MEM Fail to allocate the queue or timer
+ */
+esp_err_t emote_event_queue_init(emote_handle_t handle, uint32_t period_ms);
+
+/**
+ * @brief  Delete the drain timer and free the queue, dropping pending events
+ *
+ * Waits for wakeups pended by producers, so call it without the gfx lock held.
+ *
+ * @param[in]  handle  Emote handle
+ */
+void emote_event_queue_deinit(emote_handle_t handle);
+
+#ifdef __cplusplus
+}
+#endif
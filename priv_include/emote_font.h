@@ -0,0 +1,71 @@
+/*
+ * SPDX-FileCopyrightText: 2025 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <stddef.h>
+#include "esp_err.h"
+#include "esp_mmap_assets.h"
+#include "widget/gfx_font_lvgl.h"
+#include "expression_emote.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * LVGL binary font that keeps glyph bitmaps in the asset storage.
+ *
+ * Only the header, cmaps, kerning and glyph descriptors are loaded to RAM. The bitmap
+ * of a glyph is read from storage when it is drawn, into a buffer reused by the next
+ * glyph, so it is valid until the next bitmap request of the font. Recently drawn
+ * bitmaps are kept in an LRU cache keyed by code point, within a byte budget.
+ */
+typedef struct emote_font_s emote_font_t;
+
+/**
+ * @brief  Load a binary font without copying its glyph bitmaps
+ *
+ * @param[in]  assets    Assets handle the font is read from
+ * @param[in]  data_ref  Font data from mmap_assets_get_mem()
+ * @param[in]  size      Font file size
+ * @param[in]  mapped    data_ref is addressable (memory-mapped) rather than an offset
+ * @param[in]  cache_budget  Bytes of glyph bitmaps kept in the cache, 0 to disable it
+ *
+ * @return
+ *       - Pointer to font  On success
+ *       - NULL             Out of memory, or not a supported binary font
+ */
+emote_font_t *emote_font_load(mmap_assets_handle_t assets, const uint8_t *data_ref, size_t size, bool mapped,
+                              size_t cache_budget);
+
+/**
+ * @brief  Get the LVGL font to set on labels
+ *
+ * @param[in]  font  Font
+ *
+ * @return  LVGL font, valid until emote_font_delete()
+ */
+lv_font_t *emote_font_get_lv_font(emote_font_t *font);
+
+/**
+ * @brief  Free a font loaded by emote_font_load()
+ *
+ * @param[in]  font  Font
+ */
+void emote_font_delete(emote_font_t *font);
+
+/**
+ * @brief  Get glyph cache statistics, with the gfx lock held
+ *
+ * @param[in]   font   Font
+ * @param[out]  stats  Statistics
+ */
+void emote_font_get_cache_stats(const emote_font_t *font, emote_glyph_cache_stats_t *stats);
+
+#ifdef __cplusplus
+}
+#endif
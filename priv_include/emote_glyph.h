@@ -0,0 +1,76 @@
+/*
+ * SPDX-FileCopyrightText: 2025 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include "esp_err.h"
+#include "gfx.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Glyph helpers shared by the digit atlas and the scroll strip.
+ *
+ * Both render label text into an A8 buffer once, then show it through an RGB565A8
+ * image covering the label: a color plane filled with the text color, and an alpha
+ * plane that text updates rewrite.
+ */
+
+/**
+ * @brief  Rasterize one glyph into an A8 buffer, on the baseline of the font line
+ *
+ * Pixels keep the higher coverage of the buffer and the glyph, so glyphs brought
+ * together by kerning don't erase each other.
+ *
+ * @param[in]  font    Font of the glyph
+ * @param[in]  letter  Unicode letter
+ * @param[in]  g       Glyph descriptor of the letter
+ * @param[in]  dst     A8 buffer of font->line_height rows
+ * @param[in]  stride  Bytes per row of dst
+ * @param[in]  x       Pen position in dst
+ * @param[in]  clip_x  First column the glyph may write
+ * @param[in]  clip_w  Number of columns the glyph may write
+ */
+void emote_glyph_render_a8(const lv_font_t *font, uint32_t letter, const lv_font_glyph_dsc_t *g,
+                           uint8_t *dst, uint32_t stride, int x, int clip_x, uint32_t clip_w);
+
+/**
+ * @brief  Create a hidden image drawing A8 coverage in one color, with the gfx lock held
+ *
+ * The RGB565A8 buffer is filled with the color, the alpha plane is cleared, and dsc
+ * describes the buffer. To redraw, rewrite the alpha plane and set dsc as the source
+ * of the image again.
+ *
+ * @param[in]   disp   Display
+ * @param[out]  dsc    Image descriptor, must outlive the image
+ * @param[in]   w      Image width
+ * @param[in]   h      Image height
+ * @param[in]   color  Text color (0xRRGGBB)
+ * @param[in]   pos    Alignment of the image (GFX_ALIGN_*)
+ * @param[in]   x      X offset of the alignment
+ * @param[in]   y      Y offset of the alignment
+ * @param[out]  alpha  Alpha plane, w x h bytes
+ *
+ * @return
+ *       - Image object  On success
+ *       - NULL          Out of memory
+ */
+gfx_obj_t *emote_glyph_image_create(gfx_disp_t *disp, gfx_image_dsc_t *dsc, uint16_t w, uint16_t h, uint32_t color,
+                                    int pos, int x, int y, uint8_t **alpha);
+
+/**
+ * @brief  Delete an image of emote_glyph_image_create() and its buffer, with the gfx lock held
+ *
+ * @param[in]  img  Image object, can be NULL
+ * @param[in]  dsc  Image descriptor
+ */
+void emote_glyph_image_delete(gfx_obj_t *img, gfx_image_dsc_t *dsc);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,99 @@
+/*
+ * SPDX-FileCopyrightText: 2025 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Precompiled asset index (index.bin), generated on the host by tools/emote_index_tool.py
+ *
+ * Layout (little-endian, offsets relative to the start of index.bin):
+ *   header | emoji records | icon records | layout records | string pool
+ *
+ * File indices are resolved against the asset bin the index is packed into, and
+ * all strings are NUL-terminated entries of the string pool, so the index can be
+ * used in place from the mmap window. Records are packed and may be unaligned.
+ */
+
+#define EMOTE_INDEX_BIN_FILENAME        "index.bin"
+#define EMOTE_INDEX_BIN_MAGIC           "EIDX"
+#define EMOTE_INDEX_BIN_VERSION         1
+
+#define EMOTE_INDEX_BIN_STR_NONE        0xFFFFFFFFu  // String offset not set
+#define EMOTE_INDEX_BIN_U16_DEFAULT     0xFFFFu      // Use the runtime default value
+
+// Emoji record flags
+#define EMOTE_INDEX_BIN_EMOJI_LOOP      (1 << 0)
+
+// Layout record flags
+#define EMOTE_INDEX_BIN_LAYOUT_POS      (1 << 0)     // align/x/y present
+#define EMOTE_INDEX_BIN_LAYOUT_MIRROR   (1 << 1)     // anim.mirror is "auto" or "true"
+#define EMOTE_INDEX_BIN_LAYOUT_LOOP     (1 << 2)     // label.long_mode.loop
+#define EMOTE_INDEX_BIN_LAYOUT_TIMER    (1 << 3)     // timer object present
+#define EMOTE_INDEX_BIN_LAYOUT_COLOR    (1 << 4)     // label.color present
+#define EMOTE_INDEX_BIN_LAYOUT_DIGITS   (1 << 5)     // label.digit_atlas
+#define EMOTE_INDEX_BIN_LAYOUT_STRIP    (1 << 6)     // label.scroll_strip
+
+typedef struct __attribute__((packed)) {
+    char magic[4];              // EMOTE_INDEX_BIN_MAGIC
+    uint16_t version;           // EMOTE_INDEX_BIN_VERSION
+    uint16_t file_count;        // Number of files in the asset bin the indices refer to
+    uint16_t emoji_count;
+    uint16_t icon_count;
+    uint16_t layout_count;
+    int16_t font_file;          // File index of text_font, -1 if none
+    uint32_t emoji_offset;
+    uint32_t icon_offset;
+    uint32_t layout_offset;
+    uint32_t string_offset;
+    uint32_t string_size;
+} emote_index_bin_header_t;
+
+typedef struct __attribute__((packed)) {
+    uint32_t name;              // String pool offset
+    uint16_t file;              // File index
+    uint8_t fps;
+    uint8_t flags;              // EMOTE_INDEX_BIN_EMOJI_*
+} emote_index_bin_emoji_t;
+
+typedef struct __attribute__((packed)) {
+    uint32_t name;              // String pool offset
+    uint16_t file;              // File index
+    uint16_t reserved;
+} emote_index_bin_icon_t;
+
+typedef struct __attribute__((packed)) {
+    uint32_t name;              // String pool offsets (EMOTE_INDEX_BIN_STR_NONE if not set)
+    uint32_t align;
+    uint32_t text_align;
+    uint32_t long_mode;
+    uint8_t type;               // emote_layout_type_t
+    uint8_t flags;              // EMOTE_INDEX_BIN_LAYOUT_*
+    uint16_t qrcode_size;       // EMOTE_INDEX_BIN_U16_DEFAULT for default
+    int16_t x;
+    int16_t y;
+    uint16_t width;
+    uint16_t height;
+    uint32_t color;
+    uint16_t speed;             // EMOTE_INDEX_BIN_U16_DEFAULT for default
+    uint16_t snap_interval;     // EMOTE_INDEX_BIN_U16_DEFAULT for default
+    uint32_t period;
+    int32_t repeat_count;
+} emote_index_bin_layout_t;
+
+_Static_assert(sizeof(emote_index_bin_header_t) == 36, "index.bin header size mismatch");
+_Static_assert(sizeof(emote_index_bin_emoji_t) == 8, "index.bin emoji record size mismatch");
+_Static_assert(sizeof(emote_index_bin_icon_t) == 8, "index.bin icon record size mismatch");
+_Static_assert(sizeof(emote_index_bin_layout_t) == 44, "index.bin layout record size mismatch");
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,90 @@
+/*
+ * SPDX-FileCopyrightText: 2025 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+#include "esp_err.h"
+#include "esp_mmap_assets.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Streaming pull tokenizer for index.json
+ *
+ * Tokens are produced one at a time; no tree is built. The reader either walks a
+ * memory-mapped buffer in place, or pulls the file through a fixed-size window with
+ * mmap_assets_copy_mem(), so memory use does not depend on the file size.
+ * ',' and ':' are treated as separators; callers track object/array structure.
+ */
+
+#define EMOTE_JSON_CHUNK_SIZE   256     // Read window used when the file is not mapped
+#define EMOTE_JSON_STR_MAX      64      // Longest string kept in reader->str, including NUL
+
+typedef enum {
+    EMOTE_JSON_TOK_ERROR = 0,
+    EMOTE_JSON_TOK_END,                 // End of input
+    EMOTE_JSON_TOK_OBJ_BEGIN,
+    EMOTE_JSON_TOK_OBJ_END,
+    EMOTE_JSON_TOK_ARR_BEGIN,
+    EMOTE_JSON_TOK_ARR_END,
+    EMOTE_JSON_TOK_STRING,              // Value in reader->str
+    EMOTE_JSON_TOK_NUMBER,              // Value in reader->number
+    EMOTE_JSON_TOK_TRUE,
+    EMOTE_JSON_TOK_FALSE,
+    EMOTE_JSON_TOK_NULL,
+} emote_json_tok_t;
+
+typedef struct {
+    const uint8_t *data;                // Mapped data, or partition offset when assets is set
+    size_t size;
+    size_t pos;
+    mmap_assets_handle_t assets;        // Non-NULL: read through chunk with mmap_assets_copy_mem()
+    uint8_t chunk[EMOTE_JSON_CHUNK_SIZE];
+    size_t chunk_start;
+    size_t chunk_len;
+    char str[EMOTE_JSON_STR_MAX];
+    bool str_truncated;                 // Longer string, str holds its first EMOTE_JSON_STR_MAX - 1 bytes
+    double number;
+} emote_json_reader_t;
+
+/**
+ * @brief Initialize a reader
+ *
+ * @param reader Reader to initialize
+ * @param data Pointer to mapped data, or the offset returned by mmap_assets_get_mem()
+ * @param size Size of the JSON text in bytes
+ * @param assets NULL if data is directly addressable, otherwise the assets handle to copy from
+ */
+void emote_json_reader_init(emote_json_reader_t *reader, const void *data, size_t size, mmap_assets_handle_t assets);
+
+/**
+ * @brief Read the next token
+ *
+ * Strings of any length are read to the closing quote. Callers storing one must check
+ * reader->str_truncated, callers skipping it need not.
+ *
+ * @param reader Reader
+ * @return Token type; EMOTE_JSON_TOK_ERROR on malformed input
+ */
+emote_json_tok_t emote_json_next(emote_json_reader_t *reader);
+
+/**
+ * @brief Skip the rest of a value whose first token has already been read
+ *
+ * @param reader Reader
+ * @param tok First token of the value
+ * @return ESP_OK on success, ESP_ERR_INVALID_RESPONSE on malformed input
+ */
+esp_err_t emote_json_skip(emote_json_reader_t *reader, emote_json_tok_t tok);
+
+#ifdef __cplusplus
+}
+#endif
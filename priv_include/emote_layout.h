@@ -9,113 +9,179 @@
 #include "emote_defs.h"
 #include "esp_err.h"
 
-// Forward declaration for cJSON (only pointer types used in header)
-typedef struct cJSON cJSON;
-
 #ifdef __cplusplus
 extern "C" {
 #endif
 
+// ===== Layout Descriptor =====
+typedef enum {
+    EMOTE_LAYOUT_TYPE_ANIM = 0,
+    EMOTE_LAYOUT_TYPE_IMAGE,
+    EMOTE_LAYOUT_TYPE_LABEL,
+    EMOTE_LAYOUT_TYPE_TIMER,
+    EMOTE_LAYOUT_TYPE_QRCODE,
+    EMOTE_LAYOUT_TYPE_MAX
+} emote_layout_type_t;
+
+/** Parsed layout item, independent of the index source (index.json or index.bin)
+ *  String fields are borrowed from the source and only need to stay valid during apply
+ */
+typedef struct {
+    emote_layout_type_t type;
+    const char *name;
+    const char *align;                 // NULL if align/x/y are missing
+    int x;
+    int y;
+    int width;                         // 0 = keep default
+    int height;                        // 0 = keep default
+    struct {
+        bool mirror;
+    } anim;
+    struct {
+        uint32_t color;
+        const char *text_align;
+        const char *long_mode;
+        bool loop;
+        int speed;
+        int snap_interval;
+        bool digit_atlas;              // Draw digits from a pre-rendered atlas
+        bool scroll_strip;             // Scroll a pre-rendered text strip
+    } label;
+    struct {
+        bool present;                  // "timer" object found
+        uint32_t period;               // 0 for the default of the timer
+        int32_t repeat_count;
+    } timer;
+    struct {
+        int size;
+    } qrcode;
+} emote_layout_desc_t;
+
 // ===== Layout Application Functions =====
 /**
- * @brief  Apply font configuration to emote system
+ * @brief  Reset layout descriptor to default values
  *
- * @param[in]  handle    Emote handle
- * @param[in]  fontData  Font data buffer
+ * @param[out]  desc  Layout descriptor
+ */
+void emote_layout_desc_init(emote_layout_desc_t *desc);
+
+/**
+ * @brief  Convert layout type string ("anim", "image", ...) to layout type
+ *
+ * @param[in]  type_str  Layout type string
  *
  * @return
- *       - ESP_OK  On success
- *       - Other   Error code on failure
+ *       - Layout type              On success
+ *       - EMOTE_LAYOUT_TYPE_MAX    Unknown type string
  */
-esp_err_t emote_apply_fonts(emote_handle_t handle, const uint8_t *fontData);
+emote_layout_type_t emote_layout_type_from_str(const char *type_str);
 
 /**
- * @brief  Apply label layout configuration from JSON
+ * @brief  Apply a loaded text font to emote system
  *
  * @param[in]  handle  Emote handle
- * @param[in]  name    Label element name
- * @param[in]  label   JSON object containing label configuration
+ * @param[in]  font    Font, owned by the handle from now on
  *
  * @return
  *       - ESP_OK  On success
  *       - Other   Error code on failure
  */
-esp_err_t emote_apply_label_layout(emote_handle_t handle, const char *name, cJSON *label);
+esp_err_t emote_apply_fonts(emote_handle_t handle, lv_font_t *font);
 
 /**
- * @brief  Apply image layout configuration from JSON
+ * @brief  Apply layout configuration, dispatched by descriptor type
  *
  * @param[in]  handle  Emote handle
- * @param[in]  name    Image element name
- * @param[in]  image   JSON object containing image configuration
+ * @param[in]  desc    Layout descriptor
  *
  * @return
  *       - ESP_OK  On success
  *       - Other   Error code on failure
  */
-esp_err_t emote_apply_image_layout(emote_handle_t handle, const char *name, cJSON *image);
+esp_err_t emote_apply_layout(emote_handle_t handle, const emote_layout_desc_t *desc);
 
+// ===== UI Operation Functions =====
 /**
- * @brief  Apply timer layout configuration from JSON
+ * @brief  Update clock label with current time
  *
  * @param[in]  handle  Emote handle
- * @param[in]  name    Timer element name
- * @param[in]  timer   JSON object containing timer configuration
  *
  * @return
  *       - ESP_OK  On success
  *       - Other   Error code on failure
  */
-esp_err_t emote_apply_timer_layout(emote_handle_t handle, const char *name, cJSON *timer);
+esp_err_t emote_set_label_clock(emote_handle_t handle);
 
 /**
- * @brief  Apply animation layout configuration from JSON
+ * @brief  Update battery status display (percentage and charging icon)
  *
- * @param[in]  handle     Emote handle
- * @param[in]  name       Animation element name
- * @param[in]  animation  JSON object containing animation configuration
+ * @param[in]  handle  Emote handle
  *
  * @return
  *       - ESP_OK  On success
  *       - Other   Error code on failure
  */
-esp_err_t emote_apply_anim_layout(emote_handle_t handle, const char *name, cJSON *animation);
+esp_err_t emote_set_bat_status(emote_handle_t handle);
 
 /**
- * @brief  Apply QRCode layout configuration from JSON
+ * @brief  Check whether an event only updates cached state
  *
- * @param[in]  handle  Emote handle
- * @param[in]  name    QRCode element name
- * @param[in]  qrcode  JSON object containing QRCode configuration
+ * Such events leave the visible elements alone, unlike the others, which hide all
+ * built-in elements and show their own.
+ *
+ * @param[in]  event  Event identifier
  *
  * @return
- *       - ESP_OK  On success
- *       - Other   Error code on failure
+ *       - true   Event keeps the current UI
+ *       - false  Event replaces the UI, or is not a valid event
  */
-esp_err_t emote_apply_qrcode_layout(emote_handle_t handle, const char *name, cJSON *qrcode);
+bool emote_event_keeps_ui(emote_event_t event);
+
+/** Built-in icons an event shows, copied before the event takes the gfx lock
+ *  The handlers take over the staged references they use; the rest are released after the event
+ */
+typedef struct {
+    const void *src[EMOTE_BUILTIN_ICON_MAX];    // Icon data to show, NULL if not staged
+    void *staged[EMOTE_BUILTIN_ICON_MAX];       // Reference from emote_stage_data(), NULL if none
+} emote_event_icons_t;
 
-// ===== UI Operation Functions =====
 /**
- * @brief  Update clock label with current time
+ * @brief  Copy the built-in icons an event will show, without holding the gfx lock
  *
- * @param[in]  handle  Emote handle
+ * Icons already shown by their object are skipped. Nothing is staged while the calling
+ * task records a batch.
  *
- * @return
- *       - ESP_OK  On success
- *       - Other   Error code on failure
+ * @param[in]   handle  Emote handle
+ * @param[in]   event   Event identifier
+ * @param[out]  icons   Staged icons, for emote_apply_event()
  */
-esp_err_t emote_set_label_clock(emote_handle_t handle);
+void emote_stage_event_icons(emote_handle_t handle, emote_event_t event, emote_event_icons_t *icons);
 
 /**
- * @brief  Update battery status display (percentage and charging icon)
+ * @brief  Release the icons of emote_stage_event_icons() that the event did not use
  *
  * @param[in]  handle  Emote handle
+ * @param[in]  icons   Staged icons
+ */
+void emote_release_event_icons(emote_handle_t handle, emote_event_icons_t *icons);
+
+/**
+ * @brief  Apply an event, as emote_set_event() without logging the call
+ *
+ * Used where the component applies events itself, such as the posted event queue,
+ * so the API call log only holds calls made by the application.
+ *
+ * @param[in]  handle   Emote handle
+ * @param[in]  event    Event identifier
+ * @param[in]  message  Event message, can be NULL
+ * @param[in]  icons    Icons staged by the caller, NULL to stage them before taking the gfx lock
  *
  * @return
- *       - ESP_OK  On success
- *       - Other   Error code on failure
+ *       - ESP_OK               On success
+ *       - ESP_ERR_INVALID_ARG  Invalid handle or event
  */
-esp_err_t emote_set_bat_status(emote_handle_t handle);
+esp_err_t emote_apply_event(emote_handle_t handle, emote_event_t event, const char *message,
+                            emote_event_icons_t *icons);
 
 /**
  * @brief  Create object by name
@@ -129,6 +195,27 @@ esp_err_t emote_set_bat_status(emote_handle_t handle);
  */
 gfx_obj_t *emote_create_obj_by_name(emote_handle_t handle, const char *name);
 
+/**
+ * @brief  Map a predefined element name to its default object type
+ *
+ * @param[in]  name  Element name
+ *
+ * @return
+ *       - Object type        For predefined element names
+ *       - EMOTE_DEF_OBJ_MAX  For custom or unknown names
+ */
+emote_obj_type_t emote_get_element_type(const char *name);
+
+/**
+ * @brief  Forget the last applied state of a default object, with the gfx lock held
+ *
+ * The next text, source or visibility request is applied unconditionally. The state
+ * text is freed here and by the setters, which may run in the render task.
+ *
+ * @param[in]  entry  Default object entry
+ */
+void emote_reset_obj_state(emote_def_obj_entry_t *entry);
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,107 @@
+/*
+ * SPDX-FileCopyrightText: 2025 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include "sdkconfig.h"
+#include "esp_err.h"
+#include "expression_emote.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Frame timing and lock contention instrumentation (CONFIG_EMOTE_PERF_STATS).
+ *
+ * Each timing keeps its last CONFIG_EMOTE_PERF_WINDOW samples in a ring, reduced to
+ * min/avg/p99/max when read. With the option off, the hooks below compile to the
+ * plain gfx calls and nothing else.
+ */
+
+#if CONFIG_EMOTE_PERF_STATS
+
+#include "esp_timer.h"
+
+typedef struct emote_perf_s emote_perf_t;
+
+/**
+ * @brief  Allocate the statistics of a handle
+ *
+ * @param[in]  handle  Emote handle
+ *
+ * @return
+ *       - ESP_OK         On success
+ *       - ESP_ERR_NO_MEM Out of memory
+ */
+esp_err_t emote_perf_init(emote_handle_t handle);
+
+/**
+ * @brief  Free the statistics of a handle
+ *
+ * @param[in]  handle  Emote handle
+ */
+void emote_perf_deinit(emote_handle_t handle);
+
+/**
+ * @brief  Take the gfx lock, timing the wait and the hold for api
+ *
+ * @param[in]  handle  Emote handle
+ * @param[in]  api     Name of the calling function, a string literal
+ */
+void emote_perf_lock(emote_handle_t handle, const char *api);
+
+/**
+ * @brief  Release the gfx lock taken by emote_perf_lock()
+ *
+ * @param[in]  handle  Emote handle
+ */
+void emote_perf_unlock(emote_handle_t handle);
+
+/**
+ * @brief  Note that the flush callback was called for an area
+ *
+ * @param[in]  handle  Emote handle
+ * @param[in]  y1      Top of the flushed area
+ */
+void emote_perf_flush_start(emote_handle_t handle, int y1);
+
+/**
+ * @brief  Note that the flush finished, safe from an ISR
+ *
+ * @param[in]  handle  Emote handle
+ */
+void emote_perf_flush_done(emote_handle_t handle);
+
+/**
+ * @brief  Add an asset staging time
+ *
+ * @param[in]  handle  Emote handle
+ * @param[in]  us      Time spent, in microseconds
+ */
+void emote_perf_add_acquire(emote_handle_t handle, int64_t us);
+
+#define EMOTE_GFX_LOCK(handle)              emote_perf_lock((handle), __func__)
+#define EMOTE_GFX_UNLOCK(handle)            emote_perf_unlock(handle)
+#define EMOTE_PERF_FLUSH_START(handle, y1)  emote_perf_flush_start((handle), (y1))
+#define EMOTE_PERF_FLUSH_DONE(handle)       emote_perf_flush_done(handle)
+#define EMOTE_PERF_TIME(var)                int64_t var = esp_timer_get_time()
+#define EMOTE_PERF_ACQUIRE(handle, start)   emote_perf_add_acquire((handle), esp_timer_get_time() - (start))
+
+#else
+
+#define EMOTE_GFX_LOCK(handle)              gfx_emote_lock((handle)->gfx_handle)
+#define EMOTE_GFX_UNLOCK(handle)            gfx_emote_unlock((handle)->gfx_handle)
+#define EMOTE_PERF_FLUSH_START(handle, y1)  ((void)0)
+#define EMOTE_PERF_FLUSH_DONE(handle)       ((void)0)
+#define EMOTE_PERF_TIME(var)
+#define EMOTE_PERF_ACQUIRE(handle, start)   ((void)0)
+
+#endif
+
+#ifdef __cplusplus
+}
+#endif
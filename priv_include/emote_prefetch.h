@@ -0,0 +1,45 @@
+/*
+ * SPDX-FileCopyrightText: 2025 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include "esp_err.h"
+#include "expression_emote.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Background loader that copies assets into the asset cache ahead of use.
+ *
+ * Requests are queued to a low-priority task, which reads one asset at a time with
+ * the gfx lock released. The loader task is started by the first request.
+ */
+typedef struct emote_prefetch_s emote_prefetch_t;
+
+/**
+ * @brief  Stop the loader task and drop queued requests
+ *
+ * Callbacks of dropped requests are invoked with ESP_ERR_INVALID_STATE.
+ *
+ * @param[in]  handle  Emote handle
+ */
+void emote_prefetch_deinit(emote_handle_t handle);
+
+/**
+ * @brief  Cancel queued and running requests before the assets change
+ *
+ * Waits for an asset copy in progress to finish, so the assets can be unmounted
+ * safely when this returns. Cancelled requests complete with ESP_ERR_INVALID_STATE.
+ *
+ * @param[in]  handle  Emote handle
+ */
+void emote_prefetch_cancel(emote_handle_t handle);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,109 @@
+/*
+ * SPDX-FileCopyrightText: 2025 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include "sdkconfig.h"
+#include "esp_err.h"
+#include "expression_emote.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * API call log (CONFIG_EMOTE_RECORDER), replayed by emote_replay().
+ *
+ * The log starts with EMOTE_RECORD_MAGIC and a version byte. Each call follows as
+ *   varint  microseconds since the previous call
+ *   u8      emote_record_op_t
+ *   str     name or text argument
+ *   str     event message
+ *   varint  event, id, duration or visibility
+ * where varint is unsigned LEB128 and str is a varint of length + 1 (0 for NULL)
+ * followed by the bytes, without terminator.
+ *
+ * Calls are recorded once, at the public API the application called. Calls made by
+ * the component itself are not: the event queue and the dialog timer use internal
+ * variants, and emote_batch_commit() mutes its task while it applies a batch.
+ */
+
+#define EMOTE_RECORD_MAGIC          "EMRC"
+#define EMOTE_RECORD_VERSION        1
+
+typedef enum {
+    EMOTE_RECORD_OP_EVENT = 1,          // emote_set_event(), emote_set_event_msg(): message, event
+    EMOTE_RECORD_OP_POST_EVENT,         // emote_post_event(): message, event
+    EMOTE_RECORD_OP_EMOJI,              // emote_set_anim_emoji(): name
+    EMOTE_RECORD_OP_EMOJI_ID,           // emote_set_anim_emoji_id(): id
+    EMOTE_RECORD_OP_DIALOG,             // emote_set_dialog_anim(): name
+    EMOTE_RECORD_OP_DIALOG_ID,          // emote_set_dialog_anim_id(): id
+    EMOTE_RECORD_OP_INSERT_DIALOG,      // emote_insert_anim_dialog(): name, duration
+    EMOTE_RECORD_OP_STOP_DIALOG,        // emote_stop_anim_dialog()
+    EMOTE_RECORD_OP_QRCODE,             // emote_set_qrcode_data(): text
+    EMOTE_RECORD_OP_OBJ_VISIBLE,        // emote_set_obj_visible(): name, visible
+    EMOTE_RECORD_OP_ANIM_VISIBLE,       // emote_set_anim_visible(): visible
+    EMOTE_RECORD_OP_BATCH_BEGIN,        // emote_batch_begin()
+    EMOTE_RECORD_OP_BATCH_COMMIT,       // emote_batch_commit()
+    EMOTE_RECORD_OP_MAX,
+} emote_record_op_t;
+
+#if CONFIG_EMOTE_RECORDER
+
+typedef struct emote_recorder_s emote_recorder_t;
+
+/**
+ * @brief  Allocate the recorder of a handle, idle until emote_record_start()
+ *
+ * @param[in]  handle  Emote handle
+ *
+ * @return
+ *       - ESP_OK         On success
+ *       - ESP_ERR_NO_MEM Out of memory
+ */
+esp_err_t emote_recorder_init(emote_handle_t handle);
+
+/**
+ * @brief  Free the recorder of a handle
+ *
+ * @param[in]  handle  Emote handle
+ */
+void emote_recorder_deinit(emote_handle_t handle);
+
+/**
+ * @brief  Log a call if recording, from the task that made it
+ *
+ * @param[in]  handle   Emote handle
+ * @param[in]  op       Called API
+ * @param[in]  text     Name or text argument, can be NULL
+ * @param[in]  message  Event message, can be NULL
+ * @param[in]  value    Event, id, duration or visibility
+ */
+void emote_record_call(emote_handle_t handle, emote_record_op_t op, const char *text, const char *message,
+                       uint32_t value);
+
+/**
+ * @brief  Stop or resume logging the calls of the current task, with the gfx lock held
+ *
+ * @param[in]  handle  Emote handle
+ * @param[in]  mute    Stop logging
+ */
+void emote_record_mute(emote_handle_t handle, bool mute);
+
+#define EMOTE_RECORD(handle, op, text, message, value) \
+    emote_record_call((handle), (op), (text), (message), (uint32_t)(value))
+#define EMOTE_RECORD_MUTE(handle, mute)     emote_record_mute((handle), (mute))
+
+#else
+
+#define EMOTE_RECORD(handle, op, text, message, value)  ((void)0)
+#define EMOTE_RECORD_MUTE(handle, mute)                 ((void)0)
+
+#endif
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,88 @@
+/*
+ * SPDX-FileCopyrightText: 2025 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include "esp_err.h"
+#include "gfx.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Scroll strip drawing a scrolling label as an image.
+ *
+ * The text line is rendered once into an A8 strip whenever the text or the font
+ * changes. A scroll step copies a label-wide window of the strip into the alpha
+ * plane of an RGB565A8 image covering the label, instead of having the label lay
+ * out and rasterize the text on every step. Text whose strip exceeds
+ * CONFIG_EMOTE_SCROLL_STRIP_MAX_KB is handed back to the label.
+ */
+typedef struct emote_strip_s emote_strip_t;
+
+/**
+ * @brief  Create a scroll strip for a label
+ *
+ * Must be called with the gfx lock held, after the label is positioned and sized.
+ * The image takes the label's place; the label only draws fallback text.
+ *
+ * @param[in]  gfx    Graphics handle driving the scroll timer
+ * @param[in]  disp   Display
+ * @param[in]  label  Label object drawn over
+ * @param[in]  font   Font of the label
+ * @param[in]  color  Text color (0xRRGGBB)
+ * @param[in]  align  Horizontal alignment of text that fits the label
+ * @param[in]  pos    Alignment of the label (GFX_ALIGN_*)
+ * @param[in]  x      X offset of the label alignment
+ * @param[in]  y      Y offset of the label alignment
+ * @param[in]  speed  Milliseconds per one-pixel scroll step
+ * @param[in]  loop   Scroll continuously instead of stopping at the end of the text
+ *
+ * @return
+ *       - Pointer to strip  On success
+ *       - NULL              Out of memory
+ */
+emote_strip_t *emote_strip_create(gfx_handle_t gfx, gfx_disp_t *disp, gfx_obj_t *label, const lv_font_t *font,
+                                  uint32_t color, gfx_text_align_t align, int pos, int x, int y,
+                                  uint32_t speed, bool loop);
+
+/**
+ * @brief  Delete a scroll strip, its image and timer, with the gfx lock held
+ *
+ * @param[in]  strip  Strip to delete
+ */
+void emote_strip_delete(emote_strip_t *strip);
+
+/**
+ * @brief  Render new text and restart scrolling, with the gfx lock held
+ *
+ * @param[in]  strip  Strip
+ * @param[in]  text   UTF-8 text to draw
+ */
+void emote_strip_set_text(emote_strip_t *strip, const char *text);
+
+/**
+ * @brief  Render the current text with another font, with the gfx lock held
+ *
+ * @param[in]  strip  Strip
+ * @param[in]  font   New font of the label
+ */
+void emote_strip_set_font(emote_strip_t *strip, const lv_font_t *font);
+
+/**
+ * @brief  Follow the visibility of the label, with the gfx lock held
+ *
+ * Scrolling is paused while the label is hidden.
+ *
+ * @param[in]  strip    Strip
+ * @param[in]  visible  Label visibility
+ */
+void emote_strip_set_visible(emote_strip_t *strip, bool visible);
+
+#ifdef __cplusplus
+}
+#endif
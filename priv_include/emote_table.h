@@ -15,16 +15,29 @@ extern "C" {
 #endif
 
 // ===== Hash Table Management =====
+typedef struct {
+    uint32_t count;             // Number of entries
+    uint32_t slot_count;        // Current slot count
+    uint32_t borrowed_keys;     // Entries whose key is referenced, not copied
+    uint32_t pool_used;         // Bytes of copied key strings
+    size_t arena_size;          // Bytes allocated for slots, keys, values and key pool
+} emote_assets_table_stats_t;
+
 /**
  * @brief  Create a new assets hash table
  *
- * @param[in]  name  Name of the hash table (for logging/debugging, can be NULL)
+ * Keys are copied into the table and values of value_size bytes are stored inline,
+ * so no per-entry allocation is made. Pointers returned by emote_assets_table_get()
+ * stay valid until the next insert of a new key.
+ *
+ * @param[in]  name        Name of the hash table (for logging/debugging, can be NULL)
+ * @param[in]  value_size  Size of each value in bytes
  *
  * @return
  *       - Pointer to hash table  On success
  *       - NULL                  Fail to create hash table
  */
-assets_hash_table_t *emote_assets_table_create(const char *name);
+assets_hash_table_t *emote_assets_table_create(const char *name, size_t value_size);
 
 /**
  * @brief  Destroy and free assets hash table
@@ -33,10 +46,144 @@ assets_hash_table_t *emote_assets_table_create(const char *name);
  */
 void emote_assets_table_destroy(assets_hash_table_t *ht);
 
+/**
+ * @brief  Insert or replace a value
+ *
+ * @param[in]  ht     Hash table
+ * @param[in]  key    Key string, copied into the table
+ * @param[in]  value  Value to copy, value_size bytes
+ *
+ * @return
+ *       - ESP_OK               On success
+ *       - ESP_ERR_INVALID_ARG  Invalid parameters
+ *       - ESP_ERR_NO_MEM       Failed to grow the table
+ */
+esp_err_t emote_assets_table_set(assets_hash_table_t *ht, const char *key, const void *value);
+
+/**
+ * @brief  Insert or replace a value, referencing the key instead of copying it
+ *
+ * @note The key string must stay valid and unchanged for the lifetime of the table,
+ *       e.g. a name inside the memory-mapped asset image while it stays mounted.
+ *
+ * @param[in]  ht     Hash table
+ * @param[in]  key    Key string, borrowed
+ * @param[in]  value  Value to copy, value_size bytes
+ *
+ * @return
+ *       - ESP_OK               On success
+ *       - ESP_ERR_INVALID_ARG  Invalid parameters
+ *       - ESP_ERR_NO_MEM       Failed to grow the table
+ */
+esp_err_t emote_assets_table_set_static(assets_hash_table_t *ht, const char *key, const void *value);
+
+/**
+ * @brief  Look up a value
+ *
+ * @param[in]  ht   Hash table
+ * @param[in]  key  Key string
+ *
+ * @return
+ *       - Pointer to the stored value  On success
+ *       - NULL                         Not found
+ */
+void *emote_assets_table_get(assets_hash_table_t *ht, const char *key);
+
+/**
+ * @brief  Get the dense index of a key
+ *
+ * Entries are never removed, so an index stays valid for the lifetime of the table.
+ *
+ * @param[in]  ht   Hash table
+ * @param[in]  key  Key string
+ *
+ * @return Index in [0, count), or -1 if not found
+ */
+int emote_assets_table_index_of(const assets_hash_table_t *ht, const char *key);
+
+/**
+ * @brief  Get a value by dense index
+ *
+ * @param[in]  ht     Hash table
+ * @param[in]  index  Index returned by emote_assets_table_index_of()
+ *
+ * @return
+ *       - Pointer to the stored value  On success
+ *       - NULL                         Index out of range
+ */
+void *emote_assets_table_at(assets_hash_table_t *ht, int index);
+
+/**
+ * @brief  Get the number of entries
+ *
+ * @param[in]  ht  Hash table
+ *
+ * @return Number of entries, 0 if ht is NULL
+ */
+int emote_assets_table_count(const assets_hash_table_t *ht);
+
+/**
+ * @brief  Get memory statistics of a table
+ *
+ * @param[in]   ht     Hash table, may be NULL
+ * @param[out]  stats  Statistics, zeroed if ht is NULL
+ */
+void emote_assets_table_get_stats(const assets_hash_table_t *ht, emote_assets_table_stats_t *stats);
+
+// ===== Asset Name Index =====
+/**
+ * @brief  Sort asset name index entries by name, then by file index
+ *
+ * @param[in,out]  entries  Entries to sort in place
+ * @param[in]      count    Number of entries
+ */
+void emote_asset_index_sort(emote_asset_name_entry_t *entries, int count);
+
+/**
+ * @brief  Find a file by name in an index sorted by emote_asset_index_sort()
+ *
+ * @param[in]  entries  Sorted entries, may be NULL
+ * @param[in]  count    Number of entries
+ * @param[in]  name     File name
+ *
+ * @return Lowest file index with that name, or -1 if not found
+ */
+int emote_asset_index_find(const emote_asset_name_entry_t *entries, int count, const char *name);
+
+// ===== Built-in Icons =====
+/**
+ * @brief  Get a built-in icon resolved at load time
+ *
+ * @param[in]   handle  Emote handle
+ * @param[in]   icon    Built-in icon
+ * @param[out]  data    Icon data
+ *
+ * @return
+ *       - ESP_OK             On success
+ *       - ESP_ERR_NOT_FOUND  Icon missing from the loaded assets
+ */
+esp_err_t emote_get_builtin_icon(emote_handle_t handle, emote_builtin_icon_t icon, icon_data_t **data);
+
 // ===== Asset Data Acquisition =====
+/**
+ * @brief  Check whether asset data is directly addressable
+ *
+ * @param[in]  handle    Emote handle
+ * @param[in]  data_ref  Pointer from mmap_assets_get_mem()
+ *
+ * @return
+ *       - true   Memory-mapped pointer, usable in place
+ *       - false  Offset that has to be copied with mmap_assets_copy_mem()
+ */
+bool emote_data_is_mapped(emote_handle_t handle, const void *data_ref);
+
 /**
  * @brief  Acquire asset data with caching support
  *
+ * Mapped data is returned in place. Otherwise a reference to a shared copy in the
+ * asset cache is taken and stored in *output_ptr. The reference previously stored in
+ * *output_ptr is released afterwards, so re-acquiring the same asset is a cache hit.
+ *
  * @param[in]   handle        Emote handle
  * @param[in]   data_ref      Reference to data
  * @param[in]   size          Size of data
@@ -48,6 +195,46 @@ void emote_assets_table_destroy(assets_hash_table_t *ht);
  */
 const void *emote_acquire_data(emote_handle_t handle, const void *data_ref, size_t size, void **output_ptr);
 
+/**
+ * @brief  Phase 1 of a two-phase acquisition: make asset data addressable
+ *
+ * Call without the gfx lock held. Mapped data is returned in place. Otherwise the
+ * asset is copied into the asset cache, or found there, and the reference is
+ * returned in *staged for emote_swap_data().
+ *
+ * @param[in]   handle    Emote handle
+ * @param[in]   data_ref  Reference to data
+ * @param[in]   size      Size of data
+ * @param[out]  staged    Cache reference, NULL for mapped data
+ *
+ * @return
+ *       - Pointer to data  On success
+ *       - NULL             Fail to acquire data
+ */
+const void *emote_stage_data(emote_handle_t handle, const void *data_ref, size_t size, void **staged);
+
+/**
+ * @brief  Phase 2 of a two-phase acquisition: install a staged reference
+ *
+ * Call with the gfx lock held, together with setting the object source. Release the
+ * returned reference with emote_release_data() once the lock is dropped.
+ *
+ * @param[in,out]  output_ptr  Object cache pointer
+ * @param[in]      staged      Reference from emote_stage_data()
+ *
+ * @return
+ *       - Previous reference, may be NULL
+ */
+void *emote_swap_data(void **output_ptr, void *staged);
+
+/**
+ * @brief  Release data stored by emote_acquire_data()
+ *
+ * @param[in]  handle  Emote handle
+ * @param[in]  data    Cached data pointer, may be NULL
+ */
+void emote_release_data(emote_handle_t handle, void *data);
+
 #ifdef __cplusplus
 }
 #endif
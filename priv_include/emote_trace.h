@@ -0,0 +1,84 @@
+/*
+ * SPDX-FileCopyrightText: 2025 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include "sdkconfig.h"
+#include "esp_err.h"
+#include "expression_emote.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Span tracer (CONFIG_EMOTE_TRACE).
+ *
+ * A span is recorded once, when it ends, into a ring of the last
+ * CONFIG_EMOTE_TRACE_EVENTS spans. Recording takes no lock: a slot is claimed with an
+ * atomic increment and published through a sequence number, so spans can be recorded
+ * from any task or ISR while emote_trace_dump() reads the ring. With the option off,
+ * the hooks below compile to nothing.
+ */
+
+#if CONFIG_EMOTE_TRACE
+
+#include "esp_timer.h"
+
+typedef struct emote_trace_s emote_trace_t;
+
+/**
+ * @brief  Allocate the trace ring of a handle
+ *
+ * @param[in]  handle  Emote handle
+ *
+ * @return
+ *       - ESP_OK         On success
+ *       - ESP_ERR_NO_MEM Out of memory
+ */
+esp_err_t emote_trace_init(emote_handle_t handle);
+
+/**
+ * @brief  Free the trace ring of a handle
+ *
+ * @param[in]  handle  Emote handle
+ */
+void emote_trace_deinit(emote_handle_t handle);
+
+/**
+ * @brief  Record a span that ends now
+ *
+ * @param[in]  handle  Emote handle
+ * @param[in]  name    Span name, a string literal
+ * @param[in]  start   esp_timer_get_time() at the start of the span
+ * @param[in]  arg     Value shown in the span arguments
+ */
+void emote_trace_span(emote_handle_t handle, const char *name, int64_t start, int32_t arg);
+
+/**
+ * @brief  Record an instant event, safe from an ISR
+ *
+ * @param[in]  handle  Emote handle
+ * @param[in]  name    Event name, a string literal
+ * @param[in]  arg     Value shown in the event arguments
+ */
+void emote_trace_instant(emote_handle_t handle, const char *name, int32_t arg);
+
+#define EMOTE_TRACE_BEGIN(var)                      int64_t var = esp_timer_get_time()
+#define EMOTE_TRACE_END(handle, name, var, arg)     emote_trace_span((handle), (name), (var), (int32_t)(arg))
+#define EMOTE_TRACE_INSTANT(handle, name, arg)      emote_trace_instant((handle), (name), (int32_t)(arg))
+
+#else
+
+#define EMOTE_TRACE_BEGIN(var)
+#define EMOTE_TRACE_END(handle, name, var, arg)     ((void)0)
+#define EMOTE_TRACE_INSTANT(handle, name, arg)      ((void)0)
+
+#endif
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,231 @@
+/*
+ * SPDX-FileCopyrightText: 2025 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "esp_log.h"
+#include "esp_check.h"
+#include <string.h>
+#include <stdlib.h>
+
+#include "emote_defs.h"
+#include "emote_table.h"
+#include "emote_layout.h"
+#include "emote_batch.h"
+#include "emote_perf.h"
+#include "emote_record.h"
+
+static const char *TAG = "Expression_batch";
+
+#define BATCH_INITIAL_OPS   8
+
+typedef enum {
+    EMOTE_BATCH_OP_EMOJI,
+    EMOTE_BATCH_OP_EVENT,
+    EMOTE_BATCH_OP_VISIBLE,
+    EMOTE_BATCH_OP_QRCODE,
+} emote_batch_op_type_t;
+
+typedef struct {
+    emote_batch_op_type_t type;
+    union {
+        emote_asset_id_t id;                // EMOTE_BATCH_OP_EMOJI
+        emote_event_t event;                // EMOTE_BATCH_OP_EVENT
+        bool visible;                       // EMOTE_BATCH_OP_VISIBLE
+    };
+    char *text;                             // Message, object name or QR code text
+    void *staged;                           // Emoji copy staged before the lock is taken
+    emote_event_icons_t icons;              // Event icons staged before the lock is taken
+} emote_batch_op_t;
+
+struct emote_batch_s {
+    emote_batch_op_t *ops;
+    size_t count;
+    size_t capacity;
+};
+
+// ===== Helpers =====
+
+static void emote_batch_free(emote_handle_t handle, emote_batch_t *batch)
+{
+    for (size_t i = 0; i < batch->count; i++) {
+        emote_release_data(handle, batch->ops[i].staged);
+        emote_release_event_icons(handle, &batch->ops[i].icons);
+        free(batch->ops[i].text);
+    }
+    free(batch->ops);
+    free(batch);
+}
+
+static esp_err_t emote_batch_push(emote_handle_t handle, const emote_batch_op_t *op, const char *text)
+{
+    emote_batch_t *batch = handle->batch;
+
+    if (batch->count == batch->capacity) {
+        size_t capacity = batch->capacity ? batch->capacity * 2 : BATCH_INITIAL_OPS;
+        emote_batch_op_t *ops = (emote_batch_op_t *)realloc(batch->ops, capacity * sizeof(emote_batch_op_t));
+        ESP_RETURN_ON_FALSE(ops, ESP_ERR_NO_MEM, TAG, "Failed to grow batch");
+        batch->ops = ops;
+        batch->capacity = capacity;
+    }
+
+    char *copy = NULL;
+    if (text) {
+        copy = strdup(text);
+        ESP_RETURN_ON_FALSE(copy, ESP_ERR_NO_MEM, TAG, "Failed to copy batch text");
+    }
+
+    emote_batch_op_t *slot = &batch->ops[batch->count++];
+    *slot = *op;
+    slot->text = copy;
+    slot->staged = NULL;
+    memset(&slot->icons, 0, sizeof(slot->icons));
+    return ESP_OK;
+}
+
+static esp_err_t emote_batch_apply(emote_handle_t handle, emote_batch_op_t *op)
+{
+    switch (op->type) {
+    case EMOTE_BATCH_OP_EMOJI:
+        return emote_set_anim_emoji_id(handle, op->id);
+    case EMOTE_BATCH_OP_EVENT:
+        return emote_apply_event(handle, op->event, op->text, &op->icons);
+    case EMOTE_BATCH_OP_VISIBLE:
+        return op->text ? emote_set_obj_visible(handle, op->text, op->visible) :
+               emote_set_anim_visible(handle, op->visible);
+    case EMOTE_BATCH_OP_QRCODE:
+        return emote_set_qrcode_data(handle, op->text);
+    default:
+        return ESP_ERR_INVALID_ARG;
+    }
+}
+
+// ===== Recording =====
+
+bool emote_batch_is_recording(emote_handle_t handle)
+{
+    // Other tasks only compare the owner, they never touch the batch itself
+    return handle && handle->batch_owner && handle->batch_owner == xTaskGetCurrentTaskHandle();
+}
+
+esp_err_t emote_batch_record_emoji(emote_handle_t handle, emote_asset_id_t id)
+{
+    emote_batch_op_t op = { .type = EMOTE_BATCH_OP_EMOJI, .id = id };
+    return emote_batch_push(handle, &op, NULL);
+}
+
+esp_err_t emote_batch_record_event(emote_handle_t handle, emote_event_t event, const char *message)
+{
+    emote_batch_op_t op = { .type = EMOTE_BATCH_OP_EVENT, .event = event };
+    return emote_batch_push(handle, &op, message);
+}
+
+esp_err_t emote_batch_record_visible(emote_handle_t handle, const char *name, bool visible)
+{
+    // Fail now, as emote_set_obj_visible() would, instead of at commit
+    if (name) {
+        emote_obj_type_t type = emote_get_element_type(name);
+        gfx_obj_t *obj = (type != EMOTE_DEF_OBJ_MAX) ? handle->def_objects[type].obj :
+                         emote_get_obj_by_name(handle, name);
+        ESP_RETURN_ON_FALSE(obj, ESP_ERR_INVALID_STATE, TAG, "Object not found");
+    }
+
+    emote_batch_op_t op = { .type = EMOTE_BATCH_OP_VISIBLE, .visible = visible };
+    return emote_batch_push(handle, &op, name);
+}
+
+esp_err_t emote_batch_record_qrcode(emote_handle_t handle, const char *text)
+{
+    emote_batch_op_t op = { .type = EMOTE_BATCH_OP_QRCODE };
+    return emote_batch_push(handle, &op, text);
+}
+
+void emote_batch_deinit(emote_handle_t handle)
+{
+    if (!handle || !handle->batch) {
+        return;
+    }
+
+    emote_batch_free(handle, handle->batch);
+    handle->batch = NULL;
+    handle->batch_owner = NULL;
+}
+
+// ===== API =====
+
+esp_err_t emote_batch_begin(emote_handle_t handle)
+{
+    esp_err_t ret = ESP_OK;
+    emote_batch_t *batch = NULL;
+
+    ESP_GOTO_ON_FALSE(handle, ESP_ERR_INVALID_ARG, error, TAG, "Invalid parameters");
+    EMOTE_RECORD(handle, EMOTE_RECORD_OP_BATCH_BEGIN, NULL, NULL, 0);
+
+    batch = (emote_batch_t *)calloc(1, sizeof(emote_batch_t));
+    ESP_GOTO_ON_FALSE(batch, ESP_ERR_NO_MEM, error, TAG, "Failed to allocate batch");
+
+    EMOTE_GFX_LOCK(handle);
+    bool busy = (handle->batch_owner != NULL);
+    if (!busy) {
+        handle->batch = batch;
+        handle->batch_owner = xTaskGetCurrentTaskHandle();
+    }
+    EMOTE_GFX_UNLOCK(handle);
+    ESP_GOTO_ON_FALSE(!busy, ESP_ERR_INVALID_STATE, error, TAG, "A batch is already open");
+
+    return ESP_OK;
+
+error:
+    free(batch);
+    return ret;
+}
+
+esp_err_t emote_batch_commit(emote_handle_t handle)
+{
+    esp_err_t ret = ESP_OK;
+    emote_batch_t *batch = NULL;
+
+    ESP_GOTO_ON_FALSE(handle, ESP_ERR_INVALID_ARG, error, TAG, "Invalid parameters");
+    EMOTE_RECORD(handle, EMOTE_RECORD_OP_BATCH_COMMIT, NULL, NULL, 0);
+    ESP_GOTO_ON_FALSE(emote_batch_is_recording(handle), ESP_ERR_INVALID_STATE, error, TAG, "No batch open in this task");
+
+    // Close the batch first, so the setters below apply instead of recording
+    EMOTE_GFX_LOCK(handle);
+    batch = handle->batch;
+    handle->batch = NULL;
+    handle->batch_owner = NULL;
+    EMOTE_GFX_UNLOCK(handle);
+
+    // Copy emoji and icon data before the lock is taken; the setters then hit the asset cache
+    for (size_t i = 0; i < batch->count; i++) {
+        emote_batch_op_t *op = &batch->ops[i];
+        emoji_data_t *emoji = NULL;
+        if (op->type == EMOTE_BATCH_OP_EMOJI && emote_get_emoji_data_by_id(handle, op->id, &emoji) == ESP_OK) {
+            emote_stage_data(handle, emoji->data, emoji->size, &op->staged);
+        } else if (op->type == EMOTE_BATCH_OP_EVENT) {
+            emote_stage_event_icons(handle, op->event, &op->icons);
+        }
+    }
+
+    // One lock for all changes: the renderer sees none or all of them
+    // The setters are logged as part of the batch already, not again as they apply
+    EMOTE_GFX_LOCK(handle);
+    EMOTE_RECORD_MUTE(handle, true);
+    for (size_t i = 0; i < batch->count; i++) {
+        esp_err_t op_ret = emote_batch_apply(handle, &batch->ops[i]);
+        if (op_ret != ESP_OK && ret == ESP_OK) {
+            ret = op_ret;
+        }
+    }
+    EMOTE_RECORD_MUTE(handle, false);
+    EMOTE_GFX_UNLOCK(handle);
+
+    ESP_LOGD(TAG, "Committed %d changes: %s", (int)batch->count, esp_err_to_name(ret));
+    emote_batch_free(handle, batch);
+
+error:
+    return ret;
+}
@@ -0,0 +1,331 @@
+/*
+ * SPDX-FileCopyrightText: 2025 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/semphr.h"
+#include "esp_log.h"
+#include "esp_check.h"
+#include <string.h>
+#include <stdlib.h>
+
+#include "emote_cache.h"
+
+static const char *TAG = "Expression_cache";
+
+typedef struct emote_cache_entry_s {
+    size_t offset;
+    size_t size;
+    uint32_t refs;
+    bool detached;                          // Belongs to a previous mount, never hit
+    bool loading;                           // Being copied outside the mutex
+    bool failed;                            // The copy came back short, never served
+    uint16_t waiters;                       // Tasks waiting for the copy
+    SemaphoreHandle_t loaded;               // Given when the copy ends, while there are waiters
+    struct emote_cache_entry_s *prev;       // Towards most recently used
+    struct emote_cache_entry_s *next;       // Towards least recently used
+    uint8_t data[];
+} emote_cache_entry_t;
+
+struct emote_cache_s {
+    SemaphoreHandle_t mutex;
+    emote_cache_entry_t *head;              // Most recently used
+    emote_cache_entry_t *tail;              // Least recently used
+    size_t budget;
+    size_t idle_bytes;                      // Bytes held by unreferenced entries
+    emote_cache_stats_t stats;
+};
+
+// ===== List helpers (mutex held) =====
+
+static void emote_cache_unlink(emote_cache_t *cache, emote_cache_entry_t *entry)
+{
+    if (entry->prev) {
+        entry->prev->next = entry->next;
+    } else {
+        cache->head = entry->next;
+    }
+    if (entry->next) {
+        entry->next->prev = entry->prev;
+    } else {
+        cache->tail = entry->prev;
+    }
+    entry->prev = NULL;
+    entry->next = NULL;
+}
+
+static void emote_cache_push_front(emote_cache_t *cache, emote_cache_entry_t *entry)
+{
+    entry->prev = NULL;
+    entry->next = cache->head;
+    if (cache->head) {
+        cache->head->prev = entry;
+    }
+    cache->head = entry;
+    if (!cache->tail) {
+        cache->tail = entry;
+    }
+}
+
+static void emote_cache_free_entry(emote_cache_t *cache, emote_cache_entry_t *entry)
+{
+    emote_cache_unlink(cache, entry);
+    cache->stats.used_bytes -= entry->size;
+    cache->stats.entry_count--;
+    free(entry);
+}
+
+static emote_cache_entry_t *emote_cache_find_data(emote_cache_t *cache, const void *data)
+{
+    for (emote_cache_entry_t *entry = cache->head; entry; entry = entry->next) {
+        if (entry->data == data) {
+            return entry;
+        }
+    }
+    return NULL;
+}
+
+// Evict least recently used idle entries until idle bytes fit in the budget
+static void emote_cache_trim(emote_cache_t *cache, size_t budget)
+{
+    emote_cache_entry_t *entry = cache->tail;
+    while (entry && cache->idle_bytes > budget) {
+        emote_cache_entry_t *prev = entry->prev;
+        if (entry->refs == 0) {
+            cache->idle_bytes -= entry->size;
+            cache->stats.evictions++;
+            emote_cache_free_entry(cache, entry);
+        }
+        entry = prev;
+    }
+}
+
+// Drop a reference; unreferenced entries become idle, or are freed if detached
+static void emote_cache_put(emote_cache_t *cache, emote_cache_entry_t *entry)
+{
+    if (entry->refs > 0 && --entry->refs == 0) {
+        if (entry->detached) {
+            emote_cache_free_entry(cache, entry);
+        } else {
+            cache->idle_bytes += entry->size;
+            emote_cache_trim(cache, cache->budget);
+        }
+    }
+}
+
+/*
+ * Wait for the copy of an entry made by another task, mutex held on entry and exit.
+ * The loader gives the semaphore once; each waiter gives it on to the next, and the
+ * last one deletes it. Waiting blocks instead of polling, so a waiter holding the gfx
+ * lock does not spin against a lower-priority loader.
+ */
+static bool emote_cache_wait_loaded(emote_cache_t *cache, emote_cache_entry_t *entry)
+{
+    if (!entry->loaded) {
+        entry->loaded = xSemaphoreCreateBinary();
+        if (!entry->loaded) {
+            ESP_LOGE(TAG, "Failed to create load semaphore");
+            return false;
+        }
+    }
+
+    SemaphoreHandle_t loaded = entry->loaded;
+    entry->waiters++;
+    xSemaphoreGive(cache->mutex);
+    xSemaphoreTake(loaded, portMAX_DELAY);
+    xSemaphoreGive(loaded);
+    xSemaphoreTake(cache->mutex, portMAX_DELAY);
+
+    if (--entry->waiters == 0) {
+        vSemaphoreDelete(loaded);
+        entry->loaded = NULL;
+    }
+    return true;
+}
+
+// ===== API =====
+
+emote_cache_t *emote_cache_create(size_t budget)
+{
+    emote_cache_t *cache = (emote_cache_t *)calloc(1, sizeof(emote_cache_t));
+    if (!cache) {
+        return NULL;
+    }
+
+    cache->mutex = xSemaphoreCreateMutex();
+    if (!cache->mutex) {
+        free(cache);
+        return NULL;
+    }
+
+    cache->budget = budget;
+    cache->stats.budget = budget;
+    return cache;
+}
+
+void emote_cache_destroy(emote_cache_t *cache)
+{
+    if (!cache) {
+        return;
+    }
+
+    emote_cache_entry_t *entry = cache->head;
+    while (entry) {
+        emote_cache_entry_t *next = entry->next;
+        if (entry->refs) {
+            ESP_LOGW(TAG, "Destroying entry at 0x%x with %d references", (unsigned)entry->offset, (int)entry->refs);
+        }
+        free(entry);
+        entry = next;
+    }
+
+    vSemaphoreDelete(cache->mutex);
+    free(cache);
+}
+
+const void *emote_cache_acquire(emote_cache_t *cache, mmap_assets_handle_t assets, size_t offset, size_t size)
+{
+    emote_cache_entry_t *entry = NULL;
+
+    if (!cache || !assets || size == 0) {
+        return NULL;
+    }
+
+    xSemaphoreTake(cache->mutex, portMAX_DELAY);
+
+    for (entry = cache->head; entry; entry = entry->next) {
+        if (!entry->detached && entry->offset == offset && entry->size == size) {
+            break;
+        }
+    }
+
+    if (entry) {
+        cache->stats.hits++;
+        if (entry->refs++ == 0) {
+            cache->idle_bytes -= entry->size;
+        }
+        // Another task is still copying this asset; the reference taken above keeps it alive
+        if (entry->loading && !emote_cache_wait_loaded(cache, entry)) {
+            emote_cache_put(cache, entry);
+            xSemaphoreGive(cache->mutex);
+            return NULL;
+        }
+        if (entry->failed) {
+            emote_cache_put(cache, entry);
+            xSemaphoreGive(cache->mutex);
+            return NULL;
+        }
+        emote_cache_unlink(cache, entry);
+        emote_cache_push_front(cache, entry);
+        xSemaphoreGive(cache->mutex);
+        return entry->data;
+    }
+
+    cache->stats.misses++;
+
+    // Make room first so the old copies are gone before the new one is allocated
+    emote_cache_trim(cache, cache->budget > size ? cache->budget - size : 0);
+
+    entry = (emote_cache_entry_t *)malloc(sizeof(emote_cache_entry_t) + size);
+    if (!entry) {
+        // Last resort: drop every idle entry and retry once
+        emote_cache_trim(cache, 0);
+        entry = (emote_cache_entry_t *)malloc(sizeof(emote_cache_entry_t) + size);
+    }
+    if (!entry) {
+        xSemaphoreGive(cache->mutex);
+        ESP_LOGE(TAG, "Failed to allocate memory: %zu bytes", size);
+        return NULL;
+    }
+
+    entry->offset = offset;
+    entry->size = size;
+    entry->refs = 1;
+    entry->detached = false;
+    entry->loading = true;
+    entry->failed = false;
+    entry->waiters = 0;
+    entry->loaded = NULL;
+    emote_cache_push_front(cache, entry);
+    cache->stats.used_bytes += size;
+    cache->stats.entry_count++;
+
+    // The new entry is referenced, so it cannot be evicted while the copy runs unlocked
+    xSemaphoreGive(cache->mutex);
+    size_t copied = mmap_assets_copy_mem(assets, offset, entry->data, size);
+
+    xSemaphoreTake(cache->mutex, portMAX_DELAY);
+    entry->loading = false;
+    if (entry->loaded) {
+        xSemaphoreGive(entry->loaded);
+    }
+    if (copied != size) {
+        // Waiters still hold references; the last one frees the entry
+        entry->failed = true;
+        entry->detached = true;
+        emote_cache_put(cache, entry);
+        xSemaphoreGive(cache->mutex);
+        ESP_LOGE(TAG, "Failed to read asset at 0x%x: %zu of %zu bytes", (unsigned)offset, copied, size);
+        return NULL;
+    }
+    cache->stats.copied_bytes += size;
+    xSemaphoreGive(cache->mutex);
+    return entry->data;
+}
+
+bool emote_cache_release(emote_cache_t *cache, const void *data)
+{
+    if (!cache || !data) {
+        return false;
+    }
+
+    xSemaphoreTake(cache->mutex, portMAX_DELAY);
+
+    emote_cache_entry_t *entry = emote_cache_find_data(cache, data);
+    if (!entry) {
+        xSemaphoreGive(cache->mutex);
+        return false;
+    }
+
+    emote_cache_put(cache, entry);
+
+    xSemaphoreGive(cache->mutex);
+    return true;
+}
+
+void emote_cache_clear(emote_cache_t *cache)
+{
+    if (!cache) {
+        return;
+    }
+
+    xSemaphoreTake(cache->mutex, portMAX_DELAY);
+
+    emote_cache_entry_t *entry = cache->head;
+    while (entry) {
+        emote_cache_entry_t *next = entry->next;
+        if (entry->refs == 0) {
+            cache->idle_bytes -= entry->size;
+            emote_cache_free_entry(cache, entry);
+        } else {
+            entry->detached = true;
+        }
+        entry = next;
+    }
+
+    xSemaphoreGive(cache->mutex);
+}
+
+void emote_cache_get_stats(emote_cache_t *cache, emote_cache_stats_t *stats)
+{
+    if (!cache || !stats) {
+        return;
+    }
+
+    xSemaphoreTake(cache->mutex, portMAX_DELAY);
+    *stats = cache->stats;
+    xSemaphoreGive(cache->mutex);
+}
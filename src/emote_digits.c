@@ -0,0 +1,194 @@
+/*
+ * SPDX-FileCopyrightText: 2025 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "esp_log.h"
+#include "esp_check.h"
+#include <string.h>
+#include <stdlib.h>
+
+#include "emote_digits.h"
+#include "emote_glyph.h"
+
+static const char *TAG = "Expression_digits";
+
+#define DIGITS_CHARSET          "0123456789:%"
+#define DIGITS_GLYPH_COUNT      (sizeof(DIGITS_CHARSET) - 1)
+#define DIGITS_MAX_LEN          8           // Longer text goes to the label
+
+struct emote_digits_s {
+    gfx_obj_t *img;
+    gfx_obj_t *label;
+    gfx_image_dsc_t dsc;
+    uint8_t *alpha;                         // A8 plane of the image
+    uint8_t *atlas;                         // A8 strip of all glyphs, atlas_w x line_h
+    uint16_t atlas_w;
+    uint16_t line_h;
+    uint16_t w;
+    uint16_t h;
+    gfx_text_align_t align;
+    uint16_t glyph_x[DIGITS_GLYPH_COUNT];   // Glyph cell in the strip
+    uint8_t glyph_w[DIGITS_GLYPH_COUNT];    // Glyph advance
+    bool fallback;                          // Text is drawn by the label
+    bool visible;
+};
+
+static int emote_digits_glyph_index(char c)
+{
+    if (c >= '0' && c <= '9') {
+        return c - '0';
+    }
+    return (c == ':') ? 10 : (c == '%') ? 11 : -1;
+}
+
+static esp_err_t emote_digits_build_atlas(emote_digits_t *digits, const lv_font_t *font)
+{
+    lv_font_glyph_dsc_t glyphs[DIGITS_GLYPH_COUNT];
+    uint32_t width = 0;
+
+    for (size_t i = 0; i < DIGITS_GLYPH_COUNT; i++) {
+        uint32_t letter = (uint8_t)DIGITS_CHARSET[i];
+        ESP_RETURN_ON_FALSE(font->get_glyph_dsc(font, &glyphs[i], letter, 0) && glyphs[i].adv_w <= UINT8_MAX,
+                            ESP_ERR_NOT_FOUND, TAG, "Font lacks glyph '%c'", (char)letter);
+        digits->glyph_x[i] = width;
+        digits->glyph_w[i] = glyphs[i].adv_w;
+        width += glyphs[i].adv_w;
+    }
+
+    digits->atlas_w = width;
+    digits->line_h = font->line_height;
+    digits->atlas = (uint8_t *)calloc(1, (size_t)digits->atlas_w * digits->line_h);
+    ESP_RETURN_ON_FALSE(digits->atlas, ESP_ERR_NO_MEM, TAG, "Failed to allocate digit atlas");
+
+    for (size_t i = 0; i < DIGITS_GLYPH_COUNT; i++) {
+        // Each glyph is clipped to its own cell of the strip
+        emote_glyph_render_a8(font, (uint8_t)DIGITS_CHARSET[i], &glyphs[i], digits->atlas, digits->atlas_w,
+                              digits->glyph_x[i], digits->glyph_x[i], digits->glyph_w[i]);
+    }
+    return ESP_OK;
+}
+
+static void emote_digits_apply_visible(emote_digits_t *digits)
+{
+    gfx_obj_set_visible(digits->img, digits->visible && !digits->fallback);
+}
+
+static void emote_digits_set_fallback(emote_digits_t *digits, const char *text)
+{
+    if (text) {
+        gfx_label_set_text(digits->label, text);
+    } else if (digits->fallback) {
+        gfx_label_set_text(digits->label, "");
+    }
+
+    if (digits->fallback != (text != NULL)) {
+        digits->fallback = (text != NULL);
+        emote_digits_apply_visible(digits);
+    }
+}
+
+// ===== API =====
+
+emote_digits_t *emote_digits_create(gfx_disp_t *disp, gfx_obj_t *label, const lv_font_t *font, uint32_t color,
+                                    gfx_text_align_t align, int pos, int x, int y)
+{
+    esp_err_t ret = ESP_OK;
+    emote_digits_t *digits = NULL;
+    uint16_t w = 0;
+    uint16_t h = 0;
+
+    ESP_GOTO_ON_FALSE(disp && label && font && font->get_glyph_dsc && font->get_glyph_bitmap, ESP_ERR_INVALID_ARG,
+                      error, TAG, "Invalid parameters");
+    gfx_obj_get_size(label, &w, &h);
+    ESP_GOTO_ON_FALSE(w > 0 && h > 0, ESP_ERR_INVALID_SIZE, error, TAG, "Label has no size");
+
+    digits = (emote_digits_t *)calloc(1, sizeof(emote_digits_t));
+    ESP_GOTO_ON_FALSE(digits, ESP_ERR_NO_MEM, error, TAG, "Failed to allocate digit atlas");
+    digits->label = label;
+    digits->w = w;
+    digits->h = h;
+    digits->align = align;
+
+    ESP_GOTO_ON_ERROR(emote_digits_build_atlas(digits, font), error, TAG, "Failed to build digit atlas");
+
+    digits->img = emote_glyph_image_create(disp, &digits->dsc, w, h, color, pos, x, y, &digits->alpha);
+    ESP_GOTO_ON_FALSE(digits->img, ESP_ERR_NO_MEM, error, TAG, "Failed to create %dx%d digit image", w, h);
+
+    gfx_label_set_text(label, "");
+    return digits;
+
+error:
+    ESP_LOGD(TAG, "Digit atlas not created: %s", esp_err_to_name(ret));
+    emote_digits_delete(digits);
+    return NULL;
+}
+
+void emote_digits_delete(emote_digits_t *digits)
+{
+    if (!digits) {
+        return;
+    }
+
+    emote_glyph_image_delete(digits->img, &digits->dsc);
+    free(digits->atlas);
+    free(digits);
+}
+
+void emote_digits_set_text(emote_digits_t *digits, const char *text)
+{
+    int index[DIGITS_MAX_LEN];
+    size_t len = 0;
+    uint32_t width = 0;
+
+    if (!digits || !text) {
+        return;
+    }
+
+    for (; text[len]; len++) {
+        if (len == DIGITS_MAX_LEN || (index[len] = emote_digits_glyph_index(text[len])) < 0) {
+            emote_digits_set_fallback(digits, text);
+            return;
+        }
+        width += digits->glyph_w[index[len]];
+    }
+    if (width > digits->w) {
+        emote_digits_set_fallback(digits, text);
+        return;
+    }
+
+    uint32_t x = 0;
+    if (digits->align == GFX_TEXT_ALIGN_CENTER) {
+        x = (digits->w - width) / 2;
+    } else if (digits->align == GFX_TEXT_ALIGN_RIGHT) {
+        x = digits->w - width;
+    }
+    uint16_t rows = digits->line_h < digits->h ? digits->line_h : digits->h;
+
+    memset(digits->alpha, 0, (size_t)digits->w * digits->h);
+    for (size_t i = 0; i < len; i++) {
+        const uint8_t *src = digits->atlas + digits->glyph_x[index[i]];
+        uint8_t *dst = digits->alpha + x;
+        for (uint16_t row = 0; row < rows; row++) {
+            memcpy(dst, src, digits->glyph_w[index[i]]);
+            src += digits->atlas_w;
+            dst += digits->w;
+        }
+        x += digits->glyph_w[index[i]];
+    }
+
+    // Same descriptor, new pixels: setting the source again invalidates the area
+    gfx_img_set_src(digits->img, &digits->dsc);
+    emote_digits_set_fallback(digits, NULL);
+}
+
+void emote_digits_set_visible(emote_digits_t *digits, bool visible)
+{
+    if (!digits || digits->visible == visible) {
+        return;
+    }
+
+    digits->visible = visible;
+    emote_digits_apply_visible(digits);
+}
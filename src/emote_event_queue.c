@@ -0,0 +1,362 @@
+/*
+ * SPDX-FileCopyrightText: 2025 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/timers.h"
+#include "freertos/semphr.h"
+#include "esp_heap_caps.h"
+#include "esp_log.h"
+#include "esp_check.h"
+#include <stdatomic.h>
+#include <string.h>
+#include <stdlib.h>
+
+#include "emote_defs.h"
+#include "emote_layout.h"
+#include "emote_event_queue.h"
+#include "emote_perf.h"
+#include "emote_trace.h"
+#include "emote_record.h"
+
+static const char *TAG = "Expression_evtq";
+
+/*
+ * Vyukov's bounded queue: each cell carries a sequence number that tells producers
+ * and the consumer whose turn it is.
+ *
+ *   seq == pos          free, a producer at pos may claim it
+ *   seq == pos + 1      filled, the consumer at pos may take it
+ *   seq == pos + size   released by the consumer for the next lap
+ */
+typedef struct {
+    atomic_uint seq;
+    uint8_t event;
+    bool has_message;
+    char message[CONFIG_EMOTE_EVENT_MSG_LEN];
+} emote_event_cell_t;
+
+struct emote_event_queue_s {
+    uint32_t mask;                          // Cell count - 1, power of two
+    atomic_uint enqueue_pos;
+    uint32_t dequeue_pos;                   // Render task only
+    atomic_uint posted;
+    atomic_uint dropped;
+    uint32_t applied;                       // Render task only
+    uint32_t coalesced;                     // Render task only
+    uint32_t drains;                        // Render task only
+    atomic_bool idle;                       // Drain timer paused, the next producer wakes it
+    gfx_timer_handle_t timer;
+    emote_event_cell_t cells[];
+};
+
+// ===== Queue operations =====
+
+static esp_err_t emote_event_queue_push(emote_event_queue_t *queue, emote_event_t event, const char *message)
+{
+    uint32_t pos = atomic_load_explicit(&queue->enqueue_pos, memory_order_relaxed);
+    emote_event_cell_t *cell = NULL;
+
+    for (;;) {
+        cell = &queue->cells[pos & queue->mask];
+        uint32_t seq = atomic_load_explicit(&cell->seq, memory_order_acquire);
+        int32_t diff = (int32_t)(seq - pos);
+        if (diff == 0) {
+            if (atomic_compare_exchange_weak_explicit(&queue->enqueue_pos, &pos, pos + 1,
+                    memory_order_relaxed, memory_order_relaxed)) {
+                break;
+            }
+        } else if (diff < 0) {
+            atomic_fetch_add_explicit(&queue->dropped, 1, memory_order_relaxed);
+            return ESP_ERR_NO_MEM;
+        } else {
+            pos = atomic_load_explicit(&queue->enqueue_pos, memory_order_relaxed);
+        }
+    }
+
+    cell->event = (uint8_t)event;
+    cell->has_message = (message != NULL);
+    if (message) {
+        strcpy(cell->message, message);
+    }
+    atomic_fetch_add_explicit(&queue->posted, 1, memory_order_relaxed);
+    atomic_store_explicit(&cell->seq, pos + 1, memory_order_release);
+    return ESP_OK;
+}
+
+static bool emote_event_queue_pop(emote_event_queue_t *queue, emote_event_t *event, char *message, bool *has_message)
+{
+    uint32_t pos = queue->dequeue_pos;
+    emote_event_cell_t *cell = &queue->cells[pos & queue->mask];
+
+    if ((int32_t)(atomic_load_explicit(&cell->seq, memory_order_acquire) - (pos + 1)) < 0) {
+        return false;
+    }
+
+    *event = (emote_event_t)cell->event;
+    *has_message = cell->has_message;
+    if (cell->has_message) {
+        strcpy(message, cell->message);
+    }
+    atomic_store_explicit(&cell->seq, pos + queue->mask + 1, memory_order_release);
+    queue->dequeue_pos = pos + 1;
+    return true;
+}
+
+static bool emote_event_queue_empty(emote_event_queue_t *queue)
+{
+    emote_event_cell_t *cell = &queue->cells[queue->dequeue_pos & queue->mask];
+    return (int32_t)(atomic_load_explicit(&cell->seq, memory_order_acquire) - (queue->dequeue_pos + 1)) < 0;
+}
+
+// ===== Drain timer =====
+
+/*
+ * The drain timer only runs while events are pending, so an idle queue costs no
+ * render task wakeups. After a drain that leaves the queue empty, the timer marks
+ * the queue idle and pauses. The producer that clears the idle flag resumes it.
+ * Resuming needs the gfx lock, which producers must not wait for, so the timer
+ * service task does it.
+ */
+static void emote_event_queue_wake_cb(void *arg, uint32_t unused)
+{
+    emote_handle_t handle = (emote_handle_t)arg;
+    (void)unused;
+
+    EMOTE_GFX_LOCK(handle);
+    if (handle->event_queue) {
+        gfx_timer_resume(handle->event_queue->timer);
+    }
+    EMOTE_GFX_UNLOCK(handle);
+}
+
+static void emote_event_queue_flush_cb(void *arg, uint32_t unused)
+{
+    (void)unused;
+    xSemaphoreGive((SemaphoreHandle_t)arg);
+}
+
+static void emote_event_queue_wake(emote_handle_t handle, emote_event_queue_t *queue)
+{
+    if (!atomic_exchange(&queue->idle, false)) {
+        return;
+    }
+
+    BaseType_t pended;
+    if (xPortInIsrContext()) {
+        BaseType_t woken = pdFALSE;
+        pended = xTimerPendFunctionCallFromISR(emote_event_queue_wake_cb, handle, 0, &woken);
+        portYIELD_FROM_ISR(woken);
+    } else {
+        pended = xTimerPendFunctionCall(emote_event_queue_wake_cb, handle, 0, 0);
+    }
+    if (pended != pdPASS) {
+        // Left to the next producer; the event waits in the queue until then
+        atomic_store(&queue->idle, true);
+    }
+}
+
+// Runs at the end of a drain, with the gfx lock held
+static void emote_event_queue_sleep(emote_event_queue_t *queue)
+{
+    queue->drains++;
+    if (!emote_event_queue_empty(queue)) {
+        return;
+    }
+
+    atomic_store(&queue->idle, true);
+    // A producer that pushed before seeing the flag left the wakeup to the timer
+    if (!emote_event_queue_empty(queue) && atomic_exchange(&queue->idle, false)) {
+        return;
+    }
+    gfx_timer_pause(queue->timer);
+}
+
+#if CONFIG_EMOTE_EVENT_COALESCE
+/*
+ * Events that replace the UI hide every built-in element and show their own, so
+ * within one drain only the last of them is visible. Events that keep the UI only
+ * update cached state (battery), so the last of those carries the final state. The
+ * drain applies at most one of each: the state update first, so a final IDLE shows
+ * the latest battery level.
+ */
+typedef struct {
+    bool pending;
+    emote_event_t event;
+    bool has_message;
+    char message[CONFIG_EMOTE_EVENT_MSG_LEN];
+} emote_event_slot_t;
+
+static void emote_event_queue_apply(emote_handle_t handle, emote_event_queue_t *queue, emote_event_slot_t *slot)
+{
+    if (slot->pending) {
+        emote_apply_event(handle, slot->event, slot->has_message ? slot->message : NULL, NULL);
+        queue->applied++;
+    }
+}
+
+// Runs in the render task with the gfx lock held
+static void emote_event_queue_timer_cb(void *data)
+{
+    emote_handle_t handle = (emote_handle_t)data;
+    emote_event_queue_t *queue = handle->event_queue;
+    emote_event_slot_t state = { 0 };
+    emote_event_slot_t ui = { 0 };
+    emote_event_slot_t next;
+    uint32_t received = 0;
+
+    // Bounded by the capacity, so producers posting faster than a frame cannot stall it
+    while (received <= queue->mask && emote_event_queue_pop(queue, &next.event, next.message, &next.has_message)) {
+        emote_event_slot_t *slot = emote_event_keeps_ui(next.event) ? &state : &ui;
+        if (slot->pending) {
+            queue->coalesced++;
+        }
+        next.pending = true;
+        memcpy(slot, &next, sizeof(next));
+        received++;
+    }
+
+    emote_event_queue_apply(handle, queue, &state);
+    emote_event_queue_apply(handle, queue, &ui);
+    emote_event_queue_sleep(queue);
+}
+#else
+// Runs in the render task with the gfx lock held
+static void emote_event_queue_timer_cb(void *data)
+{
+    emote_handle_t handle = (emote_handle_t)data;
+    emote_event_queue_t *queue = handle->event_queue;
+    char message[CONFIG_EMOTE_EVENT_MSG_LEN];
+    emote_event_t event;
+    bool has_message = false;
+    uint32_t received = 0;
+
+    // Cells are copied out first, so producers can reuse them while the event is applied
+    while (received++ <= queue->mask && emote_event_queue_pop(queue, &event, message, &has_message)) {
+        emote_apply_event(handle, event, has_message ? message : NULL, NULL);
+        queue->applied++;
+    }
+    emote_event_queue_sleep(queue);
+}
+#endif
+
+// ===== Lifecycle =====
+
+esp_err_t emote_event_queue_init(emote_handle_t handle, uint32_t period_ms)
+{
+#if CONFIG_EMOTE_EVENT_QUEUE_LEN > 0
+    esp_err_t ret = ESP_OK;
+    emote_event_queue_t *queue = NULL;
+    uint32_t count = 1;
+
+    while (count < CONFIG_EMOTE_EVENT_QUEUE_LEN) {
+        count <<= 1;
+    }
+
+    // Atomics must live in internal RAM
+    queue = (emote_event_queue_t *)heap_caps_calloc(1, sizeof(emote_event_queue_t) + count * sizeof(emote_event_cell_t),
+            MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
+    ESP_GOTO_ON_FALSE(queue, ESP_ERR_NO_MEM, error, TAG, "Failed to allocate event queue");
+
+    queue->mask = count - 1;
+    for (uint32_t i = 0; i < count; i++) {
+        atomic_init(&queue->cells[i].seq, i);
+    }
+    atomic_init(&queue->idle, true);
+
+    EMOTE_GFX_LOCK(handle);
+    queue->timer = gfx_timer_create(handle->gfx_handle, emote_event_queue_timer_cb, period_ms ? period_ms : 1, handle);
+    if (queue->timer) {
+        gfx_timer_pause(queue->timer);
+    }
+    EMOTE_GFX_UNLOCK(handle);
+    ESP_GOTO_ON_FALSE(queue->timer, ESP_ERR_NO_MEM, error, TAG, "Failed to create event queue timer");
+
+    handle->event_queue = queue;
+    return ESP_OK;
+
+error:
+    heap_caps_free(queue);
+    return ret;
+#else
+    return ESP_OK;
+#endif
+}
+
+void emote_event_queue_deinit(emote_handle_t handle)
+{
+    emote_event_queue_t *queue = handle ? handle->event_queue : NULL;
+    if (!queue) {
+        return;
+    }
+
+    // No new wakeups; one already pended finds no queue
+    atomic_store(&queue->idle, false);
+    if (handle->gfx_handle) {
+        EMOTE_GFX_LOCK(handle);
+        gfx_timer_delete(handle->gfx_handle, queue->timer);
+        handle->event_queue = NULL;
+        EMOTE_GFX_UNLOCK(handle);
+    } else {
+        handle->event_queue = NULL;
+    }
+
+    // Pended calls run in order: once this one has, none refers to the handle any more
+    SemaphoreHandle_t flushed = xSemaphoreCreateBinary();
+    if (flushed && xTimerPendFunctionCall(emote_event_queue_flush_cb, flushed, 0, portMAX_DELAY) == pdPASS) {
+        xSemaphoreTake(flushed, portMAX_DELAY);
+    }
+    if (flushed) {
+        vSemaphoreDelete(flushed);
+    }
+    heap_caps_free(queue);
+}
+
+// ===== API =====
+
+esp_err_t emote_post_event(emote_handle_t handle, emote_event_t event, const char *message)
+{
+    // No logging: this may run in an ISR
+    if (!handle || (unsigned)event >= EMOTE_EVENT_MAX) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (!handle->event_queue) {
+        return ESP_ERR_NOT_SUPPORTED;
+    }
+    if (message && strnlen(message, CONFIG_EMOTE_EVENT_MSG_LEN) >= CONFIG_EMOTE_EVENT_MSG_LEN) {
+        return ESP_ERR_INVALID_SIZE;
+    }
+
+    EMOTE_TRACE_INSTANT(handle, "post", event);
+    EMOTE_RECORD(handle, EMOTE_RECORD_OP_POST_EVENT, NULL, message, event);
+    esp_err_t ret = emote_event_queue_push(handle->event_queue, event, message);
+    if (ret == ESP_OK) {
+        emote_event_queue_wake(handle, handle->event_queue);
+    }
+    return ret;
+}
+
+esp_err_t emote_get_event_queue_stats(emote_handle_t handle, emote_event_queue_stats_t *stats)
+{
+    if (!handle || !stats) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    emote_event_queue_t *queue = handle->event_queue;
+    memset(stats, 0, sizeof(*stats));
+    if (!queue) {
+        return ESP_ERR_NOT_SUPPORTED;
+    }
+
+    EMOTE_GFX_LOCK(handle);
+    stats->posted = atomic_load(&queue->posted);
+    stats->dropped = atomic_load(&queue->dropped);
+    stats->applied = queue->applied;
+    stats->coalesced = queue->coalesced;
+    stats->drains = queue->drains;
+    stats->capacity = queue->mask + 1;
+    EMOTE_GFX_UNLOCK(handle);
+    return ESP_OK;
+}
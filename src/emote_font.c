@@ -0,0 +1,708 @@
+/*
+ * SPDX-FileCopyrightText: 2025 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "esp_log.h"
+#include "esp_check.h"
+#include <string.h>
+#include <stdlib.h>
+
+#include "emote_font.h"
+
+static const char *TAG = "Expression_font";
+
+/*
+ * LVGL binary font layout: a sequence of tables, each starting with its length
+ * (including this 8-byte header) and a 4-character tag.
+ *
+ *   head | cmap | loca | glyf | kern (only if head.tables_count >= 4)
+ *
+ * Glyphs in glyf are bit streams: advance, offset and box fields followed by the
+ * bitmap, which is not byte aligned. Everything but the bitmaps is decoded into
+ * lv_font_fmt_txt_dsc_t structures at load, so lookups and kerning go through the
+ * stock fmt_txt functions; bitmaps are read and realigned when requested.
+ */
+
+#define FONT_TABLE_HEADER_SIZE  8
+#define FONT_READ_CHUNK         1024
+#define FONT_GLYPH_HEADER_MAX   8           // Bytes covering the glyph header bits
+#define GLYPH_CACHE_MIN_BUCKETS 16
+#define GLYPH_CACHE_MAX_BUCKETS 1024
+#define GLYPH_CACHE_BYTES_PER_BUCKET 128    // Roughly one small CJK glyph
+
+typedef struct __attribute__((packed)) {
+    uint32_t version;
+    uint16_t tables_count;
+    uint16_t font_size;
+    uint16_t ascent;
+    int16_t descent;
+    uint16_t typo_ascent;
+    int16_t typo_descent;
+    uint16_t typo_line_gap;
+    int16_t min_y;
+    int16_t max_y;
+    uint16_t default_advance_width;
+    uint16_t kerning_scale;
+    uint8_t index_to_loc_format;
+    uint8_t glyph_id_format;
+    uint8_t advance_width_format;
+    uint8_t bits_per_pixel;
+    uint8_t xy_bits;
+    uint8_t wh_bits;
+    uint8_t advance_width_bits;
+    uint8_t compression_id;
+    uint8_t subpixels_mode;
+    uint8_t padding;
+    int16_t underline_position;
+    uint16_t underline_thickness;
+} emote_font_head_t;
+
+typedef struct __attribute__((packed)) {
+    uint32_t data_offset;
+    uint32_t range_start;
+    uint16_t range_length;
+    uint16_t glyph_id_start;
+    uint16_t data_entries_count;
+    uint8_t format_type;
+    uint8_t padding;
+} emote_font_cmap_entry_t;
+
+typedef struct emote_glyph_entry_s {
+    uint32_t letter;
+    uint32_t size;
+    struct emote_glyph_entry_s *hash_next;
+    struct emote_glyph_entry_s *prev;       // Towards most recently used
+    struct emote_glyph_entry_s *next;       // Towards least recently used
+    uint8_t data[];                         // Bitmap as returned by get_glyph_bitmap
+} emote_glyph_entry_t;
+
+struct emote_font_s {
+    lv_font_t font;                         // First, so glyph callbacks can recover the font
+    lv_font_fmt_txt_dsc_t dsc;
+    mmap_assets_handle_t assets;
+    const uint8_t *data_ref;
+    size_t size;
+    bool mapped;
+
+    lv_font_fmt_txt_cmap_t *cmaps;
+    uint8_t *cmap_lists;                    // unicode and glyph id lists of all cmaps
+    lv_font_fmt_txt_glyph_dsc_t *glyph_dsc; // bitmap_index is 0: bitmaps are read into the buffer
+    uint32_t *glyph_pos;                    // Glyph start in the file, glyph_count + 1 entries
+    uint32_t glyph_count;
+    uint8_t header_bits;                    // Bits before the bitmap, the same for every glyph
+    void *kern_dsc;
+    void *kern_data;
+
+    uint8_t *bitmap;                        // Bitmap of the last glyph read from storage
+    uint32_t bitmap_gid;                    // 0 if bitmap holds no glyph
+
+    // LRU cache of glyph bitmaps keyed by code point, only used by the render task
+    emote_glyph_entry_t **buckets;
+    uint32_t bucket_mask;
+    emote_glyph_entry_t *head;              // Most recently used
+    emote_glyph_entry_t *tail;              // Least recently used
+    emote_glyph_cache_stats_t stats;
+};
+
+typedef struct {
+    const emote_font_t *font;
+    uint8_t *buf;                           // Not used for mapped fonts
+    size_t start;
+    size_t len;
+} emote_font_reader_t;
+
+// ===== Storage access =====
+
+static esp_err_t emote_font_read(const emote_font_t *f, size_t pos, void *dst, size_t len)
+{
+    if (pos > f->size || len > f->size - pos) {
+        return ESP_ERR_INVALID_SIZE;
+    }
+    if (f->mapped) {
+        memcpy(dst, f->data_ref + pos, len);
+    } else if (mmap_assets_copy_mem(f->assets, (size_t)f->data_ref + pos, dst, len) != len) {
+        return ESP_FAIL;
+    }
+    return ESP_OK;
+}
+
+// Sequential small reads at load, refilled a chunk at a time
+static const uint8_t *emote_font_peek(emote_font_reader_t *reader, size_t pos, size_t len)
+{
+    const emote_font_t *f = reader->font;
+
+    if (pos > f->size || len > f->size - pos) {
+        return NULL;
+    }
+    if (f->mapped) {
+        return f->data_ref + pos;
+    }
+    if (pos < reader->start || pos + len > reader->start + reader->len) {
+        size_t n = f->size - pos < FONT_READ_CHUNK ? f->size - pos : FONT_READ_CHUNK;
+        if (n < len || emote_font_read(f, pos, reader->buf, n) != ESP_OK) {
+            return NULL;
+        }
+        reader->start = pos;
+        reader->len = n;
+    }
+    return reader->buf + (pos - reader->start);
+}
+
+static esp_err_t emote_font_read_table(const emote_font_t *f, size_t pos, const char *tag, uint32_t *length)
+{
+    uint8_t header[FONT_TABLE_HEADER_SIZE];
+
+    ESP_RETURN_ON_ERROR(emote_font_read(f, pos, header, sizeof(header)), TAG, "Truncated font");
+    memcpy(length, header, sizeof(*length));
+    ESP_RETURN_ON_FALSE(memcmp(header + 4, tag, 4) == 0 && *length >= FONT_TABLE_HEADER_SIZE &&
+                        *length <= f->size - pos, ESP_ERR_INVALID_RESPONSE, TAG, "Bad font table '%s'", tag);
+    return ESP_OK;
+}
+
+static uint32_t emote_font_bits(const uint8_t *data, uint32_t *bit, uint8_t count)
+{
+    uint32_t value = 0;
+    for (uint8_t i = 0; i < count; i++, (*bit)++) {
+        value = (value << 1) | ((data[*bit >> 3] >> (7 - (*bit & 7))) & 1);
+    }
+    return value;
+}
+
+static int32_t emote_font_bits_signed(const uint8_t *data, uint32_t *bit, uint8_t count)
+{
+    uint32_t value = emote_font_bits(data, bit, count);
+    if (count && (value & (1U << (count - 1)))) {
+        value |= ~0U << count;
+    }
+    return (int32_t)value;
+}
+
+// ===== Tables =====
+
+static esp_err_t emote_font_load_cmaps(emote_font_t *f, size_t pos)
+{
+    uint32_t count = 0;
+    size_t lists_size = 0;
+    emote_font_cmap_entry_t *entries = NULL;
+    esp_err_t ret = ESP_OK;
+
+    ESP_RETURN_ON_ERROR(emote_font_read(f, pos + FONT_TABLE_HEADER_SIZE, &count, sizeof(count)), TAG, "Truncated cmap");
+    ESP_RETURN_ON_FALSE(count > 0 && count < 512, ESP_ERR_INVALID_RESPONSE, TAG, "Bad cmap count %d", (int)count);
+
+    entries = (emote_font_cmap_entry_t *)malloc(count * sizeof(emote_font_cmap_entry_t));
+    f->cmaps = (lv_font_fmt_txt_cmap_t *)calloc(count, sizeof(lv_font_fmt_txt_cmap_t));
+    ESP_GOTO_ON_FALSE(entries && f->cmaps, ESP_ERR_NO_MEM, error, TAG, "Failed to allocate cmaps");
+    ESP_GOTO_ON_ERROR(emote_font_read(f, pos + FONT_TABLE_HEADER_SIZE + sizeof(count), entries,
+                                      count * sizeof(emote_font_cmap_entry_t)), error, TAG, "Truncated cmap");
+
+    for (uint32_t i = 0; i < count; i++) {
+        size_t n = entries[i].data_entries_count;
+        switch (entries[i].format_type) {
+        case LV_FONT_FMT_TXT_CMAP_FORMAT0_FULL:  lists_size += (n + 1) & ~(size_t)1; break;
+        case LV_FONT_FMT_TXT_CMAP_SPARSE_FULL:   lists_size += n * 4; break;
+        case LV_FONT_FMT_TXT_CMAP_SPARSE_TINY:   lists_size += n * 2; break;
+        case LV_FONT_FMT_TXT_CMAP_FORMAT0_TINY:  break;
+        default:
+            ESP_GOTO_ON_FALSE(false, ESP_ERR_NOT_SUPPORTED, error, TAG, "Unknown cmap format %d", entries[i].format_type);
+        }
+    }
+
+    if (lists_size) {
+        f->cmap_lists = (uint8_t *)malloc(lists_size);
+        ESP_GOTO_ON_FALSE(f->cmap_lists, ESP_ERR_NO_MEM, error, TAG, "Failed to allocate cmap lists");
+    }
+
+    uint8_t *list = f->cmap_lists;
+    for (uint32_t i = 0; i < count; i++) {
+        const emote_font_cmap_entry_t *entry = &entries[i];
+        lv_font_fmt_txt_cmap_t *cmap = &f->cmaps[i];
+        size_t n = entry->data_entries_count;
+        size_t data = pos + entry->data_offset;
+
+        cmap->range_start = entry->range_start;
+        cmap->range_length = entry->range_length;
+        cmap->glyph_id_start = entry->glyph_id_start;
+        cmap->type = (lv_font_fmt_txt_cmap_type_t)entry->format_type;
+
+        if (entry->format_type == LV_FONT_FMT_TXT_CMAP_FORMAT0_FULL) {
+            ESP_GOTO_ON_ERROR(emote_font_read(f, data, list, n), error, TAG, "Truncated cmap %d", (int)i);
+            cmap->glyph_id_ofs_list = list;
+            cmap->list_length = cmap->range_length;
+            list += (n + 1) & ~(size_t)1;
+        } else if (entry->format_type != LV_FONT_FMT_TXT_CMAP_FORMAT0_TINY) {
+            bool full = entry->format_type == LV_FONT_FMT_TXT_CMAP_SPARSE_FULL;
+            ESP_GOTO_ON_ERROR(emote_font_read(f, data, list, n * (full ? 4 : 2)), error, TAG, "Truncated cmap %d", (int)i);
+            cmap->unicode_list = (const uint16_t *)list;
+            cmap->glyph_id_ofs_list = full ? list + n * 2 : NULL;
+            cmap->list_length = n;
+            list += n * (full ? 4 : 2);
+        }
+    }
+
+    f->dsc.cmaps = f->cmaps;
+    f->dsc.cmap_num = count;
+    free(entries);
+    return ESP_OK;
+
+error:
+    free(entries);
+    return ret;
+}
+
+static esp_err_t emote_font_load_glyphs(emote_font_t *f, const emote_font_head_t *head, size_t loca_pos, size_t glyf_pos,
+                                        uint32_t glyf_len, emote_font_reader_t *reader)
+{
+    uint32_t count = 0;
+    size_t entry_size = head->index_to_loc_format ? 4 : 2;
+    size_t bitmap_max = 0;
+
+    ESP_RETURN_ON_ERROR(emote_font_read(f, loca_pos + FONT_TABLE_HEADER_SIZE, &count, sizeof(count)), TAG, "Truncated loca");
+    ESP_RETURN_ON_FALSE(count > 0 && count <= (f->size - loca_pos) / entry_size, ESP_ERR_INVALID_RESPONSE, TAG,
+                        "Bad glyph count %d", (int)count);
+
+    f->glyph_count = count;
+    f->glyph_dsc = (lv_font_fmt_txt_glyph_dsc_t *)calloc(count, sizeof(lv_font_fmt_txt_glyph_dsc_t));
+    f->glyph_pos = (uint32_t *)malloc((count + 1) * sizeof(uint32_t));
+    ESP_RETURN_ON_FALSE(f->glyph_dsc && f->glyph_pos, ESP_ERR_NO_MEM, TAG, "Failed to allocate %d glyphs", (int)count);
+
+    // Glyph offsets, relative to the glyf table, closed by the table length
+    for (uint32_t i = 0; i < count; i++) {
+        const uint8_t *p = emote_font_peek(reader, loca_pos + FONT_TABLE_HEADER_SIZE + sizeof(count) + i * entry_size, entry_size);
+        ESP_RETURN_ON_FALSE(p, ESP_ERR_INVALID_SIZE, TAG, "Truncated loca");
+        f->glyph_pos[i] = entry_size == 4 ? (uint32_t)p[0] | (uint32_t)p[1] << 8 | (uint32_t)p[2] << 16 | (uint32_t)p[3] << 24
+                          : (uint32_t)p[0] | (uint32_t)p[1] << 8;
+    }
+    f->glyph_pos[count] = glyf_len;
+
+    f->header_bits = head->advance_width_bits + 2 * head->xy_bits + 2 * head->wh_bits;
+    for (uint32_t i = 1; i < count; i++) {
+        uint32_t start = f->glyph_pos[i];
+        uint32_t end = f->glyph_pos[i + 1];
+        ESP_RETURN_ON_FALSE(start <= end && end <= glyf_len && end - start >= f->header_bits / 8u,
+                            ESP_ERR_INVALID_RESPONSE, TAG, "Bad glyph %d", (int)i);
+
+        size_t avail = glyf_len - start < FONT_GLYPH_HEADER_MAX ? glyf_len - start : FONT_GLYPH_HEADER_MAX;
+        ESP_RETURN_ON_FALSE(avail * 8 >= f->header_bits, ESP_ERR_INVALID_RESPONSE, TAG, "Bad glyph %d", (int)i);
+        const uint8_t *p = emote_font_peek(reader, glyf_pos + start, avail);
+        ESP_RETURN_ON_FALSE(p, ESP_ERR_INVALID_SIZE, TAG, "Truncated glyph %d", (int)i);
+
+        lv_font_fmt_txt_glyph_dsc_t *gdsc = &f->glyph_dsc[i];
+        uint32_t bit = 0;
+        uint32_t adv_w = head->advance_width_bits ? emote_font_bits(p, &bit, head->advance_width_bits)
+                         : head->default_advance_width;
+        gdsc->adv_w = head->advance_width_format == 0 ? adv_w * 16 : adv_w;
+        gdsc->ofs_x = emote_font_bits_signed(p, &bit, head->xy_bits);
+        gdsc->ofs_y = emote_font_bits_signed(p, &bit, head->xy_bits);
+        gdsc->box_w = emote_font_bits(p, &bit, head->wh_bits);
+        gdsc->box_h = emote_font_bits(p, &bit, head->wh_bits);
+
+        // From here on a file offset, so get_glyph_bitmap reads the glyph directly
+        f->glyph_pos[i] = glyf_pos + start;
+        if (gdsc->box_w * gdsc->box_h != 0) {
+            size_t bitmap_size = end - start - f->header_bits / 8;
+            bitmap_max = bitmap_size > bitmap_max ? bitmap_size : bitmap_max;
+        }
+    }
+    f->glyph_pos[0] = glyf_pos + f->glyph_pos[0];
+    f->glyph_pos[count] = glyf_pos + glyf_len;
+
+    f->bitmap = (uint8_t *)malloc(bitmap_max ? bitmap_max : 1);
+    ESP_RETURN_ON_FALSE(f->bitmap, ESP_ERR_NO_MEM, TAG, "Failed to allocate glyph buffer");
+    f->dsc.glyph_dsc = f->glyph_dsc;
+    f->dsc.glyph_bitmap = f->bitmap;
+    return ESP_OK;
+}
+
+static esp_err_t emote_font_load_kern(emote_font_t *f, const emote_font_head_t *head, size_t pos)
+{
+    uint32_t len = 0;
+    uint8_t format = 0;
+
+    ESP_RETURN_ON_ERROR(emote_font_read_table(f, pos, "kern", &len), TAG, "No kern table");
+    ESP_RETURN_ON_ERROR(emote_font_read(f, pos + FONT_TABLE_HEADER_SIZE, &format, sizeof(format)), TAG, "Truncated kern");
+    pos += FONT_TABLE_HEADER_SIZE + 4;      // Format and 3 padding bytes
+
+    if (format == 0) {
+        uint32_t pairs = 0;
+        ESP_RETURN_ON_ERROR(emote_font_read(f, pos, &pairs, sizeof(pairs)), TAG, "Truncated kern");
+        size_t ids_size = pairs * (head->glyph_id_format ? 4 : 2);
+        ESP_RETURN_ON_FALSE(ids_size + pairs <= len, ESP_ERR_INVALID_RESPONSE, TAG, "Bad kern pairs");
+
+        lv_font_fmt_txt_kern_pair_t *kern = (lv_font_fmt_txt_kern_pair_t *)calloc(1, sizeof(*kern));
+        f->kern_dsc = kern;
+        f->kern_data = malloc(ids_size + pairs);
+        ESP_RETURN_ON_FALSE(kern && f->kern_data, ESP_ERR_NO_MEM, TAG, "Failed to allocate kern pairs");
+        ESP_RETURN_ON_ERROR(emote_font_read(f, pos + sizeof(pairs), f->kern_data, ids_size + pairs), TAG, "Truncated kern");
+
+        kern->glyph_ids = (void *)f->kern_data;
+        kern->values = (const int8_t *)f->kern_data + ids_size;
+        kern->pair_cnt = pairs;
+        kern->glyph_ids_size = head->glyph_id_format;
+        f->dsc.kern_classes = 0;
+    } else if (format == 3) {
+        struct __attribute__((packed)) {
+            uint16_t mapping_length;
+            uint8_t rows;
+            uint8_t cols;
+        } info;
+        ESP_RETURN_ON_ERROR(emote_font_read(f, pos, &info, sizeof(info)), TAG, "Truncated kern");
+        size_t values = (size_t)info.rows * info.cols;
+        ESP_RETURN_ON_FALSE(2 * info.mapping_length + values <= len, ESP_ERR_INVALID_RESPONSE, TAG, "Bad kern classes");
+
+        lv_font_fmt_txt_kern_classes_t *kern = (lv_font_fmt_txt_kern_classes_t *)calloc(1, sizeof(*kern));
+        f->kern_dsc = kern;
+        f->kern_data = malloc(2 * info.mapping_length + values);
+        ESP_RETURN_ON_FALSE(kern && f->kern_data, ESP_ERR_NO_MEM, TAG, "Failed to allocate kern classes");
+        ESP_RETURN_ON_ERROR(emote_font_read(f, pos + sizeof(info), f->kern_data, 2 * info.mapping_length + values),
+                            TAG, "Truncated kern");
+
+        uint8_t *data = (uint8_t *)f->kern_data;
+        kern->left_class_mapping = data;
+        kern->right_class_mapping = data + info.mapping_length;
+        kern->class_pair_values = (const int8_t *)(data + 2 * info.mapping_length);
+        kern->left_class_cnt = info.rows;
+        kern->right_class_cnt = info.cols;
+        f->dsc.kern_classes = 1;
+    } else {
+        ESP_LOGW(TAG, "Unknown kern format %d, kerning disabled", format);
+        return ESP_OK;
+    }
+
+    f->dsc.kern_dsc = f->kern_dsc;
+    f->dsc.kern_scale = head->kerning_scale;
+    return ESP_OK;
+}
+
+// ===== Glyph bitmaps =====
+
+static int emote_font_unicode_cmp(const void *key, const void *item)
+{
+    return (int)*(const uint16_t *)key - (int)*(const uint16_t *)item;
+}
+
+// Same lookup as the fmt_txt functions, which own the glyph descriptors
+static uint32_t emote_font_glyph_id(const emote_font_t *f, uint32_t letter)
+{
+    for (uint16_t i = 0; i < f->dsc.cmap_num; i++) {
+        const lv_font_fmt_txt_cmap_t *cmap = &f->cmaps[i];
+        uint32_t rcp = letter - cmap->range_start;
+        if (rcp >= cmap->range_length) {
+            continue;
+        }
+
+        switch (cmap->type) {
+        case LV_FONT_FMT_TXT_CMAP_FORMAT0_TINY:
+            return cmap->glyph_id_start + rcp;
+        case LV_FONT_FMT_TXT_CMAP_FORMAT0_FULL:
+            return cmap->glyph_id_start + ((const uint8_t *)cmap->glyph_id_ofs_list)[rcp];
+        default: {
+            uint16_t key = rcp;
+            const uint16_t *p = (const uint16_t *)bsearch(&key, cmap->unicode_list, cmap->list_length,
+                                sizeof(uint16_t), emote_font_unicode_cmp);
+            if (!p) {
+                return 0;
+            }
+            uint32_t ofs = p - cmap->unicode_list;
+            if (cmap->type == LV_FONT_FMT_TXT_CMAP_SPARSE_FULL) {
+                ofs = ((const uint16_t *)cmap->glyph_id_ofs_list)[ofs];
+            }
+            return cmap->glyph_id_start + ofs;
+        }
+        }
+    }
+    return 0;
+}
+
+static esp_err_t emote_font_read_bitmap(emote_font_t *f, uint32_t gid)
+{
+    uint32_t skip = f->header_bits / 8;
+    uint32_t shift = f->header_bits % 8;
+    size_t start = f->glyph_pos[gid] + skip;
+    size_t size = f->glyph_pos[gid + 1] - start;
+
+    ESP_RETURN_ON_ERROR(emote_font_read(f, start, f->bitmap, size), TAG, "Failed to read glyph %d", (int)gid);
+    f->stats.read_bytes += size;
+
+    // The bitmap starts mid-byte after the header bits: move it up to the byte boundary
+    if (shift) {
+        for (size_t i = 0; i + 1 < size; i++) {
+            f->bitmap[i] = (uint8_t)((f->bitmap[i] << shift) | (f->bitmap[i + 1] >> (8 - shift)));
+        }
+        f->bitmap[size - 1] = (uint8_t)(f->bitmap[size - 1] << shift);
+    }
+    return ESP_OK;
+}
+
+// ===== Glyph cache =====
+
+static void emote_glyph_cache_unlink(emote_font_t *f, emote_glyph_entry_t *entry)
+{
+    if (entry->prev) {
+        entry->prev->next = entry->next;
+    } else {
+        f->head = entry->next;
+    }
+    if (entry->next) {
+        entry->next->prev = entry->prev;
+    } else {
+        f->tail = entry->prev;
+    }
+}
+
+static void emote_glyph_cache_push_front(emote_font_t *f, emote_glyph_entry_t *entry)
+{
+    entry->prev = NULL;
+    entry->next = f->head;
+    if (f->head) {
+        f->head->prev = entry;
+    }
+    f->head = entry;
+    if (!f->tail) {
+        f->tail = entry;
+    }
+}
+
+static inline uint32_t emote_glyph_cache_bucket(const emote_font_t *f, uint32_t letter)
+{
+    return (letter * 2654435761U >> 16) & f->bucket_mask;
+}
+
+static emote_glyph_entry_t *emote_glyph_cache_find(emote_font_t *f, uint32_t letter)
+{
+    emote_glyph_entry_t *entry = f->buckets[emote_glyph_cache_bucket(f, letter)];
+    while (entry && entry->letter != letter) {
+        entry = entry->hash_next;
+    }
+    return entry;
+}
+
+static void emote_glyph_cache_evict(emote_font_t *f, emote_glyph_entry_t *entry)
+{
+    emote_glyph_entry_t **link = &f->buckets[emote_glyph_cache_bucket(f, entry->letter)];
+    while (*link != entry) {
+        link = &(*link)->hash_next;
+    }
+    *link = entry->hash_next;
+
+    emote_glyph_cache_unlink(f, entry);
+    f->stats.used_bytes -= sizeof(emote_glyph_entry_t) + entry->size;
+    f->stats.entry_count--;
+    free(entry);
+}
+
+static void emote_glyph_cache_insert(emote_font_t *f, uint32_t letter, const uint8_t *bitmap, size_t size)
+{
+    size_t need = sizeof(emote_glyph_entry_t) + size;
+    if (need > f->stats.budget) {
+        return;
+    }
+
+    while (f->tail && f->stats.used_bytes + need > f->stats.budget) {
+        emote_glyph_cache_evict(f, f->tail);
+        f->stats.evictions++;
+    }
+
+    emote_glyph_entry_t *entry = (emote_glyph_entry_t *)malloc(need);
+    if (!entry) {
+        return;
+    }
+
+    entry->letter = letter;
+    entry->size = size;
+    memcpy(entry->data, bitmap, size);
+
+    uint32_t bucket = emote_glyph_cache_bucket(f, letter);
+    entry->hash_next = f->buckets[bucket];
+    f->buckets[bucket] = entry;
+    emote_glyph_cache_push_front(f, entry);
+    f->stats.used_bytes += need;
+    f->stats.entry_count++;
+}
+
+static esp_err_t emote_glyph_cache_init(emote_font_t *f, size_t budget)
+{
+    uint32_t count = GLYPH_CACHE_MIN_BUCKETS;
+    while (count < GLYPH_CACHE_MAX_BUCKETS && count * GLYPH_CACHE_BYTES_PER_BUCKET < budget) {
+        count <<= 1;
+    }
+
+    f->stats.budget = budget;
+    if (budget == 0) {
+        return ESP_OK;
+    }
+
+    f->buckets = (emote_glyph_entry_t **)calloc(count, sizeof(emote_glyph_entry_t *));
+    ESP_RETURN_ON_FALSE(f->buckets, ESP_ERR_NO_MEM, TAG, "Failed to allocate glyph cache");
+    f->bucket_mask = count - 1;
+    return ESP_OK;
+}
+
+// Bytes of the bitmap returned for a glyph: the stored bitmap, or the decompressed one
+static size_t emote_font_bitmap_size(const emote_font_t *f, uint32_t gid)
+{
+    if (f->dsc.bitmap_format == 0) {
+        return f->glyph_pos[gid + 1] - f->glyph_pos[gid] - f->header_bits / 8;
+    }
+
+    size_t pixels = (size_t)f->glyph_dsc[gid].box_w * f->glyph_dsc[gid].box_h;
+    switch (f->dsc.bpp) {
+    case 1:  return (pixels + 7) / 8;
+    case 2:  return (pixels + 3) / 4;
+    case 3:                                 // Decompressed to 4 bpp
+    case 4:  return (pixels + 1) / 2;
+    default: return pixels;
+    }
+}
+
+static const uint8_t *emote_font_get_glyph_bitmap(const lv_font_t *font, uint32_t letter)
+{
+    emote_font_t *f = (emote_font_t *)font;
+    const uint8_t *bitmap = NULL;
+
+    emote_glyph_entry_t *entry = f->buckets ? emote_glyph_cache_find(f, letter) : NULL;
+    if (entry) {
+        f->stats.hits++;
+        emote_glyph_cache_unlink(f, entry);
+        emote_glyph_cache_push_front(f, entry);
+        return entry->data;
+    }
+
+    uint32_t gid = emote_font_glyph_id(f, letter);
+    if (gid == 0 || gid >= f->glyph_count || f->glyph_dsc[gid].box_w * f->glyph_dsc[gid].box_h == 0) {
+        return NULL;
+    }
+
+    f->stats.misses++;
+    if (gid != f->bitmap_gid) {
+        f->bitmap_gid = 0;
+        if (emote_font_read_bitmap(f, gid) != ESP_OK) {
+            return NULL;
+        }
+        f->bitmap_gid = gid;
+    }
+
+    // Every descriptor points at the buffer, so fmt_txt decompresses the glyph just read
+    bitmap = f->dsc.bitmap_format == 0 ? f->bitmap : lv_font_get_bitmap_fmt_txt(font, letter);
+    if (bitmap && f->buckets) {
+        emote_glyph_cache_insert(f, letter, bitmap, emote_font_bitmap_size(f, gid));
+    }
+    return bitmap;
+}
+
+// ===== API =====
+
+emote_font_t *emote_font_load(mmap_assets_handle_t assets, const uint8_t *data_ref, size_t size, bool mapped,
+                              size_t cache_budget)
+{
+    esp_err_t ret = ESP_OK;
+    emote_font_t *f = NULL;
+    emote_font_reader_t reader = {0};
+    emote_font_head_t head = {0};
+    uint32_t head_len = 0;
+    uint32_t cmap_len = 0;
+    uint32_t loca_len = 0;
+    uint32_t glyf_len = 0;
+
+    ESP_GOTO_ON_FALSE(data_ref && size > FONT_TABLE_HEADER_SIZE, ESP_ERR_INVALID_ARG, error, TAG, "Invalid parameters");
+
+    f = (emote_font_t *)calloc(1, sizeof(emote_font_t));
+    ESP_GOTO_ON_FALSE(f, ESP_ERR_NO_MEM, error, TAG, "Failed to allocate font");
+    f->assets = assets;
+    f->data_ref = data_ref;
+    f->size = size;
+    f->mapped = mapped;
+
+    reader.font = f;
+    if (!mapped) {
+        reader.buf = (uint8_t *)malloc(FONT_READ_CHUNK);
+        ESP_GOTO_ON_FALSE(reader.buf, ESP_ERR_NO_MEM, error, TAG, "Failed to allocate read buffer");
+    }
+
+    size_t pos = 0;
+    ESP_GOTO_ON_ERROR(emote_font_read_table(f, pos, "head", &head_len), error, TAG, "Not a binary font");
+    ESP_GOTO_ON_FALSE(head_len >= FONT_TABLE_HEADER_SIZE + sizeof(head), ESP_ERR_INVALID_RESPONSE, error, TAG, "Short font header");
+    ESP_GOTO_ON_ERROR(emote_font_read(f, pos + FONT_TABLE_HEADER_SIZE, &head, sizeof(head)), error, TAG, "Truncated font header");
+    ESP_GOTO_ON_FALSE(head.bits_per_pixel >= 1 && head.bits_per_pixel <= 8 && head.compression_id <= 2,
+                      ESP_ERR_NOT_SUPPORTED, error, TAG, "Unsupported font format");
+
+    pos += head_len;
+    ESP_GOTO_ON_ERROR(emote_font_read_table(f, pos, "cmap", &cmap_len), error, TAG, "No cmap table");
+    ESP_GOTO_ON_ERROR(emote_font_load_cmaps(f, pos), error, TAG, "Failed to load cmaps");
+
+    pos += cmap_len;
+    size_t loca_pos = pos;
+    ESP_GOTO_ON_ERROR(emote_font_read_table(f, loca_pos, "loca", &loca_len), error, TAG, "No loca table");
+
+    pos += loca_len;
+    size_t glyf_pos = pos;
+    ESP_GOTO_ON_ERROR(emote_font_read_table(f, glyf_pos, "glyf", &glyf_len), error, TAG, "No glyf table");
+    ESP_GOTO_ON_ERROR(emote_font_load_glyphs(f, &head, loca_pos, glyf_pos, glyf_len, &reader), error, TAG, "Failed to load glyphs");
+
+    pos += glyf_len;
+    if (head.tables_count >= 4) {
+        ESP_GOTO_ON_ERROR(emote_font_load_kern(f, &head, pos), error, TAG, "Failed to load kerning");
+    }
+
+    f->dsc.bpp = head.bits_per_pixel;
+    f->dsc.bitmap_format = head.compression_id;
+    ESP_GOTO_ON_ERROR(emote_glyph_cache_init(f, cache_budget), error, TAG, "Failed to create glyph cache");
+
+    f->font.get_glyph_dsc = lv_font_get_glyph_dsc_fmt_txt;
+    f->font.get_glyph_bitmap = emote_font_get_glyph_bitmap;
+    f->font.line_height = head.max_y - head.min_y;
+    f->font.base_line = -head.min_y;
+    f->font.subpx = head.subpixels_mode;
+    f->font.underline_position = head.underline_position;
+    f->font.underline_thickness = head.underline_thickness;
+    f->font.dsc = &f->dsc;
+
+    ESP_LOGI(TAG, "Font loaded in place: %d glyphs, %d bytes", (int)f->glyph_count, (int)size);
+    free(reader.buf);
+    return f;
+
+error:
+    ESP_LOGW(TAG, "Font not loaded in place: %s", esp_err_to_name(ret));
+    free(reader.buf);
+    emote_font_delete(f);
+    return NULL;
+}
+
+lv_font_t *emote_font_get_lv_font(emote_font_t *font)
+{
+    return font ? &font->font : NULL;
+}
+
+void emote_font_delete(emote_font_t *font)
+{
+    if (!font) {
+        return;
+    }
+
+    free(font->cmaps);
+    free(font->cmap_lists);
+    free(font->glyph_dsc);
+    free(font->glyph_pos);
+    free(font->kern_dsc);
+    free(font->kern_data);
+    free(font->bitmap);
+
+    emote_glyph_entry_t *entry = font->head;
+    while (entry) {
+        emote_glyph_entry_t *next = entry->next;
+        free(entry);
+        entry = next;
+    }
+    free(font->buckets);
+    free(font);
+}
+
+void emote_font_get_cache_stats(const emote_font_t *font, emote_glyph_cache_stats_t *stats)
+{
+    if (!font || !stats) {
+        return;
+    }
+
+    *stats = font->stats;
+}
@@ -0,0 +1,95 @@
+/*
+ * SPDX-FileCopyrightText: 2025 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "esp_log.h"
+#include <string.h>
+#include <stdlib.h>
+
+#include "emote_glyph.h"
+
+static const char *TAG = "Expression_glyph";
+
+void emote_glyph_render_a8(const lv_font_t *font, uint32_t letter, const lv_font_glyph_dsc_t *g,
+                           uint8_t *dst, uint32_t stride, int x, int clip_x, uint32_t clip_w)
+{
+    const uint8_t *bitmap = font->get_glyph_bitmap(font, letter);
+    if (!bitmap || g->bpp == 0 || g->bpp > 8) {
+        return;
+    }
+
+    uint32_t max = (1U << g->bpp) - 1;
+    int top = font->line_height - font->base_line - g->box_h - g->ofs_y;
+
+    for (int gy = 0; gy < g->box_h; gy++) {
+        int py = top + gy;
+        if (py < 0 || py >= font->line_height) {
+            continue;
+        }
+        uint8_t *row = dst + (size_t)py * stride;
+        for (int gx = 0; gx < g->box_w; gx++) {
+            int px = x + g->ofs_x + gx;
+            if (px < clip_x || px >= clip_x + (int)clip_w) {
+                continue;
+            }
+            // Rows are packed without padding, most significant bits first
+            uint32_t bit = (uint32_t)(gy * g->box_w + gx) * g->bpp;
+            uint32_t value = ((bitmap[bit >> 3] >> (8 - g->bpp - (bit & 7))) & max) * 255 / max;
+            if (value > row[px]) {
+                row[px] = (uint8_t)value;
+            }
+        }
+    }
+}
+
+gfx_obj_t *emote_glyph_image_create(gfx_disp_t *disp, gfx_image_dsc_t *dsc, uint16_t w, uint16_t h, uint32_t color,
+                                    int pos, int x, int y, uint8_t **alpha)
+{
+    size_t count = (size_t)w * h;
+    uint8_t *pixels = (uint8_t *)malloc(count * 3);
+    if (!pixels) {
+        ESP_LOGD(TAG, "Failed to allocate %dx%d glyph image", w, h);
+        return NULL;
+    }
+
+    // The color plane never changes; text updates only rewrite the alpha plane
+    uint16_t full = GFX_COLOR_HEX(color).full;
+    uint16_t *rgb = (uint16_t *)pixels;
+    for (size_t i = 0; i < count; i++) {
+        rgb[i] = full;
+    }
+    memset(pixels + count * 2, 0, count);
+
+    memset(dsc, 0, sizeof(*dsc));
+    dsc->header.magic = C_ARRAY_HEADER_MAGIC;
+    dsc->header.cf = GFX_COLOR_FORMAT_RGB565A8;
+    dsc->header.w = w;
+    dsc->header.h = h;
+    dsc->header.stride = w * 2;
+    dsc->data_size = count * 3;
+    dsc->data = pixels;
+
+    gfx_obj_t *img = gfx_img_create(disp);
+    if (!img) {
+        ESP_LOGD(TAG, "Failed to create glyph image");
+        emote_glyph_image_delete(NULL, dsc);
+        return NULL;
+    }
+    gfx_img_set_src(img, dsc);
+    gfx_obj_align(img, pos, x, y);
+    gfx_obj_set_visible(img, false);
+
+    *alpha = pixels + count * 2;
+    return img;
+}
+
+void emote_glyph_image_delete(gfx_obj_t *img, gfx_image_dsc_t *dsc)
+{
+    if (img) {
+        gfx_obj_delete(img);
+    }
+    free((void *)dsc->data);
+    dsc->data = NULL;
+}
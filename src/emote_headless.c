@@ -0,0 +1,197 @@
+/*
+ * SPDX-FileCopyrightText: 2025 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "expression_emote.h"
+
+#include <string.h>
+#include <stdlib.h>
+
+#include "freertos/FreeRTOS.h"
+#include "esp_timer.h"
+#include "esp_rom_sys.h"
+#include "esp_log.h"
+#include "esp_check.h"
+
+#include "emote_defs.h"
+#include "emote_perf.h"
+
+static const char *TAG = "Expression_headless";
+
+struct emote_headless_s {
+    uint16_t *framebuffer;
+    int width;
+    int height;
+    uint32_t flush_delay_us;
+
+    portMUX_TYPE mux;                       // Guards the counters, read from other tasks
+    emote_headless_stats_t stats;
+    bool frame_open;                        // A flush happened since the frame timer last ran
+    gfx_timer_handle_t frame_timer;         // Closes the open frame, paused while no frame is open
+};
+
+/*
+ * Frame boundaries. Flushes don't say which render pass they belong to, and the areas
+ * of a pass are neither sorted nor contiguous. The first flush of a frame arms a 1 ms
+ * gfx timer instead; the render task runs it between render passes, which closes the
+ * frame. The timer pauses itself, so an idle display adds no wakeups.
+ */
+static void emote_headless_frame_cb(void *arg)
+{
+    emote_headless_handle_t headless = (emote_headless_handle_t)arg;
+
+    portENTER_CRITICAL(&headless->mux);
+    headless->frame_open = false;
+    portEXIT_CRITICAL(&headless->mux);
+    gfx_timer_pause(headless->frame_timer);
+}
+
+static void emote_headless_frame_arm(emote_headless_handle_t headless, emote_handle_t manager)
+{
+    // Flushes run in the render task, which may already hold the lock; it is recursive
+    EMOTE_GFX_LOCK(manager);
+    if (!headless->frame_timer) {
+        headless->frame_timer = gfx_timer_create(manager->gfx_handle, emote_headless_frame_cb, 1, headless);
+        if (!headless->frame_timer) {
+            ESP_LOGW(TAG, "Failed to create frame timer, frames are not counted");
+        }
+    } else {
+        gfx_timer_reset(headless->frame_timer);
+        gfx_timer_resume(headless->frame_timer);
+    }
+    EMOTE_GFX_UNLOCK(manager);
+}
+
+static void emote_headless_flush_cb(int x_start, int y_start, int x_end, int y_end, const void *data,
+                                    emote_handle_t manager)
+{
+    emote_headless_handle_t headless = (emote_headless_handle_t)emote_get_user_data(manager);
+    if (!headless) {
+        return;
+    }
+
+    int64_t start = esp_timer_get_time();
+
+    // Areas end exclusive, as for esp_lcd_panel_draw_bitmap()
+    int src_width = x_end - x_start;
+    int x1 = x_start < 0 ? 0 : x_start;
+    int y1 = y_start < 0 ? 0 : y_start;
+    int x2 = x_end > headless->width ? headless->width : x_end;
+    int y2 = y_end > headless->height ? headless->height : y_end;
+    size_t bytes = 0;
+
+    if (data && x1 < x2 && y1 < y2) {
+        const uint16_t *src = (const uint16_t *)data + (size_t)(y1 - y_start) * src_width + (x1 - x_start);
+        size_t row_bytes = (size_t)(x2 - x1) * sizeof(uint16_t);
+        for (int y = y1; y < y2; y++) {
+            memcpy(headless->framebuffer + (size_t)y * headless->width + x1, src, row_bytes);
+            src += src_width;
+        }
+        bytes = row_bytes * (y2 - y1);
+    }
+
+    portENTER_CRITICAL(&headless->mux);
+    // Counted on its first flush, so the last frame is never left out
+    bool first = !headless->frame_open;
+    if (first) {
+        headless->frame_open = true;
+        headless->stats.frames++;
+    }
+    headless->stats.flushes++;
+    headless->stats.flush_bytes += bytes;
+    portEXIT_CRITICAL(&headless->mux);
+
+    if (first) {
+        emote_headless_frame_arm(headless, manager);
+    }
+
+    int64_t elapsed = esp_timer_get_time() - start;
+    if (elapsed < headless->flush_delay_us) {
+        esp_rom_delay_us(headless->flush_delay_us - (uint32_t)elapsed);
+    }
+    emote_notify_flush_finished(manager);
+}
+
+emote_headless_handle_t emote_headless_create(const emote_headless_config_t *config, emote_config_t *emote_config)
+{
+    esp_err_t ret = ESP_OK;
+    emote_headless_handle_t headless = NULL;
+
+    ESP_GOTO_ON_FALSE(config && emote_config, ESP_ERR_INVALID_ARG, error, TAG, "Invalid parameters");
+    ESP_GOTO_ON_FALSE(emote_config->gfx_emote.h_res > 0 && emote_config->gfx_emote.v_res > 0, ESP_ERR_INVALID_ARG,
+                      error, TAG, "Invalid resolution %dx%d", emote_config->gfx_emote.h_res, emote_config->gfx_emote.v_res);
+
+    headless = (emote_headless_handle_t)calloc(1, sizeof(struct emote_headless_s));
+    ESP_GOTO_ON_FALSE(headless, ESP_ERR_NO_MEM, error, TAG, "Failed to allocate headless display");
+
+    headless->width = emote_config->gfx_emote.h_res;
+    headless->height = emote_config->gfx_emote.v_res;
+    headless->framebuffer = (uint16_t *)calloc((size_t)headless->width * headless->height, sizeof(uint16_t));
+    ESP_GOTO_ON_FALSE(headless->framebuffer, ESP_ERR_NO_MEM, error, TAG, "Failed to allocate %dx%d framebuffer",
+                      headless->width, headless->height);
+
+    portMUX_TYPE mux = portMUX_INITIALIZER_UNLOCKED;
+    headless->mux = mux;
+    headless->flush_delay_us = config->flush_delay_us;
+
+    emote_config->flush_cb = emote_headless_flush_cb;
+    emote_config->user_data = headless;
+    return headless;
+
+error:
+    (void)ret;  // ret is used by ESP_GOTO_ON_FALSE macro but not returned by this function
+    emote_headless_delete(headless);
+    return NULL;
+}
+
+void emote_headless_delete(emote_headless_handle_t headless)
+{
+    if (!headless) {
+        return;
+    }
+
+    // The frame timer belongs to the gfx instance, deleted by emote_deinit()
+    free(headless->framebuffer);
+    free(headless);
+}
+
+const uint16_t *emote_headless_get_framebuffer(emote_headless_handle_t headless, int *width, int *height)
+{
+    if (!headless) {
+        return NULL;
+    }
+
+    if (width) {
+        *width = headless->width;
+    }
+    if (height) {
+        *height = headless->height;
+    }
+    return headless->framebuffer;
+}
+
+esp_err_t emote_headless_get_stats(emote_headless_handle_t headless, emote_headless_stats_t *stats)
+{
+    if (!headless || !stats) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    portENTER_CRITICAL(&headless->mux);
+    *stats = headless->stats;
+    portEXIT_CRITICAL(&headless->mux);
+    return ESP_OK;
+}
+
+esp_err_t emote_headless_reset_stats(emote_headless_handle_t headless)
+{
+    if (!headless) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    portENTER_CRITICAL(&headless->mux);
+    memset(&headless->stats, 0, sizeof(headless->stats));
+    portEXIT_CRITICAL(&headless->mux);
+    return ESP_OK;
+}
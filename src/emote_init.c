@@ -15,6 +15,12 @@
 #include "emote_defs.h"
 #include "emote_table.h"
 #include "emote_layout.h"
+#include "emote_prefetch.h"
+#include "emote_event_queue.h"
+#include "emote_batch.h"
+#include "emote_perf.h"
+#include "emote_trace.h"
+#include "emote_record.h"
 #include "widget/gfx_font_lvgl.h"
 
 static const char *TAG = "Expression_init";
@@ -22,8 +28,13 @@ static const char *TAG = "Expression_init";
 static void emote_flush_cb_wrapper(gfx_disp_t *disp, int x1, int y1, int x2, int y2, const void *data)
 {
     emote_handle_t self = (emote_handle_t)gfx_disp_get_user_data(disp);
+    if (self) {
+        EMOTE_PERF_FLUSH_START(self, y1);
+    }
     if (self && self->flush_cb) {
+        EMOTE_TRACE_BEGIN(start);
         self->flush_cb(x1, y1, x2, y2, data, self);
+        EMOTE_TRACE_END(self, "flush", start, y1);
     }
 }
 
@@ -43,7 +54,9 @@ static void emote_update_cb_wrapper(gfx_disp_t *disp, gfx_disp_event_t event, co
     }
 
     if (self && self->update_cb) {
+        EMOTE_TRACE_BEGIN(start);
         self->update_cb(event, obj, self);
+        EMOTE_TRACE_END(self, "update_cb", start, event);
     }
 }
 
@@ -63,6 +76,9 @@ emote_handle_t emote_init(const emote_config_t *config)
 
     // Initialize bat_percent
     handle->bat_percent = -1;
+    for (int i = 0; i < EMOTE_BUILTIN_ICON_MAX; i++) {
+        handle->builtin_icons[i] = -1;
+    }
     handle->flush_cb = config->flush_cb;
     handle->update_cb = config->update_cb;
 
@@ -70,6 +86,19 @@ emote_handle_t emote_init(const emote_config_t *config)
     handle->v_res = config->gfx_emote.v_res;
     handle->user_data = config->user_data;
 
+    handle->asset_cache = emote_cache_create(EMOTE_ASSET_CACHE_BUDGET);
+    ESP_GOTO_ON_FALSE(handle->asset_cache, ESP_ERR_NO_MEM, error, TAG, "Failed to create asset cache");
+
+#if CONFIG_EMOTE_PERF_STATS
+    ESP_GOTO_ON_ERROR(emote_perf_init(handle), error, TAG, "Failed to create perf stats");
+#endif
+#if CONFIG_EMOTE_TRACE
+    ESP_GOTO_ON_ERROR(emote_trace_init(handle), error, TAG, "Failed to create trace ring");
+#endif
+#if CONFIG_EMOTE_RECORDER
+    ESP_GOTO_ON_ERROR(emote_recorder_init(handle), error, TAG, "Failed to create recorder");
+#endif
+
     gfx_core_config_t gfx_cfg = {
         .fps = config->gfx_emote.fps,
         .task = {
@@ -103,30 +132,46 @@ emote_handle_t emote_init(const emote_config_t *config)
     ESP_GOTO_ON_FALSE(handle->gfx_disp != NULL, ESP_FAIL, error, TAG, "Failed to add display");
 
     // Default set
-    gfx_emote_lock(handle->gfx_handle);
+    EMOTE_GFX_LOCK(handle);
     gfx_disp_set_bg_color(handle->gfx_disp, GFX_COLOR_HEX(EMOTE_DEF_BG_COLOR));
 
     obj_default = emote_create_obj_by_name(handle, EMT_DEF_ELEM_DEFAULT_LABEL);
     ESP_GOTO_ON_FALSE(obj_default, ESP_ERR_INVALID_STATE, error_unlock, TAG, "Failed to create default label");
     gfx_obj_set_size(obj_default, handle->h_res, EMOTE_DEF_LABEL_HEIGHT);
 
-    gfx_emote_unlock(handle->gfx_handle);
+    EMOTE_GFX_UNLOCK(handle);
     ESP_LOGI(TAG, "Create default label: [%p]", obj_default);
+
+    // Drain posted events once per frame
+    uint32_t frame_ms = config->gfx_emote.fps ? 1000 / config->gfx_emote.fps : 0;
+    ret = emote_event_queue_init(handle, frame_ms);
+    ESP_GOTO_ON_FALSE(ret == ESP_OK, ret, error, TAG, "Failed to create event queue");
     handle->is_initialized = true;
     (void)ret;  // ret is used by ESP_GOTO_ON_FALSE macro but not returned by this function
     return handle;
 
 error_unlock:
     if (handle && handle->gfx_handle) {
-        gfx_emote_unlock(handle->gfx_handle);
+        EMOTE_GFX_UNLOCK(handle);
     }
 
 error:
     if (handle) {
+        emote_event_queue_deinit(handle);
         if (handle->gfx_handle) {
             gfx_emote_deinit(handle->gfx_handle);
             handle->gfx_handle = NULL;
         }
+        emote_cache_destroy(handle->asset_cache);
+#if CONFIG_EMOTE_PERF_STATS
+        emote_perf_deinit(handle);
+#endif
+#if CONFIG_EMOTE_TRACE
+        emote_trace_deinit(handle);
+#endif
+#if CONFIG_EMOTE_RECORDER
+        emote_recorder_deinit(handle);
+#endif
         free(handle);
     }
     return NULL;
@@ -142,6 +187,13 @@ bool emote_deinit(emote_handle_t handle)
         return true;
     }
 
+    // Stop the prefetch loader before the assets go away
+    emote_prefetch_deinit(handle);
+
+    // Stop applying posted events
+    emote_event_queue_deinit(handle);
+    emote_batch_deinit(handle);
+
     // Unload assets (this will cleanup hash tables, fonts, objects, custom objects created by load, etc.)
     emote_unload_assets(handle);
 
@@ -153,6 +205,7 @@ bool emote_deinit(emote_handle_t handle)
     if (obj_default) {
         gfx_obj_delete(obj_default);
         handle->def_objects[EMOTE_DEF_OBJ_LEBAL_DEFAULT].obj = NULL;
+        emote_reset_obj_state(&handle->def_objects[EMOTE_DEF_OBJ_LEBAL_DEFAULT]);
     }
 
     // Deinit engine
@@ -163,6 +216,18 @@ bool emote_deinit(emote_handle_t handle)
 
     handle->is_initialized = false;
 
+    emote_cache_destroy(handle->asset_cache);
+    handle->asset_cache = NULL;
+#if CONFIG_EMOTE_PERF_STATS
+    emote_perf_deinit(handle);
+#endif
+#if CONFIG_EMOTE_TRACE
+    emote_trace_deinit(handle);
+#endif
+#if CONFIG_EMOTE_RECORDER
+    emote_recorder_deinit(handle);
+#endif
+
     // Free handle memory
     free(handle);
     return true;
@@ -0,0 +1,289 @@
+/*
+ * SPDX-FileCopyrightText: 2025 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <string.h>
+#include <stdlib.h>
+#include "esp_log.h"
+
+#include "emote_json.h"
+
+static const char *TAG = "Expression_json";
+
+#define EMOTE_JSON_NUM_MAX      32
+
+// ===== Input =====
+
+static int emote_json_peek(emote_json_reader_t *reader)
+{
+    if (reader->pos >= reader->size) {
+        return -1;
+    }
+
+    if (!reader->assets) {
+        return reader->data[reader->pos];
+    }
+
+    if (reader->pos < reader->chunk_start || reader->pos >= reader->chunk_start + reader->chunk_len) {
+        size_t len = reader->size - reader->pos;
+        if (len > sizeof(reader->chunk)) {
+            len = sizeof(reader->chunk);
+        }
+        mmap_assets_copy_mem(reader->assets, (size_t)reader->data + reader->pos, reader->chunk, len);
+        reader->chunk_start = reader->pos;
+        reader->chunk_len = len;
+    }
+    return reader->chunk[reader->pos - reader->chunk_start];
+}
+
+static int emote_json_getc(emote_json_reader_t *reader)
+{
+    int c = emote_json_peek(reader);
+    if (c >= 0) {
+        reader->pos++;
+    }
+    return c;
+}
+
+static bool emote_json_match(emote_json_reader_t *reader, const char *rest)
+{
+    for (; *rest; rest++) {
+        if (emote_json_getc(reader) != *rest) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// ===== Tokens =====
+
+static int emote_json_hex4(emote_json_reader_t *reader)
+{
+    int value = 0;
+    for (int i = 0; i < 4; i++) {
+        int c = emote_json_getc(reader);
+        value <<= 4;
+        if (c >= '0' && c <= '9') {
+            value |= c - '0';
+        } else if (c >= 'a' && c <= 'f') {
+            value |= c - 'a' + 10;
+        } else if (c >= 'A' && c <= 'F') {
+            value |= c - 'A' + 10;
+        } else {
+            return -1;
+        }
+    }
+    return value;
+}
+
+static bool emote_json_put_utf8(char *str, size_t *len, uint32_t cp)
+{
+    uint8_t buf[4];
+    size_t n;
+
+    if (cp < 0x80) {
+        buf[0] = cp;
+        n = 1;
+    } else if (cp < 0x800) {
+        buf[0] = 0xC0 | (cp >> 6);
+        buf[1] = 0x80 | (cp & 0x3F);
+        n = 2;
+    } else if (cp < 0x10000) {
+        buf[0] = 0xE0 | (cp >> 12);
+        buf[1] = 0x80 | ((cp >> 6) & 0x3F);
+        buf[2] = 0x80 | (cp & 0x3F);
+        n = 3;
+    } else {
+        buf[0] = 0xF0 | (cp >> 18);
+        buf[1] = 0x80 | ((cp >> 12) & 0x3F);
+        buf[2] = 0x80 | ((cp >> 6) & 0x3F);
+        buf[3] = 0x80 | (cp & 0x3F);
+        n = 4;
+    }
+
+    if (*len + n >= EMOTE_JSON_STR_MAX) {
+        return false;
+    }
+    memcpy(str + *len, buf, n);
+    *len += n;
+    return true;
+}
+
+static emote_json_tok_t emote_json_read_string(emote_json_reader_t *reader)
+{
+    size_t len = 0;
+
+    reader->str_truncated = false;
+
+    while (true) {
+        int c = emote_json_getc(reader);
+        if (c < 0x20) {
+            ESP_LOGE(TAG, "Unterminated string at %d", (int)reader->pos);
+            return EMOTE_JSON_TOK_ERROR;
+        }
+        if (c == '"') {
+            break;
+        }
+
+        if (c == '\\') {
+            uint32_t cp;
+            c = emote_json_getc(reader);
+            switch (c) {
+            case '"':
+            case '\\':
+            case '/':
+                cp = c;
+                break;
+            case 'b':
+                cp = '\b';
+                break;
+            case 'f':
+                cp = '\f';
+                break;
+            case 'n':
+                cp = '\n';
+                break;
+            case 'r':
+                cp = '\r';
+                break;
+            case 't':
+                cp = '\t';
+                break;
+            case 'u': {
+                int hi = emote_json_hex4(reader);
+                if (hi < 0) {
+                    return EMOTE_JSON_TOK_ERROR;
+                }
+                cp = hi;
+                if (hi >= 0xD800 && hi <= 0xDBFF) {
+                    int lo;
+                    if (!emote_json_match(reader, "\\u") || (lo = emote_json_hex4(reader)) < 0xDC00 || lo > 0xDFFF) {
+                        return EMOTE_JSON_TOK_ERROR;
+                    }
+                    cp = 0x10000 + ((hi - 0xD800) << 10) + (lo - 0xDC00);
+                }
+                break;
+            }
+            default:
+                ESP_LOGE(TAG, "Invalid escape at %d", (int)reader->pos);
+                return EMOTE_JSON_TOK_ERROR;
+            }
+            if (!reader->str_truncated && !emote_json_put_utf8(reader->str, &len, cp)) {
+                reader->str_truncated = true;
+            }
+            continue;
+        }
+
+        // Keep scanning past the limit, a skipped value may be of any length
+        if (len + 1 >= EMOTE_JSON_STR_MAX) {
+            reader->str_truncated = true;
+        }
+        if (!reader->str_truncated) {
+            reader->str[len++] = c;
+        }
+    }
+
+    reader->str[len] = '\0';
+    return EMOTE_JSON_TOK_STRING;
+}
+
+static emote_json_tok_t emote_json_read_number(emote_json_reader_t *reader, int first)
+{
+    char buf[EMOTE_JSON_NUM_MAX];
+    size_t len = 0;
+    int c = first;
+
+    while (true) {
+        if (len + 1 >= sizeof(buf)) {
+            return EMOTE_JSON_TOK_ERROR;
+        }
+        buf[len++] = c;
+
+        c = emote_json_peek(reader);
+        if (!((c >= '0' && c <= '9') || c == '-' || c == '+' || c == '.' || c == 'e' || c == 'E')) {
+            break;
+        }
+        reader->pos++;
+    }
+    buf[len] = '\0';
+
+    char *end = NULL;
+    reader->number = strtod(buf, &end);
+    return (end == buf + len) ? EMOTE_JSON_TOK_NUMBER : EMOTE_JSON_TOK_ERROR;
+}
+
+// ===== API =====
+
+void emote_json_reader_init(emote_json_reader_t *reader, const void *data, size_t size, mmap_assets_handle_t assets)
+{
+    memset(reader, 0, sizeof(*reader));
+    reader->data = (const uint8_t *)data;
+    reader->size = size;
+    reader->assets = assets;
+}
+
+emote_json_tok_t emote_json_next(emote_json_reader_t *reader)
+{
+    int c;
+
+    do {
+        c = emote_json_getc(reader);
+    } while (c == ' ' || c == '\t' || c == '\n' || c == '\r' || c == ',' || c == ':');
+
+    switch (c) {
+    case -1:
+        return EMOTE_JSON_TOK_END;
+    case '{':
+        return EMOTE_JSON_TOK_OBJ_BEGIN;
+    case '}':
+        return EMOTE_JSON_TOK_OBJ_END;
+    case '[':
+        return EMOTE_JSON_TOK_ARR_BEGIN;
+    case ']':
+        return EMOTE_JSON_TOK_ARR_END;
+    case '"':
+        return emote_json_read_string(reader);
+    case 't':
+        return emote_json_match(reader, "rue") ? EMOTE_JSON_TOK_TRUE : EMOTE_JSON_TOK_ERROR;
+    case 'f':
+        return emote_json_match(reader, "alse") ? EMOTE_JSON_TOK_FALSE : EMOTE_JSON_TOK_ERROR;
+    case 'n':
+        return emote_json_match(reader, "ull") ? EMOTE_JSON_TOK_NULL : EMOTE_JSON_TOK_ERROR;
+    default:
+        if (c == '-' || (c >= '0' && c <= '9')) {
+            return emote_json_read_number(reader, c);
+        }
+        ESP_LOGE(TAG, "Unexpected '%c' at %d", c, (int)reader->pos);
+        return EMOTE_JSON_TOK_ERROR;
+    }
+}
+
+esp_err_t emote_json_skip(emote_json_reader_t *reader, emote_json_tok_t tok)
+{
+    int depth = 0;
+
+    while (true) {
+        switch (tok) {
+        case EMOTE_JSON_TOK_OBJ_BEGIN:
+        case EMOTE_JSON_TOK_ARR_BEGIN:
+            depth++;
+            break;
+        case EMOTE_JSON_TOK_OBJ_END:
+        case EMOTE_JSON_TOK_ARR_END:
+            depth--;
+            break;
+        case EMOTE_JSON_TOK_ERROR:
+        case EMOTE_JSON_TOK_END:
+            return ESP_ERR_INVALID_RESPONSE;
+        default:
+            break;
+        }
+
+        if (depth <= 0) {
+            return depth == 0 ? ESP_OK : ESP_ERR_INVALID_RESPONSE;
+        }
+        tok = emote_json_next(reader);
+    }
+}
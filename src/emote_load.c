@@ -10,8 +10,10 @@
 #include "esp_log.h"
 #include "esp_err.h"
 #include "esp_check.h"
+#if !CONFIG_IDF_TARGET_LINUX
 #include "soc/soc_memory_layout.h"
 #include "soc/ext_mem_defs.h"
+#endif
 #include <string.h>
 #include <stdlib.h>
 
@@ -20,166 +22,172 @@
 #include "emote_defs.h"
 #include "emote_table.h"
 #include "emote_layout.h"
+#include "emote_index_bin.h"
+#include "emote_json.h"
+#include "emote_prefetch.h"
+#include "emote_digits.h"
+#include "emote_strip.h"
+#include "emote_font.h"
+#include "emote_perf.h"
+#include "emote_trace.h"
 #include "gfx.h"
-#include "cJSON.h"
+#include "widget/gfx_font_lvgl.h"
 
 static const char *TAG = "Expression_load";
 
-// Hash table implementation
-#define ASSETS_HASH_TABLE_SIZE CONFIG_EMOTE_ASSETS_HASH_TABLE_SIZE
+bool emote_data_is_mapped(emote_handle_t handle, const void *data_ref)
+{
+    bool is_DBUS = false;
+#if CONFIG_IDF_TARGET_LINUX
+    // No flash window on the host: memory-mapped data is told apart by the mount mode
+    is_DBUS = handle->assets_mmap;
+#elif CONFIG_IDF_TARGET_ESP32P4
+    is_DBUS = ((size_t)data_ref >= SOC_MMU_FLASH_VADDR_BASE);
+#else
+    is_DBUS = ((size_t)data_ref >= SOC_MMU_DBUS_VADDR_BASE);
+#endif
+    return is_DBUS || handle->assets_handle == NULL;
+}
 
-typedef struct assets_hash_entry_s {
-    char *key;
-    void *value;
-    struct assets_hash_entry_s *next;
-} assets_hash_entry_t;
+const void *emote_stage_data(emote_handle_t handle, const void *data_ref, size_t size, void **staged)
+{
+    if (!handle || !staged) {
+        return NULL;
+    }
 
-struct assets_hash_table_s {
-    char *name;
-    assets_hash_entry_t *buckets[ASSETS_HASH_TABLE_SIZE];
-};
+    *staged = NULL;
+    if (emote_data_is_mapped(handle, data_ref)) {
+        return data_ref;
+    }
 
-static uint32_t emote_assets_hash_string(const char *str)
+    EMOTE_PERF_TIME(start);
+    EMOTE_TRACE_BEGIN(trace_start);
+    const void *buffer = emote_cache_acquire(handle->asset_cache, handle->assets_handle, (size_t)data_ref, size);
+    EMOTE_TRACE_END(handle, "acquire", trace_start, size);
+    EMOTE_PERF_ACQUIRE(handle, start);
+    *staged = (void *)buffer;
+    return buffer;
+}
+
+void *emote_swap_data(void **output_ptr, void *staged)
 {
-    uint32_t hash = 5381;
-    int c;
-    while ((c = *str++)) {
-        hash = ((hash << 5) + hash) + c;
-    }
-    return hash;
+    void *old = *output_ptr;
+    *output_ptr = staged;
+    return old;
 }
 
-assets_hash_table_t *emote_assets_table_create(const char *name)
+const void *emote_acquire_data(emote_handle_t handle, const void *data_ref, size_t size, void **output_ptr)
 {
-    assets_hash_table_t *ht = (assets_hash_table_t *)calloc(1, sizeof(assets_hash_table_t));
-    if (ht && name) {
-        ht->name = strdup(name);
-        if (!ht->name) {
-            free(ht);
-            return NULL;
-        }
+    void *staged = NULL;
+
+    // Take the new reference first, so switching back to the same asset is a hit
+    const void *buffer = emote_stage_data(handle, data_ref, size, &staged);
+    if (!buffer) {
+        return NULL;
     }
-    return ht;
+
+    if (output_ptr) {
+        emote_release_data(handle, emote_swap_data(output_ptr, staged));
+    }
+
+    return buffer;
 }
 
-void emote_assets_table_destroy(assets_hash_table_t *ht)
+void emote_release_data(emote_handle_t handle, void *data)
 {
-    if (!ht) {
+    if (!handle || !data) {
         return;
     }
 
-    for (int i = 0; i < ASSETS_HASH_TABLE_SIZE; i++) {
-        assets_hash_entry_t *entry = ht->buckets[i];
-        while (entry) {
-            assets_hash_entry_t *next = entry->next;
-            free(entry->key);
-            // Free the value if it's a dynamically allocated structure
-            if (entry->value) {
-                free(entry->value);
-            }
-            free(entry);
-            entry = next;
-        }
+    if (!emote_cache_release(handle->asset_cache, data)) {
+        ESP_LOGW(TAG, "Releasing data not owned by the asset cache: %p", data);
     }
-    if (ht->name) {
-        free(ht->name);
+}
+
+// Equal names sort by file index, so lookups resolve duplicates to the first file
+static int emote_asset_name_cmp(const void *a, const void *b)
+{
+    const emote_asset_name_entry_t *ea = (const emote_asset_name_entry_t *)a;
+    const emote_asset_name_entry_t *eb = (const emote_asset_name_entry_t *)b;
+    int cmp = strcmp(ea->name, eb->name);
+    return cmp ? cmp : (ea->index > eb->index) - (ea->index < eb->index);
+}
+
+static void emote_free_asset_index(emote_handle_t handle)
+{
+    if (handle->asset_names) {
+        free(handle->asset_names);
+        handle->asset_names = NULL;
     }
-    free(ht);
+    handle->asset_name_count = 0;
 }
 
-static esp_err_t emote_assets_table_set(assets_hash_table_t *ht, const char *key, void *value)
+static esp_err_t emote_build_asset_index(emote_handle_t handle)
 {
-    esp_err_t ret = ESP_OK;
-    assets_hash_entry_t *entry = NULL;
+    mmap_assets_handle_t asset_handle = handle->assets_handle;
+    int fileNum = mmap_assets_get_stored_files(asset_handle);
+    int count = 0;
 
-    ESP_GOTO_ON_FALSE(ht && key, ESP_ERR_INVALID_ARG, error, TAG, "Invalid parameters");
+    emote_free_asset_index(handle);
+    if (fileNum <= 0) {
+        return ESP_OK;
+    }
 
-    uint32_t hash = emote_assets_hash_string(key) % ASSETS_HASH_TABLE_SIZE;
+    emote_asset_name_entry_t *entries = (emote_asset_name_entry_t *)malloc(fileNum * sizeof(emote_asset_name_entry_t));
+    if (!entries) {
+        ESP_LOGE(TAG, "Failed to allocate asset index: %d files", fileNum);
+        return ESP_ERR_NO_MEM;
+    }
 
-    entry = ht->buckets[hash];
-    while (entry) {
-        if (strcmp(entry->key, key) == 0) {
-            entry->value = value;
-            return ESP_OK;
+    for (int i = 0; i < fileNum; i++) {
+        const char *name = mmap_assets_get_name(asset_handle, i);
+        ESP_LOGD(TAG, "Found file: %d, %s", i, name);
+        if (name) {
+            entries[count].name = name;
+            entries[count].index = i;
+            count++;
         }
-        entry = entry->next;
     }
 
-    entry = (assets_hash_entry_t *)malloc(sizeof(assets_hash_entry_t));
-    ESP_GOTO_ON_FALSE(entry, ESP_ERR_NO_MEM, error, TAG, "Failed to allocate hash entry");
-
-    entry->key = strdup(key);
-    ESP_GOTO_ON_FALSE(entry->key, ESP_ERR_NO_MEM, error_free_entry, TAG, "Failed to duplicate key");
+    // Names live in the mounted assets table, so the index only stores pointers
+    emote_asset_index_sort(entries, count);
 
-    entry->value = value;
-    entry->next = ht->buckets[hash];
-    ht->buckets[hash] = entry;
+    handle->asset_names = entries;
+    handle->asset_name_count = count;
     return ESP_OK;
-
-error_free_entry:
-    free(entry);
-
-error:
-    return ret;
 }
 
-static void *emote_assets_table_get(assets_hash_table_t *ht, const char *key)
+static int emote_find_asset_index(emote_handle_t handle, const char *name)
 {
-    if (!ht || !key) {
-        return NULL;
-    }
-
-    uint32_t hash = emote_assets_hash_string(key) % ASSETS_HASH_TABLE_SIZE;
-
-    assets_hash_entry_t *entry = ht->buckets[hash];
-    while (entry) {
-        if (strcmp(entry->key, key) == 0) {
-            return entry->value;
-        }
-        entry = entry->next;
-    }
-    return NULL;
+    return emote_asset_index_find(handle->asset_names, handle->asset_name_count, name);
 }
 
-const void *emote_acquire_data(emote_handle_t handle, const void *data_ref, size_t size, void **output_ptr)
+void emote_asset_index_sort(emote_asset_name_entry_t *entries, int count)
 {
-    if (!handle) {
-        return NULL;
-    }
-
-    mmap_assets_handle_t asset_handle = handle->assets_handle;
-    bool is_DBUS = false;
-#if CONFIG_IDF_TARGET_ESP32P4
-    is_DBUS = ((size_t)data_ref >= SOC_MMU_FLASH_VADDR_BASE);
-#else
-    is_DBUS = ((size_t)data_ref >= SOC_MMU_DBUS_VADDR_BASE);
-#endif
-    if (is_DBUS || asset_handle == NULL) {
-        if (output_ptr && *output_ptr) {
-            free(*output_ptr);
-            *output_ptr = NULL;
-        }
-        return data_ref;
+    if (entries && count > 1) {
+        qsort(entries, count, sizeof(emote_asset_name_entry_t), emote_asset_name_cmp);
     }
+}
 
-    if (output_ptr && *output_ptr) {
-        free(*output_ptr);
-        *output_ptr = NULL;
-    }
+int emote_asset_index_find(const emote_asset_name_entry_t *entries, int count, const char *name)
+{
+    int low = 0;
+    int high = count;
 
-    uint8_t *buffer = (uint8_t *)malloc(size);
-    if (!buffer) {
-        ESP_LOGE(TAG, "Failed to allocate memory: %zu bytes", size);
-        return NULL;
+    if (!entries || !name) {
+        return -1;
     }
 
-    mmap_assets_copy_mem(asset_handle, (size_t)data_ref, buffer, size);
-
-    if (output_ptr) {
-        *output_ptr = buffer;
+    // Lower bound rather than bsearch(), which may land on any of several equal names
+    while (low < high) {
+        int mid = low + (high - low) / 2;
+        if (strcmp(entries[mid].name, name) < 0) {
+            low = mid + 1;
+        } else {
+            high = mid;
+        }
     }
-
-    return buffer;
+    return (low < count && strcmp(entries[low].name, name) == 0) ? entries[low].index : -1;
 }
 
 esp_err_t emote_get_asset_data_by_name(emote_handle_t handle, const char *name,
@@ -191,17 +199,14 @@ esp_err_t emote_get_asset_data_by_name(emote_handle_t handle, const char *name,
 
     mmap_assets_handle_t asset_handle = handle->assets_handle;
 
-    int fileNum = mmap_assets_get_stored_files(asset_handle);
-    for (int i = 0; i < fileNum; i++) {
-        const char *file_name = mmap_assets_get_name(asset_handle, i);
-        if (file_name && strcmp(file_name, name) == 0) {
-            const uint8_t *file_data = mmap_assets_get_mem(asset_handle, i);
-            size_t file_size = mmap_assets_get_size(asset_handle, i);
-            if (file_data && file_size > 0) {
-                *data = file_data;
-                *size = file_size;
-                return ESP_OK;
-            }
+    int index = emote_find_asset_index(handle, name);
+    if (index >= 0) {
+        const uint8_t *file_data = mmap_assets_get_mem(asset_handle, index);
+        size_t file_size = mmap_assets_get_size(asset_handle, index);
+        if (file_data && file_size > 0) {
+            *data = file_data;
+            *size = file_size;
+            return ESP_OK;
         }
     }
 
@@ -212,6 +217,66 @@ error:
     return ret;
 }
 
+esp_err_t emote_acquire_asset(emote_handle_t handle, const char *name, const uint8_t **data, size_t *size)
+{
+    esp_err_t ret = ESP_OK;
+    const uint8_t *file_data = NULL;
+    size_t file_size = 0;
+
+    ESP_GOTO_ON_FALSE(data && size, ESP_ERR_INVALID_ARG, error, TAG, "Invalid parameters");
+
+    ret = emote_get_asset_data_by_name(handle, name, &file_data, &file_size);
+    ESP_GOTO_ON_FALSE(ret == ESP_OK, ret, error, TAG, "Failed to find asset: %s", name);
+
+    *data = (const uint8_t *)emote_acquire_data(handle, file_data, file_size, NULL);
+    ESP_GOTO_ON_FALSE(*data, ESP_ERR_NO_MEM, error, TAG, "Failed to acquire asset: %s", name);
+    *size = file_size;
+
+error:
+    return ret;
+}
+
+esp_err_t emote_release_asset(emote_handle_t handle, const uint8_t *data)
+{
+    if (!handle || !data) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    // Mapped data is not a cache entry and is ignored. Found by lookup rather than by
+    // address, since PSRAM shares the data bus address range with the mmap window.
+    emote_cache_release(handle->asset_cache, data);
+    return ESP_OK;
+}
+
+esp_err_t emote_get_cache_stats(emote_handle_t handle, emote_cache_stats_t *stats)
+{
+    if (!handle || !stats) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    emote_cache_get_stats(handle->asset_cache, stats);
+    return ESP_OK;
+}
+
+esp_err_t emote_get_glyph_cache_stats(emote_handle_t handle, emote_glyph_cache_stats_t *stats)
+{
+    esp_err_t ret = ESP_OK;
+
+    if (!handle || !stats) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    memset(stats, 0, sizeof(*stats));
+    EMOTE_GFX_LOCK(handle);
+    if (handle->font) {
+        emote_font_get_cache_stats(handle->font, stats);
+    } else {
+        ret = ESP_ERR_INVALID_STATE;
+    }
+    EMOTE_GFX_UNLOCK(handle);
+    return ret;
+}
+
 static esp_err_t emote_find_data_by_key(emote_handle_t handle, assets_hash_table_t *ht, const char *key, void **result)
 {
     if (!handle || !ht || !key || !result) {
@@ -228,6 +293,12 @@ esp_err_t emote_unmount_assets(emote_handle_t handle)
         return ESP_ERR_INVALID_ARG;
     }
 
+    emote_prefetch_cancel(handle);
+    emote_free_asset_index(handle);
+
+    // Offsets are only meaningful for the assets they were read from
+    emote_cache_clear(handle->asset_cache);
+
     if (handle->assets_handle) {
         ESP_LOGI(TAG, "Unmounting assets handle");
         mmap_assets_del(handle->assets_handle);
@@ -248,6 +319,7 @@ esp_err_t emote_mount_assets(emote_handle_t handle, const emote_data_t *data)
     // Unmount existing assets first
     ret = emote_unmount_assets(handle);
     ESP_GOTO_ON_FALSE(ret == ESP_OK, ret, error, TAG, "Failed to unmount existing assets");
+    handle->assets_mmap = false;
 
     memset(&asset_config, 0, sizeof(asset_config));
 
@@ -261,6 +333,7 @@ esp_err_t emote_mount_assets(emote_handle_t handle, const emote_data_t *data)
         asset_config.partition_label = data->source.partition_label;
         asset_config.flags.mmap_enable = data->flags.mmap_enable;
         asset_config.flags.full_check = true;
+        handle->assets_mmap = data->flags.mmap_enable;
     } else {
         ret = ESP_ERR_INVALID_ARG;
         ESP_LOGE(TAG, "Unknown source type");
@@ -273,10 +346,8 @@ esp_err_t emote_mount_assets(emote_handle_t handle, const emote_data_t *data)
     num = mmap_assets_get_stored_files(handle->assets_handle);
     ESP_GOTO_ON_FALSE(num > 0, ESP_ERR_NOT_FOUND, error_cleanup, TAG, "No files found in assets");
 
-    for (int i = 0; i < num; i++) {
-        const char *name = mmap_assets_get_name(handle->assets_handle, i);
-        ESP_LOGD(TAG, "Found file: %d, %s", i, name);
-    }
+    ret = emote_build_asset_index(handle);
+    ESP_GOTO_ON_FALSE(ret == ESP_OK, ret, error_cleanup, TAG, "Failed to build asset name index");
 
     return ESP_OK;
 
@@ -287,188 +358,672 @@ error:
     return ret;
 }
 
-static esp_err_t emote_load_emojis(emote_handle_t handle, cJSON *root)
+static esp_err_t emote_add_emoji(emote_handle_t handle, const char *name, int file_index, int fps, bool loop, bool borrow_name)
 {
     esp_err_t ret = ESP_OK;
-    cJSON *emojiCollection = NULL;
-    int emojiCount = 0;
+    emoji_data_t emoji_data = {0};
 
-    ESP_GOTO_ON_FALSE(handle && root, ESP_ERR_INVALID_ARG, error, TAG, "Invalid parameters");
+    const uint8_t *emojiData = mmap_assets_get_mem(handle->assets_handle, file_index);
+    size_t emojiSize = mmap_assets_get_size(handle->assets_handle, file_index);
+    ESP_GOTO_ON_FALSE(emojiData && emojiSize > 0, ESP_ERR_NOT_FOUND, error, TAG, "Invalid emoji file %d for: %s", file_index, name);
 
-    emojiCollection = cJSON_GetObjectItem(root, "emoji_collection");
-    if (!cJSON_IsArray(emojiCollection)) {
-        return ESP_OK;
-    }
+    emoji_data.data = emojiData;
+    emoji_data.size = emojiSize;
+    emoji_data.fps = fps;
+    emoji_data.loop = loop;
 
-    emojiCount = cJSON_GetArraySize(emojiCollection);
-    ESP_LOGI(TAG, "Found %d emoji items", emojiCount);
+    ESP_LOGD(TAG, "set emoji data: %s", name);
+    ret = borrow_name ? emote_assets_table_set_static(handle->emoji_table, name, &emoji_data)
+          : emote_assets_table_set(handle->emoji_table, name, &emoji_data);
+    ESP_GOTO_ON_FALSE(ret == ESP_OK, ret, error, TAG, "Failed to set emoji data for: %s", name);
+    return ESP_OK;
 
-    for (int i = 0; i < emojiCount; i++) {
-        cJSON *icon = cJSON_GetArrayItem(emojiCollection, i);
-        if (!cJSON_IsObject(icon)) {
-            continue;
-        }
+error:
+    return ret;
+}
 
-        cJSON *name = cJSON_GetObjectItem(icon, "name");
-        cJSON *file = cJSON_GetObjectItem(icon, "file");
-        if (!cJSON_IsString(name) || !cJSON_IsString(file)) {
-            continue;
-        }
+static esp_err_t emote_add_icon(emote_handle_t handle, const char *name, int file_index, bool borrow_name)
+{
+    esp_err_t ret = ESP_OK;
+    icon_data_t icon_data = {0};
 
-        const uint8_t *emojiData = NULL;
-        size_t emojiSize = 0;
-        ret = emote_get_asset_data_by_name(handle, file->valuestring, &emojiData, &emojiSize);
-        if (ret != ESP_OK) {
-            ESP_LOGE(TAG, "Failed to get emoji data for: %s", file->valuestring);
-            continue;
+    const uint8_t *iconData = mmap_assets_get_mem(handle->assets_handle, file_index);
+    size_t iconSize = mmap_assets_get_size(handle->assets_handle, file_index);
+    ESP_GOTO_ON_FALSE(iconData && iconSize > 0, ESP_ERR_NOT_FOUND, error, TAG, "Invalid icon file %d for: %s", file_index, name);
+
+    icon_data.data = iconData;
+    icon_data.size = iconSize;
+
+    ESP_LOGD(TAG, "set icon data: %s", name);
+    ret = borrow_name ? emote_assets_table_set_static(handle->icon_table, name, &icon_data)
+          : emote_assets_table_set(handle->icon_table, name, &icon_data);
+    ESP_GOTO_ON_FALSE(ret == ESP_OK, ret, error, TAG, "Failed to set icon data for: %s", name);
+    return ESP_OK;
+
+error:
+    return ret;
+}
+
+static esp_err_t emote_add_layout(emote_handle_t handle, const emote_layout_desc_t *desc)
+{
+    esp_err_t ret = emote_apply_layout(handle, desc);
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to apply layout for %s: %s", desc->name, esp_err_to_name(ret));
+    }
+    return ret;
+}
+
+static void emote_finish_layouts(emote_handle_t handle, esp_err_t last_ret)
+{
+    if (last_ret == ESP_OK) {
+        gfx_obj_t *obj_default = handle->def_objects[EMOTE_DEF_OBJ_LEBAL_DEFAULT].obj;
+        if (obj_default) {
+            EMOTE_GFX_LOCK(handle);
+            gfx_obj_delete(obj_default);
+            handle->def_objects[EMOTE_DEF_OBJ_LEBAL_DEFAULT].obj = NULL;
+            emote_reset_obj_state(&handle->def_objects[EMOTE_DEF_OBJ_LEBAL_DEFAULT]);
+            EMOTE_GFX_UNLOCK(handle);
         }
+    }
+}
+
+static esp_err_t emote_add_font(emote_handle_t handle, int file_index)
+{
+    esp_err_t ret = ESP_OK;
+    const void *src_data = NULL;
+    lv_font_t *font = NULL;
+
+    const uint8_t *fontData = mmap_assets_get_mem(handle->assets_handle, file_index);
+    size_t fontSize = mmap_assets_get_size(handle->assets_handle, file_index);
+    ESP_GOTO_ON_FALSE(fontData && fontSize > 0, ESP_ERR_NOT_FOUND, error, TAG, "Invalid font file %d", file_index);
+
+#if CONFIG_EMOTE_FONT_LOAD_IN_PLACE
+    // Memory-mapped fonts are used in place by the gfx loader already
+    if (!emote_data_is_mapped(handle, fontData)) {
+        handle->font = emote_font_load(handle->assets_handle, fontData, fontSize, false,
+                                       CONFIG_EMOTE_FONT_GLYPH_CACHE_KB * 1024);
+        font = emote_font_get_lv_font(handle->font);
+    }
+#endif
+
+    if (!font) {
+        src_data = emote_acquire_data(handle, fontData, fontSize, &handle->font_cache);
+        ESP_GOTO_ON_FALSE(src_data, ESP_ERR_INVALID_STATE, error, TAG, "Failed to get font data");
 
-        bool loopValue = false;
-        int fpsValue = 0;
+        font = gfx_font_lv_load_from_binary((uint8_t *)src_data);
+        ESP_GOTO_ON_FALSE(font, ESP_ERR_INVALID_STATE, error, TAG, "Failed to create font");
+    }
+
+    ret = emote_apply_fonts(handle, font);
+    ESP_GOTO_ON_FALSE(ret == ESP_OK, ret, error, TAG, "Failed to apply fonts: %s", esp_err_to_name(ret));
+
+    return ESP_OK;
+
+error:
+    return ret;
+}
+
+// ===== index.json =====
+
+typedef struct {
+    char name[EMOTE_JSON_STR_MAX];
+    char file[EMOTE_JSON_STR_MAX];
+    int fps;
+    bool loop;
+} emote_json_asset_item_t;
+
+typedef struct {
+    char type[EMOTE_JSON_STR_MAX];
+    char name[EMOTE_JSON_STR_MAX];
+    char align[EMOTE_JSON_STR_MAX];
+    char text_align[EMOTE_JSON_STR_MAX];
+    char long_mode[EMOTE_JSON_STR_MAX];
+    char mirror[EMOTE_JSON_STR_MAX];
+    bool has_x;
+    bool has_y;
+    emote_layout_desc_t desc;
+} emote_json_layout_item_t;
+
+// All parser state lives in one allocation so peak memory does not depend on the file size
+typedef struct {
+    emote_handle_t handle;
+    emote_json_reader_t reader;
+    union {
+        emote_json_asset_item_t asset;
+        emote_json_layout_item_t layout;
+    } item;
+    bool item_invalid;                  // A stored field of the current item was too long
+    int font_file;
+    esp_err_t layout_ret;
+} emote_json_loader_t;
+
+typedef esp_err_t (*emote_json_field_cb_t)(emote_json_loader_t *loader, const char *key);
+typedef esp_err_t (*emote_json_item_cb_t)(emote_json_loader_t *loader, emote_json_tok_t tok);
+
+static esp_err_t emote_json_parse_object(emote_json_loader_t *loader, emote_json_tok_t tok, emote_json_field_cb_t cb)
+{
+    emote_json_reader_t *reader = &loader->reader;
+    char key[EMOTE_JSON_STR_MAX];
 
-        cJSON *eaf = cJSON_GetObjectItem(icon, "eaf");
-        if (cJSON_IsObject(eaf)) {
-            cJSON *loop = cJSON_GetObjectItem(eaf, "loop");
-            cJSON *fps = cJSON_GetObjectItem(eaf, "fps");
-            loopValue = loop ? cJSON_IsTrue(loop) : false;
-            fpsValue = fps ? fps->valueint : 0;
+    if (tok != EMOTE_JSON_TOK_OBJ_BEGIN) {
+        return emote_json_skip(reader, tok);
+    }
+
+    while ((tok = emote_json_next(reader)) == EMOTE_JSON_TOK_STRING) {
+        // The value overwrites reader->str, so keep the key aside
+        memcpy(key, reader->str, sizeof(key));
+        esp_err_t ret = cb(loader, key);
+        if (ret != ESP_OK) {
+            return ret;
         }
+    }
 
-        emoji_data_t *emoji_data = (emoji_data_t *)malloc(sizeof(emoji_data_t));
-        ESP_GOTO_ON_FALSE(emoji_data, ESP_ERR_NO_MEM, error, TAG, "Failed to allocate emoji data");
+    return (tok == EMOTE_JSON_TOK_OBJ_END) ? ESP_OK : ESP_ERR_INVALID_RESPONSE;
+}
 
-        emoji_data->data = emojiData;
-        emoji_data->size = emojiSize;
-        emoji_data->fps = fpsValue;
-        emoji_data->loop = loopValue;
+static esp_err_t emote_json_parse_array(emote_json_loader_t *loader, emote_json_tok_t tok, emote_json_item_cb_t cb)
+{
+    emote_json_reader_t *reader = &loader->reader;
 
-        ESP_LOGD(TAG, "set emoji data: %s", name->valuestring);
-        ret = emote_assets_table_set(handle->emoji_table, name->valuestring, emoji_data);
+    if (tok != EMOTE_JSON_TOK_ARR_BEGIN) {
+        return emote_json_skip(reader, tok);
+    }
+
+    while ((tok = emote_json_next(reader)) != EMOTE_JSON_TOK_ARR_END) {
+        if (tok == EMOTE_JSON_TOK_ERROR || tok == EMOTE_JSON_TOK_END) {
+            return ESP_ERR_INVALID_RESPONSE;
+        }
+        esp_err_t ret = cb(loader, tok);
         if (ret != ESP_OK) {
-            ESP_LOGW(TAG, "Failed to set emoji data for: %s", name->valuestring);
-            free(emoji_data);
+            return ret;
         }
     }
 
     return ESP_OK;
+}
 
-error:
-    return ret;
+static esp_err_t emote_json_skip_value(emote_json_loader_t *loader)
+{
+    return emote_json_skip(&loader->reader, emote_json_next(&loader->reader));
 }
 
-static esp_err_t emote_load_icons(emote_handle_t handle, cJSON *root)
+static esp_err_t emote_json_read_string(emote_json_loader_t *loader, char *out)
 {
-    esp_err_t ret = ESP_OK;
-    cJSON *iconCollection = NULL;
-    int iconCount = 0;
+    emote_json_tok_t tok = emote_json_next(&loader->reader);
+    if (tok == EMOTE_JSON_TOK_STRING) {
+        // A cut-off name or file would silently match the wrong asset, drop the item instead
+        if (loader->reader.str_truncated) {
+            ESP_LOGE(TAG, "String too long at %d (max %d)", (int)loader->reader.pos, EMOTE_JSON_STR_MAX - 1);
+            loader->item_invalid = true;
+            return ESP_OK;
+        }
+        memcpy(out, loader->reader.str, EMOTE_JSON_STR_MAX);
+        return ESP_OK;
+    }
+    return emote_json_skip(&loader->reader, tok);
+}
 
-    ESP_GOTO_ON_FALSE(handle && root, ESP_ERR_INVALID_ARG, error, TAG, "Invalid parameters");
+static esp_err_t emote_json_read_int(emote_json_loader_t *loader, int *out, bool *present)
+{
+    emote_json_tok_t tok = emote_json_next(&loader->reader);
+    if (tok == EMOTE_JSON_TOK_NUMBER) {
+        *out = (int)loader->reader.number;
+        if (present) {
+            *present = true;
+        }
+        return ESP_OK;
+    }
+    return emote_json_skip(&loader->reader, tok);
+}
 
-    iconCollection = cJSON_GetObjectItem(root, "icon_collection");
-    if (!cJSON_IsArray(iconCollection)) {
+static esp_err_t emote_json_read_bool(emote_json_loader_t *loader, bool *out)
+{
+    emote_json_tok_t tok = emote_json_next(&loader->reader);
+    if (tok == EMOTE_JSON_TOK_TRUE || tok == EMOTE_JSON_TOK_FALSE) {
+        *out = (tok == EMOTE_JSON_TOK_TRUE);
         return ESP_OK;
     }
+    return emote_json_skip(&loader->reader, tok);
+}
 
-    iconCount = cJSON_GetArraySize(iconCollection);
-    ESP_LOGI(TAG, "Found %d icon items", iconCount);
+static esp_err_t emote_json_eaf_field(emote_json_loader_t *loader, const char *key)
+{
+    emote_json_asset_item_t *item = &loader->item.asset;
 
-    for (int i = 0; i < iconCount; i++) {
-        cJSON *icon = cJSON_GetArrayItem(iconCollection, i);
-        if (!cJSON_IsObject(icon)) {
-            continue;
+    if (strcmp(key, "loop") == 0) {
+        return emote_json_read_bool(loader, &item->loop);
+    } else if (strcmp(key, "fps") == 0) {
+        return emote_json_read_int(loader, &item->fps, NULL);
+    }
+    return emote_json_skip_value(loader);
+}
+
+static esp_err_t emote_json_asset_field(emote_json_loader_t *loader, const char *key)
+{
+    emote_json_asset_item_t *item = &loader->item.asset;
+
+    if (strcmp(key, "name") == 0) {
+        return emote_json_read_string(loader, item->name);
+    } else if (strcmp(key, "file") == 0) {
+        return emote_json_read_string(loader, item->file);
+    } else if (strcmp(key, "eaf") == 0) {
+        return emote_json_parse_object(loader, emote_json_next(&loader->reader), emote_json_eaf_field);
+    }
+    return emote_json_skip_value(loader);
+}
+
+static esp_err_t emote_json_parse_asset_item(emote_json_loader_t *loader, emote_json_tok_t tok, int *file_index)
+{
+    emote_json_asset_item_t *item = &loader->item.asset;
+
+    memset(item, 0, sizeof(*item));
+    loader->item_invalid = false;
+    *file_index = -1;
+
+    esp_err_t ret = emote_json_parse_object(loader, tok, emote_json_asset_field);
+    if (ret != ESP_OK) {
+        return ret;
+    }
+
+    if (loader->item_invalid) {
+        ESP_LOGE(TAG, "Invalid asset item: %s", item->name[0] ? item->name : "(unnamed)");
+        return ESP_OK;
+    }
+    if (item->name[0] == '\0' || item->file[0] == '\0') {
+        return ESP_OK;
+    }
+
+    *file_index = emote_find_asset_index(loader->handle, item->file);
+    if (*file_index < 0) {
+        ESP_LOGE(TAG, "Failed to get asset data for: %s", item->file);
+    }
+    return ESP_OK;
+}
+
+static esp_err_t emote_json_emoji_item(emote_json_loader_t *loader, emote_json_tok_t tok)
+{
+    int file_index;
+
+    esp_err_t ret = emote_json_parse_asset_item(loader, tok, &file_index);
+    if (ret != ESP_OK || file_index < 0) {
+        return ret;
+    }
+
+    emote_json_asset_item_t *item = &loader->item.asset;
+    ret = emote_add_emoji(loader->handle, item->name, file_index, item->fps, item->loop, false);
+    return (ret == ESP_ERR_NO_MEM) ? ret : ESP_OK;
+}
+
+static esp_err_t emote_json_icon_item(emote_json_loader_t *loader, emote_json_tok_t tok)
+{
+    int file_index;
+
+    esp_err_t ret = emote_json_parse_asset_item(loader, tok, &file_index);
+    if (ret != ESP_OK || file_index < 0) {
+        return ret;
+    }
+
+    ret = emote_add_icon(loader->handle, loader->item.asset.name, file_index, false);
+    return (ret == ESP_ERR_NO_MEM) ? ret : ESP_OK;
+}
+
+static esp_err_t emote_json_anim_field(emote_json_loader_t *loader, const char *key)
+{
+    if (strcmp(key, "mirror") == 0) {
+        return emote_json_read_string(loader, loader->item.layout.mirror);
+    }
+    return emote_json_skip_value(loader);
+}
+
+static esp_err_t emote_json_long_mode_field(emote_json_loader_t *loader, const char *key)
+{
+    emote_json_layout_item_t *item = &loader->item.layout;
+
+    if (strcmp(key, "type") == 0) {
+        return emote_json_read_string(loader, item->long_mode);
+    } else if (strcmp(key, "loop") == 0) {
+        return emote_json_read_bool(loader, &item->desc.label.loop);
+    } else if (strcmp(key, "speed") == 0) {
+        return emote_json_read_int(loader, &item->desc.label.speed, NULL);
+    } else if (strcmp(key, "snap_interval") == 0) {
+        return emote_json_read_int(loader, &item->desc.label.snap_interval, NULL);
+    }
+    return emote_json_skip_value(loader);
+}
+
+static esp_err_t emote_json_label_field(emote_json_loader_t *loader, const char *key)
+{
+    emote_json_layout_item_t *item = &loader->item.layout;
+
+    if (strcmp(key, "color") == 0) {
+        int color = 0;
+        bool present = false;
+        esp_err_t ret = emote_json_read_int(loader, &color, &present);
+        if (present) {
+            item->desc.label.color = color;
         }
+        return ret;
+    } else if (strcmp(key, "text_align") == 0) {
+        return emote_json_read_string(loader, item->text_align);
+    } else if (strcmp(key, "long_mode") == 0) {
+        return emote_json_parse_object(loader, emote_json_next(&loader->reader), emote_json_long_mode_field);
+    } else if (strcmp(key, "digit_atlas") == 0) {
+        return emote_json_read_bool(loader, &item->desc.label.digit_atlas);
+    } else if (strcmp(key, "scroll_strip") == 0) {
+        return emote_json_read_bool(loader, &item->desc.label.scroll_strip);
+    }
+    return emote_json_skip_value(loader);
+}
 
-        cJSON *name = cJSON_GetObjectItem(icon, "name");
-        cJSON *file = cJSON_GetObjectItem(icon, "file");
-        if (!cJSON_IsString(name) || !cJSON_IsString(file)) {
-            continue;
+static esp_err_t emote_json_timer_field(emote_json_loader_t *loader, const char *key)
+{
+    emote_json_layout_item_t *item = &loader->item.layout;
+
+    if (strcmp(key, "period") == 0) {
+        int period = 0;
+        bool present = false;
+        esp_err_t ret = emote_json_read_int(loader, &period, &present);
+        if (present) {
+            item->desc.timer.period = period;
         }
+        return ret;
+    } else if (strcmp(key, "repeat_count") == 0) {
+        return emote_json_read_int(loader, &item->desc.timer.repeat_count, NULL);
+    }
+    return emote_json_skip_value(loader);
+}
 
-        const uint8_t *iconData = NULL;
-        size_t iconSize = 0;
-        ret = emote_get_asset_data_by_name(handle, file->valuestring, &iconData, &iconSize);
-        if (ret != ESP_OK) {
-            ESP_LOGE(TAG, "Failed to get icon data for: %s", file->valuestring);
-            continue;
+static esp_err_t emote_json_qrcode_field(emote_json_loader_t *loader, const char *key)
+{
+    if (strcmp(key, "size") == 0) {
+        return emote_json_read_int(loader, &loader->item.layout.desc.qrcode.size, NULL);
+    }
+    return emote_json_skip_value(loader);
+}
+
+static esp_err_t emote_json_layout_field(emote_json_loader_t *loader, const char *key)
+{
+    emote_json_layout_item_t *item = &loader->item.layout;
+    emote_json_tok_t tok;
+
+    if (strcmp(key, "type") == 0) {
+        return emote_json_read_string(loader, item->type);
+    } else if (strcmp(key, "name") == 0) {
+        return emote_json_read_string(loader, item->name);
+    } else if (strcmp(key, "align") == 0) {
+        return emote_json_read_string(loader, item->align);
+    } else if (strcmp(key, "x") == 0) {
+        return emote_json_read_int(loader, &item->desc.x, &item->has_x);
+    } else if (strcmp(key, "y") == 0) {
+        return emote_json_read_int(loader, &item->desc.y, &item->has_y);
+    } else if (strcmp(key, "width") == 0) {
+        return emote_json_read_int(loader, &item->desc.width, NULL);
+    } else if (strcmp(key, "height") == 0) {
+        return emote_json_read_int(loader, &item->desc.height, NULL);
+    } else if (strcmp(key, EMOTE_OBJ_TYPE_ANIM) == 0) {
+        return emote_json_parse_object(loader, emote_json_next(&loader->reader), emote_json_anim_field);
+    } else if (strcmp(key, EMOTE_OBJ_TYPE_LABEL) == 0) {
+        return emote_json_parse_object(loader, emote_json_next(&loader->reader), emote_json_label_field);
+    } else if (strcmp(key, EMOTE_OBJ_TYPE_TIMER) == 0) {
+        tok = emote_json_next(&loader->reader);
+        item->desc.timer.present = (tok == EMOTE_JSON_TOK_OBJ_BEGIN);
+        return emote_json_parse_object(loader, tok, emote_json_timer_field);
+    } else if (strcmp(key, EMOTE_OBJ_TYPE_QRCODE) == 0) {
+        return emote_json_parse_object(loader, emote_json_next(&loader->reader), emote_json_qrcode_field);
+    }
+    return emote_json_skip_value(loader);
+}
+
+static esp_err_t emote_json_layout_item(emote_json_loader_t *loader, emote_json_tok_t tok)
+{
+    emote_json_layout_item_t *item = &loader->item.layout;
+    emote_layout_desc_t *desc = &item->desc;
+
+    memset(item, 0, sizeof(*item));
+    loader->item_invalid = false;
+    emote_layout_desc_init(desc);
+
+    esp_err_t ret = emote_json_parse_object(loader, tok, emote_json_layout_field);
+    if (ret != ESP_OK) {
+        return ret;
+    }
+
+    if (loader->item_invalid) {
+        ESP_LOGE(TAG, "Invalid layout item: %s", item->name[0] ? item->name : "(unnamed)");
+        loader->layout_ret = ESP_ERR_INVALID_ARG;
+        return ESP_OK;
+    }
+
+    if (item->type[0] == '\0' || item->name[0] == '\0') {
+        ESP_LOGE(TAG, "Invalid layout item: missing required fields");
+        return ESP_OK;
+    }
+
+    desc->type = emote_layout_type_from_str(item->type);
+    desc->name = item->name;
+    if (desc->type == EMOTE_LAYOUT_TYPE_MAX) {
+        ESP_LOGE(TAG, "Unknown type: %s", item->type);
+        loader->layout_ret = ESP_ERR_INVALID_ARG;
+        return ESP_OK;
+    }
+
+    // Position is applied only when align, x and y are all present
+    if (item->align[0] == '\0' || !item->has_x || !item->has_y) {
+        desc->x = 0;
+        desc->y = 0;
+    } else {
+        desc->align = item->align;
+    }
+
+    desc->anim.mirror = (strcmp(item->mirror, "auto") == 0 || strcmp(item->mirror, "true") == 0);
+    if (item->text_align[0]) {
+        desc->label.text_align = item->text_align;
+    }
+    if (item->long_mode[0]) {
+        desc->label.long_mode = item->long_mode;
+    }
+
+    loader->layout_ret = emote_add_layout(loader->handle, desc);
+    return ESP_OK;
+}
+
+static esp_err_t emote_json_root_field(emote_json_loader_t *loader, const char *key)
+{
+    emote_json_reader_t *reader = &loader->reader;
+    esp_err_t ret;
+
+    if (strcmp(key, "emoji_collection") == 0) {
+        return emote_json_parse_array(loader, emote_json_next(reader), emote_json_emoji_item);
+    } else if (strcmp(key, "icon_collection") == 0) {
+        return emote_json_parse_array(loader, emote_json_next(reader), emote_json_icon_item);
+    } else if (strcmp(key, "layout") == 0) {
+        loader->layout_ret = ESP_OK;
+        ret = emote_json_parse_array(loader, emote_json_next(reader), emote_json_layout_item);
+        emote_finish_layouts(loader->handle, loader->layout_ret);
+        return ret;
+    } else if (strcmp(key, "text_font") == 0) {
+        emote_json_tok_t tok = emote_json_next(reader);
+        if (tok == EMOTE_JSON_TOK_STRING) {
+            if (reader->str_truncated) {
+                ESP_LOGE(TAG, "Font file name too long at %d", (int)reader->pos);
+                return ESP_OK;
+            }
+            ESP_LOGI(TAG, "Found font: %s", reader->str);
+            loader->font_file = emote_find_asset_index(loader->handle, reader->str);
+            if (loader->font_file < 0) {
+                ESP_LOGE(TAG, "Font file not found: %s", reader->str);
+            }
+            return ESP_OK;
         }
+        return emote_json_skip(reader, tok);
+    }
+    return emote_json_skip_value(loader);
+}
+
+static esp_err_t emote_load_index_json(emote_handle_t handle, int file_index)
+{
+    esp_err_t ret = ESP_OK;
+    emote_json_loader_t *loader = NULL;
+
+    const uint8_t *asset_data = mmap_assets_get_mem(handle->assets_handle, file_index);
+    size_t asset_size = mmap_assets_get_size(handle->assets_handle, file_index);
 
-        icon_data_t *icon_data = (icon_data_t *)malloc(sizeof(icon_data_t));
-        ESP_GOTO_ON_FALSE(icon_data, ESP_ERR_NO_MEM, error, TAG, "Failed to allocate icon data");
+    ESP_LOGI(TAG, "Found %s, size: %d", EMOTE_INDEX_JSON_FILENAME, (int)asset_size);
 
-        icon_data->data = iconData;
-        icon_data->size = iconSize;
+    loader = (emote_json_loader_t *)calloc(1, sizeof(emote_json_loader_t));
+    ESP_GOTO_ON_FALSE(loader, ESP_ERR_NO_MEM, error, TAG, "Failed to allocate json loader");
 
-        ESP_LOGD(TAG, "set icon data: %s", name->valuestring);
-        ret = emote_assets_table_set(handle->icon_table, name->valuestring, icon_data);
-        if (ret != ESP_OK) {
-            ESP_LOGW(TAG, "Failed to set icon data for: %s", name->valuestring);
-            free(icon_data);
+    loader->handle = handle;
+    loader->font_file = -1;
+
+    // Parse in place from the mmap window, or stream through a small window otherwise
+    emote_json_reader_init(&loader->reader, asset_data, asset_size,
+                           emote_data_is_mapped(handle, asset_data) ? NULL : handle->assets_handle);
+
+    ret = emote_json_parse_object(loader, emote_json_next(&loader->reader), emote_json_root_field);
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to parse %s at offset %d", EMOTE_INDEX_JSON_FILENAME, (int)loader->reader.pos);
+    }
+
+    // Fonts are applied last so they reach every label created from the layout
+    if (loader->font_file >= 0) {
+        esp_err_t font_ret = emote_add_font(handle, loader->font_file);
+        if (font_ret != ESP_OK) {
+            ESP_LOGW(TAG, "Failed to load fonts: %s", esp_err_to_name(font_ret));
         }
     }
 
-    return ESP_OK;
+    free(loader);
+    return ret;
 
 error:
     return ret;
 }
 
-static esp_err_t emote_load_layouts(emote_handle_t handle, cJSON *root)
+static const char *emote_index_bin_str(const uint8_t *pool, uint32_t pool_size, uint32_t offset)
 {
-    esp_err_t ret = ESP_OK;
-    cJSON *layoutJson = NULL;
-    int layoutCount = 0;
+    // The pool is checked to end with NUL, so any in-range offset is a valid string
+    if (offset == EMOTE_INDEX_BIN_STR_NONE || offset >= pool_size) {
+        return NULL;
+    }
+    return (const char *)pool + offset;
+}
 
-    ESP_GOTO_ON_FALSE(handle && root, ESP_ERR_INVALID_ARG, error, TAG, "Invalid parameters");
+static bool emote_index_bin_range_ok(size_t size, uint32_t offset, size_t count, size_t record_size)
+{
+    return offset <= size && count * record_size <= size - offset;
+}
 
-    layoutJson = cJSON_GetObjectItem(root, "layout");
-    if (!cJSON_IsArray(layoutJson)) {
-        return ESP_OK;
+static esp_err_t emote_parse_index_bin(emote_handle_t handle, const uint8_t *data, size_t size, bool borrow_names)
+{
+    esp_err_t ret = ESP_OK;
+    emote_index_bin_header_t header;
+    emote_layout_desc_t desc;
+    esp_err_t layout_ret = ESP_OK;
+
+    ESP_GOTO_ON_FALSE(size >= sizeof(header), ESP_ERR_INVALID_SIZE, error, TAG, "%s too small", EMOTE_INDEX_BIN_FILENAME);
+    memcpy(&header, data, sizeof(header));
+
+    ESP_GOTO_ON_FALSE(memcmp(header.magic, EMOTE_INDEX_BIN_MAGIC, sizeof(header.magic)) == 0,
+                      ESP_ERR_INVALID_RESPONSE, error, TAG, "Bad %s magic", EMOTE_INDEX_BIN_FILENAME);
+    ESP_GOTO_ON_FALSE(header.version == EMOTE_INDEX_BIN_VERSION, ESP_ERR_INVALID_VERSION, error, TAG,
+                      "Unsupported %s version: %d", EMOTE_INDEX_BIN_FILENAME, header.version);
+
+    int file_count = mmap_assets_get_stored_files(handle->assets_handle);
+    ESP_GOTO_ON_FALSE(header.file_count == file_count, ESP_ERR_INVALID_STATE, error, TAG,
+                      "%s built for %d files, assets have %d", EMOTE_INDEX_BIN_FILENAME, header.file_count, file_count);
+
+    ESP_GOTO_ON_FALSE(emote_index_bin_range_ok(size, header.emoji_offset, header.emoji_count, sizeof(emote_index_bin_emoji_t)) &&
+                      emote_index_bin_range_ok(size, header.icon_offset, header.icon_count, sizeof(emote_index_bin_icon_t)) &&
+                      emote_index_bin_range_ok(size, header.layout_offset, header.layout_count, sizeof(emote_index_bin_layout_t)) &&
+                      emote_index_bin_range_ok(size, header.string_offset, header.string_size, 1) &&
+                      header.string_size > 0 && data[header.string_offset + header.string_size - 1] == '\0',
+                      ESP_ERR_INVALID_SIZE, error, TAG, "Corrupted %s", EMOTE_INDEX_BIN_FILENAME);
+
+    const uint8_t *pool = data + header.string_offset;
+    const emote_index_bin_emoji_t *emojis = (const emote_index_bin_emoji_t *)(data + header.emoji_offset);
+    const emote_index_bin_icon_t *icons = (const emote_index_bin_icon_t *)(data + header.icon_offset);
+    const emote_index_bin_layout_t *layouts = (const emote_index_bin_layout_t *)(data + header.layout_offset);
+
+    ESP_LOGI(TAG, "Found %s: %d emojis, %d icons, %d layouts", EMOTE_INDEX_BIN_FILENAME,
+             header.emoji_count, header.icon_count, header.layout_count);
+
+    for (int i = 0; i < header.emoji_count; i++) {
+        const char *name = emote_index_bin_str(pool, header.string_size, emojis[i].name);
+        if (!name || emojis[i].file >= file_count) {
+            ESP_LOGE(TAG, "Invalid emoji record %d", i);
+            continue;
+        }
+        ret = emote_add_emoji(handle, name, emojis[i].file, emojis[i].fps, emojis[i].flags & EMOTE_INDEX_BIN_EMOJI_LOOP, borrow_names);
+        ESP_GOTO_ON_FALSE(ret != ESP_ERR_NO_MEM, ret, error, TAG, "Failed to add emoji: %s", name);
     }
 
-    layoutCount = cJSON_GetArraySize(layoutJson);
-    ESP_LOGI(TAG, "Found %d layout items", layoutCount);
-
-    for (int i = 0; i < layoutCount; i++) {
-        cJSON *layout = cJSON_GetArrayItem(layoutJson, i);
-        if (!cJSON_IsObject(layout)) {
+    for (int i = 0; i < header.icon_count; i++) {
+        const char *name = emote_index_bin_str(pool, header.string_size, icons[i].name);
+        if (!name || icons[i].file >= file_count) {
+            ESP_LOGE(TAG, "Invalid icon record %d", i);
             continue;
         }
+        ret = emote_add_icon(handle, name, icons[i].file, borrow_names);
+        ESP_GOTO_ON_FALSE(ret != ESP_ERR_NO_MEM, ret, error, TAG, "Failed to add icon: %s", name);
+    }
+
+    for (int i = 0; i < header.layout_count; i++) {
+        const emote_index_bin_layout_t *layout = &layouts[i];
 
-        cJSON *type = cJSON_GetObjectItem(layout, "type");
-        cJSON *name = cJSON_GetObjectItem(layout, "name");
-        if (!cJSON_IsString(type) || !cJSON_IsString(name)) {
-            ESP_LOGE(TAG, "Invalid layout item %d: missing required fields", i);
+        emote_layout_desc_init(&desc);
+        desc.type = layout->type < EMOTE_LAYOUT_TYPE_MAX ? (emote_layout_type_t)layout->type : EMOTE_LAYOUT_TYPE_MAX;
+        desc.name = emote_index_bin_str(pool, header.string_size, layout->name);
+        if (!desc.name || desc.type == EMOTE_LAYOUT_TYPE_MAX) {
+            ESP_LOGE(TAG, "Invalid layout record %d", i);
+            layout_ret = ESP_ERR_INVALID_ARG;
             continue;
         }
 
-        const char *typeStr = type->valuestring;
-        const char *obj_name = name->valuestring;
+        if (layout->flags & EMOTE_INDEX_BIN_LAYOUT_POS) {
+            desc.align = emote_index_bin_str(pool, header.string_size, layout->align);
+            desc.x = layout->x;
+            desc.y = layout->y;
+        }
+        desc.width = layout->width;
+        desc.height = layout->height;
+        desc.anim.mirror = layout->flags & EMOTE_INDEX_BIN_LAYOUT_MIRROR;
 
-        ret = ESP_ERR_INVALID_ARG;
-        if (strcmp(typeStr, "anim") == 0) {
-            ret = emote_apply_anim_layout(handle, obj_name, layout);
-        } else if (strcmp(typeStr, "image") == 0) {
-            ret = emote_apply_image_layout(handle, obj_name, layout);
-        } else if (strcmp(typeStr, "label") == 0) {
-            ret = emote_apply_label_layout(handle, obj_name, layout);
-        } else if (strcmp(typeStr, "timer") == 0) {
-            ret = emote_apply_timer_layout(handle, obj_name, layout);
-        } else if (strcmp(typeStr, "qrcode") == 0) {
-            ret = emote_apply_qrcode_layout(handle, obj_name, layout);
-        } else {
-            ESP_LOGE(TAG, "Unknown type: %s", typeStr);
+        if (layout->flags & EMOTE_INDEX_BIN_LAYOUT_COLOR) {
+            desc.label.color = layout->color;
+        }
+        const char *text_align = emote_index_bin_str(pool, header.string_size, layout->text_align);
+        const char *long_mode = emote_index_bin_str(pool, header.string_size, layout->long_mode);
+        desc.label.text_align = text_align ? text_align : desc.label.text_align;
+        desc.label.long_mode = long_mode ? long_mode : desc.label.long_mode;
+        desc.label.loop = layout->flags & EMOTE_INDEX_BIN_LAYOUT_LOOP;
+        desc.label.digit_atlas = layout->flags & EMOTE_INDEX_BIN_LAYOUT_DIGITS;
+        desc.label.scroll_strip = layout->flags & EMOTE_INDEX_BIN_LAYOUT_STRIP;
+        if (layout->speed != EMOTE_INDEX_BIN_U16_DEFAULT) {
+            desc.label.speed = layout->speed;
+        }
+        if (layout->snap_interval != EMOTE_INDEX_BIN_U16_DEFAULT) {
+            desc.label.snap_interval = layout->snap_interval;
         }
 
-        if (ret != ESP_OK) {
-            ESP_LOGE(TAG, "Failed to apply layout for %s: %s", obj_name, esp_err_to_name(ret));
+        if (layout->flags & EMOTE_INDEX_BIN_LAYOUT_TIMER) {
+            desc.timer.present = true;
+            desc.timer.period = layout->period;
+            desc.timer.repeat_count = layout->repeat_count;
         }
+
+        if (layout->qrcode_size != EMOTE_INDEX_BIN_U16_DEFAULT) {
+            desc.qrcode.size = layout->qrcode_size;
+        }
+
+        layout_ret = emote_add_layout(handle, &desc);
     }
+    emote_finish_layouts(handle, layout_ret);
 
-    if (ret == ESP_OK) {
-        gfx_obj_t *obj_default = handle->def_objects[EMOTE_DEF_OBJ_LEBAL_DEFAULT].obj;
-        if (obj_default) {
-            gfx_obj_delete(obj_default);
-            handle->def_objects[EMOTE_DEF_OBJ_LEBAL_DEFAULT].obj = NULL;
+    if (header.font_file >= 0 && header.font_file < file_count) {
+        ret = emote_add_font(handle, header.font_file);
+        if (ret != ESP_OK) {
+            ESP_LOGW(TAG, "Failed to load fonts: %s", esp_err_to_name(ret));
         }
     }
 
@@ -478,109 +1033,145 @@ error:
     return ret;
 }
 
-static esp_err_t emote_load_fonts(emote_handle_t handle, cJSON *root)
+static esp_err_t emote_load_index_bin(emote_handle_t handle, int file_index)
 {
     esp_err_t ret = ESP_OK;
-    cJSON *font = NULL;
-    const uint8_t *fontData = NULL;
-    size_t fontSize = 0;
+    void *internal_buf = NULL;
     const void *src_data = NULL;
 
-    ESP_GOTO_ON_FALSE(handle && root, ESP_ERR_INVALID_ARG, error, TAG, "Invalid parameters");
+    const uint8_t *asset_data = mmap_assets_get_mem(handle->assets_handle, file_index);
+    size_t asset_size = mmap_assets_get_size(handle->assets_handle, file_index);
 
-    font = cJSON_GetObjectItem(root, "text_font");
-    if (!cJSON_IsString(font)) {
-        return ESP_OK;
-    }
+    // In place from the mmap window; copied only for partition/file reads
+    src_data = emote_acquire_data(handle, asset_data, asset_size, &internal_buf);
+    ESP_GOTO_ON_FALSE(src_data, ESP_ERR_INVALID_STATE, error, TAG, "Failed to resolve asset data");
 
-    const char *fontsTextFile = font->valuestring;
-    ESP_LOGI(TAG, "Foundfont: %s", fontsTextFile);
+    // Names in a mapped index live as long as the mount, so the tables can reference them
+    bool borrow_names = false;
+#if CONFIG_EMOTE_ASSETS_BORROW_KEYS
+    borrow_names = (internal_buf == NULL);
+#endif
+    ret = emote_parse_index_bin(handle, (const uint8_t *)src_data, asset_size, borrow_names);
 
-    ret = emote_get_asset_data_by_name(handle, fontsTextFile, &fontData, &fontSize);
-    ESP_GOTO_ON_FALSE(ret == ESP_OK, ret, error, TAG, "Font file not found: %s", fontsTextFile);
+    emote_release_data(handle, internal_buf);
 
-    src_data = emote_acquire_data(handle, fontData, fontSize, &handle->font_cache);
-    ESP_GOTO_ON_FALSE(src_data, ESP_ERR_INVALID_STATE, error, TAG, "Failed to get font data");
+error:
+    return ret;
+}
 
-    ret = emote_apply_fonts(handle, (uint8_t *)src_data);
-    ESP_GOTO_ON_FALSE(ret == ESP_OK, ret, error, TAG, "Failed to apply fonts: %s", esp_err_to_name(ret));
+static const char *const builtin_icon_names[EMOTE_BUILTIN_ICON_MAX] = {
+    [EMOTE_BUILTIN_ICON_MIC]            = EMOTE_ICON_MIC,
+    [EMOTE_BUILTIN_ICON_TIPS]           = EMOTE_ICON_TIPS,
+    [EMOTE_BUILTIN_ICON_LISTEN]         = EMOTE_ICON_LISTEN,
+    [EMOTE_BUILTIN_ICON_SPEAKER]        = EMOTE_ICON_SPEAKER,
+    [EMOTE_BUILTIN_ICON_BATTERY_BG]     = EMOTE_ICON_BATTERY_BG,
+    [EMOTE_BUILTIN_ICON_BATTERY_CHARGE] = EMOTE_ICON_BATTERY_CHARGE,
+};
 
-    return ESP_OK;
+static void emote_resolve_builtin_icons(emote_handle_t handle)
+{
+    for (int i = 0; i < EMOTE_BUILTIN_ICON_MAX; i++) {
+        handle->builtin_icons[i] = handle->icon_table ? emote_assets_table_index_of(handle->icon_table, builtin_icon_names[i]) : -1;
+        if (handle->builtin_icons[i] < 0) {
+            ESP_LOGD(TAG, "Built-in icon not found: %s", builtin_icon_names[i]);
+        }
+    }
+}
 
-error:
-    return ret;
+static emote_asset_id_t emote_make_asset_id(emote_handle_t handle, int index)
+{
+    if (index < 0 || index > EMOTE_ASSET_ID_INDEX_MASK) {
+        return EMOTE_ASSET_ID_INVALID;
+    }
+    return ((emote_asset_id_t)handle->asset_generation << EMOTE_ASSET_ID_INDEX_BITS) | index;
 }
 
-esp_err_t emote_load_assets(emote_handle_t handle)
+static esp_err_t emote_find_data_by_id(emote_handle_t handle, assets_hash_table_t *ht, emote_asset_id_t id, void **result)
+{
+    if (!handle || !ht || id < 0 || !result) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    if ((id >> EMOTE_ASSET_ID_INDEX_BITS) != handle->asset_generation) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    *result = emote_assets_table_at(ht, id & EMOTE_ASSET_ID_INDEX_MASK);
+    return *result ? ESP_OK : ESP_ERR_NOT_FOUND;
+}
+
+static esp_err_t emote_create_asset_tables(emote_handle_t handle, bool empty)
 {
     esp_err_t ret = ESP_OK;
-    const uint8_t *asset_data = NULL;
-    size_t asset_size = 0;
-    void *internal_buf = NULL;
-    const void *src_data = NULL;
-    cJSON *root = NULL;
 
-    ESP_GOTO_ON_FALSE(handle, ESP_ERR_INVALID_ARG, error, TAG, "Invalid parameters");
+    if (empty) {
+        emote_assets_table_destroy(handle->emoji_table);
+        handle->emoji_table = NULL;
+        emote_assets_table_destroy(handle->icon_table);
+        handle->icon_table = NULL;
+    }
 
-    // Create hash tables if they don't exist
     if (!handle->emoji_table) {
-        handle->emoji_table = emote_assets_table_create("emoji");
+        handle->emoji_table = emote_assets_table_create("emoji", sizeof(emoji_data_t));
         ESP_GOTO_ON_FALSE(handle->emoji_table, ESP_ERR_NO_MEM, error, TAG, "Failed to create emoji_table hash table");
     }
 
     if (!handle->icon_table) {
-        handle->icon_table = emote_assets_table_create("icon");
+        handle->icon_table = emote_assets_table_create("icon", sizeof(icon_data_t));
         ESP_GOTO_ON_FALSE(handle->icon_table, ESP_ERR_NO_MEM, error, TAG, "Failed to create icon_table hash table");
     }
 
-    // Create semaphore for emergency dialog animation completion
-    if (!handle->emerg_dlg_done_sem) {
-        handle->emerg_dlg_done_sem = xSemaphoreCreateBinary();
-        ESP_GOTO_ON_FALSE(handle->emerg_dlg_done_sem, ESP_ERR_NO_MEM, error, TAG, "Failed to create emerg_dlg_done_sem");
-    }
-
-    ret = emote_get_asset_data_by_name(handle, EMOTE_INDEX_JSON_FILENAME, &asset_data, &asset_size);
-    ESP_GOTO_ON_FALSE(ret == ESP_OK, ret, error, TAG, "Failed to find %s in assets", EMOTE_INDEX_JSON_FILENAME);
+error:
+    return ret;
+}
 
-    ESP_LOGI(TAG, "Found %s, size: %d", EMOTE_INDEX_JSON_FILENAME, (int)asset_size);
+esp_err_t emote_load_assets(emote_handle_t handle)
+{
+    esp_err_t ret = ESP_OK;
+    int file_index = -1;
 
-    src_data = emote_acquire_data(handle, asset_data, asset_size, &internal_buf);
-    ESP_GOTO_ON_FALSE(src_data, ESP_ERR_INVALID_STATE, error, TAG, "Failed to resolve asset data");
+    ESP_GOTO_ON_FALSE(handle && handle->assets_handle, ESP_ERR_INVALID_ARG, error, TAG, "Invalid parameters");
 
-    root = cJSON_ParseWithLength((const char *)src_data, asset_size);
-    ESP_GOTO_ON_FALSE(root, ESP_ERR_INVALID_RESPONSE, error_free_buf, TAG, "Failed to parse %s", EMOTE_INDEX_JSON_FILENAME);
+    // Create hash tables if they don't exist
+    ret = emote_create_asset_tables(handle, false);
+    ESP_GOTO_ON_FALSE(ret == ESP_OK, ret, error, TAG, "Failed to create asset tables");
 
-    ret = emote_load_emojis(handle, root);
-    if (ret != ESP_OK) {
-        ESP_LOGW(TAG, "Failed to load emojis: %s", esp_err_to_name(ret));
+    // Create semaphore for emergency dialog animation completion
+    if (!handle->emerg_dlg_done_sem) {
+        handle->emerg_dlg_done_sem = xSemaphoreCreateBinary();
+        ESP_GOTO_ON_FALSE(handle->emerg_dlg_done_sem, ESP_ERR_NO_MEM, error, TAG, "Failed to create emerg_dlg_done_sem");
     }
 
-    ret = emote_load_icons(handle, root);
-    if (ret != ESP_OK) {
-        ESP_LOGW(TAG, "Failed to load icons: %s", esp_err_to_name(ret));
+    // Ids handed out for a previous load must not alias entries of this one
+    handle->asset_generation = (handle->asset_generation + 1) & EMOTE_ASSET_ID_GEN_MASK;
+    if (handle->asset_generation == 0) {
+        handle->asset_generation = 1;
     }
 
-    ret = emote_load_layouts(handle, root);
-    if (ret != ESP_OK) {
-        ESP_LOGW(TAG, "Failed to load layouts: %s", esp_err_to_name(ret));
+    // Prefer the precompiled index, fall back to index.json when it is missing or stale
+    ret = ESP_ERR_NOT_FOUND;
+    handle->index_bin_loaded = false;
+    file_index = emote_find_asset_index(handle, EMOTE_INDEX_BIN_FILENAME);
+    if (file_index >= 0) {
+        ret = emote_load_index_bin(handle, file_index);
+        handle->index_bin_loaded = (ret == ESP_OK);
+        if (ret != ESP_OK) {
+            ESP_LOGW(TAG, "Failed to load %s, fall back to %s", EMOTE_INDEX_BIN_FILENAME, EMOTE_INDEX_JSON_FILENAME);
+            // Emojis and icons added before the failure must not mix into index.json's; layouts
+            // are only applied once both lists are in, and nothing after them fails the parse
+            esp_err_t reset_ret = emote_create_asset_tables(handle, true);
+            ESP_GOTO_ON_FALSE(reset_ret == ESP_OK, reset_ret, error, TAG, "Failed to reset asset tables");
+        }
     }
 
-    ret = emote_load_fonts(handle, root);
     if (ret != ESP_OK) {
-        ESP_LOGW(TAG, "Failed to load fonts: %s", esp_err_to_name(ret));
-    }
-
-    cJSON_Delete(root);
-    if (internal_buf) {
-        free(internal_buf);
+        file_index = emote_find_asset_index(handle, EMOTE_INDEX_JSON_FILENAME);
+        ESP_GOTO_ON_FALSE(file_index >= 0, ESP_ERR_NOT_FOUND, error, TAG, "Failed to find %s in assets", EMOTE_INDEX_JSON_FILENAME);
+        ret = emote_load_index_json(handle, file_index);
     }
 
-    return ESP_OK;
-
-error_free_buf:
-    if (internal_buf) {
-        free(internal_buf);
-    }
+    emote_resolve_builtin_icons(handle);
+    return ret;
 
 error:
     return ret;
@@ -592,12 +1183,19 @@ esp_err_t emote_unload_assets(emote_handle_t handle)
 
     ESP_GOTO_ON_FALSE(handle, ESP_ERR_INVALID_ARG, error, TAG, "Invalid parameters");
 
+    // Queued prefetches refer to the entries about to be destroyed
+    emote_prefetch_cancel(handle);
+
     // Cleanup objects
     if (handle->gfx_handle) {
-        gfx_emote_lock(handle->gfx_handle);
+        EMOTE_GFX_LOCK(handle);
         // Cleanup def_objects
         for (int i = EMOTE_DEF_OBJ_ANIM_EYE; i < EMOTE_DEF_OBJ_MAX; i++) {
             emote_def_obj_entry_t *entry = &handle->def_objects[i];
+            emote_digits_delete(entry->digits);
+            entry->digits = NULL;
+            emote_strip_delete(entry->strip);
+            entry->strip = NULL;
             if (entry->obj) {
                 if (i == EMOTE_DEF_OBJ_TIMER_STATUS) {
                     gfx_timer_delete(handle->gfx_handle, (gfx_timer_handle_t)entry->obj);
@@ -606,20 +1204,17 @@ esp_err_t emote_unload_assets(emote_handle_t handle)
                 }
                 entry->obj = NULL;
             }
+            emote_reset_obj_state(entry);
             // Cleanup cache based on object type
             if (i >= EMOTE_DEF_OBJ_ANIM_EYE && i <= EMOTE_DEF_OBJ_ANIM_EMERG_DLG) {
                 if (entry->data.anim) {
-                    if (entry->data.anim->cache) {
-                        free(entry->data.anim->cache);
-                    }
+                    emote_release_data(handle, entry->data.anim->cache);
                     free(entry->data.anim);
                     entry->data.anim = NULL;
                 }
             } else if (i == EMOTE_DEF_OBJ_ICON_STATUS || i == EMOTE_DEF_OBJ_ICON_CHARGE) {
                 if (entry->data.img) {
-                    if (entry->data.img->cache) {
-                        free(entry->data.img->cache);
-                    }
+                    emote_release_data(handle, entry->data.img->cache);
                     free(entry->data.img);
                     entry->data.img = NULL;
                 }
@@ -647,7 +1242,7 @@ esp_err_t emote_unload_assets(emote_handle_t handle)
             handle->dialog_timer = NULL;
         }
 
-        gfx_emote_unlock(handle->gfx_handle);
+        EMOTE_GFX_UNLOCK(handle);
     }
 
     // Cleanup semaphore for emergency dialog animation completion
@@ -667,18 +1262,19 @@ esp_err_t emote_unload_assets(emote_handle_t handle)
         emote_assets_table_destroy(handle->icon_table);
         handle->icon_table = NULL;
     }
+    emote_resolve_builtin_icons(handle);
 
-    // Release font cache
-    if (handle->font_cache) {
-        free(handle->font_cache);
-        handle->font_cache = NULL;
-    }
-
-    // Cleanup font
-    if (handle->gfx_font) {
+    // Cleanup font before releasing the data it points into
+    if (handle->font) {
+        emote_font_delete(handle->font);
+        handle->font = NULL;
+    } else if (handle->gfx_font) {
         gfx_font_lv_delete(handle->gfx_font);
-        handle->gfx_font = NULL;
     }
+    handle->gfx_font = NULL;
+
+    emote_release_data(handle, handle->font_cache);
+    handle->font_cache = NULL;
 
     ESP_LOGI(TAG, "Unload assets");
     return ESP_OK;
@@ -709,6 +1305,56 @@ esp_err_t emote_get_emoji_data_by_name(emote_handle_t handle, const char *name,
     return ret;
 }
 
+esp_err_t emote_get_emoji_id(emote_handle_t handle, const char *name, emote_asset_id_t *id)
+{
+    if (!handle || !name || !id) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    *id = emote_make_asset_id(handle, emote_assets_table_index_of(handle->emoji_table, name));
+    return (*id != EMOTE_ASSET_ID_INVALID) ? ESP_OK : ESP_ERR_NOT_FOUND;
+}
+
+esp_err_t emote_get_icon_id(emote_handle_t handle, const char *name, emote_asset_id_t *id)
+{
+    if (!handle || !name || !id) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    *id = emote_make_asset_id(handle, emote_assets_table_index_of(handle->icon_table, name));
+    return (*id != EMOTE_ASSET_ID_INVALID) ? ESP_OK : ESP_ERR_NOT_FOUND;
+}
+
+esp_err_t emote_get_emoji_data_by_id(emote_handle_t handle, emote_asset_id_t id, emoji_data_t **emoji)
+{
+    if (!handle || !emoji) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    return emote_find_data_by_id(handle, handle->emoji_table, id, (void **)emoji);
+}
+
+esp_err_t emote_get_icon_data_by_id(emote_handle_t handle, emote_asset_id_t id, icon_data_t **icon)
+{
+    if (!handle || !icon) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    return emote_find_data_by_id(handle, handle->icon_table, id, (void **)icon);
+}
+
+esp_err_t emote_get_builtin_icon(emote_handle_t handle, emote_builtin_icon_t icon, icon_data_t **data)
+{
+    if (!handle || icon >= EMOTE_BUILTIN_ICON_MAX || !data) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    *data = (icon_data_t *)emote_assets_table_at(handle->icon_table, handle->builtin_icons[icon]);
+    if (!*data) {
+        ESP_LOGW(TAG, "Not found:\"%s\"", builtin_icon_names[icon]);
+        return ESP_ERR_NOT_FOUND;
+    }
+    return ESP_OK;
+}
+
 esp_err_t emote_mount_and_load_assets(emote_handle_t handle, const emote_data_t *data)
 {
     esp_err_t ret = ESP_OK;
@@ -11,6 +11,8 @@
 #include <string.h>
 #include <stdlib.h>
 #include <time.h>
+#include <sys/time.h>
+#include <inttypes.h>
 
 #include "expression_emote.h"
 #include "esp_mmap_assets.h"
@@ -18,29 +20,71 @@
 #include "emote_defs.h"
 #include "emote_table.h"
 #include "emote_layout.h"
+#include "emote_batch.h"
+#include "emote_digits.h"
+#include "emote_strip.h"
+#include "emote_perf.h"
+#include "emote_trace.h"
+#include "emote_record.h"
 
 // ===== Constants and Macros =====
 static const char *TAG = "Expression_op";
 
-#define HIDE_OBJ(handle, obj_type) do { \
-    gfx_obj_t *obj = (handle)->def_objects[obj_type].obj; \
-    if (obj) gfx_obj_set_visible(obj, false); \
-} while(0)
+#define HIDE_OBJ(handle, obj_type)  emote_apply_visible((handle), (obj_type), false)
+#define SHOW_OBJ(handle, obj_type)  emote_apply_visible((handle), (obj_type), true)
 
-#define SHOW_OBJ(handle, obj_type) do { \
-    gfx_obj_t *obj = (handle)->def_objects[obj_type].obj; \
-    if (obj) gfx_obj_set_visible(obj, true); \
-} while(0)
+#define OBJ_BIT(obj_type)           (1UL << (obj_type))
 
-#define EVENT_TABLE_SIZE (sizeof(event_table) / sizeof(event_table[0]))
+// Elements hidden by events that replace the UI, unless their handler shows them again
+#define EVENT_HIDE_MASK             (OBJ_BIT(EMOTE_DEF_OBJ_ANIM_LISTEN) | OBJ_BIT(EMOTE_DEF_OBJ_LABEL_CLOCK) | \
+                                     OBJ_BIT(EMOTE_DEF_OBJ_LABEL_TOAST) | OBJ_BIT(EMOTE_DEF_OBJ_LABEL_BATTERY) | \
+                                     OBJ_BIT(EMOTE_DEF_OBJ_ICON_CHARGE) | OBJ_BIT(EMOTE_DEF_OBJ_ICON_STATUS) | \
+                                     OBJ_BIT(EMOTE_DEF_OBJ_QRCODE) | OBJ_BIT(EMOTE_DEF_OBJ_LEBAL_DEFAULT))
+
+_Static_assert(EMOTE_DEF_OBJ_MAX <= 32, "Visibility masks hold one bit per default object");
+
+#define ICON_BIT(icon)              (1UL << (icon))
+#define ICONS_BAT                   (ICON_BIT(EMOTE_BUILTIN_ICON_BATTERY_BG) | ICON_BIT(EMOTE_BUILTIN_ICON_BATTERY_CHARGE))
+#define ICONS_LISTEN                (ICON_BIT(EMOTE_BUILTIN_ICON_LISTEN) | ICON_BIT(EMOTE_BUILTIN_ICON_MIC))
+
+/*
+ * Event table as an X-macro: id, name, hash key, handler, skip_hide_ui, icons.
+ * Names are "evt_<name>" and the sixth character (the hash key) is unique, so a
+ * name resolves with one table index and a single strcmp to confirm it. C cannot
+ * index a string literal in a constant expression, so keys matching their names is
+ * checked by "Test event names resolve" in host_test/unit_test.
+ * Icons are the built-in icons the handler may show, staged before the lock is taken.
+ */
+#define EVENT_LIST(X) \
+    X(EMOTE_EVENT_IDLE,   EMOTE_MGR_EVT_IDLE,   'd', emote_handle_idle_event,    false, ICONS_BAT) \
+    X(EMOTE_EVENT_SPEAK,  EMOTE_MGR_EVT_SPEAK,  'p', emote_handle_speak_event,   false, ICON_BIT(EMOTE_BUILTIN_ICON_SPEAKER)) \
+    X(EMOTE_EVENT_LISTEN, EMOTE_MGR_EVT_LISTEN, 'i', emote_handle_listen_event,  false, ICONS_LISTEN) \
+    X(EMOTE_EVENT_SYS,    EMOTE_MGR_EVT_SYS,    'y', emote_handle_sys_set_event, false, ICON_BIT(EMOTE_BUILTIN_ICON_TIPS)) \
+    X(EMOTE_EVENT_SET,    EMOTE_MGR_EVT_SET,    'e', emote_handle_sys_set_event, false, ICON_BIT(EMOTE_BUILTIN_ICON_TIPS)) \
+    X(EMOTE_EVENT_BAT,    EMOTE_MGR_EVT_BAT,    'a', emote_handle_bat_event,     true,  ICONS_BAT) \
+    X(EMOTE_EVENT_OFF,    EMOTE_MGR_EVT_OFF,    'f', emote_handle_off_event,     false, 0)
+
+#define EVENT_HASH_POS              5
+#define EVENT_HASH_SLOTS            32
+#define EVENT_HASH(c)               ((uint8_t)(c) & (EVENT_HASH_SLOTS - 1))
+
+#define EVENT_ENTRY(id, name, key, handler, skip, icons)    [id] = { name, handler, skip, icons },
+#define EVENT_SLOT(id, name, key, handler, skip, icons)     [EVENT_HASH(key)] = (id) + 1,
+#define EVENT_COUNT(id, name, key, handler, skip, icons)    + 1
+#define EVENT_BIT_OR(id, name, key, handler, skip, icons)   | (1ULL << EVENT_HASH(key))
+#define EVENT_BIT_SUM(id, name, key, handler, skip, icons)  + (1ULL << EVENT_HASH(key))
+
+_Static_assert((0 EVENT_LIST(EVENT_COUNT)) == EMOTE_EVENT_MAX, "Event table does not cover emote_event_t");
+_Static_assert((0 EVENT_LIST(EVENT_BIT_OR)) == (0 EVENT_LIST(EVENT_BIT_SUM)), "Event hash keys collide");
 
 // ===== Type Definitions =====
-typedef esp_err_t (*emote_event_handler_t)(emote_handle_t handle, const char *message);
+typedef esp_err_t (*emote_event_handler_t)(emote_handle_t handle, const char *message, emote_event_icons_t *icons);
 
 typedef struct {
     const char *event_name;
     emote_event_handler_t handler;
     bool skip_hide_ui;
+    uint32_t icons;                    // Built-in icons the handler may show, bit per emote_builtin_icon_t
 } emote_event_entry_t;
 
 // ===== Static Function Declarations =====
@@ -49,33 +93,56 @@ static void **emote_get_cache_ptr_by_obj_type(emote_handle_t handle, emote_obj_t
 static gfx_image_dsc_t *emote_get_img_dsc_by_obj_type(emote_handle_t handle, emote_obj_type_t obj_type);
 static void emote_set_eye_hidden(emote_handle_t handle, bool hidden);
 
+// Change detection helpers (gfx lock held)
+static void emote_apply_visible(emote_handle_t handle, emote_obj_type_t obj_type, bool visible);
+static void emote_stage_visible_begin(emote_handle_t handle, uint32_t hide_mask);
+static void emote_stage_visible_commit(emote_handle_t handle);
+static void emote_apply_text(emote_handle_t handle, emote_obj_type_t obj_type, const char *text);
+
 // UI helper functions
-static esp_err_t emote_set_icon_image(emote_handle_t handle, emote_obj_type_t obj_type, const char *name, bool visible);
+static esp_err_t emote_set_icon_image(emote_handle_t handle, emote_obj_type_t obj_type, emote_builtin_icon_t icon_id, bool visible,
+                                      emote_event_icons_t *icons);
 static esp_err_t emote_set_label_text(emote_handle_t handle, emote_obj_type_t obj_type, const char *text);
-static esp_err_t emote_set_emoji_animation(emote_handle_t handle, emote_obj_type_t obj_type, const char *name);
+static esp_err_t emote_set_emoji_animation(emote_handle_t handle, emote_obj_type_t obj_type, const emoji_data_t *emoji);
 static esp_err_t emote_set_icon_animation(emote_handle_t handle, emote_obj_type_t obj_type,
-        const char *name, uint8_t fps, bool loop);
+        emote_builtin_icon_t icon_id, uint8_t fps, bool loop, emote_event_icons_t *icons);
+static const void *emote_take_event_icon(emote_handle_t handle, emote_event_icons_t *icons, emote_builtin_icon_t icon_id,
+        const icon_data_t *icon, void **staged);
+static esp_err_t emote_show_bat_status(emote_handle_t handle, emote_event_icons_t *icons);
+
+// Dialog helpers, shared by the public setters without logging the call again
+static esp_err_t emote_show_dialog_anim(emote_handle_t handle, const char *name);
+static esp_err_t emote_close_dialog_anim(emote_handle_t handle);
 
 // Event handler functions
-static esp_err_t emote_handle_idle_event(emote_handle_t handle, const char *message);
-static esp_err_t emote_handle_listen_event(emote_handle_t handle, const char *message);
-static esp_err_t emote_handle_speak_event(emote_handle_t handle, const char *message);
-static esp_err_t emote_handle_sys_set_event(emote_handle_t handle, const char *message);
-static esp_err_t emote_handle_off_event(emote_handle_t handle, const char *message);
-static esp_err_t emote_handle_bat_event(emote_handle_t handle, const char *message);
+static esp_err_t emote_handle_idle_event(emote_handle_t handle, const char *message, emote_event_icons_t *icons);
+static esp_err_t emote_handle_listen_event(emote_handle_t handle, const char *message, emote_event_icons_t *icons);
+static esp_err_t emote_handle_speak_event(emote_handle_t handle, const char *message, emote_event_icons_t *icons);
+static esp_err_t emote_handle_sys_set_event(emote_handle_t handle, const char *message, emote_event_icons_t *icons);
+static esp_err_t emote_handle_off_event(emote_handle_t handle, const char *message, emote_event_icons_t *icons);
+static esp_err_t emote_handle_bat_event(emote_handle_t handle, const char *message, emote_event_icons_t *icons);
 
 // Timer callback
 static void emote_dialog_timer_cb(void *data);
 
 // ===== Static Variables =====
-static const emote_event_entry_t event_table[] = {
-    { EMOTE_MGR_EVT_IDLE,   emote_handle_idle_event,    false },
-    { EMOTE_MGR_EVT_LISTEN, emote_handle_listen_event,  false },
-    { EMOTE_MGR_EVT_SPEAK,  emote_handle_speak_event,   false },
-    { EMOTE_MGR_EVT_SYS,    emote_handle_sys_set_event, false },
-    { EMOTE_MGR_EVT_SET,    emote_handle_sys_set_event, false },
-    { EMOTE_MGR_EVT_BAT,    emote_handle_bat_event,     true  },
-    { EMOTE_MGR_EVT_OFF,    emote_handle_off_event,     false  },
+static const emote_event_entry_t event_table[EMOTE_EVENT_MAX] = {
+    EVENT_LIST(EVENT_ENTRY)
+};
+
+// Event id + 1 by hash key, 0 for no event
+static const uint8_t event_slots[EVENT_HASH_SLOTS] = {
+    EVENT_LIST(EVENT_SLOT)
+};
+
+// Object that shows each built-in icon
+static const emote_obj_type_t builtin_icon_objs[EMOTE_BUILTIN_ICON_MAX] = {
+    [EMOTE_BUILTIN_ICON_MIC]            = EMOTE_DEF_OBJ_ICON_STATUS,
+    [EMOTE_BUILTIN_ICON_TIPS]           = EMOTE_DEF_OBJ_ICON_STATUS,
+    [EMOTE_BUILTIN_ICON_LISTEN]         = EMOTE_DEF_OBJ_ANIM_LISTEN,
+    [EMOTE_BUILTIN_ICON_SPEAKER]        = EMOTE_DEF_OBJ_ICON_STATUS,
+    [EMOTE_BUILTIN_ICON_BATTERY_BG]     = EMOTE_DEF_OBJ_ICON_STATUS,
+    [EMOTE_BUILTIN_ICON_BATTERY_CHARGE] = EMOTE_DEF_OBJ_ICON_CHARGE,
 };
 
 // ===== Static Function Implementations =====
@@ -139,17 +206,104 @@ static void emote_set_eye_hidden(emote_handle_t handle, bool hidden)
         return;
     }
 
-    gfx_emote_lock(handle->gfx_handle);
+    EMOTE_GFX_LOCK(handle);
     if (hidden) {
         HIDE_OBJ(handle, EMOTE_DEF_OBJ_ANIM_EYE);
     } else {
         SHOW_OBJ(handle, EMOTE_DEF_OBJ_ANIM_EYE);
     }
-    gfx_emote_unlock(handle->gfx_handle);
+    EMOTE_GFX_UNLOCK(handle);
+}
+
+// Change detection helpers
+static void emote_apply_visible(emote_handle_t handle, emote_obj_type_t obj_type, bool visible)
+{
+    emote_def_obj_entry_t *entry = &handle->def_objects[obj_type];
+    if (!entry->obj) {
+        return;
+    }
+
+    // Inside an event: only the final visibility is applied
+    if (handle->vis_staging) {
+        handle->vis_staged |= OBJ_BIT(obj_type);
+        handle->vis_target = visible ? (handle->vis_target | OBJ_BIT(obj_type)) : (handle->vis_target & ~OBJ_BIT(obj_type));
+        return;
+    }
+
+    if (entry->state.visible_known && entry->state.visible == visible) {
+        handle->update_stats.visible_skipped++;
+        return;
+    }
+
+    gfx_obj_set_visible(entry->obj, visible);
+    emote_digits_set_visible(entry->digits, visible);
+    emote_strip_set_visible(entry->strip, visible);
+    entry->state.visible_known = true;
+    entry->state.visible = visible;
+    handle->update_stats.visible_updates++;
+}
+
+// Start collecting visibility changes, with the objects in hide_mask targeted hidden
+static void emote_stage_visible_begin(emote_handle_t handle, uint32_t hide_mask)
+{
+    handle->vis_staging = true;
+    handle->vis_staged = hide_mask;
+    handle->vis_target = 0;
+}
+
+// Apply the staged visibility; objects already in their target state are not touched
+static void emote_stage_visible_commit(emote_handle_t handle)
+{
+    uint32_t staged = handle->vis_staged;
+
+    handle->vis_staging = false;
+    handle->vis_staged = 0;
+    for (int type = 0; type < EMOTE_DEF_OBJ_MAX; type++) {
+        if (staged & OBJ_BIT(type)) {
+            emote_apply_visible(handle, (emote_obj_type_t)type, (handle->vis_target & OBJ_BIT(type)) != 0);
+        }
+    }
+}
+
+static void emote_apply_text(emote_handle_t handle, emote_obj_type_t obj_type, const char *text)
+{
+    emote_def_obj_entry_t *entry = &handle->def_objects[obj_type];
+
+    if (entry->state.text && strcmp(entry->state.text, text) == 0) {
+        handle->update_stats.text_skipped++;
+        return;
+    }
+
+    if (entry->digits) {
+        emote_digits_set_text(entry->digits, text);
+    } else if (entry->strip) {
+        emote_strip_set_text(entry->strip, text);
+    } else {
+        gfx_label_set_text(entry->obj, text);
+    }
+    free(entry->state.text);
+    entry->state.text = strdup(text);   // NULL only disables the next comparison
+    handle->update_stats.text_updates++;
 }
 
 // UI helper functions
-static esp_err_t emote_set_icon_image(emote_handle_t handle, emote_obj_type_t obj_type, const char *name, bool visible)
+
+// Icon data staged by the event, or copied now if the event did not stage it
+static const void *emote_take_event_icon(emote_handle_t handle, emote_event_icons_t *icons, emote_builtin_icon_t icon_id,
+        const icon_data_t *icon, void **staged)
+{
+    if (icons && icons->src[icon_id]) {
+        const void *src_data = icons->src[icon_id];
+        *staged = icons->staged[icon_id];
+        icons->src[icon_id] = NULL;
+        icons->staged[icon_id] = NULL;
+        return src_data;
+    }
+    return emote_stage_data(handle, icon->data, icon->size, staged);
+}
+
+static esp_err_t emote_set_icon_image(emote_handle_t handle, emote_obj_type_t obj_type, emote_builtin_icon_t icon_id, bool visible,
+                                      emote_event_icons_t *icons)
 {
     esp_err_t ret = ESP_OK;
     icon_data_t *icon = NULL;
@@ -157,78 +311,112 @@ static esp_err_t emote_set_icon_image(emote_handle_t handle, emote_obj_type_t ob
     void **cache_ptr = NULL;
     gfx_image_dsc_t *img_dsc = NULL;
     const void *src_data = NULL;
+    void *staged = NULL;
+    void *old = NULL;
 
-    ESP_GOTO_ON_FALSE(handle && name, ESP_ERR_INVALID_ARG, error, TAG, "Invalid parameters");
+    ESP_GOTO_ON_FALSE(handle, ESP_ERR_INVALID_ARG, error, TAG, "Invalid parameters");
 
-    ret = emote_get_icon_data_by_name(handle, name, &icon);
-    ESP_GOTO_ON_FALSE(ret == ESP_OK, ret, error, TAG, "Not found:\"%s\"", name);
+    ret = emote_get_builtin_icon(handle, icon_id, &icon);
+    if (ret != ESP_OK) {
+        goto error;
+    }
 
     obj = handle->def_objects[obj_type].obj;
     ESP_GOTO_ON_FALSE(obj, ESP_ERR_INVALID_STATE, error, TAG, "object not found");
 
     ESP_GOTO_ON_FALSE(icon->data, ESP_ERR_INVALID_STATE, error, TAG, "icon.data is null");
 
+    EMOTE_GFX_LOCK(handle);
     cache_ptr = emote_get_cache_ptr_by_obj_type(handle, obj_type);
-    ESP_GOTO_ON_FALSE(cache_ptr, ESP_ERR_INVALID_STATE, error, TAG, "Failed to get cache pointer for object type %d", obj_type);
+    ESP_GOTO_ON_FALSE(cache_ptr, ESP_ERR_INVALID_STATE, error_unlock, TAG, "Failed to get cache pointer for object type %d", obj_type);
 
     img_dsc = emote_get_img_dsc_by_obj_type(handle, obj_type);
-    ESP_GOTO_ON_FALSE(img_dsc, ESP_ERR_INVALID_STATE, error, TAG, "Failed to get image descriptor for object type %d", obj_type);
+    ESP_GOTO_ON_FALSE(img_dsc, ESP_ERR_INVALID_STATE, error_unlock, TAG, "Failed to get image descriptor for object type %d", obj_type);
 
-    gfx_emote_lock(handle->gfx_handle);
-    src_data = emote_acquire_data(handle, icon->data, icon->size, cache_ptr);
-    ESP_GOTO_ON_FALSE(src_data, ESP_ERR_INVALID_STATE, error_unlock, TAG, "Failed to acquire icon data");
-
-    memcpy(&img_dsc->header, src_data, sizeof(gfx_image_header_t));
-    img_dsc->data = (const uint8_t *)src_data + sizeof(gfx_image_header_t);
-    img_dsc->data_size = icon->size - sizeof(gfx_image_header_t);
+    emote_obj_state_t *state = &handle->def_objects[obj_type].state;
+    if (state->src == icon->data) {
+        // Same icon: keep the acquired copy and avoid invalidating the area
+        handle->update_stats.src_skipped++;
+    } else {
+        src_data = emote_take_event_icon(handle, icons, icon_id, icon, &staged);
+        ESP_GOTO_ON_FALSE(src_data, ESP_ERR_INVALID_STATE, error_unlock, TAG, "Failed to acquire icon data");
+        old = emote_swap_data(cache_ptr, staged);
+        staged = NULL;
+
+        memcpy(&img_dsc->header, src_data, sizeof(gfx_image_header_t));
+        img_dsc->data = (const uint8_t *)src_data + sizeof(gfx_image_header_t);
+        img_dsc->data_size = icon->size - sizeof(gfx_image_header_t);
+
+        gfx_img_set_src(obj, img_dsc);
+        state->src = icon->data;
+        handle->update_stats.src_updates++;
+    }
+    emote_apply_visible(handle, obj_type, visible);
+    EMOTE_GFX_UNLOCK(handle);
 
-    gfx_img_set_src(obj, img_dsc);
-    gfx_obj_set_visible(obj, visible);
-    gfx_emote_unlock(handle->gfx_handle);
+    emote_release_data(handle, old);
     return ESP_OK;
 
 error_unlock:
-    gfx_emote_unlock(handle->gfx_handle);
+    EMOTE_GFX_UNLOCK(handle);
 
 error:
+    emote_release_data(handle, staged);
     return ret;
 }
 
 static esp_err_t emote_set_icon_animation(emote_handle_t handle, emote_obj_type_t obj_type,
-        const char *name, uint8_t fps, bool loop)
+        emote_builtin_icon_t icon_id, uint8_t fps, bool loop, emote_event_icons_t *icons)
 {
     esp_err_t ret = ESP_OK;
     icon_data_t *icon = NULL;
     gfx_obj_t *obj = NULL;
     void **cache_ptr = NULL;
     const void *src_data = NULL;
+    void *staged = NULL;
+    void *old = NULL;
 
-    ESP_GOTO_ON_FALSE(handle && name, ESP_ERR_INVALID_ARG, error, TAG, "Invalid parameters");
+    ESP_GOTO_ON_FALSE(handle, ESP_ERR_INVALID_ARG, error, TAG, "Invalid parameters");
 
-    ret = emote_get_icon_data_by_name(handle, name, &icon);
-    ESP_GOTO_ON_FALSE(ret == ESP_OK, ret, error, TAG, "Not found:\"%s\"", name);
+    ret = emote_get_builtin_icon(handle, icon_id, &icon);
+    if (ret != ESP_OK) {
+        goto error;
+    }
 
     obj = handle->def_objects[obj_type].obj;
     ESP_GOTO_ON_FALSE(obj, ESP_ERR_INVALID_STATE, error, TAG, "Object not found");
 
+    EMOTE_GFX_LOCK(handle);
     cache_ptr = emote_get_cache_ptr_by_obj_type(handle, obj_type);
-    ESP_GOTO_ON_FALSE(cache_ptr, ESP_ERR_INVALID_STATE, error, TAG, "Failed to get cache pointer for object type %d", obj_type);
+    ESP_GOTO_ON_FALSE(cache_ptr, ESP_ERR_INVALID_STATE, error_unlock, TAG, "Failed to get cache pointer for object type %d", obj_type);
 
-    gfx_emote_lock(handle->gfx_handle);
-    src_data = emote_acquire_data(handle, icon->data, icon->size, cache_ptr);
-    ESP_GOTO_ON_FALSE(src_data, ESP_ERR_INVALID_STATE, error_unlock, TAG, "Failed to acquire animation data");
+    emote_obj_state_t *state = &handle->def_objects[obj_type].state;
+    if (loop && state->src == icon->data) {
+        // Same looping animation keeps playing; restarting it would only cause a redraw
+        handle->update_stats.src_skipped++;
+    } else {
+        src_data = emote_take_event_icon(handle, icons, icon_id, icon, &staged);
+        ESP_GOTO_ON_FALSE(src_data, ESP_ERR_INVALID_STATE, error_unlock, TAG, "Failed to acquire animation data");
+        old = emote_swap_data(cache_ptr, staged);
+        staged = NULL;
+
+        gfx_anim_set_src(obj, src_data, icon->size);
+        gfx_anim_set_segment(obj, 0, 0xFFFF, fps, loop);
+        gfx_anim_start(obj);
+        state->src = loop ? icon->data : NULL;
+        handle->update_stats.src_updates++;
+    }
+    emote_apply_visible(handle, obj_type, true);
+    EMOTE_GFX_UNLOCK(handle);
 
-    gfx_anim_set_src(obj, src_data, icon->size);
-    gfx_anim_set_segment(obj, 0, 0xFFFF, fps, loop);
-    gfx_anim_start(obj);
-    gfx_obj_set_visible(obj, true);
-    gfx_emote_unlock(handle->gfx_handle);
+    emote_release_data(handle, old);
     return ESP_OK;
 
 error_unlock:
-    gfx_emote_unlock(handle->gfx_handle);
+    EMOTE_GFX_UNLOCK(handle);
 
 error:
+    emote_release_data(handle, staged);
     return ret;
 }
 
@@ -236,20 +424,21 @@ static esp_err_t emote_set_label_text(emote_handle_t handle, emote_obj_type_t ob
                                       const char *text)
 {
     esp_err_t ret = ESP_OK;
-    gfx_obj_t *obj = NULL;
 
     ESP_GOTO_ON_FALSE(handle, ESP_ERR_INVALID_ARG, error, TAG, "Invalid parameters");
 
-    obj = handle->def_objects[obj_type].obj;
-    if (!obj && !(obj = handle->def_objects[EMOTE_DEF_OBJ_LEBAL_DEFAULT].obj)) {
+    if (!handle->def_objects[obj_type].obj) {
+        obj_type = EMOTE_DEF_OBJ_LEBAL_DEFAULT;
+    }
+    if (!handle->def_objects[obj_type].obj) {
         ret = ESP_ERR_INVALID_STATE;
         goto error;
     }
 
-    gfx_emote_lock(handle->gfx_handle);
-    gfx_label_set_text(obj, text ? text : "");
-    gfx_obj_set_visible(obj, true);
-    gfx_emote_unlock(handle->gfx_handle);
+    EMOTE_GFX_LOCK(handle);
+    emote_apply_text(handle, obj_type, text ? text : "");
+    emote_apply_visible(handle, obj_type, true);
+    EMOTE_GFX_UNLOCK(handle);
     return ESP_OK;
 
 error:
@@ -257,54 +446,64 @@ error:
 }
 
 static esp_err_t emote_set_emoji_animation(emote_handle_t handle, emote_obj_type_t obj_type,
-        const char *name)
+        const emoji_data_t *emoji)
 {
     esp_err_t ret = ESP_OK;
-    emoji_data_t *emoji = NULL;
     gfx_obj_t *obj = NULL;
     void **cache_ptr = NULL;
     const void *src_data = NULL;
+    void *staged = NULL;
+    void *old = NULL;
 
-    ESP_GOTO_ON_FALSE(handle && name, ESP_ERR_INVALID_ARG, error, TAG, "Invalid parameters");
+    ESP_GOTO_ON_FALSE(handle && emoji, ESP_ERR_INVALID_ARG, error, TAG, "Invalid parameters");
 
-    ret = emote_get_emoji_data_by_name(handle, name, &emoji);
-    ESP_GOTO_ON_FALSE(ret == ESP_OK, ret, error, TAG, "Not found:\"%s\"", name);
-
-    ESP_LOGD(TAG, "Setting emoji: %s (fps=%d, loop=%s)",
-             name, emoji->fps, emoji->loop ? "true" : "false");
+    ESP_LOGD(TAG, "Setting emoji: %p (fps=%d, loop=%s)",
+             emoji->data, emoji->fps, emoji->loop ? "true" : "false");
 
     obj = handle->def_objects[obj_type].obj;
-    ESP_GOTO_ON_FALSE(obj, ESP_ERR_INVALID_STATE, error, TAG, "%s object not found", name);
+    ESP_GOTO_ON_FALSE(obj, ESP_ERR_INVALID_STATE, error, TAG, "Object type %d not found", obj_type);
 
+    EMOTE_TRACE_BEGIN(start);
+    // Copy before taking the lock, so the render task keeps running meanwhile
+    src_data = emote_stage_data(handle, emoji->data, emoji->size, &staged);
+    ESP_GOTO_ON_FALSE(src_data, ESP_ERR_INVALID_STATE, error, TAG, "Failed to acquire emoji animation data");
+
+    EMOTE_GFX_LOCK(handle);
+    // Looked up under the lock: stopping the dialog frees the anim data
     cache_ptr = emote_get_cache_ptr_by_obj_type(handle, obj_type);
-    ESP_GOTO_ON_FALSE(cache_ptr, ESP_ERR_INVALID_STATE, error, TAG, "Failed to get cache pointer for object type %d", obj_type);
+    ESP_GOTO_ON_FALSE(cache_ptr, ESP_ERR_INVALID_STATE, error_unlock, TAG, "Failed to get cache pointer for object type %d", obj_type);
 
-    gfx_emote_lock(handle->gfx_handle);
-    src_data = emote_acquire_data(handle, emoji->data, emoji->size, cache_ptr);
-    ESP_GOTO_ON_FALSE(src_data, ESP_ERR_INVALID_STATE, error_unlock, TAG, "Failed to acquire %s animation data", name);
+    old = emote_swap_data(cache_ptr, staged);
 
+    // Always restarted, so selecting the current emoji again replays it
     gfx_anim_set_src(obj, src_data, emoji->size);
     gfx_anim_set_segment(obj, 0, 0xFFFF, emoji->fps > 0 ? emoji->fps : EMOTE_DEF_ANIMATION_FPS, emoji->loop);
     gfx_anim_start(obj);
-    gfx_obj_set_visible(obj, true);
+    handle->def_objects[obj_type].state.src = emoji->data;
+    handle->update_stats.src_updates++;
+    emote_apply_visible(handle, obj_type, true);
+
+    EMOTE_GFX_UNLOCK(handle);
+    EMOTE_TRACE_END(handle, obj_type == EMOTE_DEF_OBJ_ANIM_EYE ? "emoji" : "dialog", start, obj_type);
 
-    gfx_emote_unlock(handle->gfx_handle);
+    emote_release_data(handle, old);
     return ESP_OK;
 
 error_unlock:
-    gfx_emote_unlock(handle->gfx_handle);
+    EMOTE_GFX_UNLOCK(handle);
 
 error:
+    emote_release_data(handle, staged);
     return ret;
 }
 
 // Event handler functions
-static esp_err_t emote_handle_idle_event(emote_handle_t handle, const char *message)
+static esp_err_t emote_handle_idle_event(emote_handle_t handle, const char *message, emote_event_icons_t *icons)
 {
     (void)message;
     esp_err_t ret = ESP_OK;
 
-    ret = emote_set_bat_status(handle);
+    ret = emote_show_bat_status(handle, icons);
     if (ret != ESP_OK) {
         ESP_LOGW(TAG, "Failed to set battery status");
     }
@@ -317,22 +516,22 @@ static esp_err_t emote_handle_idle_event(emote_handle_t handle, const char *mess
     return ESP_OK;
 }
 
-static esp_err_t emote_handle_listen_event(emote_handle_t handle, const char *message)
+static esp_err_t emote_handle_listen_event(emote_handle_t handle, const char *message, emote_event_icons_t *icons)
 {
     (void)message;
     esp_err_t ret = ESP_OK;
 
-    ret = emote_set_icon_animation(handle, EMOTE_DEF_OBJ_ANIM_LISTEN, EMOTE_ICON_LISTEN, 15, true);
+    ret = emote_set_icon_animation(handle, EMOTE_DEF_OBJ_ANIM_LISTEN, EMOTE_BUILTIN_ICON_LISTEN, 15, true, icons);
     if (ret != ESP_OK) {
         ESP_LOGW(TAG, "Failed to set listen animation");
     }
 
-    ret = emote_set_icon_image(handle, EMOTE_DEF_OBJ_ICON_STATUS, EMOTE_ICON_MIC, true);
+    ret = emote_set_icon_image(handle, EMOTE_DEF_OBJ_ICON_STATUS, EMOTE_BUILTIN_ICON_MIC, true, icons);
 
     return ret;
 }
 
-static esp_err_t emote_handle_speak_event(emote_handle_t handle, const char *message)
+static esp_err_t emote_handle_speak_event(emote_handle_t handle, const char *message, emote_event_icons_t *icons)
 {
     esp_err_t ret = ESP_OK;
 
@@ -341,19 +540,19 @@ static esp_err_t emote_handle_speak_event(emote_handle_t handle, const char *mes
         ESP_LOGW(TAG, "Failed to set label text");
     }
 
-    ret = emote_set_icon_image(handle, EMOTE_DEF_OBJ_ICON_STATUS, EMOTE_ICON_SPEAKER, true);
+    ret = emote_set_icon_image(handle, EMOTE_DEF_OBJ_ICON_STATUS, EMOTE_BUILTIN_ICON_SPEAKER, true, icons);
 
     gfx_obj_t *obj = handle->def_objects[EMOTE_DEF_OBJ_LABEL_TOAST].obj;
     if (obj) {
-        gfx_emote_lock(handle->gfx_handle);
+        EMOTE_GFX_LOCK(handle);
         gfx_label_set_snap_loop(obj, false);
-        gfx_emote_unlock(handle->gfx_handle);
+        EMOTE_GFX_UNLOCK(handle);
     }
 
     return ret;
 }
 
-static esp_err_t emote_handle_sys_set_event(emote_handle_t handle, const char *message)
+static esp_err_t emote_handle_sys_set_event(emote_handle_t handle, const char *message, emote_event_icons_t *icons)
 {
     esp_err_t ret = ESP_OK;
 
@@ -362,26 +561,26 @@ static esp_err_t emote_handle_sys_set_event(emote_handle_t handle, const char *m
         ESP_LOGW(TAG, "Failed to set label text");
     }
 
-    ret = emote_set_icon_image(handle, EMOTE_DEF_OBJ_ICON_STATUS, EMOTE_ICON_TIPS, true);
+    ret = emote_set_icon_image(handle, EMOTE_DEF_OBJ_ICON_STATUS, EMOTE_BUILTIN_ICON_TIPS, true, icons);
 
     gfx_obj_t *obj = handle->def_objects[EMOTE_DEF_OBJ_LABEL_TOAST].obj;
     if (obj) {
-        gfx_emote_lock(handle->gfx_handle);
+        EMOTE_GFX_LOCK(handle);
         gfx_label_set_snap_loop(obj, true);
-        gfx_emote_unlock(handle->gfx_handle);
+        EMOTE_GFX_UNLOCK(handle);
     }
 
     return ret;
 }
 
-static esp_err_t emote_handle_off_event(emote_handle_t handle, const char *message)
+static esp_err_t emote_handle_off_event(emote_handle_t handle, const char *message, emote_event_icons_t *icons)
 {
     esp_err_t ret = ESP_OK;
     // emote_set_eye_hidden(handle, true);
     return ret;
 }
 
-static esp_err_t emote_handle_bat_event(emote_handle_t handle, const char *message)
+static esp_err_t emote_handle_bat_event(emote_handle_t handle, const char *message, emote_event_icons_t *icons)
 {
     esp_err_t ret = ESP_OK;
 
@@ -394,6 +593,60 @@ static esp_err_t emote_handle_bat_event(emote_handle_t handle, const char *messa
         handle->bat_is_charging = (message[0] == '1');
         handle->bat_percent = (percent < 0) ? 0 : (percent > 100 ? 100 : percent);
     }
+
+    // Refresh the battery display now if it is shown, instead of on a status timer tick
+    emote_obj_state_t *state = &handle->def_objects[EMOTE_DEF_OBJ_LABEL_BATTERY].state;
+    if (state->visible_known && state->visible) {
+        emote_show_bat_status(handle, icons);
+    }
+    return ESP_OK;
+
+error:
+    return ret;
+}
+
+static esp_err_t emote_show_dialog_anim(emote_handle_t handle, const char *name)
+{
+    esp_err_t ret = ESP_OK;
+    emoji_data_t *emoji = NULL;
+
+    ESP_GOTO_ON_FALSE(handle && name, ESP_ERR_INVALID_ARG, error, TAG, "Invalid parameters");
+
+    ret = emote_get_emoji_data_by_name(handle, name, &emoji);
+    ESP_GOTO_ON_FALSE(ret == ESP_OK, ret, error, TAG, "Not found:\"%s\"", name);
+
+    emote_set_eye_hidden(handle, true);
+    return emote_set_emoji_animation(handle, EMOTE_DEF_OBJ_ANIM_EMERG_DLG, emoji);
+
+error:
+    return ret;
+}
+
+static esp_err_t emote_close_dialog_anim(emote_handle_t handle)
+{
+    esp_err_t ret = ESP_OK;
+
+    ESP_GOTO_ON_FALSE(handle, ESP_ERR_INVALID_ARG, error, TAG, "Invalid parameters");
+
+    EMOTE_GFX_LOCK(handle);
+
+    // Stop and delete timer if exists
+    if (handle->dialog_timer) {
+        gfx_timer_delete(handle->gfx_handle, handle->dialog_timer);
+        handle->dialog_timer = NULL;
+    }
+
+    SHOW_OBJ(handle, EMOTE_DEF_OBJ_ANIM_EYE);
+    HIDE_OBJ(handle, EMOTE_DEF_OBJ_ANIM_EMERG_DLG);
+
+    emote_def_obj_entry_t *entry = &handle->def_objects[EMOTE_DEF_OBJ_ANIM_EMERG_DLG];
+    if (entry->data.anim) {
+        emote_release_data(handle, entry->data.anim->cache);
+        free(entry->data.anim);
+        entry->data.anim = NULL;
+    }
+    entry->state.src = NULL;
+    EMOTE_GFX_UNLOCK(handle);
     return ESP_OK;
 
 error:
@@ -408,12 +661,10 @@ static void emote_dialog_timer_cb(void *data)
         return;
     }
 
-    emote_stop_anim_dialog(handle);
+    emote_close_dialog_anim(handle);
 }
 
-// ===== Public Function Implementations =====
-
-esp_err_t emote_set_bat_status(emote_handle_t handle)
+static esp_err_t emote_show_bat_status(emote_handle_t handle, emote_event_icons_t *icons)
 {
     esp_err_t ret = ESP_OK;
 
@@ -427,12 +678,13 @@ esp_err_t emote_set_bat_status(emote_handle_t handle)
             ESP_LOGW(TAG, "Failed to set battery label");
         }
 
-        ret = emote_set_icon_image(handle, EMOTE_DEF_OBJ_ICON_STATUS, EMOTE_ICON_BATTERY_BG, true);
+        ret = emote_set_icon_image(handle, EMOTE_DEF_OBJ_ICON_STATUS, EMOTE_BUILTIN_ICON_BATTERY_BG, true, icons);
         if (ret != ESP_OK) {
             ESP_LOGW(TAG, "Failed to set battery background icon");
         }
 
-        ret = emote_set_icon_image(handle, EMOTE_DEF_OBJ_ICON_CHARGE, EMOTE_ICON_BATTERY_CHARGE, handle->bat_is_charging);
+        ret = emote_set_icon_image(handle, EMOTE_DEF_OBJ_ICON_CHARGE, EMOTE_BUILTIN_ICON_BATTERY_CHARGE, handle->bat_is_charging,
+                                   icons);
         if (ret != ESP_OK) {
             ESP_LOGW(TAG, "Failed to set battery charge icon");
         }
@@ -443,6 +695,47 @@ error:
     return ret;
 }
 
+// ===== Public Function Implementations =====
+
+esp_err_t emote_set_bat_status(emote_handle_t handle)
+{
+    return emote_show_bat_status(handle, NULL);
+}
+
+void emote_stage_event_icons(emote_handle_t handle, emote_event_t event, emote_event_icons_t *icons)
+{
+    memset(icons, 0, sizeof(*icons));
+    if (!handle || (unsigned)event >= EMOTE_EVENT_MAX || emote_batch_is_recording(handle)) {
+        return;
+    }
+
+    for (int i = 0; i < EMOTE_BUILTIN_ICON_MAX; i++) {
+        icon_data_t *icon = NULL;
+        if (!(event_table[event].icons & ICON_BIT(i)) || emote_get_builtin_icon(handle, i, &icon) != ESP_OK || !icon->data) {
+            continue;
+        }
+        if ((i == EMOTE_BUILTIN_ICON_BATTERY_BG || i == EMOTE_BUILTIN_ICON_BATTERY_CHARGE) && handle->bat_percent < 0) {
+            continue;
+        }
+
+        // Unlocked peek: a stale read only costs a copy the handler won't use
+        emote_def_obj_entry_t *entry = &handle->def_objects[builtin_icon_objs[i]];
+        if (!entry->obj || entry->state.src == icon->data) {
+            continue;
+        }
+        icons->src[i] = emote_stage_data(handle, icon->data, icon->size, &icons->staged[i]);
+    }
+}
+
+void emote_release_event_icons(emote_handle_t handle, emote_event_icons_t *icons)
+{
+    for (int i = 0; i < EMOTE_BUILTIN_ICON_MAX; i++) {
+        emote_release_data(handle, icons->staged[i]);
+        icons->src[i] = NULL;
+        icons->staged[i] = NULL;
+    }
+}
+
 esp_err_t emote_set_label_clock(emote_handle_t handle)
 {
     esp_err_t ret = ESP_OK;
@@ -465,14 +758,23 @@ esp_err_t emote_set_label_clock(emote_handle_t handle)
     char time_str[10];
     snprintf(time_str, sizeof(time_str), "%02d:%02d", timeinfo.tm_hour, timeinfo.tm_min);
 
-    gfx_emote_lock(handle->gfx_handle);
-    gfx_label_set_text(obj, time_str);
-    gfx_obj_set_visible(obj, true);
+    // Next wake on the next wall-clock multiple of the period, e.g. the next minute
+    uint32_t period = handle->status_period_ms ? handle->status_period_ms : EMOTE_DEF_STATUS_PERIOD_MS;
+    struct timeval tv;
+    gettimeofday(&tv, NULL);
+    uint64_t now_ms = (uint64_t)tv.tv_sec * 1000 + tv.tv_usec / 1000;
+    uint32_t delay_ms = period - (uint32_t)(now_ms % period);
+
+    EMOTE_GFX_LOCK(handle);
+    emote_apply_text(handle, EMOTE_DEF_OBJ_LABEL_CLOCK, time_str);
+    emote_apply_visible(handle, EMOTE_DEF_OBJ_LABEL_CLOCK, true);
 
+    gfx_timer_set_period(timer, delay_ms);
+    gfx_timer_reset(timer);
     if (!gfx_timer_is_running(timer)) {
         gfx_timer_resume(timer);
     }
-    gfx_emote_unlock(handle->gfx_handle);
+    EMOTE_GFX_UNLOCK(handle);
     return ESP_OK;
 
 error:
@@ -481,113 +783,144 @@ error:
 
 esp_err_t emote_set_anim_emoji(emote_handle_t handle, const char *name)
 {
-    if (!handle || !name) {
-        return ESP_ERR_INVALID_ARG;
+    esp_err_t ret = ESP_OK;
+    emoji_data_t *emoji = NULL;
+
+    ESP_GOTO_ON_FALSE(handle && name, ESP_ERR_INVALID_ARG, error, TAG, "Invalid parameters");
+    EMOTE_RECORD(handle, EMOTE_RECORD_OP_EMOJI, name, NULL, 0);
+
+    if (emote_batch_is_recording(handle)) {
+        emote_asset_id_t id;
+        ret = emote_get_emoji_id(handle, name, &id);
+        ESP_GOTO_ON_FALSE(ret == ESP_OK, ret, error, TAG, "Not found:\"%s\"", name);
+        return emote_batch_record_emoji(handle, id);
     }
 
+    ret = emote_get_emoji_data_by_name(handle, name, &emoji);
+    ESP_GOTO_ON_FALSE(ret == ESP_OK, ret, error, TAG, "Not found:\"%s\"", name);
+
     emote_set_eye_hidden(handle, false);
-    return emote_set_emoji_animation(handle, EMOTE_DEF_OBJ_ANIM_EYE, name);
+    return emote_set_emoji_animation(handle, EMOTE_DEF_OBJ_ANIM_EYE, emoji);
+
+error:
+    return ret;
 }
 
-esp_err_t emote_set_dialog_anim(emote_handle_t handle, const char *name)
+esp_err_t emote_set_anim_emoji_id(emote_handle_t handle, emote_asset_id_t id)
 {
-    if (!handle || !name) {
-        return ESP_ERR_INVALID_ARG;
+    esp_err_t ret = ESP_OK;
+    emoji_data_t *emoji = NULL;
+
+    ESP_GOTO_ON_FALSE(handle, ESP_ERR_INVALID_ARG, error, TAG, "Invalid parameters");
+    EMOTE_RECORD(handle, EMOTE_RECORD_OP_EMOJI_ID, NULL, NULL, id);
+
+    ret = emote_get_emoji_data_by_id(handle, id, &emoji);
+    ESP_GOTO_ON_FALSE(ret == ESP_OK, ret, error, TAG, "Invalid emoji id: %" PRId32, id);
+
+    if (emote_batch_is_recording(handle)) {
+        return emote_batch_record_emoji(handle, id);
     }
 
-    emote_set_eye_hidden(handle, true);
-    return emote_set_emoji_animation(handle, EMOTE_DEF_OBJ_ANIM_EMERG_DLG, name);
+    emote_set_eye_hidden(handle, false);
+    return emote_set_emoji_animation(handle, EMOTE_DEF_OBJ_ANIM_EYE, emoji);
+
+error:
+    return ret;
 }
 
-esp_err_t emote_set_qrcode_data(emote_handle_t handle, const char *qrcode_text)
+esp_err_t emote_set_dialog_anim(emote_handle_t handle, const char *name)
+{
+    EMOTE_RECORD(handle, EMOTE_RECORD_OP_DIALOG, name, NULL, 0);
+    return emote_show_dialog_anim(handle, name);
+}
+
+esp_err_t emote_set_dialog_anim_id(emote_handle_t handle, emote_asset_id_t id)
 {
     esp_err_t ret = ESP_OK;
-    gfx_obj_t *obj = NULL;
+    emoji_data_t *emoji = NULL;
 
-    ESP_LOGI(TAG, "set_qrcode_data: %s", qrcode_text);
-    ESP_GOTO_ON_FALSE(handle && qrcode_text, ESP_ERR_INVALID_ARG, error, TAG, "Invalid parameters");
+    ESP_GOTO_ON_FALSE(handle, ESP_ERR_INVALID_ARG, error, TAG, "Invalid parameters");
+    EMOTE_RECORD(handle, EMOTE_RECORD_OP_DIALOG_ID, NULL, NULL, id);
 
-    obj = handle->def_objects[EMOTE_DEF_OBJ_QRCODE].obj;
-    ESP_GOTO_ON_FALSE(obj, ESP_ERR_INVALID_STATE, error, TAG, "QRCODE object not found");
+    ret = emote_get_emoji_data_by_id(handle, id, &emoji);
+    ESP_GOTO_ON_FALSE(ret == ESP_OK, ret, error, TAG, "Invalid emoji id: %" PRId32, id);
 
-    gfx_emote_lock(handle->gfx_handle);
-    gfx_qrcode_set_data(obj, qrcode_text);
-    gfx_obj_set_visible(obj, true);
-    gfx_emote_unlock(handle->gfx_handle);
-    return ESP_OK;
+    emote_set_eye_hidden(handle, true);
+    return emote_set_emoji_animation(handle, EMOTE_DEF_OBJ_ANIM_EMERG_DLG, emoji);
 
 error:
     return ret;
 }
 
-esp_err_t emote_stop_anim_dialog(emote_handle_t handle)
+esp_err_t emote_set_qrcode_data(emote_handle_t handle, const char *qrcode_text)
 {
     esp_err_t ret = ESP_OK;
+    gfx_obj_t *obj = NULL;
 
-    ESP_GOTO_ON_FALSE(handle, ESP_ERR_INVALID_ARG, error, TAG, "Invalid parameters");
-
-    gfx_emote_lock(handle->gfx_handle);
+    ESP_LOGI(TAG, "set_qrcode_data: %s", qrcode_text);
+    ESP_GOTO_ON_FALSE(handle && qrcode_text, ESP_ERR_INVALID_ARG, error, TAG, "Invalid parameters");
+    EMOTE_RECORD(handle, EMOTE_RECORD_OP_QRCODE, qrcode_text, NULL, 0);
 
-    // Stop and delete timer if exists
-    if (handle->dialog_timer) {
-        gfx_timer_delete(handle->gfx_handle, handle->dialog_timer);
-        handle->dialog_timer = NULL;
+    if (emote_batch_is_recording(handle)) {
+        return emote_batch_record_qrcode(handle, qrcode_text);
     }
 
-    SHOW_OBJ(handle, EMOTE_DEF_OBJ_ANIM_EYE);
-    HIDE_OBJ(handle, EMOTE_DEF_OBJ_ANIM_EMERG_DLG);
+    obj = handle->def_objects[EMOTE_DEF_OBJ_QRCODE].obj;
+    ESP_GOTO_ON_FALSE(obj, ESP_ERR_INVALID_STATE, error, TAG, "QRCODE object not found");
 
-    emote_def_obj_entry_t *entry = &handle->def_objects[EMOTE_DEF_OBJ_ANIM_EMERG_DLG];
-    if (entry->data.anim) {
-        if (entry->data.anim->cache) {
-            free(entry->data.anim->cache);
-        }
-        free(entry->data.anim);
-        entry->data.anim = NULL;
-    }
-    gfx_emote_unlock(handle->gfx_handle);
+    EMOTE_GFX_LOCK(handle);
+    gfx_qrcode_set_data(obj, qrcode_text);
+    emote_apply_visible(handle, EMOTE_DEF_OBJ_QRCODE, true);
+    EMOTE_GFX_UNLOCK(handle);
     return ESP_OK;
 
 error:
     return ret;
 }
 
+esp_err_t emote_stop_anim_dialog(emote_handle_t handle)
+{
+    EMOTE_RECORD(handle, EMOTE_RECORD_OP_STOP_DIALOG, NULL, NULL, 0);
+    return emote_close_dialog_anim(handle);
+}
+
 esp_err_t emote_insert_anim_dialog(emote_handle_t handle, const char *name, uint32_t duration_ms)
 {
     esp_err_t ret = ESP_OK;
     gfx_timer_handle_t timer = NULL;
 
     ESP_GOTO_ON_FALSE(handle && name, ESP_ERR_INVALID_ARG, error, TAG, "Invalid parameters");
+    EMOTE_RECORD(handle, EMOTE_RECORD_OP_INSERT_DIALOG, name, NULL, duration_ms);
 
     // Reset semaphore before starting new animation
     if (handle->emerg_dlg_done_sem) {
         xSemaphoreTake(handle->emerg_dlg_done_sem, 0); // Clear semaphore if already set
     }
 
-    gfx_emote_lock(handle->gfx_handle);
+    EMOTE_GFX_LOCK(handle);
     if (handle->dialog_timer) {
         gfx_timer_delete(handle->gfx_handle, handle->dialog_timer);
         handle->dialog_timer = NULL;
     }
-    gfx_emote_unlock(handle->gfx_handle);
+    EMOTE_GFX_UNLOCK(handle);
 
-    ret = emote_set_dialog_anim(handle, name);
+    ret = emote_show_dialog_anim(handle, name);
     ESP_GOTO_ON_FALSE(ret == ESP_OK, ret, error, TAG, "Failed to set dialog animation");
 
-    gfx_emote_lock(handle->gfx_handle);
+    EMOTE_GFX_LOCK(handle);
 
     timer = gfx_timer_create(handle->gfx_handle, emote_dialog_timer_cb, duration_ms, handle);
     ESP_GOTO_ON_FALSE(timer, ESP_ERR_NO_MEM, error_unlock, TAG, "Failed to create dialog timer");
 
     gfx_timer_set_repeat_count(timer, 1);  // Execute only once
     handle->dialog_timer = timer;
-    gfx_emote_unlock(handle->gfx_handle);
+    EMOTE_GFX_UNLOCK(handle);
 
     return ESP_OK;
 
 error_unlock:
-    gfx_emote_unlock(handle->gfx_handle);
-    emote_stop_anim_dialog(handle);
+    EMOTE_GFX_UNLOCK(handle);
+    emote_close_dialog_anim(handle);
 
 error:
     return ret;
@@ -599,13 +932,28 @@ esp_err_t emote_set_obj_visible(emote_handle_t handle, const char *name, bool vi
     gfx_obj_t *obj = NULL;
 
     ESP_GOTO_ON_FALSE(handle && name, ESP_ERR_INVALID_ARG, error, TAG, "Invalid parameters");
+    EMOTE_RECORD(handle, EMOTE_RECORD_OP_OBJ_VISIBLE, name, NULL, visible);
+
+    if (emote_batch_is_recording(handle)) {
+        return emote_batch_record_visible(handle, name, visible);
+    }
+
+    // Default objects go through change detection; looked up without handing them out
+    emote_obj_type_t obj_type = emote_get_element_type(name);
+    if (obj_type != EMOTE_DEF_OBJ_MAX) {
+        ESP_GOTO_ON_FALSE(handle->def_objects[obj_type].obj, ESP_ERR_INVALID_STATE, error, TAG, "Object not found");
+        EMOTE_GFX_LOCK(handle);
+        emote_apply_visible(handle, obj_type, visible);
+        EMOTE_GFX_UNLOCK(handle);
+        return ESP_OK;
+    }
 
     obj = emote_get_obj_by_name(handle, name);
     ESP_GOTO_ON_FALSE(obj, ESP_ERR_INVALID_STATE, error, TAG, "Object not found");
 
-    gfx_emote_lock(handle->gfx_handle);
+    EMOTE_GFX_LOCK(handle);
     gfx_obj_set_visible(obj, visible);
-    gfx_emote_unlock(handle->gfx_handle);
+    EMOTE_GFX_UNLOCK(handle);
     return ESP_OK;
 
 error:
@@ -614,55 +962,130 @@ error:
 
 esp_err_t emote_set_anim_visible(emote_handle_t handle, bool visible)
 {
+    EMOTE_RECORD(handle, EMOTE_RECORD_OP_ANIM_VISIBLE, NULL, NULL, visible);
+
+    if (emote_batch_is_recording(handle)) {
+        return emote_batch_record_visible(handle, NULL, visible);
+    }
+
     emote_set_eye_hidden(handle, !visible);
     return ESP_OK;
 }
 
+esp_err_t emote_get_event_by_name(const char *name, emote_event_t *event)
+{
+    if (!name || !event) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    if (strnlen(name, EVENT_HASH_POS + 1) <= EVENT_HASH_POS) {
+        return ESP_ERR_NOT_FOUND;
+    }
+
+    uint8_t slot = event_slots[EVENT_HASH(name[EVENT_HASH_POS])];
+    if (slot == 0 || strcmp(name, event_table[slot - 1].event_name) != 0) {
+        return ESP_ERR_NOT_FOUND;
+    }
+
+    *event = (emote_event_t)(slot - 1);
+    return ESP_OK;
+}
+
+bool emote_event_keeps_ui(emote_event_t event)
+{
+    return (unsigned)event < EMOTE_EVENT_MAX && event_table[event].skip_hide_ui;
+}
+
 esp_err_t emote_set_event_msg(emote_handle_t handle, const char *event, const char *message)
 {
     esp_err_t ret = ESP_OK;
-    const emote_event_entry_t *entry = NULL;
+    emote_event_t id;
 
     ESP_GOTO_ON_FALSE(handle && event, ESP_ERR_INVALID_ARG, error, TAG, "Invalid parameters");
+    ESP_GOTO_ON_FALSE(emote_get_event_by_name(event, &id) == ESP_OK, ESP_ERR_NOT_FOUND, error, TAG, "Unhandled event: %s", event);
 
-    ESP_LOGD(TAG, "setEventMsg: %s, message: \"%s\"", event, message ? message : "");
+    return emote_set_event(handle, id, message);
 
-    gfx_emote_lock(handle->gfx_handle);
+error:
+    return ret;
+}
 
-    // Look up event handler in table
-    for (size_t i = 0; i < EVENT_TABLE_SIZE; i++) {
-        if (strcmp(event, event_table[i].event_name) == 0) {
-            entry = &event_table[i];
-            break;
-        }
+esp_err_t emote_set_event(emote_handle_t handle, emote_event_t event, const char *message)
+{
+    EMOTE_RECORD(handle, EMOTE_RECORD_OP_EVENT, NULL, message, event);
+    return emote_apply_event(handle, event, message, NULL);
+}
+
+esp_err_t emote_apply_event(emote_handle_t handle, emote_event_t event, const char *message,
+                            emote_event_icons_t *icons)
+{
+    esp_err_t ret = ESP_OK;
+    const emote_event_entry_t *entry = NULL;
+    emote_event_icons_t local_icons;
+
+    ESP_GOTO_ON_FALSE(handle && (unsigned)event < EMOTE_EVENT_MAX, ESP_ERR_INVALID_ARG, error, TAG, "Invalid parameters");
+
+    if (emote_batch_is_recording(handle)) {
+        return emote_batch_record_event(handle, event, message);
+    }
+
+    entry = &event_table[event];
+    ESP_LOGD(TAG, "setEvent: %s, message: \"%s\"", entry->event_name, message ? message : "");
+
+    // Copy the icons out of flash before the render task is blocked
+    if (!icons) {
+        emote_stage_event_icons(handle, event, &local_icons);
+        icons = &local_icons;
+    }
+
+    EMOTE_TRACE_BEGIN(start);
+    EMOTE_GFX_LOCK(handle);
+
+    /*
+     * Events that don't skip hiding target all UI elements hidden. The handler then
+     * shows its own, and the resulting target set is applied as a diff, so elements
+     * that stay visible are never hidden and shown again.
+     */
+    if (!entry->skip_hide_ui) {
+        emote_stage_visible_begin(handle, EVENT_HIDE_MASK);
     }
 
-    ESP_GOTO_ON_FALSE(entry, ESP_ERR_NOT_FOUND, error_unlock, TAG, "Unhandled event: %s", event);
+    // Call event handler
+    ret = entry->handler(handle, message, icons);
 
-    // Hide all UI elements for events that don't skip hiding
     if (!entry->skip_hide_ui) {
-        HIDE_OBJ(handle, EMOTE_DEF_OBJ_ANIM_LISTEN);
-        HIDE_OBJ(handle, EMOTE_DEF_OBJ_LABEL_CLOCK);
-        HIDE_OBJ(handle, EMOTE_DEF_OBJ_LABEL_TOAST);
-        HIDE_OBJ(handle, EMOTE_DEF_OBJ_LABEL_BATTERY);
-        HIDE_OBJ(handle, EMOTE_DEF_OBJ_ICON_CHARGE);
-        HIDE_OBJ(handle, EMOTE_DEF_OBJ_ICON_STATUS);
-        HIDE_OBJ(handle, EMOTE_DEF_OBJ_QRCODE);
-        HIDE_OBJ(handle, EMOTE_DEF_OBJ_LEBAL_DEFAULT);
+        emote_stage_visible_commit(handle);
+
+        // The status timer only runs while the clock is shown
         gfx_timer_handle_t obj_timer = (gfx_timer_handle_t)handle->def_objects[EMOTE_DEF_OBJ_TIMER_STATUS].obj;
-        if (obj_timer) {
+        emote_def_obj_entry_t *clock = &handle->def_objects[EMOTE_DEF_OBJ_LABEL_CLOCK];
+        if (obj_timer && !(clock->state.visible_known && clock->state.visible)) {
             gfx_timer_pause(obj_timer);
         }
     }
 
-    // Call event handler
-    ret = entry->handler(handle, message);
+    EMOTE_GFX_UNLOCK(handle);
+    EMOTE_TRACE_END(handle, entry->event_name, start, event);
+
+    // Icons the handler did not take, e.g. after a failed lookup
+    if (icons == &local_icons) {
+        emote_release_event_icons(handle, icons);
+    }
 
-    gfx_emote_unlock(handle->gfx_handle);
+error:
     return ret;
+}
 
-error_unlock:
-    gfx_emote_unlock(handle->gfx_handle);
+esp_err_t emote_get_update_stats(emote_handle_t handle, emote_update_stats_t *stats)
+{
+    esp_err_t ret = ESP_OK;
+
+    ESP_GOTO_ON_FALSE(handle && stats, ESP_ERR_INVALID_ARG, error, TAG, "Invalid parameters");
+
+    EMOTE_GFX_LOCK(handle);
+    *stats = handle->update_stats;
+    EMOTE_GFX_UNLOCK(handle);
+    return ESP_OK;
 
 error:
     return ret;
@@ -676,6 +1099,8 @@ esp_err_t emote_notify_flush_finished(emote_handle_t handle)
 
     ESP_GOTO_ON_FALSE(handle->gfx_disp, ESP_ERR_INVALID_STATE, error, TAG, "GFX display handle not initialized");
 
+    EMOTE_PERF_FLUSH_DONE(handle);
+    EMOTE_TRACE_INSTANT(handle, "flush_ready", 0);
     gfx_disp_flush_ready(handle->gfx_disp, true);
     return ESP_OK;
 
@@ -707,7 +1132,7 @@ esp_err_t emote_lock(emote_handle_t handle)
 
     ESP_GOTO_ON_FALSE(handle->gfx_handle, ESP_ERR_INVALID_STATE, error, TAG, "GFX handle not initialized");
 
-    gfx_emote_lock(handle->gfx_handle);
+    EMOTE_GFX_LOCK(handle);
     return ESP_OK;
 
 error:
@@ -723,7 +1148,7 @@ esp_err_t emote_unlock(emote_handle_t handle)
 
     ESP_GOTO_ON_FALSE(handle->gfx_handle, ESP_ERR_INVALID_STATE, error, TAG, "GFX handle not initialized");
 
-    gfx_emote_unlock(handle->gfx_handle);
+    EMOTE_GFX_UNLOCK(handle);
     return ESP_OK;
 
 error:
@@ -0,0 +1,357 @@
+/*
+ * SPDX-FileCopyrightText: 2025 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "sdkconfig.h"
+#include "freertos/FreeRTOS.h"
+#include "esp_timer.h"
+#include "esp_log.h"
+#include "esp_check.h"
+#include <string.h>
+#include <stdlib.h>
+#include <stdatomic.h>
+
+#include "emote_defs.h"
+#include "emote_perf.h"
+
+static const char *TAG = "Expression_perf";
+
+#if CONFIG_EMOTE_PERF_STATS
+
+#define PERF_WINDOW             CONFIG_EMOTE_PERF_WINDOW
+#define PERF_READ_RETRIES       4
+
+/*
+ * Writers update a ring under mux; readers copy it without the mux, as a seqlock:
+ * seq is odd while a writer is inside, and a copy is kept only if seq did not move.
+ */
+typedef struct {
+    atomic_uint seq;                        // Odd while a writer updates the ring
+    uint32_t samples[PERF_WINDOW];
+    uint32_t next;                          // Slot of the next sample
+    uint32_t count;                         // Valid samples, up to PERF_WINDOW
+} emote_perf_ring_t;
+
+typedef struct {
+    const char *api;
+    emote_perf_ring_t wait;
+    emote_perf_ring_t hold;
+} emote_perf_site_t;
+
+struct emote_perf_s {
+    portMUX_TYPE mux;                       // Guards the rings and the site list
+    emote_perf_ring_t frame;
+    emote_perf_ring_t flush;
+    emote_perf_ring_t acquire;
+    emote_perf_site_t sites[EMOTE_PERF_MAX_APIS];
+    size_t site_count;
+
+    // Outermost lock, only touched by the task holding the gfx lock
+    uint32_t depth;
+    emote_perf_site_t *holder;
+    int64_t hold_start;
+
+    // Flush tracking: the render task writes flush_start, the flush ISR flush_done under mux
+    int64_t frame_start;
+    int64_t flush_start;
+    int64_t flush_done;
+    int last_y1;
+};
+
+// Both with mux held
+static void emote_perf_ring_add(emote_perf_ring_t *ring, int64_t us)
+{
+    atomic_fetch_add_explicit(&ring->seq, 1, memory_order_relaxed);
+    atomic_thread_fence(memory_order_release);
+    ring->samples[ring->next] = us < 0 ? 0 : (us > UINT32_MAX ? UINT32_MAX : (uint32_t)us);
+    ring->next = (ring->next + 1) % PERF_WINDOW;
+    if (ring->count < PERF_WINDOW) {
+        ring->count++;
+    }
+    atomic_fetch_add_explicit(&ring->seq, 1, memory_order_release);
+}
+
+static void emote_perf_ring_reset(emote_perf_ring_t *ring)
+{
+    atomic_fetch_add_explicit(&ring->seq, 1, memory_order_relaxed);
+    atomic_thread_fence(memory_order_release);
+    ring->count = 0;
+    atomic_fetch_add_explicit(&ring->seq, 1, memory_order_release);
+}
+
+// Copy the valid samples; the order does not matter, the reduction sorts them
+static void emote_perf_ring_copy(const emote_perf_ring_t *ring, emote_perf_ring_t *copy)
+{
+    uint32_t count = ring->count;
+    copy->count = count < PERF_WINDOW ? count : PERF_WINDOW;
+    memcpy(copy->samples, ring->samples, copy->count * sizeof(uint32_t));
+}
+
+static void emote_perf_add(emote_perf_t *perf, emote_perf_ring_t *ring, int64_t us)
+{
+    portENTER_CRITICAL_SAFE(&perf->mux);
+    emote_perf_ring_add(ring, us);
+    portEXIT_CRITICAL_SAFE(&perf->mux);
+}
+
+static int emote_perf_cmp(const void *a, const void *b)
+{
+    uint32_t va = *(const uint32_t *)a;
+    uint32_t vb = *(const uint32_t *)b;
+    return (va > vb) - (va < vb);
+}
+
+// Reduce a copied ring; sorts the copy in place
+static void emote_perf_reduce(emote_perf_ring_t *ring, emote_perf_metric_t *metric)
+{
+    memset(metric, 0, sizeof(*metric));
+    if (ring->count == 0) {
+        return;
+    }
+
+    uint64_t sum = 0;
+    qsort(ring->samples, ring->count, sizeof(uint32_t), emote_perf_cmp);
+    for (uint32_t i = 0; i < ring->count; i++) {
+        sum += ring->samples[i];
+    }
+
+    metric->count = ring->count;
+    metric->min_us = ring->samples[0];
+    metric->max_us = ring->samples[ring->count - 1];
+    metric->avg_us = (uint32_t)(sum / ring->count);
+    metric->p99_us = ring->samples[(ring->count * 99 + 99) / 100 - 1];
+}
+
+static void emote_perf_read(emote_perf_t *perf, emote_perf_ring_t *ring, emote_perf_ring_t *copy,
+                            emote_perf_metric_t *metric)
+{
+    bool consistent = false;
+
+    // Samples arrive once per frame or lock, so a copy racing a writer is rare
+    for (int i = 0; i < PERF_READ_RETRIES && !consistent; i++) {
+        uint32_t seq = atomic_load_explicit(&ring->seq, memory_order_acquire);
+        if (seq & 1) {
+            continue;
+        }
+        emote_perf_ring_copy(ring, copy);
+        atomic_thread_fence(memory_order_acquire);
+        consistent = (atomic_load_explicit(&ring->seq, memory_order_relaxed) == seq);
+    }
+
+    // Writers kept racing the copy; block them for this ring only
+    if (!consistent) {
+        portENTER_CRITICAL(&perf->mux);
+        emote_perf_ring_copy(ring, copy);
+        portEXIT_CRITICAL(&perf->mux);
+    }
+    emote_perf_reduce(copy, metric);
+}
+
+static emote_perf_site_t *emote_perf_site(emote_perf_t *perf, const char *api)
+{
+    emote_perf_site_t *site = NULL;
+
+    portENTER_CRITICAL(&perf->mux);
+    for (size_t i = 0; i < perf->site_count; i++) {
+        if (perf->sites[i].api == api) {
+            site = &perf->sites[i];
+            break;
+        }
+    }
+    if (!site) {
+        // Functions past the table share its last entry
+        if (perf->site_count < EMOTE_PERF_MAX_APIS) {
+            perf->site_count++;
+        }
+        site = &perf->sites[perf->site_count - 1];
+        if (!site->api) {
+            site->api = api;
+        } else if (site->api != api) {
+            site->api = "(other)";
+        }
+    }
+    portEXIT_CRITICAL(&perf->mux);
+    return site;
+}
+
+// ===== Hooks =====
+
+esp_err_t emote_perf_init(emote_handle_t handle)
+{
+    emote_perf_t *perf = (emote_perf_t *)calloc(1, sizeof(emote_perf_t));
+    ESP_RETURN_ON_FALSE(perf, ESP_ERR_NO_MEM, TAG, "Failed to allocate perf stats");
+
+    portMUX_TYPE mux = portMUX_INITIALIZER_UNLOCKED;
+    perf->mux = mux;
+    perf->last_y1 = -1;
+    handle->perf = perf;
+    return ESP_OK;
+}
+
+void emote_perf_deinit(emote_handle_t handle)
+{
+    if (!handle) {
+        return;
+    }
+
+    free(handle->perf);
+    handle->perf = NULL;
+}
+
+void emote_perf_lock(emote_handle_t handle, const char *api)
+{
+    emote_perf_t *perf = handle->perf;
+    int64_t start = esp_timer_get_time();
+
+    gfx_emote_lock(handle->gfx_handle);
+    if (!perf || perf->depth++ > 0) {
+        return;
+    }
+
+    int64_t now = esp_timer_get_time();
+    perf->holder = emote_perf_site(perf, api);
+    perf->hold_start = now;
+    emote_perf_add(perf, &perf->holder->wait, now - start);
+}
+
+void emote_perf_unlock(emote_handle_t handle)
+{
+    emote_perf_t *perf = handle->perf;
+
+    if (perf && perf->depth > 0 && --perf->depth == 0 && perf->holder) {
+        emote_perf_add(perf, &perf->holder->hold, esp_timer_get_time() - perf->hold_start);
+        perf->holder = NULL;
+    }
+    gfx_emote_unlock(handle->gfx_handle);
+}
+
+void emote_perf_flush_start(emote_handle_t handle, int y1)
+{
+    emote_perf_t *perf = handle->perf;
+    if (!perf) {
+        return;
+    }
+
+    int64_t now = esp_timer_get_time();
+    portENTER_CRITICAL(&perf->mux);
+    int64_t done = perf->flush_done;
+    perf->flush_done = 0;
+    portEXIT_CRITICAL(&perf->mux);
+    if (perf->flush_start && done >= perf->flush_start) {
+        emote_perf_add(perf, &perf->flush, done - perf->flush_start);
+    }
+
+    // Areas of a frame are flushed top to bottom; moving back up starts the next frame
+    if (y1 <= perf->last_y1 || perf->last_y1 < 0) {
+        if (perf->frame_start) {
+            emote_perf_add(perf, &perf->frame, now - perf->frame_start);
+        }
+        perf->frame_start = now;
+    }
+    perf->last_y1 = y1;
+    perf->flush_start = now;
+}
+
+void emote_perf_flush_done(emote_handle_t handle)
+{
+    emote_perf_t *perf = handle->perf;
+    if (perf) {
+        int64_t now = esp_timer_get_time();
+        // 64-bit stores are not atomic on the 32-bit targets
+        portENTER_CRITICAL_SAFE(&perf->mux);
+        perf->flush_done = now;
+        portEXIT_CRITICAL_SAFE(&perf->mux);
+    }
+}
+
+void emote_perf_add_acquire(emote_handle_t handle, int64_t us)
+{
+    if (handle->perf) {
+        emote_perf_add(handle->perf, &handle->perf->acquire, us);
+    }
+}
+
+// ===== API =====
+
+esp_err_t emote_get_perf_stats(emote_handle_t handle, emote_perf_stats_t *stats)
+{
+    esp_err_t ret = ESP_OK;
+    emote_perf_ring_t *copy = NULL;
+
+    ESP_GOTO_ON_FALSE(handle && stats, ESP_ERR_INVALID_ARG, error, TAG, "Invalid parameters");
+    ESP_GOTO_ON_FALSE(handle->perf, ESP_ERR_INVALID_STATE, error, TAG, "Perf stats not initialized");
+
+    // A ring can take a few KB, too much for the caller's stack
+    copy = (emote_perf_ring_t *)malloc(sizeof(emote_perf_ring_t));
+    ESP_GOTO_ON_FALSE(copy, ESP_ERR_NO_MEM, error, TAG, "Failed to allocate perf samples");
+
+    emote_perf_t *perf = handle->perf;
+    memset(stats, 0, sizeof(*stats));
+    emote_perf_read(perf, &perf->frame, copy, &stats->frame);
+    emote_perf_read(perf, &perf->flush, copy, &stats->flush);
+    emote_perf_read(perf, &perf->acquire, copy, &stats->acquire);
+
+    portENTER_CRITICAL(&perf->mux);
+    stats->lock_count = perf->site_count;
+    portEXIT_CRITICAL(&perf->mux);
+    for (size_t i = 0; i < stats->lock_count; i++) {
+        stats->locks[i].api = perf->sites[i].api;
+        emote_perf_read(perf, &perf->sites[i].wait, copy, &stats->locks[i].wait);
+        emote_perf_read(perf, &perf->sites[i].hold, copy, &stats->locks[i].hold);
+    }
+    free(copy);
+
+    emote_cache_stats_t cache;
+    emote_glyph_cache_stats_t glyphs;
+    if (emote_get_cache_stats(handle, &cache) == ESP_OK) {
+        stats->bytes_copied += cache.copied_bytes;
+    }
+    if (emote_get_glyph_cache_stats(handle, &glyphs) == ESP_OK) {
+        stats->bytes_copied += glyphs.read_bytes;
+    }
+    return ESP_OK;
+
+error:
+    return ret;
+}
+
+esp_err_t emote_reset_perf_stats(emote_handle_t handle)
+{
+    esp_err_t ret = ESP_OK;
+
+    ESP_GOTO_ON_FALSE(handle, ESP_ERR_INVALID_ARG, error, TAG, "Invalid parameters");
+    ESP_GOTO_ON_FALSE(handle->perf, ESP_ERR_INVALID_STATE, error, TAG, "Perf stats not initialized");
+
+    emote_perf_t *perf = handle->perf;
+    portENTER_CRITICAL(&perf->mux);
+    emote_perf_ring_reset(&perf->frame);
+    emote_perf_ring_reset(&perf->flush);
+    emote_perf_ring_reset(&perf->acquire);
+    for (size_t i = 0; i < perf->site_count; i++) {
+        emote_perf_ring_reset(&perf->sites[i].wait);
+        emote_perf_ring_reset(&perf->sites[i].hold);
+    }
+    portEXIT_CRITICAL(&perf->mux);
+    return ESP_OK;
+
+error:
+    return ret;
+}
+
+#else
+
+esp_err_t emote_get_perf_stats(emote_handle_t handle, emote_perf_stats_t *stats)
+{
+    ESP_LOGD(TAG, "CONFIG_EMOTE_PERF_STATS is disabled");
+    return ESP_ERR_NOT_SUPPORTED;
+}
+
+esp_err_t emote_reset_perf_stats(emote_handle_t handle)
+{
+    ESP_LOGD(TAG, "CONFIG_EMOTE_PERF_STATS is disabled");
+    return ESP_ERR_NOT_SUPPORTED;
+}
+
+#endif
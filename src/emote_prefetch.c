@@ -0,0 +1,242 @@
+/*
+ * SPDX-FileCopyrightText: 2025 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/queue.h"
+#include "freertos/semphr.h"
+#include "esp_log.h"
+#include "esp_check.h"
+#include <string.h>
+#include <stdlib.h>
+
+#include "emote_defs.h"
+#include "emote_table.h"
+#include "emote_cache.h"
+#include "emote_prefetch.h"
+#include "emote_perf.h"
+
+static const char *TAG = "Expression_prefetch";
+
+typedef struct {
+    size_t offset;                          // Asset offset from mmap_assets_get_mem()
+    size_t size;
+} emote_prefetch_item_t;
+
+typedef struct {
+    uint32_t epoch;                         // Cancelled when it no longer matches the loader
+    emote_prefetch_done_cb_t done_cb;
+    void *user_data;
+    size_t count;
+    emote_prefetch_item_t items[];
+} emote_prefetch_job_t;
+
+struct emote_prefetch_s {
+    emote_handle_t handle;
+    TaskHandle_t task;
+    QueueHandle_t queue;                    // emote_prefetch_job_t *, NULL stops the task
+    SemaphoreHandle_t lock;                 // Held while an asset is being copied
+    SemaphoreHandle_t exited;
+    uint32_t epoch;                         // Bumped by cancel, guarded by lock
+};
+
+// ===== Loader task =====
+
+static void emote_prefetch_complete(emote_prefetch_t *pf, emote_prefetch_job_t *job, esp_err_t result, size_t loaded)
+{
+    if (job->done_cb) {
+        job->done_cb(pf->handle, result, loaded, job->user_data);
+    }
+    free(job);
+}
+
+static void emote_prefetch_task(void *arg)
+{
+    emote_prefetch_t *pf = (emote_prefetch_t *)arg;
+    emote_handle_t handle = pf->handle;
+    emote_prefetch_job_t *job = NULL;
+
+    while (xQueueReceive(pf->queue, &job, portMAX_DELAY) == pdTRUE && job) {
+        esp_err_t result = ESP_OK;
+        size_t loaded = 0;
+
+        for (size_t i = 0; i < job->count; i++) {
+            xSemaphoreTake(pf->lock, portMAX_DELAY);
+            if (job->epoch != pf->epoch) {
+                xSemaphoreGive(pf->lock);
+                result = ESP_ERR_INVALID_STATE;
+                break;
+            }
+
+            // Acquire and release at once: the copy stays resident as an unreferenced entry
+            const void *data = emote_cache_acquire(handle->asset_cache, handle->assets_handle,
+                                                   job->items[i].offset, job->items[i].size);
+            if (data) {
+                emote_cache_release(handle->asset_cache, data);
+                loaded++;
+            } else {
+                result = ESP_ERR_NO_MEM;
+            }
+            xSemaphoreGive(pf->lock);
+        }
+
+        ESP_LOGD(TAG, "Prefetched %d/%d assets: %s", (int)loaded, (int)job->count, esp_err_to_name(result));
+        emote_prefetch_complete(pf, job, result, loaded);
+    }
+
+    xSemaphoreGive(pf->exited);
+    vTaskDelete(NULL);
+}
+
+static void emote_prefetch_free(emote_prefetch_t *pf)
+{
+    if (pf->queue) {
+        vQueueDelete(pf->queue);
+    }
+    if (pf->lock) {
+        vSemaphoreDelete(pf->lock);
+    }
+    if (pf->exited) {
+        vSemaphoreDelete(pf->exited);
+    }
+    free(pf);
+}
+
+static esp_err_t emote_prefetch_start(emote_handle_t handle)
+{
+    esp_err_t ret = ESP_OK;
+    emote_prefetch_t *pf = NULL;
+
+    if (handle->prefetch) {
+        return ESP_OK;
+    }
+
+    pf = (emote_prefetch_t *)calloc(1, sizeof(emote_prefetch_t));
+    ESP_GOTO_ON_FALSE(pf, ESP_ERR_NO_MEM, error, TAG, "Failed to allocate prefetch loader");
+
+    pf->handle = handle;
+    pf->queue = xQueueCreate(CONFIG_EMOTE_PREFETCH_QUEUE_LEN, sizeof(emote_prefetch_job_t *));
+    pf->lock = xSemaphoreCreateMutex();
+    pf->exited = xSemaphoreCreateBinary();
+    ESP_GOTO_ON_FALSE(pf->queue && pf->lock && pf->exited, ESP_ERR_NO_MEM, error, TAG, "Failed to create prefetch queue");
+
+    BaseType_t created = xTaskCreate(emote_prefetch_task, "emote_prefetch", CONFIG_EMOTE_PREFETCH_TASK_STACK,
+                                     pf, CONFIG_EMOTE_PREFETCH_TASK_PRIORITY, &pf->task);
+    ESP_GOTO_ON_FALSE(created == pdPASS, ESP_ERR_NO_MEM, error, TAG, "Failed to create prefetch task");
+
+    handle->prefetch = pf;
+    return ESP_OK;
+
+error:
+    if (pf) {
+        emote_prefetch_free(pf);
+    }
+    return ret;
+}
+
+// ===== API =====
+
+esp_err_t emote_prefetch(emote_handle_t handle, const char *const names[], size_t count,
+                         emote_prefetch_done_cb_t done_cb, void *user_data)
+{
+    esp_err_t ret = ESP_OK;
+    emote_prefetch_t *pf = NULL;
+    emote_prefetch_job_t *job = NULL;
+    size_t queued = 0;
+
+    ESP_GOTO_ON_FALSE(handle && names && count > 0, ESP_ERR_INVALID_ARG, error, TAG, "Invalid parameters");
+    ESP_GOTO_ON_FALSE(handle->assets_handle, ESP_ERR_INVALID_STATE, error, TAG, "Assets not mounted");
+
+    job = (emote_prefetch_job_t *)calloc(1, sizeof(emote_prefetch_job_t) + count * sizeof(emote_prefetch_item_t));
+    ESP_GOTO_ON_FALSE(job, ESP_ERR_NO_MEM, error, TAG, "Failed to allocate prefetch request");
+
+    // Resolve names now, so the loader never touches the emoji and icon tables
+    for (size_t i = 0; i < count; i++) {
+        emoji_data_t *emoji = NULL;
+        icon_data_t *icon = NULL;
+        const void *data = NULL;
+        size_t size = 0;
+
+        if (emote_get_emoji_data_by_name(handle, names[i], &emoji) == ESP_OK) {
+            data = emoji->data;
+            size = emoji->size;
+        } else if (emote_get_icon_data_by_name(handle, names[i], &icon) == ESP_OK) {
+            data = icon->data;
+            size = icon->size;
+        } else {
+            ret = ESP_ERR_NOT_FOUND;
+            ESP_LOGE(TAG, "Prefetch: \"%s\" not found", names[i] ? names[i] : "");
+            goto error;
+        }
+
+        // Memory-mapped assets are used in place; there is nothing to load
+        if (!emote_data_is_mapped(handle, data)) {
+            job->items[queued].offset = (size_t)data;
+            job->items[queued].size = size;
+            queued++;
+        }
+    }
+
+    if (queued == 0) {
+        if (done_cb) {
+            done_cb(handle, ESP_OK, 0, user_data);
+        }
+        free(job);
+        return ESP_OK;
+    }
+
+    job->count = queued;
+    job->done_cb = done_cb;
+    job->user_data = user_data;
+
+    EMOTE_GFX_LOCK(handle);
+    ret = emote_prefetch_start(handle);
+    EMOTE_GFX_UNLOCK(handle);
+    ESP_GOTO_ON_FALSE(ret == ESP_OK, ret, error, TAG, "Failed to start prefetch loader");
+
+    pf = handle->prefetch;
+    xSemaphoreTake(pf->lock, portMAX_DELAY);
+    job->epoch = pf->epoch;
+    xSemaphoreGive(pf->lock);
+
+    ESP_GOTO_ON_FALSE(xQueueSend(pf->queue, &job, 0) == pdTRUE, ESP_ERR_NO_MEM, error, TAG, "Prefetch queue full");
+    return ESP_OK;
+
+error:
+    free(job);
+    return ret;
+}
+
+void emote_prefetch_cancel(emote_handle_t handle)
+{
+    emote_prefetch_t *pf = handle ? handle->prefetch : NULL;
+    if (!pf) {
+        return;
+    }
+
+    // Taking the lock waits for a copy in progress to finish
+    xSemaphoreTake(pf->lock, portMAX_DELAY);
+    pf->epoch++;
+    xSemaphoreGive(pf->lock);
+}
+
+void emote_prefetch_deinit(emote_handle_t handle)
+{
+    emote_prefetch_t *pf = handle ? handle->prefetch : NULL;
+    if (!pf) {
+        return;
+    }
+
+    emote_prefetch_cancel(handle);
+
+    // Queued jobs are cancelled by the loader; the NULL job stops it after them
+    emote_prefetch_job_t *stop = NULL;
+    xQueueSend(pf->queue, &stop, portMAX_DELAY);
+    xSemaphoreTake(pf->exited, portMAX_DELAY);
+
+    emote_prefetch_free(pf);
+    handle->prefetch = NULL;
+}
@@ -0,0 +1,358 @@
+/*
+ * SPDX-FileCopyrightText: 2025 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "sdkconfig.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/semphr.h"
+#include "esp_log.h"
+#include "esp_check.h"
+#include "esp_timer.h"
+#include <inttypes.h>
+#include <string.h>
+#include <stdlib.h>
+
+#include "emote_defs.h"
+#include "emote_batch.h"
+#include "emote_record.h"
+
+static const char *TAG = "Expression_record";
+
+#define RECORD_MAGIC_LEN            (sizeof(EMOTE_RECORD_MAGIC) - 1)
+#define RECORD_VARINT_MAX           10      // Bytes of a 64-bit LEB128 value
+#define REPLAY_MAX_STR              4096    // Longest string accepted from a log
+
+// ===== Recording =====
+
+#if CONFIG_EMOTE_RECORDER
+
+struct emote_recorder_s {
+    SemaphoreHandle_t mutex;                // Serializes writers, start and stop
+    FILE *stream;                           // Log being written, NULL while idle
+    int64_t last_us;                        // Time of the previous call
+    TaskHandle_t mute_task;                 // Task applying a batch, its calls are not logged
+    uint32_t calls;
+    uint32_t dropped;                       // Calls from an ISR
+};
+
+static size_t emote_record_put_varint(uint8_t *buf, uint64_t value)
+{
+    size_t len = 0;
+    do {
+        uint8_t byte = value & 0x7F;
+        value >>= 7;
+        buf[len++] = byte | (value ? 0x80 : 0);
+    } while (value);
+    return len;
+}
+
+static void emote_record_put_str(FILE *stream, const char *str)
+{
+    uint8_t buf[RECORD_VARINT_MAX];
+    size_t len = str ? strlen(str) : 0;
+
+    fwrite(buf, 1, emote_record_put_varint(buf, str ? (uint64_t)len + 1 : 0), stream);
+    if (len) {
+        fwrite(str, 1, len, stream);
+    }
+}
+
+esp_err_t emote_recorder_init(emote_handle_t handle)
+{
+    emote_recorder_t *rec = (emote_recorder_t *)calloc(1, sizeof(emote_recorder_t));
+    ESP_RETURN_ON_FALSE(rec, ESP_ERR_NO_MEM, TAG, "Failed to allocate recorder");
+
+    rec->mutex = xSemaphoreCreateMutex();
+    if (!rec->mutex) {
+        free(rec);
+        ESP_LOGE(TAG, "Failed to create recorder mutex");
+        return ESP_ERR_NO_MEM;
+    }
+
+    handle->recorder = rec;
+    return ESP_OK;
+}
+
+void emote_recorder_deinit(emote_handle_t handle)
+{
+    if (!handle || !handle->recorder) {
+        return;
+    }
+
+    // The stream belongs to the caller, an unstopped log is left unflushed
+    vSemaphoreDelete(handle->recorder->mutex);
+    free(handle->recorder);
+    handle->recorder = NULL;
+}
+
+void emote_record_call(emote_handle_t handle, emote_record_op_t op, const char *text, const char *message,
+                       uint32_t value)
+{
+    emote_recorder_t *rec = handle ? handle->recorder : NULL;
+
+    // Checked without the mutex, so calls cost one load while nothing is recorded
+    if (!rec || !__atomic_load_n(&rec->stream, __ATOMIC_ACQUIRE)) {
+        return;
+    }
+    if (xPortInIsrContext()) {
+        __atomic_fetch_add(&rec->dropped, 1, __ATOMIC_RELAXED);
+        return;
+    }
+    if (rec->mute_task == xTaskGetCurrentTaskHandle()) {
+        return;
+    }
+
+    xSemaphoreTake(rec->mutex, portMAX_DELAY);
+    if (rec->stream) {
+        uint8_t buf[RECORD_VARINT_MAX * 2 + 1];
+        int64_t now = esp_timer_get_time();
+        size_t len = emote_record_put_varint(buf, (uint64_t)(now - rec->last_us));
+        buf[len++] = (uint8_t)op;
+
+        fwrite(buf, 1, len, rec->stream);
+        emote_record_put_str(rec->stream, text);
+        emote_record_put_str(rec->stream, message);
+        fwrite(buf, 1, emote_record_put_varint(buf, value), rec->stream);
+
+        rec->last_us = now;
+        rec->calls++;
+    }
+    xSemaphoreGive(rec->mutex);
+}
+
+void emote_record_mute(emote_handle_t handle, bool mute)
+{
+    if (handle && handle->recorder) {
+        handle->recorder->mute_task = mute ? xTaskGetCurrentTaskHandle() : NULL;
+    }
+}
+
+esp_err_t emote_record_start(emote_handle_t handle, FILE *stream)
+{
+    esp_err_t ret = ESP_OK;
+    emote_recorder_t *rec = NULL;
+
+    ESP_GOTO_ON_FALSE(handle && stream, ESP_ERR_INVALID_ARG, error, TAG, "Invalid parameters");
+    rec = handle->recorder;
+    ESP_GOTO_ON_FALSE(rec, ESP_ERR_INVALID_STATE, error, TAG, "Recorder not initialized");
+
+    xSemaphoreTake(rec->mutex, portMAX_DELAY);
+    bool busy = (rec->stream != NULL);
+    bool written = false;
+    if (!busy) {
+        fwrite(EMOTE_RECORD_MAGIC, 1, RECORD_MAGIC_LEN, stream);
+        fputc(EMOTE_RECORD_VERSION, stream);
+        written = !ferror(stream);
+    }
+    if (written) {
+        rec->last_us = esp_timer_get_time();
+        rec->calls = 0;
+        __atomic_store_n(&rec->dropped, 0, __ATOMIC_RELAXED);
+        __atomic_store_n(&rec->stream, stream, __ATOMIC_RELEASE);
+    }
+    xSemaphoreGive(rec->mutex);
+    ESP_GOTO_ON_FALSE(!busy, ESP_ERR_INVALID_STATE, error, TAG, "Already recording");
+    ESP_GOTO_ON_FALSE(written, ESP_FAIL, error, TAG, "Failed to write log header");
+    return ESP_OK;
+
+error:
+    return ret;
+}
+
+esp_err_t emote_record_stop(emote_handle_t handle)
+{
+    esp_err_t ret = ESP_OK;
+    emote_recorder_t *rec = NULL;
+
+    ESP_GOTO_ON_FALSE(handle, ESP_ERR_INVALID_ARG, error, TAG, "Invalid parameters");
+    rec = handle->recorder;
+    ESP_GOTO_ON_FALSE(rec, ESP_ERR_INVALID_STATE, error, TAG, "Recorder not initialized");
+
+    xSemaphoreTake(rec->mutex, portMAX_DELAY);
+    FILE *stream = rec->stream;
+    __atomic_store_n(&rec->stream, NULL, __ATOMIC_RELEASE);
+    xSemaphoreGive(rec->mutex);
+    ESP_GOTO_ON_FALSE(stream, ESP_ERR_INVALID_STATE, error, TAG, "Not recording");
+
+    uint32_t dropped = __atomic_load_n(&rec->dropped, __ATOMIC_RELAXED);
+    ESP_LOGI(TAG, "Recorded %" PRIu32 " calls, %" PRIu32 " dropped from ISR", rec->calls, dropped);
+
+    fflush(stream);
+    ESP_GOTO_ON_FALSE(!ferror(stream), ESP_FAIL, error, TAG, "Failed to write log");
+    return ESP_OK;
+
+error:
+    return ret;
+}
+
+#else
+
+esp_err_t emote_record_start(emote_handle_t handle, FILE *stream)
+{
+    ESP_LOGD(TAG, "CONFIG_EMOTE_RECORDER is disabled");
+    return ESP_ERR_NOT_SUPPORTED;
+}
+
+esp_err_t emote_record_stop(emote_handle_t handle)
+{
+    ESP_LOGD(TAG, "CONFIG_EMOTE_RECORDER is disabled");
+    return ESP_ERR_NOT_SUPPORTED;
+}
+
+#endif
+
+// ===== Replay =====
+
+static bool emote_replay_get_varint(FILE *stream, uint64_t *value)
+{
+    uint64_t result = 0;
+
+    for (int shift = 0; shift < RECORD_VARINT_MAX * 7; shift += 7) {
+        int c = fgetc(stream);
+        if (c == EOF) {
+            return false;
+        }
+        result |= (uint64_t)(c & 0x7F) << shift;
+        if (!(c & 0x80)) {
+            *value = result;
+            return true;
+        }
+    }
+    return false;
+}
+
+static esp_err_t emote_replay_get_str(FILE *stream, char **str)
+{
+    uint64_t len;
+
+    *str = NULL;
+    if (!emote_replay_get_varint(stream, &len) || len > REPLAY_MAX_STR + 1) {
+        return ESP_ERR_INVALID_SIZE;
+    }
+    if (len == 0) {
+        return ESP_OK;
+    }
+
+    *str = (char *)malloc(len);
+    ESP_RETURN_ON_FALSE(*str, ESP_ERR_NO_MEM, TAG, "Failed to allocate %" PRIu32 " bytes", (uint32_t)len);
+    if (fread(*str, 1, len - 1, stream) != len - 1) {
+        return ESP_ERR_INVALID_SIZE;
+    }
+    (*str)[len - 1] = '\0';
+    return ESP_OK;
+}
+
+static esp_err_t emote_replay_call(emote_handle_t handle, uint8_t op, const char *text, const char *message,
+                                   uint32_t value)
+{
+    switch (op) {
+    case EMOTE_RECORD_OP_EVENT:
+        return emote_set_event(handle, (emote_event_t)value, message);
+    case EMOTE_RECORD_OP_POST_EVENT:
+        return emote_post_event(handle, (emote_event_t)value, message);
+    case EMOTE_RECORD_OP_EMOJI:
+        return emote_set_anim_emoji(handle, text);
+    case EMOTE_RECORD_OP_EMOJI_ID:
+        return emote_set_anim_emoji_id(handle, (emote_asset_id_t)value);
+    case EMOTE_RECORD_OP_DIALOG:
+        return emote_set_dialog_anim(handle, text);
+    case EMOTE_RECORD_OP_DIALOG_ID:
+        return emote_set_dialog_anim_id(handle, (emote_asset_id_t)value);
+    case EMOTE_RECORD_OP_INSERT_DIALOG:
+        return emote_insert_anim_dialog(handle, text, value);
+    case EMOTE_RECORD_OP_STOP_DIALOG:
+        return emote_stop_anim_dialog(handle);
+    case EMOTE_RECORD_OP_QRCODE:
+        return emote_set_qrcode_data(handle, text);
+    case EMOTE_RECORD_OP_OBJ_VISIBLE:
+        return emote_set_obj_visible(handle, text, value != 0);
+    case EMOTE_RECORD_OP_ANIM_VISIBLE:
+        return emote_set_anim_visible(handle, value != 0);
+    case EMOTE_RECORD_OP_BATCH_BEGIN:
+        return emote_batch_begin(handle);
+    case EMOTE_RECORD_OP_BATCH_COMMIT:
+        return emote_batch_commit(handle);
+    default:
+        return ESP_ERR_INVALID_ARG;
+    }
+}
+
+// Sleeps until the call is due, against the replay start so rounding never accumulates
+static void emote_replay_wait(int64_t start_us, uint64_t log_us, uint32_t speed_percent)
+{
+    if (speed_percent == 0) {
+        return;
+    }
+
+    int64_t due = start_us + (int64_t)(log_us * 100 / speed_percent);
+    int64_t remaining = due - esp_timer_get_time();
+    if (remaining > 0) {
+        vTaskDelay(pdMS_TO_TICKS((uint32_t)((remaining + 999) / 1000)));
+    }
+}
+
+esp_err_t emote_replay(emote_handle_t handle, FILE *stream, uint32_t speed_percent)
+{
+    esp_err_t ret = ESP_OK;
+    char magic[RECORD_MAGIC_LEN];
+    char *text = NULL;
+    char *message = NULL;
+    uint64_t log_us = 0;
+    uint32_t calls = 0;
+    uint32_t failed = 0;
+
+    ESP_GOTO_ON_FALSE(handle && stream, ESP_ERR_INVALID_ARG, error, TAG, "Invalid parameters");
+
+    ESP_GOTO_ON_FALSE(fread(magic, 1, sizeof(magic), stream) == sizeof(magic) &&
+                      memcmp(magic, EMOTE_RECORD_MAGIC, sizeof(magic)) == 0 &&
+                      fgetc(stream) == EMOTE_RECORD_VERSION, ESP_ERR_INVALID_VERSION, error, TAG, "Not an emote log");
+
+    int64_t start_us = esp_timer_get_time();
+    while (true) {
+        uint64_t delta;
+        uint64_t value;
+        int op;
+
+        // The log may end after any complete call
+        if (!emote_replay_get_varint(stream, &delta)) {
+            ESP_GOTO_ON_FALSE(feof(stream), ESP_ERR_INVALID_SIZE, error, TAG, "Malformed call %" PRIu32, calls);
+            break;
+        }
+
+        op = fgetc(stream);
+        ESP_GOTO_ON_FALSE(op > 0 && op < EMOTE_RECORD_OP_MAX, ESP_ERR_INVALID_SIZE, error, TAG,
+                          "Unknown op %d in call %" PRIu32, op, calls);
+        ESP_GOTO_ON_ERROR(emote_replay_get_str(stream, &text), error, TAG, "Malformed call %" PRIu32, calls);
+        ESP_GOTO_ON_ERROR(emote_replay_get_str(stream, &message), error, TAG, "Malformed call %" PRIu32, calls);
+        ESP_GOTO_ON_FALSE(emote_replay_get_varint(stream, &value), ESP_ERR_INVALID_SIZE, error, TAG,
+                          "Malformed call %" PRIu32, calls);
+
+        log_us += delta;
+        emote_replay_wait(start_us, log_us, speed_percent);
+
+        if (emote_replay_call(handle, (uint8_t)op, text, message, (uint32_t)value) != ESP_OK) {
+            failed++;
+        }
+        calls++;
+
+        free(text);
+        free(message);
+        text = NULL;
+        message = NULL;
+    }
+
+    ESP_LOGI(TAG, "Replayed %" PRIu32 " calls over %" PRIu64 " ms of log in %" PRId64 " ms, %" PRIu32 " failed",
+             calls, log_us / 1000, (esp_timer_get_time() - start_us) / 1000, failed);
+
+error:
+    // A log stopped inside a batch leaves it open; apply it rather than leave the handle recording
+    if (handle && emote_batch_is_recording(handle)) {
+        emote_batch_commit(handle);
+    }
+    free(text);
+    free(message);
+    return ret;
+}
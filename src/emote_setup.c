@@ -14,8 +14,11 @@
 #include "emote_defs.h"
 #include "emote_table.h"
 #include "emote_layout.h"
+#include "emote_digits.h"
+#include "emote_strip.h"
+#include "emote_perf.h"
+#include "emote_trace.h"
 #include "widget/gfx_font_lvgl.h"
-#include "cJSON.h"
 
 // ===== Constants and Macros =====
 static const char *TAG = "Expression_setup";
@@ -63,6 +66,11 @@ typedef struct {
     emote_obj_type_t value;
 } element_type_map_t;
 
+typedef struct {
+    const char *name;
+    emote_layout_type_t value;
+} layout_type_map_t;
+
 // ===== Static Function Declarations =====
 // Object creators
 static gfx_obj_t *emote_create_anim_obj(emote_handle_t handle);
@@ -84,8 +92,9 @@ static void emote_config_label_battery_obj(gfx_obj_t *obj);
 static int emote_convert_align_str(const char *str);
 static gfx_text_align_t emote_convert_text_align_str(const char *str);
 static gfx_label_long_mode_t emote_convert_long_mode_str(const char *str);
-static emote_obj_type_t emote_get_element_type(const char *name);
 static void emote_status_timer_callback(void *data);
+static void emote_apply_digit_atlas(emote_handle_t handle, const emote_layout_desc_t *desc, gfx_obj_t *obj);
+static void emote_apply_scroll_strip(emote_handle_t handle, const emote_layout_desc_t *desc, gfx_obj_t *obj);
 
 // Object management
 static gfx_obj_t *emote_create_object(emote_handle_t handle, emote_obj_type_t type);
@@ -201,7 +210,7 @@ static gfx_label_long_mode_t emote_convert_long_mode_str(const char *str)
     return GFX_LABEL_LONG_CLIP;
 }
 
-static emote_obj_type_t emote_get_element_type(const char *name)
+emote_obj_type_t emote_get_element_type(const char *name)
 {
     if (!name) {
         return EMOTE_DEF_OBJ_MAX;
@@ -234,8 +243,9 @@ static void emote_status_timer_callback(void *data)
 {
     emote_handle_t handle = (emote_handle_t)data;
     if (handle) {
+        // Battery changes are applied by the BAT event; only the clock needs the timer
+        handle->update_stats.status_wakeups++;
         emote_set_label_clock(handle);
-        emote_set_bat_status(handle);
     }
 }
 
@@ -262,7 +272,7 @@ static gfx_obj_t *emote_create_label_obj(emote_handle_t handle)
 
 static gfx_obj_t *emote_create_timer_obj(emote_handle_t handle)
 {
-    return (gfx_obj_t *)gfx_timer_create(handle->gfx_handle, emote_status_timer_callback, 1000, handle);
+    return (gfx_obj_t *)gfx_timer_create(handle->gfx_handle, emote_status_timer_callback, EMOTE_DEF_STATUS_PERIOD_MS, handle);
 }
 
 // Object configurators
@@ -364,6 +374,16 @@ static void emote_config_label_battery_obj(gfx_obj_t *obj)
 }
 
 // Object management
+void emote_reset_obj_state(emote_def_obj_entry_t *entry)
+{
+    if (!entry) {
+        return;
+    }
+
+    free(entry->state.text);
+    memset(&entry->state, 0, sizeof(entry->state));
+}
+
 static gfx_obj_t *emote_create_object(emote_handle_t handle, emote_obj_type_t type)
 {
     if (!handle) {
@@ -380,7 +400,7 @@ static gfx_obj_t *emote_create_object(emote_handle_t handle, emote_obj_type_t ty
         return NULL;
     }
 
-    gfx_emote_lock(gfx_handle);
+    EMOTE_GFX_LOCK(handle);
 
     // Look up object creation entry in table
     const obj_creation_entry_t *entry = NULL;
@@ -399,7 +419,7 @@ static gfx_obj_t *emote_create_object(emote_handle_t handle, emote_obj_type_t ty
         }
     }
 
-    gfx_emote_unlock(gfx_handle);
+    EMOTE_GFX_UNLOCK(handle);
 
     if (obj) {
         handle->def_objects[type].obj = obj;
@@ -470,6 +490,10 @@ gfx_obj_t *emote_create_obj_by_name(emote_handle_t handle, const char *name)
         if (!obj) {
             obj = emote_create_object(handle, type);
         }
+        // The caller is about to configure the object directly
+        EMOTE_GFX_LOCK(handle);
+        emote_reset_obj_state(&handle->def_objects[type]);
+        EMOTE_GFX_UNLOCK(handle);
         return obj;
     }
 
@@ -485,44 +509,65 @@ gfx_obj_t *emote_create_obj_by_name(emote_handle_t handle, const char *name)
 
 // ===== Public Function Implementations =====
 
-esp_err_t emote_apply_anim_layout(emote_handle_t handle, const char *name, cJSON *layout)
+void emote_layout_desc_init(emote_layout_desc_t *desc)
 {
-    esp_err_t ret = ESP_OK;
-    gfx_obj_t *obj = NULL;
-
-    ESP_GOTO_ON_FALSE(handle && name && layout, ESP_ERR_INVALID_ARG, error, TAG, "Invalid parameters");
+    if (!desc) {
+        return;
+    }
 
-    cJSON *align = cJSON_GetObjectItem(layout, "align");
-    cJSON *x = cJSON_GetObjectItem(layout, "x");
-    cJSON *y = cJSON_GetObjectItem(layout, "y");
+    memset(desc, 0, sizeof(emote_layout_desc_t));
+    desc->type = EMOTE_LAYOUT_TYPE_MAX;
+    desc->label.color = EMOTE_DEF_FONT_COLOR;
+    desc->label.text_align = "center";
+    desc->label.long_mode = "clip";
+    desc->label.speed = EMOTE_DEF_SCROLL_SPEED;
+    desc->label.snap_interval = 1500;
+    desc->timer.period = 0;
+    desc->timer.repeat_count = -1;
+    desc->qrcode.size = 150;  // Default QRCode size
+}
 
-    ESP_GOTO_ON_FALSE(cJSON_IsString(align) && cJSON_IsNumber(x) && cJSON_IsNumber(y),
-                      ESP_ERR_INVALID_ARG, error, TAG, "Anim %s: missing align/x/y fields", name);
+emote_layout_type_t emote_layout_type_from_str(const char *type_str)
+{
+    if (!type_str) {
+        return EMOTE_LAYOUT_TYPE_MAX;
+    }
 
-    const char *align_str = align->valuestring;
-    int xVal = x->valueint;
-    int yVal = y->valueint;
+    static const layout_type_map_t layout_type_map[] = {
+        { EMOTE_OBJ_TYPE_ANIM,   EMOTE_LAYOUT_TYPE_ANIM   },
+        { EMOTE_OBJ_TYPE_IMAGE,  EMOTE_LAYOUT_TYPE_IMAGE  },
+        { EMOTE_OBJ_TYPE_LABEL,  EMOTE_LAYOUT_TYPE_LABEL  },
+        { EMOTE_OBJ_TYPE_TIMER,  EMOTE_LAYOUT_TYPE_TIMER  },
+        { EMOTE_OBJ_TYPE_QRCODE, EMOTE_LAYOUT_TYPE_QRCODE },
+    };
 
-    bool autoMirror = false;
-    cJSON *animObj = cJSON_GetObjectItem(layout, EMOTE_OBJ_TYPE_ANIM);
-    if (cJSON_IsObject(animObj)) {
-        cJSON *mirror = cJSON_GetObjectItem(animObj, "mirror");
-        if (cJSON_IsString(mirror)) {
-            const char *mirrorStr = mirror->valuestring;
-            autoMirror = (strcmp(mirrorStr, "auto") == 0 || strcmp(mirrorStr, "true") == 0);
+    for (size_t i = 0; i < sizeof(layout_type_map) / sizeof(layout_type_map[0]); i++) {
+        if (strcmp(type_str, layout_type_map[i].name) == 0) {
+            return layout_type_map[i].value;
         }
     }
 
+    return EMOTE_LAYOUT_TYPE_MAX;
+}
+
+static esp_err_t emote_apply_anim_layout(emote_handle_t handle, const emote_layout_desc_t *desc)
+{
+    esp_err_t ret = ESP_OK;
+    gfx_obj_t *obj = NULL;
+    const char *name = desc->name;
+
+    ESP_GOTO_ON_FALSE(desc->align, ESP_ERR_INVALID_ARG, error, TAG, "Anim %s: missing align/x/y fields", name);
+
     obj = emote_create_obj_by_name(handle, name);
     ESP_GOTO_ON_FALSE(obj, ESP_ERR_INVALID_STATE, error, TAG, "Failed to create anim: %s", name);
 
-    gfx_emote_lock(handle->gfx_handle);
-    gfx_obj_align(obj, emote_convert_align_str(align_str), xVal, yVal);
-    if (autoMirror) {
+    EMOTE_GFX_LOCK(handle);
+    gfx_obj_align(obj, emote_convert_align_str(desc->align), desc->x, desc->y);
+    if (desc->anim.mirror) {
         gfx_anim_set_auto_mirror(obj, true);
     }
     gfx_obj_set_visible(obj, false);
-    gfx_emote_unlock(handle->gfx_handle);
+    EMOTE_GFX_UNLOCK(handle);
 
     return ESP_OK;
 
@@ -530,27 +575,21 @@ error:
     return ret;
 }
 
-esp_err_t emote_apply_image_layout(emote_handle_t handle, const char *name, cJSON *layout)
+static esp_err_t emote_apply_image_layout(emote_handle_t handle, const emote_layout_desc_t *desc)
 {
     esp_err_t ret = ESP_OK;
     gfx_obj_t *obj = NULL;
+    const char *name = desc->name;
 
-    ESP_GOTO_ON_FALSE(handle && name && layout, ESP_ERR_INVALID_ARG, error, TAG, "Invalid parameters");
-
-    cJSON *align = cJSON_GetObjectItem(layout, "align");
-    cJSON *x = cJSON_GetObjectItem(layout, "x");
-    cJSON *y = cJSON_GetObjectItem(layout, "y");
-
-    ESP_GOTO_ON_FALSE(cJSON_IsString(align) && cJSON_IsNumber(x) && cJSON_IsNumber(y),
-                      ESP_ERR_INVALID_ARG, error, TAG, "Image %s: missing align/x/y fields", name);
+    ESP_GOTO_ON_FALSE(desc->align, ESP_ERR_INVALID_ARG, error, TAG, "Image %s: missing align/x/y fields", name);
 
     obj = emote_create_obj_by_name(handle, name);
     ESP_GOTO_ON_FALSE(obj, ESP_ERR_INVALID_STATE, error, TAG, "Failed to create image: %s", name);
 
-    gfx_emote_lock(handle->gfx_handle);
-    gfx_obj_align(obj, emote_convert_align_str(align->valuestring), x->valueint, y->valueint);
+    EMOTE_GFX_LOCK(handle);
+    gfx_obj_align(obj, emote_convert_align_str(desc->align), desc->x, desc->y);
     gfx_obj_set_visible(obj, false);
-    gfx_emote_unlock(handle->gfx_handle);
+    EMOTE_GFX_UNLOCK(handle);
 
     return ESP_OK;
 
@@ -558,92 +597,110 @@ error:
     return ret;
 }
 
-esp_err_t emote_apply_label_layout(emote_handle_t handle, const char *name, cJSON *layout)
+// Clock and battery labels only show digits, so they can draw from a digit atlas
+static void emote_apply_digit_atlas(emote_handle_t handle, const emote_layout_desc_t *desc, gfx_obj_t *obj)
 {
-    esp_err_t ret = ESP_OK;
-    gfx_obj_t *obj = NULL;
+    emote_obj_type_t type = emote_get_element_type(desc->name);
+    const lv_font_t *font = NULL;
 
-    ESP_GOTO_ON_FALSE(handle && name && layout, ESP_ERR_INVALID_ARG, error, TAG, "Invalid parameters");
-
-    cJSON *align = cJSON_GetObjectItem(layout, "align");
-    cJSON *x = cJSON_GetObjectItem(layout, "x");
-    cJSON *y = cJSON_GetObjectItem(layout, "y");
+    if (type == EMOTE_DEF_OBJ_LABEL_CLOCK) {
+        font = &font_maison_neue_book_26;
+    } else if (type == EMOTE_DEF_OBJ_LABEL_BATTERY) {
+        font = &font_maison_neue_book_12;
+    }
 
-    ESP_GOTO_ON_FALSE(cJSON_IsString(align) && cJSON_IsNumber(x) && cJSON_IsNumber(y),
-                      ESP_ERR_INVALID_ARG, error, TAG, "Label %s: missing align/x/y fields", name);
+    if (font) {
+        emote_digits_delete(handle->def_objects[type].digits);
+        handle->def_objects[type].digits = NULL;
+    }
+    if (!desc->label.digit_atlas) {
+        return;
+    }
+    if (!font) {
+        ESP_LOGW(TAG, "Label %s: digit_atlas is only supported by the clock and battery labels", desc->name);
+        return;
+    }
 
-    cJSON *width = cJSON_GetObjectItem(layout, "width");
-    cJSON *height = cJSON_GetObjectItem(layout, "height");
-    int w = cJSON_IsNumber(width) ? width->valueint : 0;
-    int h = cJSON_IsNumber(height) ? height->valueint : 0;
+    handle->def_objects[type].digits = emote_digits_create(handle->gfx_disp, obj, font, desc->label.color,
+                                       emote_convert_text_align_str(desc->label.text_align),
+                                       emote_convert_align_str(desc->align), desc->x, desc->y);
+    if (!handle->def_objects[type].digits) {
+        ESP_LOGW(TAG, "Label %s: digit atlas unavailable, drawing text with the font", desc->name);
+    }
+}
 
-    uint32_t color = EMOTE_DEF_FONT_COLOR;
-    const char *textAlign = "center";
-    const char *longModeType = "clip";
-    bool longModeLoop = false;
-    int longModeSpeed = EMOTE_DEF_SCROLL_SPEED;
-    int longModeSnapInterval = 1500;
+// The toast label scrolls long messages, so it can scroll a pre-rendered strip
+static void emote_apply_scroll_strip(emote_handle_t handle, const emote_layout_desc_t *desc, gfx_obj_t *obj)
+{
+    emote_obj_type_t type = emote_get_element_type(desc->name);
+    emote_def_obj_entry_t *entry = NULL;
+
+    if (type == EMOTE_DEF_OBJ_LABEL_TOAST) {
+        entry = &handle->def_objects[type];
+        emote_strip_delete(entry->strip);
+        entry->strip = NULL;
+        // The strip starts empty, so the next text update must not be skipped
+        free(entry->state.text);
+        entry->state.text = NULL;
+    }
+    if (!desc->label.scroll_strip) {
+        return;
+    }
+    if (!entry) {
+        ESP_LOGW(TAG, "Label %s: scroll_strip is only supported by the toast label", desc->name);
+        return;
+    }
+    if (strcmp(desc->label.long_mode, "GFX_LABEL_LONG_SCROLL") != 0) {
+        ESP_LOGW(TAG, "Label %s: scroll_strip needs GFX_LABEL_LONG_SCROLL", desc->name);
+        return;
+    }
 
-    cJSON *labelObj = cJSON_GetObjectItem(layout, EMOTE_OBJ_TYPE_LABEL);
-    if (cJSON_IsObject(labelObj)) {
-        cJSON *colorJson = cJSON_GetObjectItem(labelObj, "color");
-        if (cJSON_IsNumber(colorJson)) {
-            color = colorJson->valueint;
-        }
+    const lv_font_t *font = handle->gfx_font ? handle->gfx_font : &font_puhui_basic_20_4;
+    entry->strip = emote_strip_create(handle->gfx_handle, handle->gfx_disp, obj, font, desc->label.color,
+                                      emote_convert_text_align_str(desc->label.text_align),
+                                      emote_convert_align_str(desc->align), desc->x, desc->y,
+                                      desc->label.speed, desc->label.loop);
+    if (!entry->strip) {
+        ESP_LOGW(TAG, "Label %s: scroll strip unavailable, drawing text with the font", desc->name);
+    }
+}
 
-        cJSON *textAlignJson = cJSON_GetObjectItem(labelObj, "text_align");
-        if (cJSON_IsString(textAlignJson)) {
-            textAlign = textAlignJson->valuestring;
-        }
+static esp_err_t emote_apply_label_layout(emote_handle_t handle, const emote_layout_desc_t *desc)
+{
+    esp_err_t ret = ESP_OK;
+    gfx_obj_t *obj = NULL;
+    const char *name = desc->name;
+    const char *longModeType = desc->label.long_mode;
 
-        cJSON *longMode = cJSON_GetObjectItem(labelObj, "long_mode");
-        if (cJSON_IsObject(longMode)) {
-            cJSON *longType = cJSON_GetObjectItem(longMode, "type");
-            if (cJSON_IsString(longType)) {
-                longModeType = longType->valuestring;
-            }
-
-            cJSON *loop = cJSON_GetObjectItem(longMode, "loop");
-            if (cJSON_IsBool(loop)) {
-                longModeLoop = cJSON_IsTrue(loop);
-            }
-
-            cJSON *speed = cJSON_GetObjectItem(longMode, "speed");
-            if (cJSON_IsNumber(speed)) {
-                longModeSpeed = speed->valueint;
-            }
-
-            cJSON *snap_interval = cJSON_GetObjectItem(longMode, "snap_interval");
-            if (cJSON_IsNumber(snap_interval)) {
-                longModeSnapInterval = snap_interval->valueint;
-            }
-        }
-    }
+    ESP_GOTO_ON_FALSE(desc->align, ESP_ERR_INVALID_ARG, error, TAG, "Label %s: missing align/x/y fields", name);
 
     obj = emote_create_obj_by_name(handle, name);
     ESP_GOTO_ON_FALSE(obj, ESP_ERR_INVALID_STATE, error, TAG, "Failed to create label: %s", name);
 
-    gfx_emote_lock(handle->gfx_handle);
-    gfx_obj_align(obj, emote_convert_align_str(align->valuestring), x->valueint, y->valueint);
+    EMOTE_GFX_LOCK(handle);
+    gfx_obj_align(obj, emote_convert_align_str(desc->align), desc->x, desc->y);
 
-    if (w > 0 && h > 0) {
-        gfx_obj_set_size(obj, w, h);
+    if (desc->width > 0 && desc->height > 0) {
+        gfx_obj_set_size(obj, desc->width, desc->height);
     }
 
-    gfx_label_set_color(obj, GFX_COLOR_HEX(color));
-    gfx_label_set_text_align(obj, emote_convert_text_align_str(textAlign));
+    gfx_label_set_color(obj, GFX_COLOR_HEX(desc->label.color));
+    gfx_label_set_text_align(obj, emote_convert_text_align_str(desc->label.text_align));
     gfx_label_set_long_mode(obj, emote_convert_long_mode_str(longModeType));
 
     if (strcmp(longModeType, "GFX_LABEL_LONG_SCROLL") == 0) {
-        gfx_label_set_scroll_speed(obj, longModeSpeed);
-        gfx_label_set_scroll_loop(obj, longModeLoop);
+        gfx_label_set_scroll_speed(obj, desc->label.speed);
+        gfx_label_set_scroll_loop(obj, desc->label.loop);
     } else if (strcmp(longModeType, "GFX_LABEL_LONG_SNAP") == 0) {
-        gfx_label_set_snap_loop(obj, longModeLoop);
-        gfx_label_set_snap_interval(obj, longModeSnapInterval);
+        gfx_label_set_snap_loop(obj, desc->label.loop);
+        gfx_label_set_snap_interval(obj, desc->label.snap_interval);
     }
 
+    emote_apply_digit_atlas(handle, desc, obj);
+    emote_apply_scroll_strip(handle, desc, obj);
+
     gfx_obj_set_visible(obj, false);
-    gfx_emote_unlock(handle->gfx_handle);
+    EMOTE_GFX_UNLOCK(handle);
 
     return ESP_OK;
 
@@ -651,37 +708,31 @@ error:
     return ret;
 }
 
-esp_err_t emote_apply_timer_layout(emote_handle_t handle, const char *name, cJSON *layout)
+static esp_err_t emote_apply_timer_layout(emote_handle_t handle, const emote_layout_desc_t *desc)
 {
     esp_err_t ret = ESP_OK;
     gfx_obj_t *obj = NULL;
+    const char *name = desc->name;
 
-    ESP_GOTO_ON_FALSE(handle && name && layout, ESP_ERR_INVALID_ARG, error, TAG, "Invalid parameters");
-
-    uint32_t period = 1000;
-    int32_t repeat_count = -1;
-
-    cJSON *timerObj = cJSON_GetObjectItem(layout, EMOTE_OBJ_TYPE_TIMER);
-    ESP_GOTO_ON_FALSE(cJSON_IsObject(timerObj), ESP_ERR_INVALID_ARG, error, TAG, "Timer object not found for %s", name);
-
-    cJSON *periodJson = cJSON_GetObjectItem(timerObj, "period");
-    if (cJSON_IsNumber(periodJson)) {
-        period = periodJson->valueint;
-    }
-
-    cJSON *repeatCountJson = cJSON_GetObjectItem(timerObj, "repeat_count");
-    if (cJSON_IsNumber(repeatCountJson)) {
-        repeat_count = repeatCountJson->valueint;
-    }
+    ESP_GOTO_ON_FALSE(desc->timer.present, ESP_ERR_INVALID_ARG, error, TAG, "Timer object not found for %s", name);
 
     obj = emote_create_obj_by_name(handle, name);
     ESP_GOTO_ON_FALSE(obj, ESP_ERR_INVALID_STATE, error, TAG, "Failed to create timer: %s", name);
 
-    gfx_emote_lock(handle->gfx_handle);
-    gfx_timer_set_repeat_count(obj, repeat_count);
+    // The status timer is rescheduled to the next period boundary whenever it runs
+    uint32_t period = desc->timer.period;
+    if (emote_get_element_type(name) == EMOTE_DEF_OBJ_TIMER_STATUS) {
+        handle->status_period_ms = period ? period : EMOTE_DEF_STATUS_PERIOD_MS;
+        period = handle->status_period_ms;
+    } else if (period == 0) {
+        period = EMOTE_DEF_TIMER_PERIOD_MS;
+    }
+
+    EMOTE_GFX_LOCK(handle);
+    gfx_timer_set_repeat_count(obj, desc->timer.repeat_count);
     gfx_timer_set_period(obj, period);
     gfx_timer_pause((gfx_timer_handle_t)obj);
-    gfx_emote_unlock(handle->gfx_handle);
+    EMOTE_GFX_UNLOCK(handle);
 
     return ESP_OK;
 
@@ -689,39 +740,24 @@ error:
     return ret;
 }
 
-esp_err_t emote_apply_qrcode_layout(emote_handle_t handle, const char *name, cJSON *layout)
+static esp_err_t emote_apply_qrcode_layout(emote_handle_t handle, const emote_layout_desc_t *desc)
 {
     esp_err_t ret = ESP_OK;
     gfx_obj_t *obj = NULL;
+    const char *name = desc->name;
 
-    ESP_GOTO_ON_FALSE(handle && name && layout, ESP_ERR_INVALID_ARG, error, TAG, "Invalid parameters");
-
-    cJSON *align = cJSON_GetObjectItem(layout, "align");
-    cJSON *x = cJSON_GetObjectItem(layout, "x");
-    cJSON *y = cJSON_GetObjectItem(layout, "y");
-
-    ESP_GOTO_ON_FALSE(cJSON_IsString(align) && cJSON_IsNumber(x) && cJSON_IsNumber(y),
-                      ESP_ERR_INVALID_ARG, error, TAG, "QRCode %s: missing align/x/y fields", name);
-
-    int size = 150;  // Default QRCode size
-    cJSON *qrcodeObj = cJSON_GetObjectItem(layout, EMOTE_OBJ_TYPE_QRCODE);
-    if (cJSON_IsObject(qrcodeObj)) {
-        cJSON *sizeJson = cJSON_GetObjectItem(qrcodeObj, "size");
-        if (cJSON_IsNumber(sizeJson)) {
-            size = sizeJson->valueint;
-        }
-    }
+    ESP_GOTO_ON_FALSE(desc->align, ESP_ERR_INVALID_ARG, error, TAG, "QRCode %s: missing align/x/y fields", name);
 
     obj = emote_create_obj_by_name(handle, name);
     ESP_GOTO_ON_FALSE(obj, ESP_ERR_INVALID_STATE, error, TAG, "Failed to create qrcode: %s", name);
 
-    gfx_emote_lock(handle->gfx_handle);
-    gfx_obj_align(obj, emote_convert_align_str(align->valuestring), x->valueint, y->valueint);
-    if (size > 0) {
-        gfx_obj_set_size(obj, size, size);
+    EMOTE_GFX_LOCK(handle);
+    gfx_obj_align(obj, emote_convert_align_str(desc->align), desc->x, desc->y);
+    if (desc->qrcode.size > 0) {
+        gfx_obj_set_size(obj, desc->qrcode.size, desc->qrcode.size);
     }
     gfx_obj_set_visible(obj, false);
-    gfx_emote_unlock(handle->gfx_handle);
+    EMOTE_GFX_UNLOCK(handle);
 
     return ESP_OK;
 
@@ -729,20 +765,54 @@ error:
     return ret;
 }
 
-esp_err_t emote_apply_fonts(emote_handle_t handle, const uint8_t *fontData)
+esp_err_t emote_apply_layout(emote_handle_t handle, const emote_layout_desc_t *desc)
+{
+    esp_err_t ret = ESP_OK;
+
+    ESP_GOTO_ON_FALSE(handle && desc && desc->name, ESP_ERR_INVALID_ARG, error, TAG, "Invalid parameters");
+
+    EMOTE_TRACE_BEGIN(start);
+    switch (desc->type) {
+    case EMOTE_LAYOUT_TYPE_ANIM:
+        ret = emote_apply_anim_layout(handle, desc);
+        break;
+    case EMOTE_LAYOUT_TYPE_IMAGE:
+        ret = emote_apply_image_layout(handle, desc);
+        break;
+    case EMOTE_LAYOUT_TYPE_LABEL:
+        ret = emote_apply_label_layout(handle, desc);
+        break;
+    case EMOTE_LAYOUT_TYPE_TIMER:
+        ret = emote_apply_timer_layout(handle, desc);
+        break;
+    case EMOTE_LAYOUT_TYPE_QRCODE:
+        ret = emote_apply_qrcode_layout(handle, desc);
+        break;
+    default:
+        ret = ESP_ERR_INVALID_ARG;
+        ESP_LOGE(TAG, "Unknown layout type %d for %s", desc->type, desc->name);
+        break;
+    }
+    EMOTE_TRACE_END(handle, "layout", start, desc->type);
+
+error:
+    return ret;
+}
+
+esp_err_t emote_apply_fonts(emote_handle_t handle, lv_font_t *font)
 {
     esp_err_t ret = ESP_OK;
 
-    ESP_GOTO_ON_FALSE(handle && fontData, ESP_ERR_INVALID_ARG, error, TAG, "Invalid parameters");
+    ESP_GOTO_ON_FALSE(handle && font, ESP_ERR_INVALID_ARG, error, TAG, "Invalid parameters");
 
-    handle->gfx_font = gfx_font_lv_load_from_binary((uint8_t *)fontData);
-    ESP_GOTO_ON_FALSE(handle->gfx_font, ESP_ERR_INVALID_STATE, error, TAG, "Failed to create font");
+    handle->gfx_font = font;
 
     gfx_obj_t *obj = handle->def_objects[EMOTE_DEF_OBJ_LABEL_TOAST].obj;
     if (obj) {
-        gfx_emote_lock(handle->gfx_handle);
+        EMOTE_GFX_LOCK(handle);
         gfx_label_set_font(obj, handle->gfx_font);
-        gfx_emote_unlock(handle->gfx_handle);
+        emote_strip_set_font(handle->def_objects[EMOTE_DEF_OBJ_LABEL_TOAST].strip, handle->gfx_font);
+        EMOTE_GFX_UNLOCK(handle);
     }
 
     return ESP_OK;
@@ -761,6 +831,9 @@ gfx_obj_t *emote_get_obj_by_name(emote_handle_t handle, const char *name)
     // First check predefined types
     emote_obj_type_t type = emote_get_element_type(name);
     if (type != EMOTE_DEF_OBJ_MAX) {
+        EMOTE_GFX_LOCK(handle);
+        emote_reset_obj_state(&handle->def_objects[type]);
+        EMOTE_GFX_UNLOCK(handle);
         return handle->def_objects[type].obj;
     }
 
@@ -802,7 +875,7 @@ gfx_obj_t *emote_create_obj_by_type(emote_handle_t handle, const char *type_str,
     gfx_handle = handle->gfx_handle;
     ESP_GOTO_ON_FALSE(gfx_handle, ESP_ERR_INVALID_STATE, error, TAG, "GFX handle not initialized");
 
-    gfx_emote_lock(gfx_handle);
+    EMOTE_GFX_LOCK(handle);
 
     // Create object
     obj = entry->creator(handle);
@@ -810,16 +883,16 @@ gfx_obj_t *emote_create_obj_by_type(emote_handle_t handle, const char *type_str,
         entry->configurator(obj);
     }
 
-    gfx_emote_unlock(gfx_handle);
+    EMOTE_GFX_UNLOCK(handle);
 
     if (obj) {
         // Register as custom object
         ret = emote_register_custom_obj(handle, name, obj);
         if (ret != ESP_OK) {
             ESP_LOGE(TAG, "Failed to register custom object: %s", name);
-            gfx_emote_lock(gfx_handle);
+            EMOTE_GFX_LOCK(handle);
             gfx_obj_delete(obj);
-            gfx_emote_unlock(gfx_handle);
+            EMOTE_GFX_UNLOCK(handle);
             obj = NULL;
             goto error;
         }
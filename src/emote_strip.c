@@ -0,0 +1,307 @@
+/*
+ * SPDX-FileCopyrightText: 2025 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "sdkconfig.h"
+#include "esp_log.h"
+#include "esp_check.h"
+#include <string.h>
+#include <stdlib.h>
+
+#include "emote_strip.h"
+#include "emote_glyph.h"
+
+static const char *TAG = "Expression_strip";
+
+#define STRIP_MAX_BYTES         (CONFIG_EMOTE_SCROLL_STRIP_MAX_KB * 1024)
+#define STRIP_LOOP_GAP_LINES    2           // Blank space before a looping text restarts, in line heights
+
+struct emote_strip_s {
+    gfx_handle_t gfx;
+    gfx_obj_t *img;
+    gfx_obj_t *label;
+    gfx_timer_handle_t timer;
+    gfx_image_dsc_t dsc;
+    const lv_font_t *font;
+    char *text;                             // Rendered again on a font change
+    uint8_t *alpha;                         // A8 plane of the image
+    uint8_t *line;                          // A8 strip of the text, period x line_h
+    size_t line_size;                       // Bytes allocated for line
+    uint32_t text_w;
+    uint32_t period;                        // Strip width: the text, plus the gap when looping
+    uint32_t offset;                        // First strip column shown
+    uint16_t line_h;
+    uint16_t w;
+    uint16_t h;
+    gfx_text_align_t align;
+    bool loop;
+    bool scrolling;                         // Text is wider than the label
+    bool fallback;                          // Text is drawn by the label
+    bool visible;
+};
+
+static size_t emote_strip_utf8_next(const char *text, uint32_t *letter)
+{
+    const uint8_t *s = (const uint8_t *)text;
+    size_t len = (s[0] < 0x80) ? 1 : ((s[0] & 0xE0) == 0xC0) ? 2 : ((s[0] & 0xF0) == 0xE0) ? 3 :
+                 ((s[0] & 0xF8) == 0xF0) ? 4 : 1;
+    uint32_t value = (len == 1) ? s[0] : (s[0] & (0x7F >> len));
+
+    for (size_t i = 1; i < len; i++) {
+        if ((s[i] & 0xC0) != 0x80) {
+            *letter = 0xFFFD;
+            return i;
+        }
+        value = (value << 6) | (s[i] & 0x3F);
+    }
+    *letter = value;
+    return len;
+}
+
+// Lay out the text on one line; returns its width, rendering it into the strip if requested
+static uint32_t emote_strip_walk(emote_strip_t *strip, bool render)
+{
+    const lv_font_t *font = strip->font;
+    const char *text = strip->text ? strip->text : "";
+    uint32_t x = 0;
+    uint32_t letter = 0;
+    uint32_t next = 0;
+
+    text += *text ? emote_strip_utf8_next(text, &letter) : 0;
+    while (letter) {
+        next = 0;
+        text += *text ? emote_strip_utf8_next(text, &next) : 0;
+
+        lv_font_glyph_dsc_t g;
+        if (letter >= 0x20 && font->get_glyph_dsc(font, &g, letter, next)) {
+            if (render && g.box_w * g.box_h > 0) {
+                emote_glyph_render_a8(font, letter, &g, strip->line, strip->period, x, 0, strip->text_w);
+            }
+            x += g.adv_w;
+        }
+        letter = next;
+    }
+    return x;
+}
+
+static esp_err_t emote_strip_render(emote_strip_t *strip)
+{
+    strip->line_h = strip->font->line_height;
+    strip->text_w = emote_strip_walk(strip, false);
+    strip->scrolling = strip->text_w > strip->w;
+    strip->period = strip->text_w + ((strip->scrolling && strip->loop) ? STRIP_LOOP_GAP_LINES * strip->line_h : 0);
+    strip->offset = 0;
+
+    size_t size = (size_t)strip->period * strip->line_h;
+    ESP_RETURN_ON_FALSE(size <= STRIP_MAX_BYTES, ESP_ERR_INVALID_SIZE, TAG, "Text strip of %zu bytes over budget", size);
+    if (size > strip->line_size) {
+        uint8_t *line = (uint8_t *)realloc(strip->line, size);
+        ESP_RETURN_ON_FALSE(line, ESP_ERR_NO_MEM, TAG, "Failed to allocate %zu bytes text strip", size);
+        strip->line = line;
+        strip->line_size = size;
+    }
+
+    if (size) {
+        memset(strip->line, 0, size);
+        emote_strip_walk(strip, true);
+    }
+    return ESP_OK;
+}
+
+// Copy the window of the strip at the current offset into the image
+static void emote_strip_draw(emote_strip_t *strip)
+{
+    uint16_t rows = strip->line_h < strip->h ? strip->line_h : strip->h;
+    const uint8_t *src = strip->line;
+    uint8_t *dst = strip->alpha;
+
+    if (!strip->scrolling) {
+        uint32_t x = 0;
+        if (strip->align == GFX_TEXT_ALIGN_CENTER) {
+            x = (strip->w - strip->text_w) / 2;
+        } else if (strip->align == GFX_TEXT_ALIGN_RIGHT) {
+            x = strip->w - strip->text_w;
+        }
+        memset(strip->alpha, 0, (size_t)strip->w * strip->h);
+        for (uint16_t row = 0; row < rows && strip->text_w; row++) {
+            memcpy(dst + x, src, strip->text_w);
+            src += strip->period;
+            dst += strip->w;
+        }
+    } else {
+        // A looping strip wraps around; without the loop the offset never passes text_w - w
+        uint32_t first = strip->period - strip->offset;
+        first = first < strip->w ? first : strip->w;
+        for (uint16_t row = 0; row < rows; row++) {
+            memcpy(dst, src + strip->offset, first);
+            memcpy(dst + first, src, strip->w - first);
+            src += strip->period;
+            dst += strip->w;
+        }
+    }
+
+    // Same descriptor, new pixels: setting the source again invalidates the area
+    gfx_img_set_src(strip->img, &strip->dsc);
+}
+
+static void emote_strip_update_timer(emote_strip_t *strip)
+{
+    bool run = strip->visible && !strip->fallback && strip->scrolling &&
+               (strip->loop || strip->offset < strip->text_w - strip->w);
+
+    if (run && !gfx_timer_is_running(strip->timer)) {
+        gfx_timer_reset(strip->timer);
+        gfx_timer_resume(strip->timer);
+    } else if (!run && gfx_timer_is_running(strip->timer)) {
+        gfx_timer_pause(strip->timer);
+    }
+}
+
+static void emote_strip_timer_cb(void *user_data)
+{
+    emote_strip_t *strip = (emote_strip_t *)user_data;
+
+    if (!strip->scrolling || strip->fallback) {
+        return;
+    }
+
+    if (++strip->offset == strip->period) {
+        strip->offset = 0;
+    }
+    emote_strip_draw(strip);
+    if (!strip->loop && strip->offset >= strip->text_w - strip->w) {
+        emote_strip_update_timer(strip);
+    }
+}
+
+static void emote_strip_apply_visible(emote_strip_t *strip)
+{
+    gfx_obj_set_visible(strip->img, strip->visible && !strip->fallback);
+    emote_strip_update_timer(strip);
+}
+
+static void emote_strip_set_fallback(emote_strip_t *strip, const char *text)
+{
+    if (text) {
+        gfx_label_set_text(strip->label, text);
+    } else if (strip->fallback) {
+        gfx_label_set_text(strip->label, "");
+    }
+
+    if (strip->fallback != (text != NULL)) {
+        strip->fallback = (text != NULL);
+        emote_strip_apply_visible(strip);
+    }
+}
+
+// Render the current text and show it from the start, or hand it to the label
+static void emote_strip_refresh(emote_strip_t *strip)
+{
+    if (emote_strip_render(strip) != ESP_OK) {
+        strip->scrolling = false;
+        emote_strip_set_fallback(strip, strip->text ? strip->text : "");
+        return;
+    }
+
+    emote_strip_draw(strip);
+    emote_strip_set_fallback(strip, NULL);
+    gfx_timer_pause(strip->timer);
+    emote_strip_update_timer(strip);
+}
+
+// ===== API =====
+
+emote_strip_t *emote_strip_create(gfx_handle_t gfx, gfx_disp_t *disp, gfx_obj_t *label, const lv_font_t *font,
+                                  uint32_t color, gfx_text_align_t align, int pos, int x, int y,
+                                  uint32_t speed, bool loop)
+{
+    esp_err_t ret = ESP_OK;
+    emote_strip_t *strip = NULL;
+    uint16_t w = 0;
+    uint16_t h = 0;
+
+    ESP_GOTO_ON_FALSE(gfx && disp && label && font && font->get_glyph_dsc && font->get_glyph_bitmap,
+                      ESP_ERR_INVALID_ARG, error, TAG, "Invalid parameters");
+    gfx_obj_get_size(label, &w, &h);
+    ESP_GOTO_ON_FALSE(w > 0 && h > 0, ESP_ERR_INVALID_SIZE, error, TAG, "Label has no size");
+
+    strip = (emote_strip_t *)calloc(1, sizeof(emote_strip_t));
+    ESP_GOTO_ON_FALSE(strip, ESP_ERR_NO_MEM, error, TAG, "Failed to allocate scroll strip");
+    strip->gfx = gfx;
+    strip->label = label;
+    strip->font = font;
+    strip->w = w;
+    strip->h = h;
+    strip->align = align;
+    strip->loop = loop;
+
+    strip->timer = gfx_timer_create(gfx, emote_strip_timer_cb, speed ? speed : 1, strip);
+    ESP_GOTO_ON_FALSE(strip->timer, ESP_ERR_NO_MEM, error, TAG, "Failed to create scroll timer");
+    gfx_timer_pause(strip->timer);
+
+    strip->img = emote_glyph_image_create(disp, &strip->dsc, w, h, color, pos, x, y, &strip->alpha);
+    ESP_GOTO_ON_FALSE(strip->img, ESP_ERR_NO_MEM, error, TAG, "Failed to create %dx%d strip image", w, h);
+
+    gfx_label_set_text(label, "");
+    return strip;
+
+error:
+    ESP_LOGD(TAG, "Scroll strip not created: %s", esp_err_to_name(ret));
+    emote_strip_delete(strip);
+    return NULL;
+}
+
+void emote_strip_delete(emote_strip_t *strip)
+{
+    if (!strip) {
+        return;
+    }
+
+    if (strip->timer) {
+        gfx_timer_delete(strip->gfx, strip->timer);
+    }
+    emote_glyph_image_delete(strip->img, &strip->dsc);
+    free(strip->text);
+    free(strip->line);
+    free(strip);
+}
+
+void emote_strip_set_text(emote_strip_t *strip, const char *text)
+{
+    if (!strip || !text) {
+        return;
+    }
+
+    char *copy = strdup(text);
+    if (!copy) {
+        strip->scrolling = false;
+        emote_strip_set_fallback(strip, text);
+        return;
+    }
+
+    free(strip->text);
+    strip->text = copy;
+    emote_strip_refresh(strip);
+}
+
+void emote_strip_set_font(emote_strip_t *strip, const lv_font_t *font)
+{
+    if (!strip || !font || !font->get_glyph_dsc || !font->get_glyph_bitmap || font == strip->font) {
+        return;
+    }
+
+    strip->font = font;
+    emote_strip_refresh(strip);
+}
+
+void emote_strip_set_visible(emote_strip_t *strip, bool visible)
+{
+    if (!strip || strip->visible == visible) {
+        return;
+    }
+
+    strip->visible = visible;
+    emote_strip_apply_visible(strip);
+}
@@ -0,0 +1,278 @@
+/*
+ * SPDX-FileCopyrightText: 2025 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "sdkconfig.h"
+#include "esp_log.h"
+#include "esp_err.h"
+#include "esp_check.h"
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+
+#include "emote_table.h"
+
+static const char *TAG = "Expression_table";
+
+/*
+ * Open-addressing table with linear probing. Everything except the table header
+ * lives in one arena:
+ *
+ *   slots[slot_count] | keys[max_count] | values[max_count * value_size] | key pool
+ *
+ * Keys point either into the key pool (copied) or at caller-owned strings that
+ * outlive the table (borrowed), such as names in a memory-mapped asset image.
+ *
+ * Slots hold the key hash and a dense entry index, so probing touches only the
+ * 8-byte slot array until the hash matches. The arena is rebuilt at twice the slot
+ * count once the load factor exceeds 3/4, or when the key pool runs out.
+ */
+
+#define ASSETS_TABLE_MIN_SLOTS      8
+#define ASSETS_TABLE_POOL_PER_KEY   16      // Initial key pool estimate per entry
+#define ASSETS_TABLE_ALIGN(x)       (((x) + 7) & ~(size_t)7)
+
+typedef struct {
+    uint32_t hash;                  // 0 marks an empty slot
+    uint32_t index;                 // Dense entry index
+} assets_hash_slot_t;
+
+struct assets_hash_table_s {
+    char name[16];
+    size_t value_size;
+    uint32_t slot_count;            // Power of two
+    uint32_t count;
+    uint32_t pool_size;
+    uint32_t pool_used;
+    uint32_t borrowed;              // Number of borrowed keys
+    uint8_t *arena;
+    assets_hash_slot_t *slots;
+    const char **keys;              // Parallel to values
+    uint8_t *values;
+    char *pool;
+};
+
+static uint32_t emote_assets_hash_string(const char *str)
+{
+    uint32_t hash = 5381;
+    int c;
+    while ((c = *str++)) {
+        hash = ((hash << 5) + hash) + c;
+    }
+    return hash ? hash : 1;
+}
+
+static inline uint32_t emote_assets_table_max_count(uint32_t slot_count)
+{
+    return slot_count - slot_count / 4;
+}
+
+static esp_err_t emote_assets_table_rebuild(assets_hash_table_t *ht, uint32_t slot_count, uint32_t pool_size)
+{
+    uint32_t max_count = emote_assets_table_max_count(slot_count);
+    size_t slots_size = slot_count * sizeof(assets_hash_slot_t);
+    size_t keys_size = ASSETS_TABLE_ALIGN(max_count * sizeof(const char *));
+    size_t values_size = ASSETS_TABLE_ALIGN(max_count * ht->value_size);
+
+    uint8_t *arena = (uint8_t *)malloc(slots_size + keys_size + values_size + pool_size);
+    ESP_RETURN_ON_FALSE(arena, ESP_ERR_NO_MEM, TAG, "[%s] Failed to grow table to %d slots", ht->name, (int)slot_count);
+
+    assets_hash_slot_t *slots = (assets_hash_slot_t *)arena;
+    const char **keys = (const char **)(arena + slots_size);
+    uint8_t *values = arena + slots_size + keys_size;
+    char *pool = (char *)(values + values_size);
+
+    // Entries stay dense, so only the slot array has to be rehashed
+    memset(slots, 0, slots_size);
+    if (ht->arena) {
+        memcpy(values, ht->values, ht->count * ht->value_size);
+        memcpy(pool, ht->pool, ht->pool_used);
+        for (uint32_t i = 0; i < ht->count; i++) {
+            const char *key = ht->keys[i];
+            uintptr_t offset = (uintptr_t)key - (uintptr_t)ht->pool;
+            bool copied = offset < ht->pool_used;
+            keys[i] = copied ? pool + offset : key;
+        }
+        free(ht->arena);
+    }
+
+    uint32_t mask = slot_count - 1;
+    for (uint32_t i = 0; i < ht->count; i++) {
+        uint32_t hash = emote_assets_hash_string(keys[i]);
+        uint32_t pos = hash & mask;
+        while (slots[pos].hash) {
+            pos = (pos + 1) & mask;
+        }
+        slots[pos].hash = hash;
+        slots[pos].index = i;
+    }
+
+    ht->arena = arena;
+    ht->slots = slots;
+    ht->keys = keys;
+    ht->values = values;
+    ht->pool = pool;
+    ht->slot_count = slot_count;
+    ht->pool_size = pool_size;
+    return ESP_OK;
+}
+
+static int emote_assets_table_lookup(const assets_hash_table_t *ht, const char *key, uint32_t hash)
+{
+    uint32_t mask = ht->slot_count - 1;
+    uint32_t pos = hash & mask;
+
+    while (ht->slots[pos].hash) {
+        const assets_hash_slot_t *slot = &ht->slots[pos];
+        if (slot->hash == hash && strcmp(ht->keys[slot->index], key) == 0) {
+            return slot->index;
+        }
+        pos = (pos + 1) & mask;
+    }
+    return -1;
+}
+
+assets_hash_table_t *emote_assets_table_create(const char *name, size_t value_size)
+{
+    assets_hash_table_t *ht = (assets_hash_table_t *)calloc(1, sizeof(assets_hash_table_t));
+    if (!ht) {
+        return NULL;
+    }
+
+    if (name) {
+        snprintf(ht->name, sizeof(ht->name), "%s", name);
+    }
+    ht->value_size = value_size;
+
+    uint32_t slot_count = ASSETS_TABLE_MIN_SLOTS;
+    while (slot_count < CONFIG_EMOTE_ASSETS_HASH_TABLE_SIZE) {
+        slot_count <<= 1;
+    }
+
+    if (emote_assets_table_rebuild(ht, slot_count, emote_assets_table_max_count(slot_count) * ASSETS_TABLE_POOL_PER_KEY) != ESP_OK) {
+        free(ht);
+        return NULL;
+    }
+    return ht;
+}
+
+void emote_assets_table_destroy(assets_hash_table_t *ht)
+{
+    if (!ht) {
+        return;
+    }
+
+    free(ht->arena);
+    free(ht);
+}
+
+static esp_err_t emote_assets_table_insert(assets_hash_table_t *ht, const char *key, const void *value, bool borrow)
+{
+    ESP_RETURN_ON_FALSE(ht && key && value, ESP_ERR_INVALID_ARG, TAG, "Invalid parameters");
+
+    uint32_t hash = emote_assets_hash_string(key);
+    int index = emote_assets_table_lookup(ht, key, hash);
+    if (index >= 0) {
+        memcpy(ht->values + index * ht->value_size, value, ht->value_size);
+        return ESP_OK;
+    }
+
+    uint32_t key_len = borrow ? 0 : strlen(key) + 1;
+    uint32_t slot_count = ht->slot_count;
+    uint32_t pool_size = ht->pool_size;
+    if (ht->count + 1 > emote_assets_table_max_count(slot_count)) {
+        slot_count <<= 1;
+    }
+    while (ht->pool_used + key_len > pool_size) {
+        pool_size <<= 1;
+    }
+    if (slot_count != ht->slot_count || pool_size != ht->pool_size) {
+        ESP_RETURN_ON_ERROR(emote_assets_table_rebuild(ht, slot_count, pool_size), TAG, "[%s] Failed to insert: %s", ht->name, key);
+    }
+
+    index = ht->count++;
+    if (borrow) {
+        ht->keys[index] = key;
+        ht->borrowed++;
+    } else {
+        memcpy(ht->pool + ht->pool_used, key, key_len);
+        ht->keys[index] = ht->pool + ht->pool_used;
+        ht->pool_used += key_len;
+    }
+    memcpy(ht->values + index * ht->value_size, value, ht->value_size);
+
+    uint32_t mask = ht->slot_count - 1;
+    uint32_t pos = hash & mask;
+    while (ht->slots[pos].hash) {
+        pos = (pos + 1) & mask;
+    }
+    ht->slots[pos].hash = hash;
+    ht->slots[pos].index = index;
+    return ESP_OK;
+}
+
+esp_err_t emote_assets_table_set(assets_hash_table_t *ht, const char *key, const void *value)
+{
+    return emote_assets_table_insert(ht, key, value, false);
+}
+
+esp_err_t emote_assets_table_set_static(assets_hash_table_t *ht, const char *key, const void *value)
+{
+    return emote_assets_table_insert(ht, key, value, true);
+}
+
+void *emote_assets_table_get(assets_hash_table_t *ht, const char *key)
+{
+    if (!ht || !key) {
+        return NULL;
+    }
+
+    int index = emote_assets_table_lookup(ht, key, emote_assets_hash_string(key));
+    return (index >= 0) ? ht->values + index * ht->value_size : NULL;
+}
+
+int emote_assets_table_index_of(const assets_hash_table_t *ht, const char *key)
+{
+    if (!ht || !key) {
+        return -1;
+    }
+
+    return emote_assets_table_lookup(ht, key, emote_assets_hash_string(key));
+}
+
+void *emote_assets_table_at(assets_hash_table_t *ht, int index)
+{
+    if (!ht || index < 0 || (uint32_t)index >= ht->count) {
+        return NULL;
+    }
+
+    return ht->values + index * ht->value_size;
+}
+
+int emote_assets_table_count(const assets_hash_table_t *ht)
+{
+    return ht ? (int)ht->count : 0;
+}
+
+void emote_assets_table_get_stats(const assets_hash_table_t *ht, emote_assets_table_stats_t *stats)
+{
+    if (!stats) {
+        return;
+    }
+
+    memset(stats, 0, sizeof(*stats));
+    if (!ht) {
+        return;
+    }
+
+    uint32_t max_count = emote_assets_table_max_count(ht->slot_count);
+    stats->count = ht->count;
+    stats->slot_count = ht->slot_count;
+    stats->borrowed_keys = ht->borrowed;
+    stats->pool_used = ht->pool_used;
+    stats->arena_size = ht->slot_count * sizeof(assets_hash_slot_t) +
+                        ASSETS_TABLE_ALIGN(max_count * sizeof(const char *)) +
+                        ASSETS_TABLE_ALIGN(max_count * ht->value_size) + ht->pool_size;
+}
@@ -0,0 +1,256 @@
+/*
+ * SPDX-FileCopyrightText: 2025 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "sdkconfig.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "esp_log.h"
+#include "esp_check.h"
+#include <inttypes.h>
+#include <string.h>
+#include <stdlib.h>
+
+#include "emote_defs.h"
+#include "emote_trace.h"
+
+static const char *TAG = "Expression_trace";
+
+#if CONFIG_EMOTE_TRACE
+
+#define TRACE_EVENTS            CONFIG_EMOTE_TRACE_EVENTS
+#define TRACE_MAX_TASKS         8
+#define TRACE_TID_ISR           0
+#define TRACE_TID_OTHER         (TRACE_MAX_TASKS + 1)
+
+typedef struct {
+    uint32_t seq;                           // Index + 1 of the span held, 0 while being written
+    uint8_t tid;
+    char phase;                             // 'X' span, 'i' instant
+    const char *name;
+    int64_t ts;
+    uint32_t dur;
+    int32_t arg;
+} emote_trace_entry_t;
+
+// 32 bytes on the chips, where ts is 8-byte aligned; 28 on the -m32 linux target
+_Static_assert(sizeof(emote_trace_entry_t) <= 32, "Update the span size in the EMOTE_TRACE_EVENTS help");
+
+typedef struct {
+    TaskHandle_t task;
+    char name[configMAX_TASK_NAME_LEN];
+} emote_trace_task_t;
+
+struct emote_trace_s {
+    uint32_t head;                          // Spans claimed so far
+    uint32_t tail;                          // First span kept since emote_trace_clear()
+    uint32_t task_count;
+    portMUX_TYPE mux;                       // Serializes task registration
+    emote_trace_task_t tasks[TRACE_MAX_TASKS];
+    emote_trace_entry_t entries[TRACE_EVENTS];
+};
+
+// Thread ids are small integers, so names are copied once and not looked up per span
+static uint8_t emote_trace_tid(emote_trace_t *trace)
+{
+    if (xPortInIsrContext()) {
+        return TRACE_TID_ISR;
+    }
+
+    TaskHandle_t task = xTaskGetCurrentTaskHandle();
+    uint32_t count = __atomic_load_n(&trace->task_count, __ATOMIC_ACQUIRE);
+    for (uint32_t i = 0; i < count; i++) {
+        if (trace->tasks[i].task == task) {
+            return i + 1;
+        }
+    }
+    if (count == TRACE_MAX_TASKS) {
+        return TRACE_TID_OTHER;
+    }
+
+    // First span of this task
+    char name[configMAX_TASK_NAME_LEN];
+    snprintf(name, sizeof(name), "%s", pcTaskGetName(NULL));
+
+    uint8_t tid = TRACE_TID_OTHER;
+    portENTER_CRITICAL(&trace->mux);
+    count = trace->task_count;
+    for (uint32_t i = 0; i < count; i++) {
+        if (trace->tasks[i].task == task) {
+            tid = i + 1;
+            break;
+        }
+    }
+    if (tid == TRACE_TID_OTHER && count < TRACE_MAX_TASKS) {
+        trace->tasks[count].task = task;
+        memcpy(trace->tasks[count].name, name, sizeof(name));
+        __atomic_store_n(&trace->task_count, count + 1, __ATOMIC_RELEASE);
+        tid = count + 1;
+    }
+    portEXIT_CRITICAL(&trace->mux);
+    return tid;
+}
+
+static void emote_trace_record(emote_trace_t *trace, char phase, const char *name, int64_t ts, int64_t dur,
+                               int32_t arg)
+{
+    uint8_t tid = emote_trace_tid(trace);
+    uint32_t idx = __atomic_fetch_add(&trace->head, 1, __ATOMIC_RELAXED);
+    emote_trace_entry_t *entry = &trace->entries[idx % TRACE_EVENTS];
+
+    // Readers skip the slot until its sequence number is published again
+    __atomic_store_n(&entry->seq, 0, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+    entry->tid = tid;
+    entry->phase = phase;
+    entry->name = name;
+    entry->ts = ts;
+    entry->dur = dur < 0 ? 0 : (dur > UINT32_MAX ? UINT32_MAX : (uint32_t)dur);
+    entry->arg = arg;
+    __atomic_store_n(&entry->seq, idx + 1, __ATOMIC_RELEASE);
+}
+
+// Copy the span at idx, false if it is being written or was overwritten
+static bool emote_trace_read(emote_trace_t *trace, uint32_t idx, emote_trace_entry_t *out)
+{
+    emote_trace_entry_t *entry = &trace->entries[idx % TRACE_EVENTS];
+
+    if (__atomic_load_n(&entry->seq, __ATOMIC_ACQUIRE) != idx + 1) {
+        return false;
+    }
+    *out = *entry;
+    __atomic_thread_fence(__ATOMIC_ACQUIRE);
+    return __atomic_load_n(&entry->seq, __ATOMIC_RELAXED) == idx + 1;
+}
+
+static void emote_trace_thread_name(FILE *stream, const char **sep, uint32_t tid, const char *name)
+{
+    fprintf(stream, "%s{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%" PRIu32 ",\"args\":{\"name\":\"%s\"}}",
+            *sep, tid, name);
+    *sep = ",\n";
+}
+
+// ===== Hooks =====
+
+esp_err_t emote_trace_init(emote_handle_t handle)
+{
+    emote_trace_t *trace = (emote_trace_t *)calloc(1, sizeof(emote_trace_t));
+    ESP_RETURN_ON_FALSE(trace, ESP_ERR_NO_MEM, TAG, "Failed to allocate trace ring");
+
+    portMUX_TYPE mux = portMUX_INITIALIZER_UNLOCKED;
+    trace->mux = mux;
+    handle->trace = trace;
+    return ESP_OK;
+}
+
+void emote_trace_deinit(emote_handle_t handle)
+{
+    if (!handle) {
+        return;
+    }
+
+    free(handle->trace);
+    handle->trace = NULL;
+}
+
+void emote_trace_span(emote_handle_t handle, const char *name, int64_t start, int32_t arg)
+{
+    if (handle->trace) {
+        emote_trace_record(handle->trace, 'X', name, start, esp_timer_get_time() - start, arg);
+    }
+}
+
+void emote_trace_instant(emote_handle_t handle, const char *name, int32_t arg)
+{
+    if (handle->trace) {
+        emote_trace_record(handle->trace, 'i', name, esp_timer_get_time(), 0, arg);
+    }
+}
+
+// ===== API =====
+
+esp_err_t emote_trace_dump(emote_handle_t handle, FILE *stream)
+{
+    esp_err_t ret = ESP_OK;
+
+    ESP_GOTO_ON_FALSE(handle && stream, ESP_ERR_INVALID_ARG, error, TAG, "Invalid parameters");
+    ESP_GOTO_ON_FALSE(handle->trace, ESP_ERR_INVALID_STATE, error, TAG, "Trace not initialized");
+
+    emote_trace_t *trace = handle->trace;
+    uint32_t head = __atomic_load_n(&trace->head, __ATOMIC_ACQUIRE);
+    uint32_t kept = head - __atomic_load_n(&trace->tail, __ATOMIC_RELAXED);
+    if (kept > TRACE_EVENTS) {
+        kept = TRACE_EVENTS;
+    }
+
+    const char *sep = "";
+    fputs("{\"traceEvents\":[\n", stream);
+    emote_trace_thread_name(stream, &sep, TRACE_TID_ISR, "isr");
+    uint32_t task_count = __atomic_load_n(&trace->task_count, __ATOMIC_ACQUIRE);
+    for (uint32_t i = 0; i < task_count; i++) {
+        emote_trace_thread_name(stream, &sep, i + 1, trace->tasks[i].name);
+    }
+    if (task_count == TRACE_MAX_TASKS) {
+        emote_trace_thread_name(stream, &sep, TRACE_TID_OTHER, "other");
+    }
+
+    // Spans recorded meanwhile are left out; slots overwritten meanwhile are skipped
+    emote_trace_entry_t entry;
+    uint32_t dropped = 0;
+    for (uint32_t idx = head - kept; idx != head; idx++) {
+        if (!emote_trace_read(trace, idx, &entry)) {
+            dropped++;
+            continue;
+        }
+        fprintf(stream, "%s{\"name\":\"%s\",\"cat\":\"emote\",\"ph\":\"%c\",\"ts\":%" PRId64,
+                sep, entry.name, entry.phase, entry.ts);
+        if (entry.phase == 'X') {
+            fprintf(stream, ",\"dur\":%" PRIu32, entry.dur);
+        } else {
+            fputs(",\"s\":\"t\"", stream);
+        }
+        fprintf(stream, ",\"pid\":1,\"tid\":%u,\"args\":{\"arg\":%" PRId32 "}}", entry.tid, entry.arg);
+    }
+    fputs("\n],\"displayTimeUnit\":\"ms\"}\n", stream);
+    fflush(stream);
+
+    ESP_LOGD(TAG, "Dumped %" PRIu32 " spans, %" PRIu32 " overwritten while dumping", kept - dropped, dropped);
+    ESP_GOTO_ON_FALSE(!ferror(stream), ESP_FAIL, error, TAG, "Failed to write trace");
+    return ESP_OK;
+
+error:
+    return ret;
+}
+
+esp_err_t emote_trace_clear(emote_handle_t handle)
+{
+    esp_err_t ret = ESP_OK;
+
+    ESP_GOTO_ON_FALSE(handle, ESP_ERR_INVALID_ARG, error, TAG, "Invalid parameters");
+    ESP_GOTO_ON_FALSE(handle->trace, ESP_ERR_INVALID_STATE, error, TAG, "Trace not initialized");
+
+    __atomic_store_n(&handle->trace->tail, __atomic_load_n(&handle->trace->head, __ATOMIC_ACQUIRE),
+                     __ATOMIC_RELEASE);
+    return ESP_OK;
+
+error:
+    return ret;
+}
+
+#else
+
+esp_err_t emote_trace_dump(emote_handle_t handle, FILE *stream)
+{
+    ESP_LOGD(TAG, "CONFIG_EMOTE_TRACE is disabled");
+    return ESP_ERR_NOT_SUPPORTED;
+}
+
+esp_err_t emote_trace_clear(emote_handle_t handle)
+{
+    ESP_LOGD(TAG, "CONFIG_EMOTE_TRACE is disabled");
+    return ESP_ERR_NOT_SUPPORTED;
+}
+
+#endif
@@ -6,7 +6,9 @@
 
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
+#include "freertos/semphr.h"
 #include <string.h>
+#include <stdlib.h>
 #include "esp_log.h"
 #include "unity.h"
 #include "unity_test_utils.h"
@@ -14,20 +16,56 @@
 #include "bsp/display.h"
 #include "esp_lcd_panel_io.h"
 #include "esp_lcd_panel_ops.h"
+#include "esp_timer.h"
 
 #include "dirent.h"
 #include "expression_emote.h"
+#include "emote_json.h"
+#include "emote_table.h"
+#include "emote_layout.h"
+#include "emote_font.h"
+#include "emote_strip.h"
+#include "emote_trace.h"
+#include "emote_record.h"
 #include "gfx.h"
 
 static const char *TAG = "expression_emote_test";
 
+LV_FONT_DECLARE(font_puhui_basic_20_4);
+
 static esp_lcd_panel_io_handle_t io_handle = NULL;
 static esp_lcd_panel_handle_t panel_handle = NULL;
 
 static gfx_image_dsc_t img_dsc = {0};
 
+// Frame gap histogram, filled by the flush callback while enabled
+#define TEST_GAP_BINS       5
+static const int64_t test_gap_limits_ms[TEST_GAP_BINS - 1] = { 10, 20, 40, 80 };
+static volatile bool test_gap_enabled = false;
+static int64_t test_gap_last_us = 0;
+static int64_t test_gap_max_us = 0;
+static uint32_t test_gap_hist[TEST_GAP_BINS] = {0};
+
+static volatile uint32_t test_flush_count = 0;
+
 static void test_flush_callback(int x_start, int y_start, int x_end, int y_end, const void *data, emote_handle_t handle)
 {
+    test_flush_count++;
+    if (test_gap_enabled) {
+        int64_t now = esp_timer_get_time();
+        if (test_gap_last_us) {
+            int64_t gap = now - test_gap_last_us;
+            int bin = 0;
+            while (bin < TEST_GAP_BINS - 1 && gap >= test_gap_limits_ms[bin] * 1000) {
+                bin++;
+            }
+            test_gap_hist[bin]++;
+            if (gap > test_gap_max_us) {
+                test_gap_max_us = gap;
+            }
+        }
+        test_gap_last_us = now;
+    }
     esp_lcd_panel_draw_bitmap(panel_handle, x_start, y_start, x_end, y_end, data);
 }
 
@@ -372,6 +410,167 @@ TEST_CASE("Test basic elements", "[path][flash read][basic]")
     bsp_spiffs_unmount();
 }
 
+// Tables of one load, compared between index.json and index.bin
+#define TEST_INDEX_MAX_ASSETS   64
+#define TEST_INDEX_JSON_PATH    BSP_SPIFFS_MOUNT_POINT "/esp32_s3_assets.bin"
+#define TEST_INDEX_BIN_PATH     BSP_SPIFFS_MOUNT_POINT "/esp32_s3_assets_index.bin"
+
+typedef struct {
+    bool index_bin_loaded;
+    int emoji_count;
+    int icon_count;
+    emoji_data_t emojis[TEST_INDEX_MAX_ASSETS];
+    icon_data_t icons[TEST_INDEX_MAX_ASSETS];
+    int builtin_icons[EMOTE_BUILTIN_ICON_MAX];
+    struct {
+        bool present;
+        bool digits;
+        bool strip;
+        gfx_coord_t x;
+        gfx_coord_t y;
+        uint16_t width;
+        uint16_t height;
+    } objs[EMOTE_DEF_OBJ_MAX];
+    int custom_count;
+} test_index_snapshot_t;
+
+static void test_index_snapshot(const char *path, test_index_snapshot_t *snap)
+{
+    memset(snap, 0, sizeof(*snap));
+
+    emote_handle_t handle = init_emote();
+    TEST_ASSERT_NOT_NULL(handle);
+
+    emote_data_t data = {
+        .type = EMOTE_SOURCE_PATH,
+        .source = {
+            .path = path,
+        },
+    };
+    TEST_ASSERT_EQUAL(ESP_OK, emote_mount_and_load_assets(handle, &data));
+
+    snap->index_bin_loaded = handle->index_bin_loaded;
+    snap->emoji_count = emote_assets_table_count(handle->emoji_table);
+    snap->icon_count = emote_assets_table_count(handle->icon_table);
+    TEST_ASSERT_LESS_OR_EQUAL(TEST_INDEX_MAX_ASSETS, snap->emoji_count);
+    TEST_ASSERT_LESS_OR_EQUAL(TEST_INDEX_MAX_ASSETS, snap->icon_count);
+    for (int i = 0; i < snap->emoji_count; i++) {
+        snap->emojis[i] = *(emoji_data_t *)emote_assets_table_at(handle->emoji_table, i);
+    }
+    for (int i = 0; i < snap->icon_count; i++) {
+        snap->icons[i] = *(icon_data_t *)emote_assets_table_at(handle->icon_table, i);
+    }
+    memcpy(snap->builtin_icons, handle->builtin_icons, sizeof(snap->builtin_icons));
+
+    for (int i = 0; i < EMOTE_DEF_OBJ_MAX; i++) {
+        gfx_obj_t *obj = handle->def_objects[i].obj;
+        snap->objs[i].present = (obj != NULL);
+        snap->objs[i].digits = (handle->def_objects[i].digits != NULL);
+        snap->objs[i].strip = (handle->def_objects[i].strip != NULL);
+        if (obj) {
+            gfx_obj_get_pos(obj, &snap->objs[i].x, &snap->objs[i].y);
+            gfx_obj_get_size(obj, &snap->objs[i].width, &snap->objs[i].height);
+        }
+    }
+    for (emote_custom_obj_entry_t *entry = handle->custom_objects; entry; entry = entry->next) {
+        snap->custom_count++;
+    }
+
+    cleanup_emote(handle);
+}
+
+static void test_index_compare(const test_index_snapshot_t *expected, const test_index_snapshot_t *actual)
+{
+    // Data references are offsets into different bins, sizes and attributes must match
+    TEST_ASSERT_EQUAL(expected->emoji_count, actual->emoji_count);
+    for (int i = 0; i < expected->emoji_count; i++) {
+        TEST_ASSERT_EQUAL(expected->emojis[i].size, actual->emojis[i].size);
+        TEST_ASSERT_EQUAL(expected->emojis[i].fps, actual->emojis[i].fps);
+        TEST_ASSERT_EQUAL(expected->emojis[i].loop, actual->emojis[i].loop);
+    }
+    TEST_ASSERT_EQUAL(expected->icon_count, actual->icon_count);
+    for (int i = 0; i < expected->icon_count; i++) {
+        TEST_ASSERT_EQUAL(expected->icons[i].size, actual->icons[i].size);
+    }
+    TEST_ASSERT_EQUAL_INT_ARRAY(expected->builtin_icons, actual->builtin_icons, EMOTE_BUILTIN_ICON_MAX);
+
+    for (int i = 0; i < EMOTE_DEF_OBJ_MAX; i++) {
+        TEST_ASSERT_EQUAL(expected->objs[i].present, actual->objs[i].present);
+        TEST_ASSERT_EQUAL(expected->objs[i].digits, actual->objs[i].digits);
+        TEST_ASSERT_EQUAL(expected->objs[i].strip, actual->objs[i].strip);
+        TEST_ASSERT_EQUAL(expected->objs[i].x, actual->objs[i].x);
+        TEST_ASSERT_EQUAL(expected->objs[i].y, actual->objs[i].y);
+        TEST_ASSERT_EQUAL(expected->objs[i].width, actual->objs[i].width);
+        TEST_ASSERT_EQUAL(expected->objs[i].height, actual->objs[i].height);
+    }
+    TEST_ASSERT_EQUAL(expected->custom_count, actual->custom_count);
+}
+
+// Swap the first two bytes of the index.bin magic, a second call restores them.
+// The assets checksum is a byte sum, so the bin still mounts.
+static void test_index_swap_magic(const char *path)
+{
+    const int entry_size = CONFIG_MMAP_FILE_NAME_LENGTH + 12;   // name, size, offset, width, height
+    uint32_t header[3];                                          // total_files, checksum, total_len
+    uint8_t entry[CONFIG_MMAP_FILE_NAME_LENGTH + 12];
+    uint8_t magic[2];
+    long pos = -1;
+
+    FILE *fp = fopen(path, "r+b");
+    TEST_ASSERT_NOT_NULL(fp);
+    TEST_ASSERT_EQUAL(1, fread(header, sizeof(header), 1, fp));
+
+    for (uint32_t i = 0; i < header[0]; i++) {
+        TEST_ASSERT_EQUAL(1, fread(entry, entry_size, 1, fp));
+        if (strncmp((const char *)entry, "index.bin", CONFIG_MMAP_FILE_NAME_LENGTH) == 0) {
+            uint32_t offset;
+            memcpy(&offset, entry + CONFIG_MMAP_FILE_NAME_LENGTH + 4, sizeof(offset));
+            pos = sizeof(header) + header[0] * entry_size + offset + 2;  // Skip the "ZZ" file prefix
+            break;
+        }
+    }
+    TEST_ASSERT_NOT_EQUAL(-1, pos);
+
+    TEST_ASSERT_EQUAL(0, fseek(fp, pos, SEEK_SET));
+    TEST_ASSERT_EQUAL(1, fread(magic, sizeof(magic), 1, fp));
+    uint8_t swapped[2] = { magic[1], magic[0] };
+    TEST_ASSERT_EQUAL(0, fseek(fp, pos, SEEK_SET));
+    TEST_ASSERT_EQUAL(1, fwrite(swapped, sizeof(swapped), 1, fp));
+    fclose(fp);
+}
+
+TEST_CASE("Test precompiled index", "[path][flash read][index]")
+{
+    test_index_snapshot_t *json_snap = calloc(1, sizeof(test_index_snapshot_t));
+    test_index_snapshot_t *bin_snap = calloc(1, sizeof(test_index_snapshot_t));
+    TEST_ASSERT_NOT_NULL(json_snap);
+    TEST_ASSERT_NOT_NULL(bin_snap);
+
+    bsp_spiffs_mount();
+
+    // The plain bin only has index.json, its copy also has index.bin built by emote_index_tool.py
+    test_index_snapshot(TEST_INDEX_JSON_PATH, json_snap);
+    TEST_ASSERT_FALSE(json_snap->index_bin_loaded);
+    TEST_ASSERT_GREATER_THAN(0, json_snap->emoji_count);
+
+    test_index_snapshot(TEST_INDEX_BIN_PATH, bin_snap);
+    TEST_ASSERT_TRUE(bin_snap->index_bin_loaded);
+    test_index_compare(json_snap, bin_snap);
+    printf("index.bin matches index.json: %d emojis, %d icons, %d custom objects\n",
+           bin_snap->emoji_count, bin_snap->icon_count, bin_snap->custom_count);
+
+    // A corrupted header must fall back to index.json
+    test_index_swap_magic(TEST_INDEX_BIN_PATH);
+    test_index_snapshot(TEST_INDEX_BIN_PATH, bin_snap);
+    test_index_swap_magic(TEST_INDEX_BIN_PATH);
+    TEST_ASSERT_FALSE(bin_snap->index_bin_loaded);
+    test_index_compare(json_snap, bin_snap);
+
+    bsp_spiffs_unmount();
+    free(bin_snap);
+    free(json_snap);
+}
+
 TEST_CASE("Test custom elements", "[partition][flash mmap][custom]")
 {
     emote_handle_t handle = init_emote();
@@ -444,6 +643,1798 @@ TEST_CASE("Test mount and load assets", "[partition][flash mmap][custom]")
     cleanup_emote(handle);
 }
 
+// Lookup before the name index: strcmp over every file in storage order
+static int test_linear_find(char *const names[], int count, const char *name)
+{
+    for (int i = 0; i < count; i++) {
+        if (strcmp(names[i], name) == 0) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+TEST_CASE("Test asset name lookup scaling", "[table][benchmark]")
+{
+    static const int sizes[] = { 16, 256, 1024 };
+    const int max_count = 1024;
+    const size_t name_len = 24;
+    int64_t linear_ns = 0;
+    int64_t index_ns = 0;
+
+    char *pool = (char *)malloc(max_count * name_len);
+    char **names = (char **)malloc(max_count * sizeof(char *));
+    emote_asset_name_entry_t *entries = (emote_asset_name_entry_t *)malloc(max_count * sizeof(emote_asset_name_entry_t));
+    TEST_ASSERT_NOT_NULL(pool);
+    TEST_ASSERT_NOT_NULL(names);
+    TEST_ASSERT_NOT_NULL(entries);
+
+    for (size_t s = 0; s < sizeof(sizes) / sizeof(sizes[0]); s++) {
+        const int count = sizes[s];
+        const int rounds = count < 1024 ? 4096 / count : 4;
+        int hits = 0;
+
+        // Storage order is not name order, as in a real partition
+        for (int i = 0; i < count; i++) {
+            names[i] = pool + i * name_len;
+            snprintf(names[i], name_len, "emoji_%04d.eaf", (i * 7919) % count);
+        }
+
+        int64_t start = esp_timer_get_time();
+        for (int i = 0; i < count; i++) {
+            entries[i].name = names[i];
+            entries[i].index = i;
+        }
+        emote_asset_index_sort(entries, count);
+        int64_t build_us = esp_timer_get_time() - start;
+
+        start = esp_timer_get_time();
+        for (int round = 0; round < rounds; round++) {
+            for (int i = 0; i < count; i++) {
+                hits += test_linear_find(names, count, names[i]) == i;
+            }
+        }
+        linear_ns = (esp_timer_get_time() - start) * 1000 / (rounds * count);
+
+        start = esp_timer_get_time();
+        for (int round = 0; round < rounds; round++) {
+            for (int i = 0; i < count; i++) {
+                hits += emote_asset_index_find(entries, count, names[i]) == i;
+            }
+        }
+        index_ns = (esp_timer_get_time() - start) * 1000 / (rounds * count);
+
+        printf("Asset lookup: %4d names, index build %6lld us, linear %7lld ns/name, index %5lld ns/name\n",
+               count, build_us, linear_ns, index_ns);
+        TEST_ASSERT_EQUAL(2 * rounds * count, hits);
+        TEST_ASSERT_EQUAL(-1, emote_asset_index_find(entries, count, "missing.eaf"));
+    }
+
+    // Loading looks up every indexed asset by name, so this is the mount-time cost per asset too
+    TEST_ASSERT_EQUAL(true, index_ns < linear_ns);
+
+    // A name stored twice resolves to its first file, as the linear scan did
+    static const char *const dups[] = { "b.eaf", "a.eaf", "b.eaf", "c.eaf", "a.eaf", "b.eaf", "a.eaf" };
+    const int dup_count = sizeof(dups) / sizeof(dups[0]);
+    for (int i = 0; i < dup_count; i++) {
+        entries[i].name = dups[i];
+        entries[i].index = i;
+    }
+    emote_asset_index_sort(entries, dup_count);
+    TEST_ASSERT_EQUAL(1, emote_asset_index_find(entries, dup_count, "a.eaf"));
+    TEST_ASSERT_EQUAL(0, emote_asset_index_find(entries, dup_count, "b.eaf"));
+    TEST_ASSERT_EQUAL(3, emote_asset_index_find(entries, dup_count, "c.eaf"));
+    TEST_ASSERT_EQUAL(-1, emote_asset_index_find(entries, dup_count, "d.eaf"));
+
+    free(entries);
+    free(names);
+    free(pool);
+}
+
+TEST_CASE("Test asset name lookup", "[partition][flash mmap][benchmark]")
+{
+    static const char *file_names[] = {
+        "index.json", "happy.eaf", "sad.eaf", "crying.eaf", "sleepy.eaf", "angry.eaf",
+        "shocked.eaf", "thinking.eaf", "winking.eaf", "neutral.eaf", "icon_tips.bin",
+        "icon_speaker.bin", "battery_bg.bin", "icon_mic.bin", "battery_charge.bin", "listen.eaf",
+    };
+    const int file_count = sizeof(file_names) / sizeof(file_names[0]);
+    const int rounds = 1000;
+
+    emote_data_t data = {
+        .type = EMOTE_SOURCE_PARTITION,
+        .source = {
+            .partition_label = "anim_icon",
+        },
+        .flags = {
+            .mmap_enable = true,
+        },
+    };
+
+    emote_handle_t handle = init_emote();
+    if (handle) {
+        TEST_ASSERT_EQUAL(ESP_OK, emote_mount_assets(handle, &data));
+
+        int64_t start = esp_timer_get_time();
+        TEST_ASSERT_EQUAL(ESP_OK, emote_load_assets(handle));
+        int64_t load_us = esp_timer_get_time() - start;
+
+        const uint8_t *file_data = NULL;
+        size_t file_size = 0;
+        start = esp_timer_get_time();
+        for (int round = 0; round < rounds; round++) {
+            for (int i = 0; i < file_count; i++) {
+                TEST_ASSERT_EQUAL(ESP_OK, emote_get_asset_data_by_name(handle, file_names[i], &file_data, &file_size));
+            }
+        }
+        int64_t lookup_us = esp_timer_get_time() - start;
+
+        printf("Asset lookup: %d names, load: %lld us, lookup: %lld ns/name\n",
+               file_count, load_us, lookup_us * 1000 / (rounds * file_count));
+
+        cleanup_emote(handle);
+    }
+}
+
+// Write an assets bin as built by the assets tools: header, file table, then "ZZ" + data per file
+static void test_write_assets(const char *path, const char *const names[], const void *const datas[],
+                              const size_t sizes[], int count)
+{
+    const int entry_size = CONFIG_MMAP_FILE_NAME_LENGTH + 12;   // name, size, offset, width, height
+    uint8_t *table = (uint8_t *)calloc(count, entry_size);
+    uint32_t offset = 0;
+    uint32_t checksum = 0;
+    TEST_ASSERT_NOT_NULL(table);
+
+    for (int i = 0; i < count; i++) {
+        uint8_t *entry = table + i * entry_size;
+        uint32_t size = sizes[i];
+        strncpy((char *)entry, names[i], CONFIG_MMAP_FILE_NAME_LENGTH - 1);
+        memcpy(entry + CONFIG_MMAP_FILE_NAME_LENGTH, &size, sizeof(size));
+        memcpy(entry + CONFIG_MMAP_FILE_NAME_LENGTH + 4, &offset, sizeof(offset));
+        offset += 2 + size;
+    }
+
+    for (int i = 0; i < count * entry_size; i++) {
+        checksum += table[i];
+    }
+    for (int i = 0; i < count; i++) {
+        checksum += 'Z' + 'Z';
+        for (size_t j = 0; j < sizes[i]; j++) {
+            checksum += ((const uint8_t *)datas[i])[j];
+        }
+    }
+    uint32_t header[3] = { count, checksum & 0xFFFF, count * entry_size + offset };
+
+    FILE *fp = fopen(path, "wb");
+    TEST_ASSERT_NOT_NULL(fp);
+    TEST_ASSERT_EQUAL(1, fwrite(header, sizeof(header), 1, fp));
+    TEST_ASSERT_EQUAL(1, fwrite(table, count * entry_size, 1, fp));
+    for (int i = 0; i < count; i++) {
+        TEST_ASSERT_EQUAL(1, fwrite("ZZ", 2, 1, fp));
+        TEST_ASSERT_EQUAL(1, fwrite(datas[i], sizes[i], 1, fp));
+    }
+    fclose(fp);
+    free(table);
+}
+
+TEST_CASE("Test streaming index parser memory", "[path][json][benchmark]")
+{
+    const int entry_count = 1000;
+    const size_t entry_max = 96;
+    const size_t heap_limit = 1024;
+    const char *path = BSP_SPIFFS_MOUNT_POINT "/index_1000.bin";
+    static const uint8_t eaf[16] = { 0 };
+    char long_str[200];
+    size_t len = 0;
+
+    // Synthetic index.json: 1000 emojis, one item with a long field the loader does not use,
+    // and one with an over-long name that must only drop its own record
+    memset(long_str, 'x', sizeof(long_str) - 1);
+    long_str[sizeof(long_str) - 1] = '\0';
+    char *json = (char *)malloc(entry_count * entry_max + 2 * sizeof(long_str) + 128);
+    TEST_ASSERT_NOT_NULL(json);
+    len += sprintf(json + len, "{\"version\":\"1.0\",\"emoji_collection\":[");
+    for (int i = 0; i < entry_count; i++) {
+        len += sprintf(json + len, "%s{\"name\":\"emoji_%04d\",\"file\":\"emoji.eaf\",\"eaf\":{\"loop\":true,\"fps\":20}}",
+                       i ? "," : "", i);
+    }
+    len += sprintf(json + len, ",{\"name\":\"emoji_note\",\"file\":\"emoji.eaf\",\"note\":\"%s\"}", long_str);
+    len += sprintf(json + len, ",{\"name\":\"%s\",\"file\":\"emoji.eaf\"}]}", long_str);
+
+    const char *names[] = { "emoji.eaf", "index.json" };
+    const void *datas[] = { eaf, json };
+    const size_t sizes[] = { sizeof(eaf), len };
+
+    bsp_spiffs_mount();
+    test_write_assets(path, names, datas, sizes, 2);
+    free(json);
+
+    emote_handle_t handle = init_emote();
+    if (handle) {
+        emote_data_t data = {
+            .type = EMOTE_SOURCE_PATH,
+            .source = {
+                .path = path,
+            },
+        };
+        TEST_ASSERT_EQUAL(ESP_OK, emote_mount_assets(handle, &data));
+
+        // First load: the tables grow to 1000 entries
+        size_t free_before = heap_caps_get_free_size(MALLOC_CAP_DEFAULT);
+        heap_caps_monitor_local_minimum_free_size_start();
+        int64_t start = esp_timer_get_time();
+        TEST_ASSERT_EQUAL(ESP_OK, emote_load_assets(handle));
+        int64_t load_us = esp_timer_get_time() - start;
+        size_t free_min = heap_caps_get_minimum_free_size(MALLOC_CAP_DEFAULT);
+        heap_caps_monitor_local_minimum_free_size_stop();
+        size_t retained = free_before - heap_caps_get_free_size(MALLOC_CAP_DEFAULT);
+
+        printf("First load: %d bytes of index.json, %lld us, peak heap %d bytes, tables %d bytes\n",
+               (int)len, load_us, (int)(free_before - free_min), (int)retained);
+        TEST_ASSERT_EQUAL(entry_count + 1, emote_assets_table_count(handle->emoji_table));
+        TEST_ASSERT_NOT_NULL(emote_assets_table_get(handle->emoji_table, "emoji_note"));
+        TEST_ASSERT_NOT_NULL(emote_assets_table_get(handle->emoji_table, "emoji_0999"));
+
+        // Reload: the tables keep their size, so the peak is the parser's own working memory
+        free_before = heap_caps_get_free_size(MALLOC_CAP_DEFAULT);
+        heap_caps_monitor_local_minimum_free_size_start();
+        start = esp_timer_get_time();
+        TEST_ASSERT_EQUAL(ESP_OK, emote_load_assets(handle));
+        load_us = esp_timer_get_time() - start;
+        free_min = heap_caps_get_minimum_free_size(MALLOC_CAP_DEFAULT);
+        heap_caps_monitor_local_minimum_free_size_stop();
+
+        printf("Reload: %lld us, peak heap %d bytes (reader %d bytes + %d)\n",
+               load_us, (int)(free_before - free_min), (int)sizeof(emote_json_reader_t), (int)heap_limit);
+        TEST_ASSERT_EQUAL(entry_count + 1, emote_assets_table_count(handle->emoji_table));
+        TEST_ASSERT_LESS_OR_EQUAL(sizeof(emote_json_reader_t) + heap_limit, free_before - free_min);
+
+        cleanup_emote(handle);
+    }
+
+    remove(path);
+    bsp_spiffs_unmount();
+}
+
+// Baseline: the previous fixed-bucket chained table, kept here only for comparison
+#define TEST_CHAINED_BUCKETS 32
+
+typedef struct test_chained_entry_s {
+    char *key;
+    void *value;
+    struct test_chained_entry_s *next;
+} test_chained_entry_t;
+
+static uint32_t test_chained_hash(const char *str)
+{
+    uint32_t hash = 5381;
+    int c;
+    while ((c = *str++)) {
+        hash = ((hash << 5) + hash) + c;
+    }
+    return hash % TEST_CHAINED_BUCKETS;
+}
+
+static void test_chained_set(test_chained_entry_t **buckets, const char *key, const emoji_data_t *value)
+{
+    test_chained_entry_t *entry = (test_chained_entry_t *)malloc(sizeof(test_chained_entry_t));
+    TEST_ASSERT_NOT_NULL(entry);
+    entry->key = strdup(key);
+    entry->value = malloc(sizeof(emoji_data_t));
+    TEST_ASSERT_NOT_NULL(entry->key);
+    TEST_ASSERT_NOT_NULL(entry->value);
+    memcpy(entry->value, value, sizeof(emoji_data_t));
+
+    uint32_t hash = test_chained_hash(key);
+    entry->next = buckets[hash];
+    buckets[hash] = entry;
+}
+
+static void *test_chained_get(test_chained_entry_t **buckets, const char *key)
+{
+    for (test_chained_entry_t *entry = buckets[test_chained_hash(key)]; entry; entry = entry->next) {
+        if (strcmp(entry->key, key) == 0) {
+            return entry->value;
+        }
+    }
+    return NULL;
+}
+
+static void test_chained_destroy(test_chained_entry_t **buckets)
+{
+    for (int i = 0; i < TEST_CHAINED_BUCKETS; i++) {
+        test_chained_entry_t *entry = buckets[i];
+        while (entry) {
+            test_chained_entry_t *next = entry->next;
+            free(entry->key);
+            free(entry->value);
+            free(entry);
+            entry = next;
+        }
+    }
+}
+
+TEST_CASE("Test assets hash table", "[table][benchmark]")
+{
+    const int key_count = 500;
+    const int rounds = 20;
+    char key[32];
+    emoji_data_t value = {0};
+    test_chained_entry_t *buckets[TEST_CHAINED_BUCKETS] = {0};
+
+    size_t free_start = heap_caps_get_free_size(MALLOC_CAP_DEFAULT);
+    int64_t start = esp_timer_get_time();
+    for (int i = 0; i < key_count; i++) {
+        snprintf(key, sizeof(key), "emoji_%d", i);
+        value.size = i;
+        test_chained_set(buckets, key, &value);
+    }
+    int64_t chained_insert_us = esp_timer_get_time() - start;
+    size_t chained_heap = free_start - heap_caps_get_free_size(MALLOC_CAP_DEFAULT);
+
+    start = esp_timer_get_time();
+    for (int round = 0; round < rounds; round++) {
+        for (int i = 0; i < key_count; i++) {
+            snprintf(key, sizeof(key), "emoji_%d", i);
+            emoji_data_t *found = (emoji_data_t *)test_chained_get(buckets, key);
+            TEST_ASSERT_NOT_NULL(found);
+        }
+    }
+    int64_t chained_lookup_us = esp_timer_get_time() - start;
+    test_chained_destroy(buckets);
+
+    free_start = heap_caps_get_free_size(MALLOC_CAP_DEFAULT);
+    start = esp_timer_get_time();
+    assets_hash_table_t *ht = emote_assets_table_create("bench", sizeof(emoji_data_t));
+    TEST_ASSERT_NOT_NULL(ht);
+    for (int i = 0; i < key_count; i++) {
+        snprintf(key, sizeof(key), "emoji_%d", i);
+        value.size = i;
+        TEST_ASSERT_EQUAL(ESP_OK, emote_assets_table_set(ht, key, &value));
+    }
+    int64_t table_insert_us = esp_timer_get_time() - start;
+    size_t table_heap = free_start - heap_caps_get_free_size(MALLOC_CAP_DEFAULT);
+
+    start = esp_timer_get_time();
+    for (int round = 0; round < rounds; round++) {
+        for (int i = 0; i < key_count; i++) {
+            snprintf(key, sizeof(key), "emoji_%d", i);
+            emoji_data_t *found = (emoji_data_t *)emote_assets_table_get(ht, key);
+            TEST_ASSERT_NOT_NULL(found);
+            TEST_ASSERT_EQUAL(i, found->size);
+        }
+    }
+    int64_t table_lookup_us = esp_timer_get_time() - start;
+
+    TEST_ASSERT_EQUAL(key_count, emote_assets_table_count(ht));
+    TEST_ASSERT_NULL(emote_assets_table_get(ht, "missing"));
+    emote_assets_table_destroy(ht);
+
+    printf("Chained: insert %lld us, lookup %lld ns/key, heap %d bytes\n",
+           chained_insert_us, chained_lookup_us * 1000 / (rounds * key_count), (int)chained_heap);
+    printf("Open addressing: insert %lld us, lookup %lld ns/key, heap %d bytes\n",
+           table_insert_us, table_lookup_us * 1000 / (rounds * key_count), (int)table_heap);
+}
+
+TEST_CASE("Test table key storage heap", "[table][heap]")
+{
+    const int key_count = 200;
+    emote_assets_table_stats_t stats;
+    int value = 0;
+
+    // Stand-in for names inside a mapped asset image: one block that outlives both tables
+    char *names = (char *)malloc(key_count * 16);
+    TEST_ASSERT_NOT_NULL(names);
+    for (int i = 0; i < key_count; i++) {
+        snprintf(names + i * 16, 16, "emoji_%d", i);
+    }
+
+    size_t free_start = heap_caps_get_free_size(MALLOC_CAP_8BIT | MALLOC_CAP_INTERNAL);
+    assets_hash_table_t *copied = emote_assets_table_create("copied", sizeof(int));
+    TEST_ASSERT_NOT_NULL(copied);
+    for (int i = 0; i < key_count; i++) {
+        TEST_ASSERT_EQUAL(ESP_OK, emote_assets_table_set(copied, names + i * 16, &value));
+    }
+    int copied_heap = free_start - heap_caps_get_free_size(MALLOC_CAP_8BIT | MALLOC_CAP_INTERNAL);
+    emote_assets_table_get_stats(copied, &stats);
+    printf("Copied keys: heap %d bytes, arena %d bytes, key pool %d bytes\n",
+           copied_heap, (int)stats.arena_size, (int)stats.pool_used);
+    emote_assets_table_destroy(copied);
+
+    free_start = heap_caps_get_free_size(MALLOC_CAP_8BIT | MALLOC_CAP_INTERNAL);
+    assets_hash_table_t *borrowed = emote_assets_table_create("borrowed", sizeof(int));
+    TEST_ASSERT_NOT_NULL(borrowed);
+    for (int i = 0; i < key_count; i++) {
+        TEST_ASSERT_EQUAL(ESP_OK, emote_assets_table_set_static(borrowed, names + i * 16, &value));
+    }
+    int borrowed_heap = free_start - heap_caps_get_free_size(MALLOC_CAP_8BIT | MALLOC_CAP_INTERNAL);
+    emote_assets_table_get_stats(borrowed, &stats);
+    printf("Borrowed keys: heap %d bytes, arena %d bytes, key pool %d bytes\n",
+           borrowed_heap, (int)stats.arena_size, (int)stats.pool_used);
+    TEST_ASSERT_EQUAL(key_count, stats.borrowed_keys);
+    TEST_ASSERT_EQUAL(0, stats.pool_used);
+    TEST_ASSERT_NOT_NULL(emote_assets_table_get(borrowed, "emoji_42"));
+    emote_assets_table_destroy(borrowed);
+
+    TEST_ASSERT_LESS_THAN(copied_heap, borrowed_heap);
+    free(names);
+
+    // Table footprint for the bundled assets
+    emote_data_t data = {
+        .type = EMOTE_SOURCE_PARTITION,
+        .source = {
+            .partition_label = "anim_icon",
+        },
+        .flags = {
+            .mmap_enable = true,
+        },
+    };
+
+    emote_handle_t handle = init_emote();
+    if (handle) {
+        TEST_ASSERT_EQUAL(ESP_OK, emote_mount_and_load_assets(handle, &data));
+        emote_assets_table_get_stats(handle->emoji_table, &stats);
+        printf("Emoji table: %d entries, %d borrowed, arena %d bytes\n",
+               (int)stats.count, (int)stats.borrowed_keys, (int)stats.arena_size);
+        emote_assets_table_get_stats(handle->icon_table, &stats);
+        printf("Icon table: %d entries, %d borrowed, arena %d bytes\n",
+               (int)stats.count, (int)stats.borrowed_keys, (int)stats.arena_size);
+        cleanup_emote(handle);
+    }
+}
+
+TEST_CASE("Test asset id lookup", "[partition][flash mmap][benchmark]")
+{
+    static const char *emoji_names[] = {
+        "happy", "laughing", "funny", "loving", "embarrassed", "confident", "delicious",
+        "sad", "crying", "sleepy", "silly", "angry", "surprised", "shocked", "thinking",
+        "winking", "relaxed", "confused", "neutral", "idle",
+    };
+    const int emoji_count = sizeof(emoji_names) / sizeof(emoji_names[0]);
+    const int rounds = 1000;
+    emote_asset_id_t ids[sizeof(emoji_names) / sizeof(emoji_names[0])];
+
+    emote_data_t data = {
+        .type = EMOTE_SOURCE_PARTITION,
+        .source = {
+            .partition_label = "anim_icon",
+        },
+        .flags = {
+            .mmap_enable = true,
+        },
+    };
+
+    emote_handle_t handle = init_emote();
+    if (handle) {
+        TEST_ASSERT_EQUAL(ESP_OK, emote_mount_and_load_assets(handle, &data));
+
+        for (int i = 0; i < emoji_count; i++) {
+            TEST_ASSERT_EQUAL(ESP_OK, emote_get_emoji_id(handle, emoji_names[i], &ids[i]));
+        }
+        emote_asset_id_t missing_id;
+        TEST_ASSERT_EQUAL(ESP_ERR_NOT_FOUND, emote_get_emoji_id(handle, "missing", &missing_id));
+
+        emoji_data_t *by_name = NULL;
+        emoji_data_t *by_id = NULL;
+        int64_t start = esp_timer_get_time();
+        for (int round = 0; round < rounds; round++) {
+            for (int i = 0; i < emoji_count; i++) {
+                TEST_ASSERT_EQUAL(ESP_OK, emote_get_emoji_data_by_name(handle, emoji_names[i], &by_name));
+            }
+        }
+        int64_t name_us = esp_timer_get_time() - start;
+
+        start = esp_timer_get_time();
+        for (int round = 0; round < rounds; round++) {
+            for (int i = 0; i < emoji_count; i++) {
+                TEST_ASSERT_EQUAL(ESP_OK, emote_get_emoji_data_by_id(handle, ids[i], &by_id));
+            }
+        }
+        int64_t id_us = esp_timer_get_time() - start;
+        TEST_ASSERT_EQUAL_PTR(by_name, by_id);
+
+        start = esp_timer_get_time();
+        for (int i = 0; i < emoji_count; i++) {
+            TEST_ASSERT_EQUAL(ESP_OK, emote_set_anim_emoji(handle, emoji_names[i]));
+        }
+        int64_t set_name_us = esp_timer_get_time() - start;
+
+        start = esp_timer_get_time();
+        for (int i = 0; i < emoji_count; i++) {
+            TEST_ASSERT_EQUAL(ESP_OK, emote_set_anim_emoji_id(handle, ids[i]));
+        }
+        int64_t set_id_us = esp_timer_get_time() - start;
+
+        printf("Emoji lookup: by name %lld ns, by id %lld ns\n",
+               name_us * 1000 / (rounds * emoji_count), id_us * 1000 / (rounds * emoji_count));
+        printf("Set emoji: by name %lld us, by id %lld us\n",
+               set_name_us / emoji_count, set_id_us / emoji_count);
+
+        // Ids from a previous load are rejected instead of aliasing new entries
+        TEST_ASSERT_EQUAL(ESP_OK, emote_unload_assets(handle));
+        TEST_ASSERT_EQUAL(ESP_OK, emote_load_assets(handle));
+        TEST_ASSERT_EQUAL(ESP_ERR_INVALID_STATE, emote_get_emoji_data_by_id(handle, ids[0], &by_id));
+
+        cleanup_emote(handle);
+    }
+}
+
+TEST_CASE("Test shared asset cache", "[partition][flash read][cache]")
+{
+    const int rounds = 20;
+    emote_cache_stats_t before;
+    emote_cache_stats_t after;
+
+    emote_data_t data = {
+        .type = EMOTE_SOURCE_PARTITION,
+        .source = {
+            .partition_label = "anim_icon",
+        },
+        .flags = {
+            .mmap_enable = false,
+        },
+    };
+
+    emote_handle_t handle = init_emote();
+    if (handle) {
+        TEST_ASSERT_EQUAL(ESP_OK, emote_mount_and_load_assets(handle, &data));
+
+        // Warm both emojis, then every switch should be served from RAM
+        TEST_ASSERT_EQUAL(ESP_OK, emote_set_anim_emoji(handle, "happy"));
+        TEST_ASSERT_EQUAL(ESP_OK, emote_set_anim_emoji(handle, "angry"));
+        TEST_ASSERT_EQUAL(ESP_OK, emote_get_cache_stats(handle, &before));
+
+        int64_t start = esp_timer_get_time();
+        for (int i = 0; i < rounds; i++) {
+            TEST_ASSERT_EQUAL(ESP_OK, emote_set_anim_emoji(handle, (i & 1) ? "angry" : "happy"));
+        }
+        int64_t switch_us = esp_timer_get_time() - start;
+
+        TEST_ASSERT_EQUAL(ESP_OK, emote_get_cache_stats(handle, &after));
+        TEST_ASSERT_EQUAL(before.misses, after.misses);
+        TEST_ASSERT_EQUAL(before.hits + rounds, after.hits);
+
+        // Custom objects share the same copies
+        const uint8_t *icon_a = NULL;
+        const uint8_t *icon_b = NULL;
+        size_t size_a = 0;
+        size_t size_b = 0;
+        TEST_ASSERT_EQUAL(ESP_OK, emote_acquire_asset(handle, "battery_bg.bin", &icon_a, &size_a));
+        TEST_ASSERT_EQUAL(ESP_OK, emote_acquire_asset(handle, "battery_bg.bin", &icon_b, &size_b));
+        TEST_ASSERT_EQUAL_PTR(icon_a, icon_b);
+        TEST_ASSERT_EQUAL(size_a, size_b);
+        TEST_ASSERT_EQUAL(ESP_OK, emote_release_asset(handle, icon_a));
+        TEST_ASSERT_EQUAL(ESP_OK, emote_release_asset(handle, icon_b));
+        TEST_ASSERT_EQUAL(ESP_ERR_NOT_FOUND, emote_acquire_asset(handle, "missing.bin", &icon_a, &size_a));
+
+        TEST_ASSERT_EQUAL(ESP_OK, emote_get_cache_stats(handle, &after));
+        printf("Asset cache: %d switches %lld us each, hits %lu, misses %lu, evictions %lu, %lu entries, %u bytes\n",
+               rounds, switch_us / rounds, (unsigned long)after.hits, (unsigned long)after.misses,
+               (unsigned long)after.evictions, (unsigned long)after.entry_count, (unsigned)after.used_bytes);
+
+        // Once nothing references them, copies are trimmed to the budget
+        TEST_ASSERT_EQUAL(ESP_OK, emote_unload_assets(handle));
+        TEST_ASSERT_EQUAL(ESP_OK, emote_get_cache_stats(handle, &after));
+        TEST_ASSERT_LESS_OR_EQUAL(after.budget, after.used_bytes);
+
+        cleanup_emote(handle);
+    }
+}
+
+TEST_CASE("Test skip unchanged updates", "[partition][flash mmap][update]")
+{
+    const int rounds = 10;
+    emote_update_stats_t before;
+    emote_update_stats_t after;
+
+    emote_data_t data = {
+        .type = EMOTE_SOURCE_PARTITION,
+        .source = {
+            .partition_label = "anim_icon",
+        },
+        .flags = {
+            .mmap_enable = true,
+        },
+    };
+
+    emote_handle_t handle = init_emote();
+    if (handle) {
+        TEST_ASSERT_EQUAL(ESP_OK, emote_mount_and_load_assets(handle, &data));
+
+        TEST_ASSERT_EQUAL(ESP_OK, emote_set_event_msg(handle, EMOTE_MGR_EVT_BAT, "1,75"));
+        TEST_ASSERT_EQUAL(ESP_OK, emote_set_event_msg(handle, EMOTE_MGR_EVT_IDLE, NULL));
+        TEST_ASSERT_EQUAL(ESP_OK, emote_get_update_stats(handle, &before));
+
+        // Same battery state: icons and battery text are already in place
+        for (int i = 0; i < rounds; i++) {
+            TEST_ASSERT_EQUAL(ESP_OK, emote_set_event_msg(handle, EMOTE_MGR_EVT_IDLE, NULL));
+        }
+        TEST_ASSERT_EQUAL(ESP_OK, emote_get_update_stats(handle, &after));
+        TEST_ASSERT_EQUAL(before.src_updates, after.src_updates);
+        TEST_ASSERT_EQUAL(before.src_skipped + rounds * 2, after.src_skipped);
+        TEST_ASSERT_GREATER_OR_EQUAL(before.text_skipped + rounds, after.text_skipped);
+
+        // A battery change only updates the battery text
+        TEST_ASSERT_EQUAL(ESP_OK, emote_set_event_msg(handle, EMOTE_MGR_EVT_BAT, "1,76"));
+        TEST_ASSERT_EQUAL(ESP_OK, emote_get_update_stats(handle, &before));
+        TEST_ASSERT_EQUAL(ESP_OK, emote_set_event_msg(handle, EMOTE_MGR_EVT_IDLE, NULL));
+        TEST_ASSERT_EQUAL(ESP_OK, emote_get_update_stats(handle, &after));
+        TEST_ASSERT_EQUAL(before.src_updates, after.src_updates);
+        TEST_ASSERT_GREATER_OR_EQUAL(before.text_updates + 1, after.text_updates);
+
+        TEST_ASSERT_EQUAL(ESP_OK, emote_set_obj_visible(handle, EMT_DEF_ELEM_STATUS_ICON, true));
+        TEST_ASSERT_EQUAL(ESP_OK, emote_get_update_stats(handle, &before));
+        TEST_ASSERT_EQUAL(ESP_OK, emote_set_obj_visible(handle, EMT_DEF_ELEM_STATUS_ICON, true));
+        TEST_ASSERT_EQUAL(ESP_OK, emote_get_update_stats(handle, &after));
+        TEST_ASSERT_EQUAL(before.visible_skipped + 1, after.visible_skipped);
+
+        printf("Updates: text %lu/%lu skipped, src %lu/%lu skipped, visible %lu/%lu skipped\n",
+               (unsigned long)after.text_skipped, (unsigned long)(after.text_skipped + after.text_updates),
+               (unsigned long)after.src_skipped, (unsigned long)(after.src_skipped + after.src_updates),
+               (unsigned long)after.visible_skipped, (unsigned long)(after.visible_skipped + after.visible_updates));
+
+        cleanup_emote(handle);
+    }
+}
+
+static void test_gap_reset(void)
+{
+    test_gap_enabled = false;
+    test_gap_last_us = 0;
+    test_gap_max_us = 0;
+    memset(test_gap_hist, 0, sizeof(test_gap_hist));
+}
+
+static void test_gap_print(const char *label)
+{
+    printf("%s: <10ms %lu, <20ms %lu, <40ms %lu, <80ms %lu, >=80ms %lu, max %lld us\n", label,
+           (unsigned long)test_gap_hist[0], (unsigned long)test_gap_hist[1], (unsigned long)test_gap_hist[2],
+           (unsigned long)test_gap_hist[3], (unsigned long)test_gap_hist[4], test_gap_max_us);
+}
+
+// Switch through emojis that are not cached yet, one per few frames
+static void test_gap_switch(emote_handle_t handle, const char *const names[], size_t count, bool copy_under_lock)
+{
+    test_gap_reset();
+    test_gap_enabled = true;
+    for (size_t i = 0; i < count; i++) {
+        if (copy_under_lock) {
+            // Emulates the previous behaviour: the flash copy blocks rendering
+            TEST_ASSERT_EQUAL(ESP_OK, emote_lock(handle));
+        }
+        TEST_ASSERT_EQUAL(ESP_OK, emote_set_anim_emoji(handle, names[i]));
+        if (copy_under_lock) {
+            TEST_ASSERT_EQUAL(ESP_OK, emote_unlock(handle));
+        }
+        vTaskDelay(pdMS_TO_TICKS(100));
+    }
+    test_gap_enabled = false;
+}
+
+TEST_CASE("Test frame gaps during asset loads", "[partition][flash read][stall]")
+{
+    static const char *const names[] = { "happy", "laughing", "funny", "loving", "embarrassed", "confident" };
+    const size_t count = sizeof(names) / sizeof(names[0]);
+    emote_cache_stats_t before;
+    emote_cache_stats_t after;
+
+    emote_data_t data = {
+        .type = EMOTE_SOURCE_PARTITION,
+        .source = {
+            .partition_label = "anim_icon",
+        },
+        .flags = {
+            .mmap_enable = false,
+        },
+    };
+
+    emote_handle_t handle = init_emote();
+    if (handle) {
+        TEST_ASSERT_EQUAL(ESP_OK, emote_mount_and_load_assets(handle, &data));
+        vTaskDelay(pdMS_TO_TICKS(500));
+
+        TEST_ASSERT_EQUAL(ESP_OK, emote_get_cache_stats(handle, &before));
+        test_gap_switch(handle, names, count, true);
+        TEST_ASSERT_EQUAL(ESP_OK, emote_get_cache_stats(handle, &after));
+        TEST_ASSERT_GREATER_OR_EQUAL(count, after.misses - before.misses);
+        test_gap_print("Copy under lock");
+        uint32_t locked_stalls = test_gap_hist[3] + test_gap_hist[4];
+        int64_t locked_max_us = test_gap_max_us;
+
+        // Same emojis again, read from flash again instead of hitting the cache
+        emote_cache_clear(handle->asset_cache);
+
+        TEST_ASSERT_EQUAL(ESP_OK, emote_get_cache_stats(handle, &before));
+        test_gap_switch(handle, names, count, false);
+        TEST_ASSERT_EQUAL(ESP_OK, emote_get_cache_stats(handle, &after));
+        TEST_ASSERT_GREATER_OR_EQUAL(count, after.misses - before.misses);
+        test_gap_print("Copy outside lock");
+        uint32_t staged_stalls = test_gap_hist[3] + test_gap_hist[4];
+        int64_t staged_max_us = test_gap_max_us;
+
+        TEST_ASSERT_GREATER_THAN(0, locked_stalls);
+        TEST_ASSERT_LESS_THAN(locked_stalls, staged_stalls);
+        TEST_ASSERT_LESS_OR_EQUAL(locked_max_us, staged_max_us);
+
+        cleanup_emote(handle);
+    }
+    test_gap_reset();
+}
+
+TEST_CASE("Test event dispatch", "[partition][flash mmap][benchmark]")
+{
+    static const struct {
+        const char *name;
+        emote_event_t id;
+    } events[] = {
+        { EMOTE_MGR_EVT_IDLE,   EMOTE_EVENT_IDLE },
+        { EMOTE_MGR_EVT_SPEAK,  EMOTE_EVENT_SPEAK },
+        { EMOTE_MGR_EVT_LISTEN, EMOTE_EVENT_LISTEN },
+        { EMOTE_MGR_EVT_SYS,    EMOTE_EVENT_SYS },
+        { EMOTE_MGR_EVT_SET,    EMOTE_EVENT_SET },
+        { EMOTE_MGR_EVT_BAT,    EMOTE_EVENT_BAT },
+        { EMOTE_MGR_EVT_OFF,    EMOTE_EVENT_OFF },
+    };
+    static const char *const unknown[] = { "", "evt_", "evt_i", "evt_idl", "evt_idle2", "evt_dle", "xyz_sys" };
+    const int event_count = sizeof(events) / sizeof(events[0]);
+    const int rounds = 1000;
+    emote_event_t id;
+
+    for (int i = 0; i < event_count; i++) {
+        TEST_ASSERT_EQUAL(ESP_OK, emote_get_event_by_name(events[i].name, &id));
+        TEST_ASSERT_EQUAL(events[i].id, id);
+    }
+    for (size_t i = 0; i < sizeof(unknown) / sizeof(unknown[0]); i++) {
+        TEST_ASSERT_EQUAL(ESP_ERR_NOT_FOUND, emote_get_event_by_name(unknown[i], &id));
+    }
+
+    // Name resolution: linear strcmp scan, as before, against the hashed lookup
+    volatile int sink = 0;
+    int64_t start = esp_timer_get_time();
+    for (int round = 0; round < rounds; round++) {
+        for (int i = 0; i < event_count; i++) {
+            for (int j = 0; j < event_count; j++) {
+                if (strcmp(events[i].name, events[j].name) == 0) {
+                    sink += j;
+                    break;
+                }
+            }
+        }
+    }
+    int64_t scan_us = esp_timer_get_time() - start;
+
+    start = esp_timer_get_time();
+    for (int round = 0; round < rounds; round++) {
+        for (int i = 0; i < event_count; i++) {
+            emote_get_event_by_name(events[i].name, &id);
+            sink += id;
+        }
+    }
+    int64_t hash_us = esp_timer_get_time() - start;
+    (void)sink;
+
+    printf("Event name resolution: scan %lld ns/event, hash %lld ns/event\n",
+           scan_us * 1000 / (rounds * event_count), hash_us * 1000 / (rounds * event_count));
+
+    emote_data_t data = {
+        .type = EMOTE_SOURCE_PARTITION,
+        .source = {
+            .partition_label = "anim_icon",
+        },
+        .flags = {
+            .mmap_enable = true,
+        },
+    };
+
+    emote_handle_t handle = init_emote();
+    if (handle) {
+        TEST_ASSERT_EQUAL(ESP_OK, emote_mount_and_load_assets(handle, &data));
+        TEST_ASSERT_EQUAL(ESP_ERR_INVALID_ARG, emote_set_event(handle, EMOTE_EVENT_MAX, NULL));
+        TEST_ASSERT_EQUAL(ESP_ERR_NOT_FOUND, emote_set_event_msg(handle, "evt_unknown", NULL));
+
+        // Event throughput: battery updates do not restart animations
+        const int updates = 200;
+        start = esp_timer_get_time();
+        for (int i = 0; i < updates; i++) {
+            TEST_ASSERT_EQUAL(ESP_OK, emote_set_event_msg(handle, EMOTE_MGR_EVT_BAT, "1,75"));
+        }
+        int64_t msg_us = esp_timer_get_time() - start;
+
+        start = esp_timer_get_time();
+        for (int i = 0; i < updates; i++) {
+            TEST_ASSERT_EQUAL(ESP_OK, emote_set_event(handle, EMOTE_EVENT_BAT, "1,75"));
+        }
+        int64_t enum_us = esp_timer_get_time() - start;
+
+        printf("Event throughput: by name %lld us/event, by id %lld us/event\n",
+               msg_us / updates, enum_us / updates);
+
+        cleanup_emote(handle);
+    }
+}
+
+static esp_err_t test_wait_events_drained(emote_handle_t handle, emote_event_queue_stats_t *stats)
+{
+    for (int wait = 0; wait < 100; wait++) {
+        esp_err_t ret = emote_get_event_queue_stats(handle, stats);
+        if (ret != ESP_OK) {
+            return ret;
+        }
+        if (stats->applied + stats->coalesced == stats->posted) {
+            return ESP_OK;
+        }
+        vTaskDelay(pdMS_TO_TICKS(20));
+    }
+    return ESP_ERR_TIMEOUT;
+}
+
+TEST_CASE("Test posted event coalescing", "[partition][flash mmap][event]")
+{
+    emote_event_queue_stats_t before;
+    emote_event_queue_stats_t after;
+    emote_update_stats_t updates;
+
+    emote_data_t data = {
+        .type = EMOTE_SOURCE_PARTITION,
+        .source = {
+            .partition_label = "anim_icon",
+        },
+        .flags = {
+            .mmap_enable = true,
+        },
+    };
+
+    emote_handle_t handle = init_emote();
+    if (handle) {
+        TEST_ASSERT_EQUAL(ESP_OK, emote_mount_and_load_assets(handle, &data));
+        TEST_ASSERT_EQUAL(ESP_OK, test_wait_events_drained(handle, &before));
+
+        // A fast conversation turn, posted within one frame
+        TEST_ASSERT_EQUAL(ESP_OK, emote_lock(handle));
+        TEST_ASSERT_EQUAL(ESP_OK, emote_post_event(handle, EMOTE_EVENT_LISTEN, NULL));
+        TEST_ASSERT_EQUAL(ESP_OK, emote_post_event(handle, EMOTE_EVENT_SPEAK, "Hello"));
+        TEST_ASSERT_EQUAL(ESP_OK, emote_post_event(handle, EMOTE_EVENT_BAT, "0,40"));
+        TEST_ASSERT_EQUAL(ESP_OK, emote_post_event(handle, EMOTE_EVENT_SPEAK, "Hello, I'm"));
+        TEST_ASSERT_EQUAL(ESP_OK, emote_post_event(handle, EMOTE_EVENT_BAT, "1,41"));
+        TEST_ASSERT_EQUAL(ESP_OK, emote_post_event(handle, EMOTE_EVENT_SPEAK, "Hello, I'm Brookesia!"));
+        TEST_ASSERT_EQUAL(ESP_OK, emote_post_event(handle, EMOTE_EVENT_IDLE, NULL));
+        TEST_ASSERT_EQUAL(ESP_OK, emote_get_update_stats(handle, &updates));
+        TEST_ASSERT_EQUAL(ESP_OK, emote_unlock(handle));
+
+        TEST_ASSERT_EQUAL(ESP_OK, test_wait_events_drained(handle, &after));
+        printf("Coalescing: received %lu, applied %lu, coalesced %lu\n",
+               (unsigned long)(after.posted - before.posted), (unsigned long)(after.applied - before.applied),
+               (unsigned long)(after.coalesced - before.coalesced));
+        TEST_ASSERT_EQUAL(7, after.posted - before.posted);
+        TEST_ASSERT_EQUAL(2, after.applied - before.applied);
+        TEST_ASSERT_EQUAL(5, after.coalesced - before.coalesced);
+
+        // The superseded SPEAKs never set the toast text; the final IDLE sets clock and battery
+        emote_update_stats_t final;
+        TEST_ASSERT_EQUAL(ESP_OK, emote_get_update_stats(handle, &final));
+        printf("Text updates during the burst: %lu\n", (unsigned long)(final.text_updates - updates.text_updates));
+        TEST_ASSERT_LESS_OR_EQUAL(3, final.text_updates - updates.text_updates);
+
+        // An empty queue no longer wakes the render task
+        TEST_ASSERT_GREATER_THAN(before.drains, after.drains);
+        vTaskDelay(pdMS_TO_TICKS(500));
+        TEST_ASSERT_EQUAL(ESP_OK, emote_get_event_queue_stats(handle, &before));
+        TEST_ASSERT_EQUAL(after.drains, before.drains);
+
+        cleanup_emote(handle);
+    }
+}
+
+// Toast text, status icon and battery changed together, as the app does
+static void test_batch_changes(emote_handle_t handle, const char *text, const char *battery)
+{
+    TEST_ASSERT_EQUAL(ESP_OK, emote_set_event(handle, EMOTE_EVENT_SYS, text));
+    vTaskDelay(pdMS_TO_TICKS(40));
+    TEST_ASSERT_EQUAL(ESP_OK, emote_set_event(handle, EMOTE_EVENT_BAT, battery));
+    vTaskDelay(pdMS_TO_TICKS(40));
+    TEST_ASSERT_EQUAL(ESP_OK, emote_set_obj_visible(handle, EMT_DEF_ELEM_BAT_LEFT_LABEL, true));
+    vTaskDelay(pdMS_TO_TICKS(40));
+    TEST_ASSERT_EQUAL(ESP_OK, emote_set_obj_visible(handle, EMT_DEF_ELEM_CHARGE_ICON, true));
+}
+
+TEST_CASE("Test batch update", "[partition][flash mmap][batch]")
+{
+    emote_data_t data = {
+        .type = EMOTE_SOURCE_PARTITION,
+        .source = {
+            .partition_label = "anim_icon",
+        },
+        .flags = {
+            .mmap_enable = true,
+        },
+    };
+
+    emote_handle_t handle = init_emote();
+    if (handle) {
+        TEST_ASSERT_EQUAL(ESP_OK, emote_mount_and_load_assets(handle, &data));
+        TEST_ASSERT_EQUAL(ESP_ERR_INVALID_STATE, emote_batch_commit(handle));
+
+        // Keep the scene static, so only the changes below cause flushes
+        TEST_ASSERT_EQUAL(ESP_OK, emote_set_anim_visible(handle, false));
+        vTaskDelay(pdMS_TO_TICKS(500));
+
+        // Unbatched: each call is picked up by its own frame
+        uint32_t start = test_flush_count;
+        test_batch_changes(handle, "Hello", "0,50");
+        vTaskDelay(pdMS_TO_TICKS(200));
+        uint32_t unbatched = test_flush_count - start;
+
+        // Batched: recorded, then applied under one lock
+        TEST_ASSERT_EQUAL(ESP_OK, emote_batch_begin(handle));
+        TEST_ASSERT_EQUAL(ESP_ERR_INVALID_STATE, emote_batch_begin(handle));
+        TEST_ASSERT_EQUAL(ESP_ERR_NOT_FOUND, emote_set_anim_emoji(handle, "missing"));
+        TEST_ASSERT_EQUAL(ESP_ERR_INVALID_STATE, emote_set_obj_visible(handle, "missing", true));
+        start = test_flush_count;
+        test_batch_changes(handle, "Hi again", "1,60");
+        uint32_t recorded = test_flush_count - start;
+        TEST_ASSERT_EQUAL(ESP_OK, emote_batch_commit(handle));
+        vTaskDelay(pdMS_TO_TICKS(200));
+        uint32_t batched = test_flush_count - start;
+
+        printf("Flushes for 4 changes: unbatched %lu, batched %lu (%lu while recording)\n",
+               (unsigned long)unbatched, (unsigned long)batched, (unsigned long)recorded);
+        TEST_ASSERT_EQUAL(0, recorded);
+        TEST_ASSERT_LESS_OR_EQUAL(unbatched, batched);
+
+        // Emoji data is loaded before the lock; the order of recorded calls is kept
+        TEST_ASSERT_EQUAL(ESP_OK, emote_batch_begin(handle));
+        TEST_ASSERT_EQUAL(ESP_OK, emote_set_anim_emoji(handle, "happy"));
+        TEST_ASSERT_EQUAL(ESP_OK, emote_set_event(handle, EMOTE_EVENT_SPEAK, "Batched"));
+        TEST_ASSERT_EQUAL(ESP_OK, emote_batch_commit(handle));
+
+        // The batch is closed: calls apply immediately again
+        TEST_ASSERT_EQUAL(ESP_ERR_INVALID_STATE, emote_batch_commit(handle));
+        TEST_ASSERT_EQUAL(ESP_OK, emote_set_anim_emoji(handle, "sad"));
+
+        cleanup_emote(handle);
+    }
+}
+
+static uint32_t test_event_transitions(emote_handle_t handle, emote_event_t event, const char *message)
+{
+    emote_update_stats_t before;
+    emote_update_stats_t after;
+
+    TEST_ASSERT_EQUAL(ESP_OK, emote_get_update_stats(handle, &before));
+    TEST_ASSERT_EQUAL(ESP_OK, emote_set_event(handle, event, message));
+    TEST_ASSERT_EQUAL(ESP_OK, emote_get_update_stats(handle, &after));
+    return after.visible_updates - before.visible_updates;
+}
+
+TEST_CASE("Test event visibility diff", "[partition][flash mmap][update]")
+{
+    emote_data_t data = {
+        .type = EMOTE_SOURCE_PARTITION,
+        .source = {
+            .partition_label = "anim_icon",
+        },
+        .flags = {
+            .mmap_enable = true,
+        },
+    };
+
+    emote_handle_t handle = init_emote();
+    if (handle) {
+        TEST_ASSERT_EQUAL(ESP_OK, emote_mount_and_load_assets(handle, &data));
+        TEST_ASSERT_EQUAL(ESP_OK, emote_set_event(handle, EMOTE_EVENT_BAT, "1,80"));
+
+        // Transitions counted per event: each is one gfx_obj_set_visible() call
+        uint32_t first_speak = test_event_transitions(handle, EMOTE_EVENT_SPEAK, "Hello");
+        uint32_t speak = test_event_transitions(handle, EMOTE_EVENT_SPEAK, "Hello again");
+        uint32_t listen = test_event_transitions(handle, EMOTE_EVENT_LISTEN, NULL);
+        uint32_t listen_again = test_event_transitions(handle, EMOTE_EVENT_LISTEN, NULL);
+        uint32_t idle = test_event_transitions(handle, EMOTE_EVENT_IDLE, NULL);
+        uint32_t idle_again = test_event_transitions(handle, EMOTE_EVENT_IDLE, NULL);
+        uint32_t bat = test_event_transitions(handle, EMOTE_EVENT_BAT, "0,80");
+
+        printf("Visibility transitions: speak %lu, speak again %lu, listen %lu, listen again %lu, "
+               "idle %lu, idle again %lu, bat %lu\n",
+               (unsigned long)first_speak, (unsigned long)speak, (unsigned long)listen,
+               (unsigned long)listen_again, (unsigned long)idle, (unsigned long)idle_again, (unsigned long)bat);
+
+        // Repeating an event touches nothing
+        TEST_ASSERT_EQUAL(0, speak);
+        TEST_ASSERT_EQUAL(0, listen_again);
+        TEST_ASSERT_EQUAL(0, idle_again);
+
+        // SPEAK -> LISTEN: toast hidden, listen animation shown, status icon stays visible
+        TEST_ASSERT_EQUAL(2, listen);
+
+        // Battery events only update state
+        TEST_ASSERT_EQUAL(0, bat);
+
+        cleanup_emote(handle);
+    }
+}
+
+TEST_CASE("Test QR code hidden by events", "[partition][flash mmap][update]")
+{
+    emote_event_queue_stats_t stats;
+    emote_layout_desc_t desc;
+
+    emote_data_t data = {
+        .type = EMOTE_SOURCE_PARTITION,
+        .source = {
+            .partition_label = "anim_icon",
+        },
+        .flags = {
+            .mmap_enable = true,
+        },
+    };
+
+    emote_handle_t handle = init_emote();
+    if (handle) {
+        TEST_ASSERT_EQUAL(ESP_OK, emote_mount_and_load_assets(handle, &data));
+
+        // The bundled layout has no QR code
+        emote_layout_desc_init(&desc);
+        desc.type = EMOTE_LAYOUT_TYPE_QRCODE;
+        desc.name = EMT_DEF_ELEM_QRCODE;
+        TEST_ASSERT_EQUAL(ESP_OK, emote_apply_layout(handle, &desc));
+        emote_def_obj_entry_t *entry = &handle->def_objects[EMOTE_DEF_OBJ_QRCODE];
+        TEST_ASSERT_NOT_NULL(entry->obj);
+
+        // Start from a known hidden state
+        TEST_ASSERT_EQUAL(ESP_OK, emote_set_event(handle, EMOTE_EVENT_IDLE, NULL));
+        TEST_ASSERT_TRUE(entry->state.visible_known);
+        TEST_ASSERT_FALSE(entry->state.visible);
+
+        // Showing the QR code must go through the visibility cache, or IDLE would skip hiding it
+        TEST_ASSERT_EQUAL(ESP_OK, emote_set_qrcode_data(handle, "https://www.esp32.com"));
+        TEST_ASSERT_TRUE(entry->state.visible_known);
+        TEST_ASSERT_TRUE(entry->state.visible);
+        vTaskDelay(pdMS_TO_TICKS(100));
+
+        TEST_ASSERT_EQUAL(ESP_OK, emote_post_event(handle, EMOTE_EVENT_IDLE, NULL));
+        TEST_ASSERT_EQUAL(ESP_OK, test_wait_events_drained(handle, &stats));
+        TEST_ASSERT_TRUE(entry->state.visible_known);
+        TEST_ASSERT_FALSE(entry->state.visible);
+
+        cleanup_emote(handle);
+    }
+}
+
+static uint32_t test_status_wakeups(emote_handle_t handle, uint32_t period_ms, uint32_t window_ms)
+{
+    emote_layout_desc_t desc;
+    emote_update_stats_t before;
+    emote_update_stats_t after;
+
+    emote_layout_desc_init(&desc);
+    desc.type = EMOTE_LAYOUT_TYPE_TIMER;
+    desc.name = EMT_DEF_ELEM_TIMER_STATUS;
+    desc.timer.present = true;
+    desc.timer.period = period_ms;
+    TEST_ASSERT_EQUAL(ESP_OK, emote_apply_layout(handle, &desc));
+
+    // IDLE shows the clock and schedules the timer
+    TEST_ASSERT_EQUAL(ESP_OK, emote_set_event(handle, EMOTE_EVENT_IDLE, NULL));
+    TEST_ASSERT_EQUAL(ESP_OK, emote_get_update_stats(handle, &before));
+    vTaskDelay(pdMS_TO_TICKS(window_ms));
+    TEST_ASSERT_EQUAL(ESP_OK, emote_get_update_stats(handle, &after));
+    return after.status_wakeups - before.status_wakeups;
+}
+
+TEST_CASE("Test minute-aligned status timer", "[partition][flash mmap][timer]")
+{
+    const uint32_t window_ms = 5000;
+    emote_update_stats_t before;
+    emote_update_stats_t after;
+
+    emote_data_t data = {
+        .type = EMOTE_SOURCE_PARTITION,
+        .source = {
+            .partition_label = "anim_icon",
+        },
+        .flags = {
+            .mmap_enable = true,
+        },
+    };
+
+    emote_handle_t handle = init_emote();
+    if (handle) {
+        TEST_ASSERT_EQUAL(ESP_OK, emote_mount_and_load_assets(handle, &data));
+        TEST_ASSERT_EQUAL(ESP_OK, emote_set_event(handle, EMOTE_EVENT_BAT, "0,40"));
+
+        uint32_t per_second = test_status_wakeups(handle, 1000, window_ms);
+        uint32_t per_minute = test_status_wakeups(handle, 0, window_ms);
+        printf("Status timer wakeups in %lu ms: 1 s period %lu, minute-aligned %lu\n",
+               (unsigned long)window_ms, (unsigned long)per_second, (unsigned long)per_minute);
+        TEST_ASSERT_GREATER_OR_EQUAL(window_ms / 1000 - 1, per_second);
+        TEST_ASSERT_LESS_OR_EQUAL(1, per_minute);
+
+        // The battery display follows BAT events without waiting for a wakeup
+        TEST_ASSERT_EQUAL(ESP_OK, emote_get_update_stats(handle, &before));
+        TEST_ASSERT_EQUAL(ESP_OK, emote_set_event(handle, EMOTE_EVENT_BAT, "1,41"));
+        TEST_ASSERT_EQUAL(ESP_OK, emote_get_update_stats(handle, &after));
+        TEST_ASSERT_EQUAL(1, after.text_updates - before.text_updates);
+        TEST_ASSERT_EQUAL(0, after.status_wakeups - before.status_wakeups);
+
+        cleanup_emote(handle);
+    }
+}
+
+static void test_digit_updates(emote_handle_t handle, bool digit_atlas, int rounds, int64_t *set_us, int64_t *frame_us)
+{
+    emote_layout_desc_t desc;
+    char message[16];
+
+    emote_layout_desc_init(&desc);
+    desc.type = EMOTE_LAYOUT_TYPE_LABEL;
+    desc.name = EMT_DEF_ELEM_BAT_LEFT_LABEL;
+    desc.align = "GFX_ALIGN_TOP_MID";
+    desc.y = 20;
+    desc.label.text_align = "GFX_TEXT_ALIGN_CENTER";
+    desc.label.digit_atlas = digit_atlas;
+    TEST_ASSERT_EQUAL(ESP_OK, emote_apply_layout(handle, &desc));
+    // The layout hides the label; IDLE shows it so BAT events redraw it
+    TEST_ASSERT_EQUAL(ESP_OK, emote_set_event(handle, EMOTE_EVENT_IDLE, NULL));
+
+    *set_us = 0;
+    *frame_us = 0;
+    for (int i = 0; i < rounds; i++) {
+        snprintf(message, sizeof(message), "0,%d", 10 + i % 90);
+        uint32_t flushes = test_flush_count;
+        int64_t start = esp_timer_get_time();
+        TEST_ASSERT_EQUAL(ESP_OK, emote_set_event(handle, EMOTE_EVENT_BAT, message));
+        int64_t set = esp_timer_get_time();
+        while (test_flush_count == flushes) {
+            vTaskDelay(1);
+        }
+        *set_us += set - start;
+        *frame_us += esp_timer_get_time() - set;
+    }
+    *set_us /= rounds;
+    *frame_us /= rounds;
+}
+
+TEST_CASE("Test digit atlas labels", "[partition][flash mmap][benchmark]")
+{
+    const int rounds = 50;
+    int64_t label_set_us, label_frame_us;
+    int64_t atlas_set_us, atlas_frame_us;
+
+    emote_data_t data = {
+        .type = EMOTE_SOURCE_PARTITION,
+        .source = {
+            .partition_label = "anim_icon",
+        },
+        .flags = {
+            .mmap_enable = true,
+        },
+    };
+
+    emote_handle_t handle = init_emote();
+    if (handle) {
+        TEST_ASSERT_EQUAL(ESP_OK, emote_mount_and_load_assets(handle, &data));
+        TEST_ASSERT_EQUAL(ESP_OK, emote_set_event(handle, EMOTE_EVENT_BAT, "0,5"));
+
+        test_digit_updates(handle, false, rounds, &label_set_us, &label_frame_us);
+        test_digit_updates(handle, true, rounds, &atlas_set_us, &atlas_frame_us);
+        printf("Battery label update: gfx_label_set_text %lld us + %lld us to flush, digit atlas %lld us + %lld us to flush\n",
+               label_set_us, label_frame_us, atlas_set_us, atlas_frame_us);
+        TEST_ASSERT_EQUAL(ESP_OK, emote_set_event(handle, EMOTE_EVENT_BAT, "1,100"));
+        vTaskDelay(pdMS_TO_TICKS(200));
+
+        cleanup_emote(handle);
+    }
+}
+
+static void test_toast_scroll(emote_handle_t handle, bool scroll_strip, const char *text, int64_t *set_us,
+                              int64_t *frame_us)
+{
+    emote_layout_desc_t desc;
+
+    emote_layout_desc_init(&desc);
+    desc.type = EMOTE_LAYOUT_TYPE_LABEL;
+    desc.name = EMT_DEF_ELEM_TOAST_LABEL;
+    desc.align = "GFX_ALIGN_TOP_MID";
+    desc.y = 20;
+    desc.width = 160;
+    desc.height = 40;
+    desc.label.text_align = "GFX_TEXT_ALIGN_CENTER";
+    desc.label.long_mode = "GFX_LABEL_LONG_SCROLL";
+    desc.label.loop = true;
+    desc.label.scroll_strip = scroll_strip;
+    TEST_ASSERT_EQUAL(ESP_OK, emote_apply_layout(handle, &desc));
+
+    int64_t start = esp_timer_get_time();
+    TEST_ASSERT_EQUAL(ESP_OK, emote_set_event(handle, EMOTE_EVENT_SPEAK, text));
+    *set_us = esp_timer_get_time() - start;
+    vTaskDelay(pdMS_TO_TICKS(200));
+
+    // Average time between flushed frames while the toast scrolls
+    uint32_t flushes = test_flush_count;
+    start = esp_timer_get_time();
+    vTaskDelay(pdMS_TO_TICKS(2000));
+    uint32_t frames = test_flush_count - flushes;
+    *frame_us = frames ? (esp_timer_get_time() - start) / frames : 0;
+}
+
+TEST_CASE("Test toast scroll strip", "[partition][flash mmap][benchmark]")
+{
+    const char *text = "正在更新固件，请勿断电。Updating firmware, please keep the power on.";
+    int64_t label_set_us, label_frame_us;
+    int64_t strip_set_us, strip_frame_us;
+
+    emote_data_t data = {
+        .type = EMOTE_SOURCE_PARTITION,
+        .source = {
+            .partition_label = "anim_icon",
+        },
+        .flags = {
+            .mmap_enable = true,
+        },
+    };
+
+    emote_handle_t handle = init_emote();
+    if (handle) {
+        TEST_ASSERT_EQUAL(ESP_OK, emote_mount_and_load_assets(handle, &data));
+
+        test_toast_scroll(handle, false, text, &label_set_us, &label_frame_us);
+        TEST_ASSERT_NULL(handle->def_objects[EMOTE_DEF_OBJ_LABEL_TOAST].strip);
+        test_toast_scroll(handle, true, text, &strip_set_us, &strip_frame_us);
+        TEST_ASSERT_NOT_NULL(handle->def_objects[EMOTE_DEF_OBJ_LABEL_TOAST].strip);
+        printf("Toast scroll: label %lld us to set, %lld us per frame; strip %lld us to set, %lld us per frame\n",
+               label_set_us, label_frame_us, strip_set_us, strip_frame_us);
+
+        // A new text, then a font change, are rendered into the strip again
+        TEST_ASSERT_EQUAL(ESP_OK, emote_set_event(handle, EMOTE_EVENT_SPEAK, "你好"));
+        vTaskDelay(pdMS_TO_TICKS(200));
+        gfx_emote_lock(handle->gfx_handle);
+        emote_strip_set_font(handle->def_objects[EMOTE_DEF_OBJ_LABEL_TOAST].strip, &font_puhui_basic_20_4);
+        gfx_emote_unlock(handle->gfx_handle);
+        vTaskDelay(pdMS_TO_TICKS(200));
+
+        cleanup_emote(handle);
+    }
+}
+
+#define TEST_FONT_LETTERS   (0x7F - 0x20 + 4)
+
+typedef struct {
+    bool found;
+    lv_font_glyph_dsc_t dsc;
+    uint8_t *bitmap;
+    size_t size;
+} test_glyph_t;
+
+static uint32_t test_font_letter(int i)
+{
+    static const uint32_t cjk[] = { 0x4F60, 0x597D, 0x4E2D, 0x6587 };
+    return i < 0x7F - 0x20 ? 0x20 + i : cjk[i - (0x7F - 0x20)];
+}
+
+static void test_font_snapshot(const lv_font_t *font, test_glyph_t *glyphs)
+{
+    for (int i = 0; i < TEST_FONT_LETTERS; i++) {
+        uint32_t letter = test_font_letter(i);
+        test_glyph_t *glyph = &glyphs[i];
+        glyph->found = font->get_glyph_dsc(font, &glyph->dsc, letter, 0);
+        const uint8_t *bitmap = glyph->found ? font->get_glyph_bitmap(font, letter) : NULL;
+        if (bitmap) {
+            glyph->size = (glyph->dsc.box_w * glyph->dsc.box_h * glyph->dsc.bpp + 7) / 8;
+            glyph->bitmap = malloc(glyph->size);
+            TEST_ASSERT_NOT_NULL(glyph->bitmap);
+            memcpy(glyph->bitmap, bitmap, glyph->size);
+        }
+    }
+}
+
+TEST_CASE("Test in-place font glyphs", "[partition][flash read][font]")
+{
+    test_glyph_t *expected = calloc(TEST_FONT_LETTERS, sizeof(test_glyph_t));
+    test_glyph_t *actual = calloc(TEST_FONT_LETTERS, sizeof(test_glyph_t));
+    emote_cache_stats_t stats;
+    TEST_ASSERT_NOT_NULL(expected);
+    TEST_ASSERT_NOT_NULL(actual);
+
+    emote_data_t data = {
+        .type = EMOTE_SOURCE_PARTITION,
+        .source = {
+            .partition_label = "anim_icon",
+        },
+        .flags = {
+            .mmap_enable = true,
+        },
+    };
+
+    emote_handle_t handle = init_emote();
+    if (handle) {
+        // Reference: the gfx loader on the memory-mapped font
+        TEST_ASSERT_EQUAL(ESP_OK, emote_mount_and_load_assets(handle, &data));
+        TEST_ASSERT_NOT_NULL(handle->gfx_font);
+        TEST_ASSERT_NULL(handle->font);
+        test_font_snapshot(handle->gfx_font, expected);
+        TEST_ASSERT_EQUAL(ESP_OK, emote_unload_assets(handle));
+
+        data.flags.mmap_enable = false;
+        size_t free_before = heap_caps_get_free_size(MALLOC_CAP_8BIT);
+        TEST_ASSERT_EQUAL(ESP_OK, emote_mount_and_load_assets(handle, &data));
+        size_t free_after = heap_caps_get_free_size(MALLOC_CAP_8BIT);
+        TEST_ASSERT_NOT_NULL(handle->font);
+        TEST_ASSERT_EQUAL(ESP_OK, emote_get_cache_stats(handle, &stats));
+        printf("Flash-read load: %d bytes of heap, %d bytes in the asset cache\n",
+               (int)(free_before - free_after), (int)stats.used_bytes);
+
+        test_font_snapshot(handle->gfx_font, actual);
+        for (int i = 0; i < TEST_FONT_LETTERS; i++) {
+            TEST_ASSERT_EQUAL(expected[i].found, actual[i].found);
+            if (!expected[i].found) {
+                continue;
+            }
+            TEST_ASSERT_EQUAL(expected[i].dsc.adv_w, actual[i].dsc.adv_w);
+            TEST_ASSERT_EQUAL(expected[i].dsc.box_w, actual[i].dsc.box_w);
+            TEST_ASSERT_EQUAL(expected[i].dsc.box_h, actual[i].dsc.box_h);
+            TEST_ASSERT_EQUAL(expected[i].dsc.ofs_x, actual[i].dsc.ofs_x);
+            TEST_ASSERT_EQUAL(expected[i].dsc.ofs_y, actual[i].dsc.ofs_y);
+            TEST_ASSERT_EQUAL(expected[i].size, actual[i].size);
+            if (expected[i].size) {
+                TEST_ASSERT_EQUAL_MEMORY(expected[i].bitmap, actual[i].bitmap, expected[i].size);
+            }
+        }
+
+        // Kerning goes through the same descriptors
+        lv_font_glyph_dsc_t plain;
+        lv_font_glyph_dsc_t kerned;
+        const lv_font_t *font = handle->gfx_font;
+        font->get_glyph_dsc(font, &plain, 'A', 0);
+        font->get_glyph_dsc(font, &kerned, 'A', 'V');
+        printf("Kerning A-V: %d px\n", kerned.adv_w - plain.adv_w);
+
+        emote_set_event_msg(handle, EMOTE_MGR_EVT_SPEAK, "Hello 你好");
+        vTaskDelay(pdMS_TO_TICKS(500));
+
+        cleanup_emote(handle);
+    }
+
+    for (int i = 0; i < TEST_FONT_LETTERS; i++) {
+        free(expected[i].bitmap);
+        free(actual[i].bitmap);
+    }
+    free(expected);
+    free(actual);
+}
+
+static const char *const test_toasts[] = {
+    "Hello 你好",
+    "电量低，请及时充电",
+    "Wi-Fi 已连接",
+    "正在更新固件，请勿断电",
+    "网络连接失败，请重试",
+    "你好，我在听",
+    "Battery low, please charge",
+    "更新完成，正在重启",
+};
+
+static size_t test_utf8_next(const char *text, uint32_t *letter)
+{
+    const uint8_t *s = (const uint8_t *)text;
+    if (s[0] < 0x80) {
+        *letter = s[0];
+        return 1;
+    }
+    if ((s[0] & 0xE0) == 0xC0) {
+        *letter = ((s[0] & 0x1F) << 6) | (s[1] & 0x3F);
+        return 2;
+    }
+    if ((s[0] & 0xF0) == 0xE0) {
+        *letter = ((s[0] & 0x0F) << 12) | ((s[1] & 0x3F) << 6) | (s[2] & 0x3F);
+        return 3;
+    }
+    *letter = ((s[0] & 0x07) << 18) | ((s[1] & 0x3F) << 12) | ((s[2] & 0x3F) << 6) | (s[3] & 0x3F);
+    return 4;
+}
+
+// Request the bitmap of every glyph of the toasts, as the label does when drawing them
+static uint32_t test_replay_toasts(const lv_font_t *font, int64_t *elapsed_us)
+{
+    uint32_t count = 0;
+    int64_t start = esp_timer_get_time();
+
+    for (size_t i = 0; i < sizeof(test_toasts) / sizeof(test_toasts[0]); i++) {
+        const char *text = test_toasts[i];
+        while (*text) {
+            uint32_t letter;
+            lv_font_glyph_dsc_t dsc;
+            text += test_utf8_next(text, &letter);
+            if (font->get_glyph_dsc(font, &dsc, letter, 0) && font->get_glyph_bitmap(font, letter)) {
+                count++;
+            }
+        }
+    }
+
+    *elapsed_us = esp_timer_get_time() - start;
+    return count;
+}
+
+TEST_CASE("Test glyph cache on toasts", "[partition][flash read][font][benchmark]")
+{
+    emote_glyph_cache_stats_t base;
+    emote_glyph_cache_stats_t cold;
+    emote_glyph_cache_stats_t warm;
+
+    emote_data_t data = {
+        .type = EMOTE_SOURCE_PARTITION,
+        .source = {
+            .partition_label = "anim_icon",
+        },
+        .flags = {
+            .mmap_enable = false,
+        },
+    };
+
+    emote_handle_t handle = init_emote();
+    if (handle) {
+        TEST_ASSERT_EQUAL(ESP_OK, emote_mount_and_load_assets(handle, &data));
+        TEST_ASSERT_NOT_NULL(handle->font);
+
+        int64_t cold_us = 0;
+        int64_t warm_us = 0;
+        gfx_emote_lock(handle->gfx_handle);
+        emote_font_get_cache_stats(handle->font, &base);
+        uint32_t glyphs = test_replay_toasts(handle->gfx_font, &cold_us);
+        gfx_emote_unlock(handle->gfx_handle);
+        TEST_ASSERT_EQUAL(ESP_OK, emote_get_glyph_cache_stats(handle, &cold));
+
+        gfx_emote_lock(handle->gfx_handle);
+        test_replay_toasts(handle->gfx_font, &warm_us);
+        gfx_emote_unlock(handle->gfx_handle);
+        TEST_ASSERT_EQUAL(ESP_OK, emote_get_glyph_cache_stats(handle, &warm));
+
+        printf("Toast replay: %d glyphs, cold %.1f us/glyph, warm %.1f us/glyph\n", (int)glyphs,
+               glyphs ? (double)cold_us / glyphs : 0.0, glyphs ? (double)warm_us / glyphs : 0.0);
+        printf("Glyph cache: %d hits, %d misses, %d evictions, %d entries, %d/%d bytes\n",
+               (int)warm.hits, (int)warm.misses, (int)warm.evictions, (int)warm.entry_count,
+               (int)warm.used_bytes, (int)warm.budget);
+        TEST_ASSERT_EQUAL(true, warm.used_bytes <= warm.budget);
+
+        if (warm.budget > 0 && glyphs > 0) {
+            TEST_ASSERT_EQUAL(glyphs, cold.hits + cold.misses - base.hits - base.misses);
+            TEST_ASSERT_EQUAL(2 * glyphs, warm.hits + warm.misses - base.hits - base.misses);
+            // Without evictions the second replay is served entirely from the cache
+            if (warm.evictions == 0) {
+                TEST_ASSERT_EQUAL(cold.misses, warm.misses);
+            }
+            TEST_ASSERT_EQUAL(true, warm.hits > cold.hits);
+        }
+
+        for (size_t i = 0; i < sizeof(test_toasts) / sizeof(test_toasts[0]); i++) {
+            emote_set_event_msg(handle, EMOTE_MGR_EVT_SPEAK, test_toasts[i]);
+            vTaskDelay(pdMS_TO_TICKS(300));
+        }
+        TEST_ASSERT_EQUAL(ESP_OK, emote_get_glyph_cache_stats(handle, &warm));
+        printf("After drawing toasts: %d hits, %d misses, hit rate %d%%\n", (int)warm.hits, (int)warm.misses,
+               (int)(warm.hits * 100 / (warm.hits + warm.misses ? warm.hits + warm.misses : 1)));
+
+        cleanup_emote(handle);
+    }
+}
+
+static void test_perf_print(const char *name, const emote_perf_metric_t *metric)
+{
+    printf("  %-28s n=%-4d min %6d  avg %6d  p99 %6d  max %6d us\n", name, (int)metric->count,
+           (int)metric->min_us, (int)metric->avg_us, (int)metric->p99_us, (int)metric->max_us);
+}
+
+TEST_CASE("Test perf stats", "[partition][flash read][perf]")
+{
+    emote_perf_stats_t stats;
+    char name[48];
+
+    emote_data_t data = {
+        .type = EMOTE_SOURCE_PARTITION,
+        .source = {
+            .partition_label = "anim_icon",
+        },
+        .flags = {
+            .mmap_enable = false,
+        },
+    };
+
+    emote_handle_t handle = init_emote();
+    if (handle) {
+#if CONFIG_EMOTE_PERF_STATS
+        TEST_ASSERT_EQUAL(ESP_OK, emote_mount_and_load_assets(handle, &data));
+        TEST_ASSERT_EQUAL(ESP_OK, emote_reset_perf_stats(handle));
+
+        const emote_event_t events[] = { EMOTE_EVENT_IDLE, EMOTE_EVENT_LISTEN, EMOTE_EVENT_SPEAK };
+        for (int i = 0; i < 30; i++) {
+            TEST_ASSERT_EQUAL(ESP_OK, emote_set_event(handle, events[i % 3], "Hello 你好"));
+            vTaskDelay(pdMS_TO_TICKS(50));
+        }
+
+        TEST_ASSERT_EQUAL(ESP_OK, emote_get_perf_stats(handle, &stats));
+        printf("Perf stats, %d bytes copied from storage:\n", (int)stats.bytes_copied);
+        test_perf_print("frame", &stats.frame);
+        test_perf_print("flush", &stats.flush);
+        test_perf_print("acquire", &stats.acquire);
+
+        bool set_event_found = false;
+        for (size_t i = 0; i < stats.lock_count; i++) {
+            snprintf(name, sizeof(name), "%s wait", stats.locks[i].api);
+            test_perf_print(name, &stats.locks[i].wait);
+            snprintf(name, sizeof(name), "%s hold", stats.locks[i].api);
+            test_perf_print(name, &stats.locks[i].hold);
+            if (strcmp(stats.locks[i].api, "emote_set_event") == 0) {
+                set_event_found = true;
+                TEST_ASSERT_EQUAL(30, stats.locks[i].hold.count);
+            }
+        }
+        TEST_ASSERT_EQUAL(true, set_event_found);
+        TEST_ASSERT_EQUAL(true, stats.frame.count > 0);
+        TEST_ASSERT_EQUAL(true, stats.flush.count > 0);
+        TEST_ASSERT_EQUAL(true, stats.frame.min_us <= stats.frame.avg_us && stats.frame.avg_us <= stats.frame.max_us);
+        TEST_ASSERT_EQUAL(true, stats.frame.p99_us <= stats.frame.max_us);
+        TEST_ASSERT_EQUAL(true, stats.bytes_copied > 0);
+#else
+        TEST_ASSERT_EQUAL(ESP_ERR_NOT_SUPPORTED, emote_get_perf_stats(handle, &stats));
+        (void)data;
+        (void)name;
+#endif
+        cleanup_emote(handle);
+    }
+}
+
+TEST_CASE("Test trace dump", "[partition][flash read][trace]")
+{
+    emote_data_t data = {
+        .type = EMOTE_SOURCE_PARTITION,
+        .source = {
+            .partition_label = "anim_icon",
+        },
+        .flags = {
+            .mmap_enable = false,
+        },
+    };
+
+    emote_handle_t handle = init_emote();
+    if (handle) {
+#if CONFIG_EMOTE_TRACE
+        const int span_count = 1000;
+        size_t size = 64 * 1024;
+        char *json = (char *)calloc(1, size);
+        TEST_ASSERT_NOT_NULL(json);
+
+        TEST_ASSERT_EQUAL(ESP_OK, emote_mount_and_load_assets(handle, &data));
+
+        // Recording cost, timer reads included
+        int64_t start = esp_timer_get_time();
+        for (int i = 0; i < span_count; i++) {
+            EMOTE_TRACE_BEGIN(span);
+            EMOTE_TRACE_END(handle, "bench", span, i);
+        }
+        int64_t elapsed = esp_timer_get_time() - start;
+        printf("Trace: %d ns per span\n", (int)(elapsed * 1000 / span_count));
+        TEST_ASSERT_EQUAL(true, elapsed * 1000 / span_count < 1000);
+
+        // A SPEAK event colliding with an emoji switch and a dialog insert
+        TEST_ASSERT_EQUAL(ESP_OK, emote_trace_clear(handle));
+        TEST_ASSERT_EQUAL(ESP_OK, emote_set_event(handle, EMOTE_EVENT_SPEAK, "Hello 你好"));
+        TEST_ASSERT_EQUAL(ESP_OK, emote_set_anim_emoji(handle, "happy"));
+        TEST_ASSERT_EQUAL(ESP_OK, emote_insert_anim_dialog(handle, "angry", 1000));
+        vTaskDelay(pdMS_TO_TICKS(500));
+
+        FILE *stream = fmemopen(json, size - 1, "w");
+        TEST_ASSERT_NOT_NULL(stream);
+        TEST_ASSERT_EQUAL(ESP_OK, emote_trace_dump(handle, stream));
+        fclose(stream);
+
+        printf("Trace: %d bytes of JSON\n", (int)strlen(json));
+        TEST_ASSERT_EQUAL(0, strncmp(json, "{\"traceEvents\":[", strlen("{\"traceEvents\":[")));
+        TEST_ASSERT_NOT_NULL(strstr(json, "],\"displayTimeUnit\":\"ms\"}"));
+        TEST_ASSERT_NOT_NULL(strstr(json, "\"name\":\"evt_speak\""));
+        TEST_ASSERT_NOT_NULL(strstr(json, "\"name\":\"emoji\""));
+        TEST_ASSERT_NOT_NULL(strstr(json, "\"name\":\"dialog\""));
+        TEST_ASSERT_NOT_NULL(strstr(json, "\"name\":\"acquire\""));
+        TEST_ASSERT_NOT_NULL(strstr(json, "\"name\":\"flush\""));
+        TEST_ASSERT_NULL(strstr(json, "\"name\":\"bench\""));
+        free(json);
+#else
+        TEST_ASSERT_EQUAL(ESP_ERR_NOT_SUPPORTED, emote_trace_dump(handle, stdout));
+        (void)data;
+#endif
+        cleanup_emote(handle);
+    }
+}
+
+TEST_CASE("Test headless display", "[partition][headless][benchmark]")
+{
+    emote_data_t data = {
+        .type = EMOTE_SOURCE_PARTITION,
+        .source = {
+            .partition_label = "anim_icon",
+        },
+        .flags = {
+            .mmap_enable = true,
+        },
+    };
+    emote_headless_config_t headless_config = {
+        .flush_delay_us = 2000,
+    };
+    emote_headless_stats_t stats;
+    int width = 0;
+    int height = 0;
+
+    // No panel: the manager renders into the headless framebuffer only
+    emote_config_t config = get_default_emote_config();
+    config.update_cb = NULL;
+    emote_headless_handle_t headless = emote_headless_create(&headless_config, &config);
+    TEST_ASSERT_NOT_NULL(headless);
+
+    emote_handle_t handle = emote_init(&config);
+    TEST_ASSERT_NOT_NULL(handle);
+    TEST_ASSERT_EQUAL(ESP_OK, emote_mount_and_load_assets(handle, &data));
+    vTaskDelay(pdMS_TO_TICKS(200));
+
+    TEST_ASSERT_EQUAL(ESP_OK, emote_headless_reset_stats(headless));
+    int64_t start = esp_timer_get_time();
+    TEST_ASSERT_EQUAL(ESP_OK, emote_set_event(handle, EMOTE_EVENT_SPEAK, "Hello, I'm esp_emote_expression!"));
+    vTaskDelay(pdMS_TO_TICKS(2000));
+    TEST_ASSERT_EQUAL(ESP_OK, emote_headless_get_stats(headless, &stats));
+    int64_t elapsed = esp_timer_get_time() - start;
+
+    printf("Headless: %d frames, %.1f frames/s, %d flushes, %d bytes per frame\n", (int)stats.frames,
+           stats.frames * 1e6 / elapsed, (int)stats.flushes, stats.frames ? (int)(stats.flush_bytes / stats.frames) : 0);
+    TEST_ASSERT_EQUAL(true, stats.frames > 0);
+    TEST_ASSERT_EQUAL(true, stats.flush_bytes > 0);
+
+    const uint16_t *framebuffer = emote_headless_get_framebuffer(headless, &width, &height);
+    TEST_ASSERT_NOT_NULL(framebuffer);
+    TEST_ASSERT_EQUAL(config.gfx_emote.h_res, width);
+    TEST_ASSERT_EQUAL(config.gfx_emote.v_res, height);
+
+    // The toast text is drawn on the black background
+    size_t lit = 0;
+    for (size_t i = 0; i < (size_t)width * height; i++) {
+        lit += framebuffer[i] != 0;
+    }
+    TEST_ASSERT_EQUAL(true, lit > 0);
+
+    TEST_ASSERT_TRUE(emote_deinit(handle));
+    emote_headless_delete(headless);
+}
+
+// Ops of the calls in an API call log, in order; -1 if malformed
+static int test_log_ops(const char *log, long length, uint8_t *ops, int max)
+{
+    const uint8_t *pos = (const uint8_t *)log + strlen(EMOTE_RECORD_MAGIC) + 1;
+    const uint8_t *end = (const uint8_t *)log + length;
+    int count = 0;
+
+    while (pos < end && count < max) {
+        // delta, op, text, message, value
+        for (int field = 0; field < 5; field++) {
+            uint32_t value = 0;
+            int shift = 0;
+            if (field == 1) {
+                ops[count] = *pos++;
+                continue;
+            }
+            do {
+                if (pos >= end) {
+                    return -1;
+                }
+                value |= (uint32_t)(*pos & 0x7F) << shift;
+                shift += 7;
+            } while (*pos++ & 0x80);
+            if (field == 2 || field == 3) {
+                pos += value ? value - 1 : 0;
+            }
+        }
+        count++;
+    }
+    return pos == end ? count : -1;
+}
+
+TEST_CASE("Test record and replay", "[partition][flash read][record]")
+{
+    emote_data_t data = {
+        .type = EMOTE_SOURCE_PARTITION,
+        .source = {
+            .partition_label = "anim_icon",
+        },
+        .flags = {
+            .mmap_enable = false,
+        },
+    };
+
+    emote_handle_t handle = init_emote();
+    if (handle) {
+#if CONFIG_EMOTE_RECORDER
+        size_t size = 4 * 1024;
+        char *log = (char *)calloc(1, size);
+        char *again = (char *)calloc(1, size);
+        TEST_ASSERT_NOT_NULL(log);
+        TEST_ASSERT_NOT_NULL(again);
+
+        TEST_ASSERT_EQUAL(ESP_OK, emote_mount_and_load_assets(handle, &data));
+
+        // A session of 500 ms, with a batch whose setters must not be logged twice
+        FILE *stream = fmemopen(log, size, "wb");
+        TEST_ASSERT_NOT_NULL(stream);
+        TEST_ASSERT_EQUAL(ESP_OK, emote_record_start(handle, stream));
+        TEST_ASSERT_EQUAL(ESP_ERR_INVALID_STATE, emote_record_start(handle, stream));
+        TEST_ASSERT_EQUAL(ESP_OK, emote_set_event_msg(handle, EMOTE_MGR_EVT_SPEAK, "Hello 你好"));
+        vTaskDelay(pdMS_TO_TICKS(250));
+        TEST_ASSERT_EQUAL(ESP_OK, emote_batch_begin(handle));
+        TEST_ASSERT_EQUAL(ESP_OK, emote_set_anim_emoji(handle, "happy"));
+        TEST_ASSERT_EQUAL(ESP_OK, emote_set_event(handle, EMOTE_EVENT_IDLE, NULL));
+        TEST_ASSERT_EQUAL(ESP_OK, emote_batch_commit(handle));
+        vTaskDelay(pdMS_TO_TICKS(250));
+        TEST_ASSERT_EQUAL(ESP_OK, emote_insert_anim_dialog(handle, "angry", 100));
+        TEST_ASSERT_EQUAL(ESP_OK, emote_record_stop(handle));
+        long length = ftell(stream);
+        fclose(stream);
+        printf("Record: %ld bytes for 6 calls\n", length);
+        TEST_ASSERT_EQUAL(0, memcmp(log, "EMRC", 4));
+        vTaskDelay(pdMS_TO_TICKS(200));
+
+        // Real time reproduces the spacing; the replayed calls are logged once each
+        stream = fmemopen(log, length, "rb");
+        FILE *copy = fmemopen(again, size, "wb");
+        TEST_ASSERT_EQUAL(ESP_OK, emote_record_start(handle, copy));
+        int64_t start = esp_timer_get_time();
+        TEST_ASSERT_EQUAL(ESP_OK, emote_replay(handle, stream, 100));
+        int64_t elapsed = esp_timer_get_time() - start;
+        TEST_ASSERT_EQUAL(ESP_OK, emote_record_stop(handle));
+        long copy_length = ftell(copy);
+        fclose(copy);
+        fclose(stream);
+
+        uint8_t ops[16];
+        uint8_t copy_ops[16];
+        const uint8_t expected[] = {
+            EMOTE_RECORD_OP_EVENT, EMOTE_RECORD_OP_BATCH_BEGIN, EMOTE_RECORD_OP_EMOJI, EMOTE_RECORD_OP_EVENT,
+            EMOTE_RECORD_OP_BATCH_COMMIT, EMOTE_RECORD_OP_INSERT_DIALOG,
+        };
+        TEST_ASSERT_EQUAL(sizeof(expected), test_log_ops(log, length, ops, 16));
+        TEST_ASSERT_EQUAL_UINT8_ARRAY(expected, ops, sizeof(expected));
+        TEST_ASSERT_EQUAL(sizeof(expected), test_log_ops(again, copy_length, copy_ops, 16));
+        TEST_ASSERT_EQUAL_UINT8_ARRAY(expected, copy_ops, sizeof(expected));
+        printf("Replay: %d ms at 100%%\n", (int)(elapsed / 1000));
+        TEST_ASSERT_EQUAL(true, elapsed >= 480 * 1000 && elapsed < 800 * 1000);
+
+        // Four times faster, then without delays
+        stream = fmemopen(log, length, "rb");
+        start = esp_timer_get_time();
+        TEST_ASSERT_EQUAL(ESP_OK, emote_replay(handle, stream, 400));
+        elapsed = esp_timer_get_time() - start;
+        fclose(stream);
+        printf("Replay: %d ms at 400%%\n", (int)(elapsed / 1000));
+        TEST_ASSERT_EQUAL(true, elapsed < 300 * 1000);
+
+        stream = fmemopen(log, length, "rb");
+        TEST_ASSERT_EQUAL(ESP_OK, emote_replay(handle, stream, 0));
+        fclose(stream);
+
+        // A log cut inside a call is reported, and never leaves a batch open
+        stream = fmemopen(log, length - 1, "rb");
+        TEST_ASSERT_EQUAL(ESP_ERR_INVALID_SIZE, emote_replay(handle, stream, 0));
+        fclose(stream);
+        TEST_ASSERT_EQUAL(ESP_ERR_INVALID_STATE, emote_batch_commit(handle));
+
+        stream = fmemopen("EMRX", 4, "rb");
+        TEST_ASSERT_EQUAL(ESP_ERR_INVALID_VERSION, emote_replay(handle, stream, 0));
+        fclose(stream);
+        vTaskDelay(pdMS_TO_TICKS(200));
+
+        free(again);
+        free(log);
+#else
+        TEST_ASSERT_EQUAL(ESP_ERR_NOT_SUPPORTED, emote_record_start(handle, stdout));
+        (void)data;
+#endif
+        cleanup_emote(handle);
+    }
+}
+
 void app_main(void)
 {
     ESP_LOGI(TAG, "Starting Expression Emote test");
@@ -0,0 +1,284 @@
+#!/usr/bin/env python3
+#
+# SPDX-FileCopyrightText: 2025 Espressif Systems (Shanghai) CO LTD
+#
+# SPDX-License-Identifier: Apache-2.0
+#
+"""
+Precompile index.json of an emote assets bin into index.bin.
+
+    build   Parse index.json inside an assets bin, encode it as index.bin and
+            append it to the bin (header and checksum are regenerated).
+    verify  Decode index.bin from an assets bin and check that it matches
+            index.json field by field.
+
+The index.bin layout must stay in sync with priv_include/emote_index_bin.h.
+"""
+
+import argparse
+import json
+import struct
+import sys
+
+ASSETS_HEADER = struct.Struct('<III')           # total_files, checksum, total_len
+ASSETS_PREFIX = b'ZZ'
+
+INDEX_JSON = 'index.json'
+INDEX_BIN = 'index.bin'
+INDEX_MAGIC = b'EIDX'
+INDEX_VERSION = 1
+
+INDEX_HEADER = struct.Struct('<4sHHHHHhIIIII')
+INDEX_EMOJI = struct.Struct('<IHBB')
+INDEX_ICON = struct.Struct('<IHH')
+INDEX_LAYOUT = struct.Struct('<IIIIBBHhhHHIHHIi')
+
+STR_NONE = 0xFFFFFFFF
+U16_DEFAULT = 0xFFFF
+
+EMOJI_LOOP = 1 << 0
+
+LAYOUT_POS = 1 << 0
+LAYOUT_MIRROR = 1 << 1
+LAYOUT_LOOP = 1 << 2
+LAYOUT_TIMER = 1 << 3
+LAYOUT_COLOR = 1 << 4
+LAYOUT_DIGITS = 1 << 5
+LAYOUT_STRIP = 1 << 6
+
+# Matches emote_layout_type_t
+LAYOUT_TYPES = ['anim', 'image', 'label', 'timer', 'qrcode']
+
+
+def read_assets(data, name_length):
+    entry = struct.Struct('<%dsIIHH' % name_length)
+    total_files, _, _ = ASSETS_HEADER.unpack_from(data, 0)
+    base = ASSETS_HEADER.size + total_files * entry.size
+    files = []
+    for i in range(total_files):
+        name, size, offset, width, height = entry.unpack_from(data, ASSETS_HEADER.size + i * entry.size)
+        start = base + offset
+        if data[start:start + len(ASSETS_PREFIX)] != ASSETS_PREFIX:
+            raise ValueError('bad file prefix for entry %d' % i)
+        files.append({
+            'name': name.split(b'\0', 1)[0].decode(),
+            'data': data[start + len(ASSETS_PREFIX):start + len(ASSETS_PREFIX) + size],
+            'width': width,
+            'height': height,
+        })
+    return files
+
+
+def write_assets(files, name_length):
+    entry = struct.Struct('<%dsIIHH' % name_length)
+    table = bytearray()
+    payload = bytearray()
+    for f in files:
+        name = f['name'].encode()
+        if len(name) >= name_length:
+            raise ValueError('file name too long: %s' % f['name'])
+        table += entry.pack(name, len(f['data']), len(payload), f['width'], f['height'])
+        payload += ASSETS_PREFIX + f['data']
+    body = bytes(table + payload)
+    return ASSETS_HEADER.pack(len(files), sum(body) & 0xFFFF, len(body)) + body
+
+
+class StringPool:
+    def __init__(self):
+        self.data = bytearray()
+        self.offsets = {}
+
+    def add(self, s):
+        if s is None:
+            return STR_NONE
+        if s not in self.offsets:
+            self.offsets[s] = len(self.data)
+            self.data += s.encode() + b'\0'
+        return self.offsets[s]
+
+
+def u16_or_default(value):
+    return U16_DEFAULT if value is None else value & 0xFFFF
+
+
+def encode_index(index, file_names):
+    def file_index(name):
+        return file_names.index(name) if name in file_names else None
+
+    pool = StringPool()
+    emojis = bytearray()
+    icons = bytearray()
+    layouts = bytearray()
+    emoji_count = icon_count = 0
+
+    for item in index.get('emoji_collection', []):
+        idx = file_index(item.get('file'))
+        if not isinstance(item.get('name'), str) or idx is None:
+            continue
+        eaf = item.get('eaf') or {}
+        flags = EMOJI_LOOP if eaf.get('loop') is True else 0
+        emojis += INDEX_EMOJI.pack(pool.add(item['name']), idx, int(eaf.get('fps', 0)) & 0xFF, flags)
+        emoji_count += 1
+
+    for item in index.get('icon_collection', []):
+        idx = file_index(item.get('file'))
+        if not isinstance(item.get('name'), str) or idx is None:
+            continue
+        icons += INDEX_ICON.pack(pool.add(item['name']), idx, 0)
+        icon_count += 1
+
+    layout_items = [l for l in index.get('layout', [])
+                    if isinstance(l.get('type'), str) and isinstance(l.get('name'), str)]
+    for item in layout_items:
+        if item['type'] not in LAYOUT_TYPES:
+            raise ValueError('unknown layout type: %s' % item['type'])
+        flags = 0
+        align = None
+        x = y = 0
+        if isinstance(item.get('align'), str) and 'x' in item and 'y' in item:
+            flags |= LAYOUT_POS
+            align, x, y = item['align'], item['x'], item['y']
+
+        anim = item.get('anim') or {}
+        if anim.get('mirror') in ('auto', 'true'):
+            flags |= LAYOUT_MIRROR
+
+        label = item.get('label') or {}
+        color = 0
+        if isinstance(label.get('color'), int):
+            flags |= LAYOUT_COLOR
+            color = label['color']
+        if label.get('digit_atlas') is True:
+            flags |= LAYOUT_DIGITS
+        if label.get('scroll_strip') is True:
+            flags |= LAYOUT_STRIP
+        long_mode = label.get('long_mode') or {}
+        if long_mode.get('loop') is True:
+            flags |= LAYOUT_LOOP
+
+        timer = item.get('timer')
+        period, repeat_count = 0, -1
+        if isinstance(timer, dict):
+            flags |= LAYOUT_TIMER
+            period = timer.get('period', period)
+            repeat_count = timer.get('repeat_count', repeat_count)
+
+        qrcode = item.get('qrcode') or {}
+        layouts += INDEX_LAYOUT.pack(
+            pool.add(item['name']), pool.add(align),
+            pool.add(label.get('text_align')), pool.add(long_mode.get('type')),
+            LAYOUT_TYPES.index(item['type']), flags, u16_or_default(qrcode.get('size')),
+            x, y, item.get('width', 0), item.get('height', 0), color & 0xFFFFFFFF,
+            u16_or_default(long_mode.get('speed')), u16_or_default(long_mode.get('snap_interval')),
+            period, repeat_count)
+
+    font = file_index(index.get('text_font'))
+    pool.add('')
+    emoji_offset = INDEX_HEADER.size
+    icon_offset = emoji_offset + len(emojis)
+    layout_offset = icon_offset + len(icons)
+    string_offset = layout_offset + len(layouts)
+    header = INDEX_HEADER.pack(INDEX_MAGIC, INDEX_VERSION, len(file_names), emoji_count, icon_count,
+                               len(layout_items), -1 if font is None else font, emoji_offset,
+                               icon_offset, layout_offset, string_offset, len(pool.data))
+    return header + bytes(emojis + icons + layouts + pool.data)
+
+
+def decode_index(data):
+    (magic, version, file_count, emoji_count, icon_count, layout_count, font, emoji_offset,
+     icon_offset, layout_offset, string_offset, string_size) = INDEX_HEADER.unpack_from(data, 0)
+    if magic != INDEX_MAGIC or version != INDEX_VERSION:
+        raise ValueError('bad index.bin header')
+    pool = data[string_offset:string_offset + string_size]
+
+    def string(offset):
+        if offset == STR_NONE:
+            return None
+        return pool[offset:pool.index(b'\0', offset)].decode()
+
+    result = {'file_count': file_count, 'font': font, 'emojis': [], 'icons': [], 'layouts': []}
+    for i in range(emoji_count):
+        name, idx, fps, flags = INDEX_EMOJI.unpack_from(data, emoji_offset + i * INDEX_EMOJI.size)
+        result['emojis'].append((string(name), idx, fps, bool(flags & EMOJI_LOOP)))
+    for i in range(icon_count):
+        name, idx, _ = INDEX_ICON.unpack_from(data, icon_offset + i * INDEX_ICON.size)
+        result['icons'].append((string(name), idx))
+    for i in range(layout_count):
+        f = INDEX_LAYOUT.unpack_from(data, layout_offset + i * INDEX_LAYOUT.size)
+        result['layouts'].append({
+            'name': string(f[0]), 'align': string(f[1]), 'text_align': string(f[2]),
+            'long_mode': string(f[3]), 'type': LAYOUT_TYPES[f[4]], 'flags': f[5],
+            'qrcode_size': f[6], 'x': f[7], 'y': f[8], 'width': f[9], 'height': f[10],
+            'color': f[11], 'speed': f[12], 'snap_interval': f[13], 'period': f[14],
+            'repeat_count': f[15],
+        })
+    return result
+
+
+def find_file(files, name):
+    for f in files:
+        if f['name'] == name:
+            return f
+    return None
+
+
+def cmd_build(args):
+    with open(args.input, 'rb') as fp:
+        files = read_assets(fp.read(), args.name_length)
+    files = [f for f in files if f['name'] != INDEX_BIN]
+
+    index_json = find_file(files, INDEX_JSON)
+    if index_json is None:
+        sys.exit('%s not found in %s' % (INDEX_JSON, args.input))
+
+    # index.bin counts itself, so its file_count must cover the appended entry
+    names = [f['name'] for f in files] + [INDEX_BIN]
+    index_bin = encode_index(json.loads(index_json['data']), names)
+    files.append({'name': INDEX_BIN, 'data': index_bin, 'width': 0, 'height': 0})
+
+    with open(args.output or args.input, 'wb') as fp:
+        fp.write(write_assets(files, args.name_length))
+    print('%s: %d bytes, %d files' % (INDEX_BIN, len(index_bin), len(files)))
+
+
+def cmd_verify(args):
+    with open(args.input, 'rb') as fp:
+        files = read_assets(fp.read(), args.name_length)
+    names = [f['name'] for f in files]
+
+    index_json = find_file(files, INDEX_JSON)
+    index_bin = find_file(files, INDEX_BIN)
+    if index_json is None or index_bin is None:
+        sys.exit('%s or %s not found in %s' % (INDEX_JSON, INDEX_BIN, args.input))
+
+    expected = decode_index(encode_index(json.loads(index_json['data']), names))
+    actual = decode_index(index_bin['data'])
+    if expected != actual:
+        for key in expected:
+            if expected[key] != actual[key]:
+                print('mismatch in %s:\n  expected %s\n  actual   %s' % (key, expected[key], actual[key]))
+        sys.exit(1)
+    print('%s matches %s: %d emojis, %d icons, %d layouts' % (
+        INDEX_BIN, INDEX_JSON, len(actual['emojis']), len(actual['icons']), len(actual['layouts'])))
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument('--name-length', type=int, default=32, help='CONFIG_MMAP_FILE_NAME_LENGTH of the assets bin')
+    sub = parser.add_subparsers(dest='command', required=True)
+
+    build = sub.add_parser('build', help='append index.bin to an assets bin')
+    build.add_argument('input')
+    build.add_argument('-o', '--output', help='output assets bin (default: overwrite input)')
+    build.set_defaults(func=cmd_build)
+
+    verify = sub.add_parser('verify', help='check index.bin against index.json')
+    verify.add_argument('input')
+    verify.set_defaults(func=cmd_verify)
+
+    args = parser.parse_args()
+    args.func(args)
+
+
+if __name__ == '__main__':
+    main()